@@ -12,11 +12,13 @@
 // limitations under the License.
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <unordered_map>
 #include <vector>
 #include <mutex>
 #include <iostream>
+#include <pipe_trace.h>
 
 #include "svdpi.h"
 #include "verilated_vpi.h"
@@ -44,13 +46,16 @@ extern "C" {
   int dpi_register();
   void dpi_assert(int inst, bool cond, int delay);
 
+  int dpi_trace_enabled(int level);
   void dpi_trace(int level, const char* format, ...);
+  void dpi_trace_pipe(int stage, int core_id, int wid, int unit, int64_t PC, int64_t tmask, int64_t uuid);
   void dpi_trace_start();
   void dpi_trace_stop();
 }
 
 bool sim_trace_enabled();
 void sim_trace_enable(bool enable);
+double sc_time_stamp();
 
 class ShiftRegister {
 public:
@@ -195,6 +200,36 @@ void dpi_trace(int level, const char* format, ...) {
 	va_end(va);
 }
 
+int dpi_trace_enabled(int level) {
+  return (level <= DEBUG_LEVEL) && sim_trace_enabled();
+}
+
+// Binary pipeline trace, written to the file named by VORTEX_PIPE_TRACE.
+// The simulator evaluates the design twice per clock cycle.
+void dpi_trace_pipe(int stage, int core_id, int wid, int unit, int64_t PC, int64_t tmask, int64_t uuid) {
+  static vortex::PipeTraceWriter s_writer;
+  static bool s_init = false;
+  if (!s_init) {
+    s_init = true;
+    auto filename = getenv("VORTEX_PIPE_TRACE");
+    if (filename && s_writer.open(filename, 1, 2) != 0) {
+      std::cerr << "Error: failed to open pipe trace " << filename << std::endl;
+    }
+  }
+  if (!s_writer.is_open())
+    return;
+  vortex::pipe_trace_rec_t rec;
+  rec.timestamp = (uint64_t)sc_time_stamp();
+  rec.uuid    = uuid;
+  rec.PC      = PC;
+  rec.tmask   = tmask;
+  rec.core_id = core_id;
+  rec.wid     = wid;
+  rec.stage   = (vortex::PipeStage)stage;
+  rec.unit    = (vortex::PipeUnit)unit;
+  s_writer.record(rec);
+}
+
 void dpi_trace_start() {
   sim_trace_enable(true);
 }
@@ -27,6 +27,8 @@ import "DPI-C" function int dpi_register();
 import "DPI-C" function void dpi_assert(int inst, input logic cond, input int delay);
 
 import "DPI-C" function void dpi_trace(input int level, input string format /*verilator sformat*/);
+import "DPI-C" function int dpi_trace_enabled(input int level);
+import "DPI-C" function void dpi_trace_pipe(input int stage, input int core_id, input int wid, input int unit, input longint PC, input longint tmask, input longint uuid);
 import "DPI-C" function void dpi_trace_start();
 import "DPI-C" function void dpi_trace_stop();
 
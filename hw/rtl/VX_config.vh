@@ -309,6 +309,10 @@
         `ifndef PT_SIZE_LIMIT
         `define PT_SIZE_LIMIT (1<<23)
         `endif
+        // highest page table level mapping superpages (4MB), 0 to disable
+        `ifndef VM_SUPERPAGE_LEVEL
+        `define VM_SUPERPAGE_LEVEL (1)
+        `endif
     `else
         `ifndef VM_ADDR_MODE
         `define VM_ADDR_MODE SV39 //or BARE
@@ -325,6 +329,10 @@
         `ifndef PT_SIZE_LIMIT
         `define PT_SIZE_LIMIT (1<<25)
         `endif
+        // highest page table level mapping superpages (2MB, 1GB), 0 to disable
+        `ifndef VM_SUPERPAGE_LEVEL
+        `define VM_SUPERPAGE_LEVEL (2)
+        `endif
     `endif
 
     `ifndef PT_SIZE
@@ -335,6 +343,38 @@
     `define TLB_SIZE (32)
     `endif
 
+    `ifndef TLB_NUM_WAYS
+    `define TLB_NUM_WAYS (4)
+    `endif
+
+    `ifndef L2_TLB_SIZE
+    `define L2_TLB_SIZE (512)
+    `endif
+
+    `ifndef L2_TLB_NUM_WAYS
+    `define L2_TLB_NUM_WAYS (8)
+    `endif
+
+    // TLB replacement policy: 0=LRU, 1=FIFO, 2=random
+    `ifndef TLB_REPL_POLICY
+    `define TLB_REPL_POLICY (0)
+    `endif
+
+    // page walk cache entries
+    `ifndef PWC_SIZE
+    `define PWC_SIZE (16)
+    `endif
+
+    // cycles added by an L2 TLB hit
+    `ifndef L2_TLB_LATENCY
+    `define L2_TLB_LATENCY (4)
+    `endif
+
+    // cycles added by each page table read of a page walk
+    `ifndef PTW_MEM_LATENCY
+    `define PTW_MEM_LATENCY (40)
+    `endif
+
 `endif
 
 // Pipeline Configuration /////////////////////////////////////////////////////
@@ -118,12 +118,17 @@
 
 `ifdef SV_DPI
 `define TRACE(level, args) \
-    dpi_trace(level, $sformatf args);
+    if (dpi_trace_enabled(level) != 0) begin \
+        dpi_trace(level, $sformatf args); \
+    end
+`define TRACE_PIPE(stage, core_id, wid, unit, pc, tmask, uuid) \
+    dpi_trace_pipe(stage, core_id, 32'(wid), unit, 64'(pc), 64'(tmask), 64'(uuid));
 `else
 `define TRACE(level, args) \
     if (level <= `DEBUG_LEVEL) begin \
         $write args; \
     end
+`define TRACE_PIPE(stage, core_id, wid, unit, pc, tmask, uuid)
 `endif
 
 `define SFORMATF(x) $sformatf x
@@ -139,6 +144,7 @@
 `define TRACE(level, args) \
     if (level <= `DEBUG_LEVEL) begin \
     end
+`define TRACE_PIPE(stage, core_id, wid, unit, pc, tmask, uuid)
 `define SFORMATF(x) ""
 
 `define TRACING_ON
@@ -26,8 +26,30 @@ package VX_trace_pkg;
 
 `ifdef SV_DPI
     import "DPI-C" function void dpi_trace(input int level, input string format /*verilator sformat*/);
+    import "DPI-C" function int dpi_trace_enabled(input int level);
 `endif
 
+    // binary pipeline trace codes (see sim/common/pipe_trace.h)
+    localparam PIPE_SCHEDULE = 0;
+    localparam PIPE_IBUFFER  = 1;
+    localparam PIPE_DISPATCH = 2;
+    localparam PIPE_COMMIT   = 3;
+
+    function automatic int pipe_unit(input [EX_BITS-1:0] ex_type);
+        case (ex_type)
+            EX_ALU: return 1;
+            EX_LSU: return 2;
+            EX_SFU: return 3;
+        `ifdef EXT_F_ENABLE
+            EX_FPU: return 4;
+        `endif
+        `ifdef EXT_TCU_ENABLE
+            EX_TCU: return 5;
+        `endif
+            default: return 0;
+        endcase
+    endfunction
+
     task trace_reg_idx(input int level, input reg_idx_t reg_id);
         `TRACE(level, ("%0d", to_reg_number(reg_id)));
     endtask
@@ -43,6 +43,7 @@
 `define VX_DCR_MPM_CLASS_CORE           1
 `define VX_DCR_MPM_CLASS_MEM            2
 `define VX_DCR_MPM_CLASS_VEC            3
+`define VX_DCR_MPM_CLASS_CACHE          4
 
 // User Floating-Point CSRs ///////////////////////////////////////////////////
 
@@ -68,6 +69,8 @@
 
 `define VX_CSR_MNSTATUS                 12'h744
 
+`define VX_CSR_SIM_MARKER               12'h7C0     // simulation marker (write-only)
+
 `define VX_CSR_MPM_BASE                 12'hB00
 `define VX_CSR_MPM_BASE_H               12'hB80
 `define VX_CSR_MPM_USER                 12'hB03
@@ -122,6 +125,20 @@
 `define VX_CSR_MPM_IFETCH_LT_H          12'hB91
 `define VX_CSR_MPM_LOAD_LT              12'hB12
 `define VX_CSR_MPM_LOAD_LT_H            12'hB92
+// PERF: simulator decode cache
+`define VX_CSR_MPM_DECODES              12'hB15
+`define VX_CSR_MPM_DECODES_H            12'hB95
+`define VX_CSR_MPM_DECODE_HITS          12'hB16
+`define VX_CSR_MPM_DECODE_HITS_H        12'hB96
+// PERF: simulator address translation
+`define VX_CSR_MPM_TLB_HITS             12'hB17
+`define VX_CSR_MPM_TLB_HITS_H           12'hB97
+`define VX_CSR_MPM_TLB_MISSES           12'hB18
+`define VX_CSR_MPM_TLB_MISSES_H         12'hB98
+`define VX_CSR_MPM_TLB_WALK_LT          12'hB19     // page walk latency
+`define VX_CSR_MPM_TLB_WALK_LT_H        12'hB99
+`define VX_CSR_MPM_PWC_HITS             12'hB1A     // page walk cache hits
+`define VX_CSR_MPM_PWC_HITS_H           12'hB9A
 
 // Machine Performance-monitoring memory counters (class 2) ///////////////////
 
@@ -202,6 +219,65 @@
 `define VX_CSR_MPM_VEC_ST               12'hB06     // vector stalls
 `define VX_CSR_MPM_VEC_ST_H             12'hB86
 
+// Machine Performance-monitoring cache counters (class 4) ////////////////////
+// simulator MSHR statistics, the occupancy histogram counts the bank cycles
+// spent in each quarter of the MSHR capacity
+// PERF: icache
+`define VX_CSR_MPM_ICACHE_MSHR_MRG      12'hB03     // merged secondary misses
+`define VX_CSR_MPM_ICACHE_MSHR_MRG_H    12'hB83
+`define VX_CSR_MPM_ICACHE_MSHR_FULL     12'hB04     // MSHR full cycles
+`define VX_CSR_MPM_ICACHE_MSHR_FULL_H   12'hB84
+`define VX_CSR_MPM_ICACHE_MSHR_OCC0     12'hB05     // occupancy <= 25%
+`define VX_CSR_MPM_ICACHE_MSHR_OCC0_H   12'hB85
+`define VX_CSR_MPM_ICACHE_MSHR_OCC1     12'hB06     // occupancy <= 50%
+`define VX_CSR_MPM_ICACHE_MSHR_OCC1_H   12'hB86
+`define VX_CSR_MPM_ICACHE_MSHR_OCC2     12'hB07     // occupancy <= 75%
+`define VX_CSR_MPM_ICACHE_MSHR_OCC2_H   12'hB87
+`define VX_CSR_MPM_ICACHE_MSHR_OCC3     12'hB08     // occupancy <= 100%
+`define VX_CSR_MPM_ICACHE_MSHR_OCC3_H   12'hB88
+
+// PERF: dcache
+`define VX_CSR_MPM_DCACHE_MSHR_MRG      12'hB09     // merged secondary misses
+`define VX_CSR_MPM_DCACHE_MSHR_MRG_H    12'hB89
+`define VX_CSR_MPM_DCACHE_MSHR_FULL     12'hB0A     // MSHR full cycles
+`define VX_CSR_MPM_DCACHE_MSHR_FULL_H   12'hB8A
+`define VX_CSR_MPM_DCACHE_MSHR_OCC0     12'hB0B     // occupancy <= 25%
+`define VX_CSR_MPM_DCACHE_MSHR_OCC0_H   12'hB8B
+`define VX_CSR_MPM_DCACHE_MSHR_OCC1     12'hB0C     // occupancy <= 50%
+`define VX_CSR_MPM_DCACHE_MSHR_OCC1_H   12'hB8C
+`define VX_CSR_MPM_DCACHE_MSHR_OCC2     12'hB0D     // occupancy <= 75%
+`define VX_CSR_MPM_DCACHE_MSHR_OCC2_H   12'hB8D
+`define VX_CSR_MPM_DCACHE_MSHR_OCC3     12'hB0E     // occupancy <= 100%
+`define VX_CSR_MPM_DCACHE_MSHR_OCC3_H   12'hB8E
+
+// PERF: l2cache
+`define VX_CSR_MPM_L2CACHE_MSHR_MRG     12'hB0F     // merged secondary misses
+`define VX_CSR_MPM_L2CACHE_MSHR_MRG_H   12'hB8F
+`define VX_CSR_MPM_L2CACHE_MSHR_FULL    12'hB10     // MSHR full cycles
+`define VX_CSR_MPM_L2CACHE_MSHR_FULL_H  12'hB90
+`define VX_CSR_MPM_L2CACHE_MSHR_OCC0    12'hB11     // occupancy <= 25%
+`define VX_CSR_MPM_L2CACHE_MSHR_OCC0_H  12'hB91
+`define VX_CSR_MPM_L2CACHE_MSHR_OCC1    12'hB12     // occupancy <= 50%
+`define VX_CSR_MPM_L2CACHE_MSHR_OCC1_H  12'hB92
+`define VX_CSR_MPM_L2CACHE_MSHR_OCC2    12'hB13     // occupancy <= 75%
+`define VX_CSR_MPM_L2CACHE_MSHR_OCC2_H  12'hB93
+`define VX_CSR_MPM_L2CACHE_MSHR_OCC3    12'hB14     // occupancy <= 100%
+`define VX_CSR_MPM_L2CACHE_MSHR_OCC3_H  12'hB94
+
+// PERF: l3cache
+`define VX_CSR_MPM_L3CACHE_MSHR_MRG     12'hB15     // merged secondary misses
+`define VX_CSR_MPM_L3CACHE_MSHR_MRG_H   12'hB95
+`define VX_CSR_MPM_L3CACHE_MSHR_FULL    12'hB16     // MSHR full cycles
+`define VX_CSR_MPM_L3CACHE_MSHR_FULL_H  12'hB96
+`define VX_CSR_MPM_L3CACHE_MSHR_OCC0    12'hB17     // occupancy <= 25%
+`define VX_CSR_MPM_L3CACHE_MSHR_OCC0_H  12'hB97
+`define VX_CSR_MPM_L3CACHE_MSHR_OCC1    12'hB18     // occupancy <= 50%
+`define VX_CSR_MPM_L3CACHE_MSHR_OCC1_H  12'hB98
+`define VX_CSR_MPM_L3CACHE_MSHR_OCC2    12'hB19     // occupancy <= 75%
+`define VX_CSR_MPM_L3CACHE_MSHR_OCC2_H  12'hB99
+`define VX_CSR_MPM_L3CACHE_MSHR_OCC3    12'hB1A     // occupancy <= 100%
+`define VX_CSR_MPM_L3CACHE_MSHR_OCC3_H  12'hB9A
+
 // <Add your own counters: use addresses hB03..B1F, hB83..hB9F>
 
 // Machine Information Registers //////////////////////////////////////////////
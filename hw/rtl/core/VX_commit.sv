@@ -14,7 +14,8 @@
 `include "VX_define.vh"
 
 module VX_commit import VX_gpu_pkg::*; #(
-    parameter `STRING INSTANCE_ID = ""
+    parameter `STRING INSTANCE_ID = "",
+    parameter CORE_ID = 0
 ) (
     input wire              clk,
     input wire              reset,
@@ -28,6 +29,7 @@ module VX_commit import VX_gpu_pkg::*; #(
     VX_commit_sched_if.master commit_sched_if
 );
     `UNUSED_SPARAM (INSTANCE_ID)
+    `UNUSED_PARAM (CORE_ID)
     localparam OUT_DATAW = $bits(commit_t);
     localparam COMMIT_SIZEW = `CLOG2(`SIMD_WIDTH + 1);
     localparam COMMIT_ALL_SIZEW = COMMIT_SIZEW + `ISSUE_WIDTH - 1;
@@ -184,6 +186,9 @@ module VX_commit import VX_gpu_pkg::*; #(
                     `TRACE(1, (", tmask=%b, wb=%0d, rd=%0d, sop=%b, eop=%b, data=", commit_if[j * `ISSUE_WIDTH + i].data.tmask, commit_if[j * `ISSUE_WIDTH + i].data.wb, commit_if[j * `ISSUE_WIDTH + i].data.rd, commit_if[j * `ISSUE_WIDTH + i].data.sop, commit_if[j * `ISSUE_WIDTH + i].data.eop))
                     `TRACE_ARRAY1D(1, "0x%0h", commit_if[j * `ISSUE_WIDTH + i].data.data, `SIMD_WIDTH)
                     `TRACE(1, (" (#%0d)\n", commit_if[j * `ISSUE_WIDTH + i].data.uuid))
+                    if (commit_if[j * `ISSUE_WIDTH + i].data.eop) begin
+                        `TRACE_PIPE(VX_trace_pkg::PIPE_COMMIT, CORE_ID, commit_if[j * `ISSUE_WIDTH + i].data.wid, VX_trace_pkg::pipe_unit(j), to_fullPC(commit_if[j * `ISSUE_WIDTH + i].data.PC), commit_if[j * `ISSUE_WIDTH + i].data.tmask, commit_if[j * `ISSUE_WIDTH + i].data.uuid)
+                    end
                 end
             end
         end
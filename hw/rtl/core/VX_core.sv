@@ -143,7 +143,8 @@ module VX_core import VX_gpu_pkg::*; #(
     );
 
     VX_issue #(
-        .INSTANCE_ID (`SFORMATF(("%s-issue", INSTANCE_ID)))
+        .INSTANCE_ID (`SFORMATF(("%s-issue", INSTANCE_ID))),
+        .CORE_ID (CORE_ID)
     ) issue (
         `SCOPE_IO_BIND  (1)
 
@@ -189,7 +190,8 @@ module VX_core import VX_gpu_pkg::*; #(
     );
 
     VX_commit #(
-        .INSTANCE_ID (`SFORMATF(("%s-commit", INSTANCE_ID)))
+        .INSTANCE_ID (`SFORMATF(("%s-commit", INSTANCE_ID))),
+        .CORE_ID (CORE_ID)
     ) commit (
         .clk            (clk),
         .reset          (reset),
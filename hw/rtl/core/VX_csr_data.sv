@@ -158,7 +158,8 @@ import VX_fpu_pkg::*;
                 `VX_CSR_MTVEC,
                 `VX_CSR_MEPC,
                 `VX_CSR_PMPCFG0,
-                `VX_CSR_PMPADDR0: begin
+                `VX_CSR_PMPADDR0,
+                `VX_CSR_SIM_MARKER: begin
                     // do nothing!
                 end
                 `VX_CSR_MSCRATCH: begin
@@ -223,7 +224,8 @@ import VX_fpu_pkg::*;
             `VX_CSR_MTVEC,
             `VX_CSR_MEPC,
             `VX_CSR_PMPCFG0,
-            `VX_CSR_PMPADDR0 : read_data_ro_w = `XLEN'(0);
+            `VX_CSR_PMPADDR0,
+            `VX_CSR_SIM_MARKER : read_data_ro_w = `XLEN'(0);
 
             default: begin
                 read_addr_valid_w = 0;
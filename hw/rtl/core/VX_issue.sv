@@ -14,7 +14,8 @@
 `include "VX_define.vh"
 
 module VX_issue import VX_gpu_pkg::*; #(
-    parameter `STRING INSTANCE_ID = ""
+    parameter `STRING INSTANCE_ID = "",
+    parameter CORE_ID = 0
 ) (
     `SCOPE_IO_DECL
 
@@ -67,6 +68,7 @@ module VX_issue import VX_gpu_pkg::*; #(
 
         VX_issue_slice #(
             .INSTANCE_ID (`SFORMATF(("%s%0d", INSTANCE_ID, issue_id))),
+            .CORE_ID (CORE_ID),
             .ISSUE_ID (issue_id)
         ) issue_slice (
             `SCOPE_IO_BIND(issue_id)
@@ -15,6 +15,7 @@
 
 module VX_issue_slice import VX_gpu_pkg::*; #(
     parameter `STRING INSTANCE_ID = "",
+    parameter CORE_ID = 0,
     parameter ISSUE_ID = 0
 ) (
     `SCOPE_IO_DECL
@@ -32,6 +33,7 @@ module VX_issue_slice import VX_gpu_pkg::*; #(
     VX_issue_sched_if.master issue_sched_if
 );
     `UNUSED_PARAM (ISSUE_ID)
+    `UNUSED_PARAM (CORE_ID)
 
     VX_ibuffer_if ibuffer_if [PER_ISSUE_WARPS]();
     VX_scoreboard_if scoreboard_if();
@@ -186,6 +188,7 @@ module VX_issue_slice import VX_gpu_pkg::*; #(
                 `TRACE(1, (", "))
                 VX_trace_pkg::trace_op_args(1, ibuffer_if[i].data.ex_type, ibuffer_if[i].data.op_type, ibuffer_if[i].data.op_args);
                 `TRACE(1, (" (#%0d)\n", ibuffer_if[i].data.uuid))
+                `TRACE_PIPE(VX_trace_pkg::PIPE_IBUFFER, CORE_ID, wid, VX_trace_pkg::pipe_unit(ibuffer_if[i].data.ex_type), to_fullPC(ibuffer_if[i].data.PC), ibuffer_if[i].data.tmask, ibuffer_if[i].data.uuid)
             end
         end
     end
@@ -205,6 +208,9 @@ module VX_issue_slice import VX_gpu_pkg::*; #(
             `TRACE(1, (", "))
            VX_trace_pkg::trace_op_args(1, operands_if.data.ex_type, operands_if.data.op_type, operands_if.data.op_args);
             `TRACE(1, (", sop=%b, eop=%b (#%0d)\n", operands_if.data.sop, operands_if.data.eop, operands_if.data.uuid))
+            if (operands_if.data.sop) begin
+                `TRACE_PIPE(VX_trace_pkg::PIPE_DISPATCH, CORE_ID, wis_to_wid(operands_if.data.wis, ISSUE_ID), VX_trace_pkg::pipe_unit(operands_if.data.ex_type), to_fullPC(operands_if.data.PC), operands_if.data.tmask, operands_if.data.uuid)
+            end
         end
     end
 `endif
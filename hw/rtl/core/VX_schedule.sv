@@ -468,6 +468,7 @@ module VX_schedule import VX_gpu_pkg::*; #(
     always @(posedge clk) begin
         if (schedule_fire) begin
             `TRACE(1, ("%t: %s: wid=%0d, PC=0x%0h, tmask=%b (#%0d)\n", $time, INSTANCE_ID, schedule_wid, to_fullPC(schedule_pc), schedule_tmask, instr_uuid))
+            `TRACE_PIPE(VX_trace_pkg::PIPE_SCHEDULE, CORE_ID, schedule_wid, 0, to_fullPC(schedule_pc), schedule_tmask, instr_uuid)
         end
     end
 `endif
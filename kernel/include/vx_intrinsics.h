@@ -221,6 +221,11 @@ inline void vx_fence() {
     __asm__ volatile ("fence iorw, iorw");
 }
 
+// Simulation marker, can be used by simx to switch from functional fast-forward to detailed simulation
+inline void vx_sim_marker(int id) {
+    csr_write(VX_CSR_SIM_MARKER, id);
+}
+
 // Returns 1 if every active lane’s predicate is true, 0 otherwise.
 inline int vx_vote_all(int predicate) {
     int ret;
@@ -3,39 +3,33 @@
 # exit when any command fails
 set -e
 
+SCRIPT_DIR=$(dirname "$0")
+
 # ensure build
-make -s
+make -s -C sim/sweep
+make -s -C tests/kernel/vecadd
 
-sgemm()
+cache()
 {
 echo "begin cache tests"
 
-CONFIGS="-DICACHE_NUM_WAYS=2" ./ci/blackbox.sh --driver=rtlsim --app=sgemm --args="-n64" --perf=1 | grep 'PERF' > cache_perf.log
-echo -e "\n**************************************\n" >> cache_perf.log
-CONFIGS="-DDCACHE_NUM_WAYS=2" ./ci/blackbox.sh --driver=rtlsim --app=sgemm --args="-n64" --perf=1 | grep 'PERF' >> cache_perf.log
-echo -e "\n**************************************\n" >> cache_perf.log
-CONFIGS="-DICACHE_NUM_WAYS=4" ./ci/blackbox.sh --driver=rtlsim --app=sgemm --args="-n64" --perf=1 | grep 'PERF' >> cache_perf.log
-echo -e "\n**************************************\n" >> cache_perf.log
-CONFIGS="-DDCACHE_NUM_WAYS=4" ./ci/blackbox.sh --driver=rtlsim --app=sgemm --args="-n64" --perf=1 | grep 'PERF' >> cache_perf.log
-echo -e "\n**************************************\n" >> cache_perf.log
-CONFIGS="-DICACHE_NUM_WAYS=8" ./ci/blackbox.sh --driver=rtlsim --app=sgemm --args="-n64" --perf=1 | grep 'PERF' >> cache_perf.log
-echo -e "\n**************************************\n" >> cache_perf.log
-CONFIGS="-DDCACHE_NUM_WAYS=8" ./ci/blackbox.sh --driver=rtlsim --app=sgemm --args="-n64" --perf=1 | grep 'PERF' >> cache_perf.log
+# sweep the icache and dcache geometry, one simulation per point on all host cores
+./sim/sweep/sweep -G $SCRIPT_DIR/grid.json -o cache_perf.csv "$@" tests/kernel/vecadd/vecadd.bin
 
 echo "cache tests done!"
 }
 
 usage()
 {
-    echo "usage: [-s] [-h|--help]"
+    echo "usage: [-s] [-h|--help] [sweep options]"
 }
 
 case $1 in
-    -s ) sgemm
+    -s ) shift
+         cache "$@"
             ;;
     -h | --help ) usage
                     ;;
-    * ) sgemm
+    * ) cache "$@"
         ;;
 esac
-shift
\ No newline at end of file
@@ -5,4 +5,10 @@ SIM_DIR := $(VORTEX_HOME)/sim
 HW_DIR := $(VORTEX_HOME)/hw
 
 INC_DIR := $(VORTEX_HOME)/runtime/include
-RT_COMMON_DIR := $(VORTEX_HOME)/runtime/common
\ No newline at end of file
+RT_COMMON_DIR := $(VORTEX_HOME)/runtime/common
+
+# Optional zstd support for compressed images
+ifdef ZSTD
+CXXFLAGS += -DVX_ZSTD_ENABLE
+LDFLAGS += -lzstd
+endif
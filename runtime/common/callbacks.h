@@ -45,6 +45,9 @@ typedef struct {
   // return device memory address
   int (*mem_address) (vx_buffer_h hbuffer, uint64_t* address);
 
+  // return the pinned host memory of a buffer
+  int (*mem_host_ptr) (vx_buffer_h hbuffer, void** host_ptr);
+
   // get device memory info
   int (*mem_info) (vx_device_h hdevice, uint64_t* mem_free, uint64_t* mem_used);
 
@@ -69,6 +72,39 @@ typedef struct {
   // query device performance counter
   int (*mpm_query) (vx_device_h hdevice, uint32_t addr, uint32_t core_id, uint64_t* value);
 
+  // save or restore a simulator checkpoint
+  int (*checkpoint) (vx_device_h hdevice, const char* path, int mode);
+
+  // create a command queue
+  int (*queue_create) (vx_device_h hdevice, vx_queue_h* hqueue);
+
+  // wait for pending commands and release the queue
+  int (*queue_destroy) (vx_queue_h hqueue);
+
+  // wait for all pending commands
+  int (*queue_finish) (vx_queue_h hqueue);
+
+  // make subsequent commands wait for an event
+  int (*queue_wait_event) (vx_queue_h hqueue, vx_event_h hevent);
+
+  // enqueue a copy from host to device memory
+  int (*copy_to_dev_async) (vx_queue_h hqueue, vx_buffer_h hbuffer, const void* host_ptr, uint64_t dst_offset, uint64_t size, vx_event_h* hevent);
+
+  // enqueue a copy from device memory to host
+  int (*copy_from_dev_async) (vx_queue_h hqueue, void* host_ptr, vx_buffer_h hbuffer, uint64_t src_offset, uint64_t size, vx_event_h* hevent);
+
+  // enqueue a kernel launch
+  int (*start_async) (vx_queue_h hqueue, vx_buffer_h hkernel, vx_buffer_h harguments, vx_event_h* hevent);
+
+  // wait for an event with milliseconds timeout
+  int (*event_wait) (vx_event_h hevent, uint64_t timeout);
+
+  // query an event status
+  int (*event_status) (vx_event_h hevent);
+
+  // release an event
+  int (*event_release) (vx_event_h hevent);
+
 } callbacks_t;
 
 int vx_dev_init(callbacks_t* callbacks);
@@ -0,0 +1,139 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+// Polling policy used while waiting for the device to become ready:
+// the first spin_count polls are issued back-to-back, the next yield_count
+// polls yield the CPU in between, then the wait sleeps for min_sleep_us
+// doubling up to max_sleep_us.
+// It can be overridden with VORTEX_WAIT_POLICY=<spin>:<yield>:<min_us>:<max_us>.
+struct wait_policy_t {
+  uint32_t spin_count;
+  uint32_t yield_count;
+  uint32_t min_sleep_us;
+  uint32_t max_sleep_us;
+
+  static const wait_policy_t& get() {
+    static const wait_policy_t policy = [] {
+      wait_policy_t policy{64, 64, 10, 1000};
+      auto policy_s = getenv("VORTEX_WAIT_POLICY");
+      if (policy_s != nullptr && policy_s[0] != '\0') {
+        wait_policy_t custom;
+        if (4 == sscanf(policy_s, "%u:%u:%u:%u",
+                        &custom.spin_count,
+                        &custom.yield_count,
+                        &custom.min_sleep_us,
+                        &custom.max_sleep_us)) {
+          custom.max_sleep_us = std::max(custom.min_sleep_us, custom.max_sleep_us);
+          policy = custom;
+        } else {
+          printf("[VXDRV] Warning: invalid VORTEX_WAIT_POLICY '%s', expected <spin>:<yield>:<min_us>:<max_us>\n", policy_s);
+        }
+      }
+      return policy;
+    }();
+    return policy;
+  }
+};
+
+// Paces the polling loop of a single wait according to the wait policy.
+class ready_poller {
+public:
+  ready_poller(uint64_t timeout_ms, const wait_policy_t& policy = wait_policy_t::get())
+    : policy_(policy)
+    , deadline_(std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms))
+    , polls_(0)
+    , sleep_us_(policy.min_sleep_us)
+  {}
+
+  bool expired() const {
+    return std::chrono::steady_clock::now() >= deadline_;
+  }
+
+  // time left before the deadline
+  std::chrono::microseconds remaining() const {
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline_)
+      return std::chrono::microseconds(0);
+    return std::chrono::duration_cast<std::chrono::microseconds>(deadline_ - now);
+  }
+
+  // next sleep interval, or zero while still spinning or yielding
+  std::chrono::microseconds next_sleep() {
+    auto polls = polls_++;
+    if (polls < policy_.spin_count + policy_.yield_count)
+      return std::chrono::microseconds(0);
+    auto sleep_us = sleep_us_;
+    sleep_us_ = std::min<uint64_t>(sleep_us_ * 2, policy_.max_sleep_us);
+    return std::min(std::chrono::microseconds(sleep_us), this->remaining());
+  }
+
+  // wait before the next poll
+  void pause() {
+    auto polls = polls_;
+    auto sleep_time = this->next_sleep();
+    if (sleep_time.count() != 0) {
+      std::this_thread::sleep_for(sleep_time);
+    } else if (polls >= policy_.spin_count) {
+      std::this_thread::yield();
+    }
+  }
+
+private:
+  const wait_policy_t& policy_;
+  std::chrono::steady_clock::time_point deadline_;
+  uint64_t polls_;
+  uint64_t sleep_us_;
+};
+
+// Completion notification raised by the device when it goes idle.
+// Waiters sample the generation before polling the device, so that a
+// completion that happens in between wakes them up immediately.
+class completion_notifier {
+public:
+  completion_notifier() : generation_(0) {}
+
+  void notify() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++generation_;
+    }
+    cv_.notify_all();
+  }
+
+  uint64_t generation() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+  }
+
+  // returns true if notified since the given generation
+  bool wait(uint64_t generation, std::chrono::microseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(lock, timeout, [&] { return generation_ != generation; });
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  uint64_t generation_;
+};
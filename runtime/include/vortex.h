@@ -25,6 +25,8 @@ extern "C" {
 
 typedef void* vx_device_h;
 typedef void* vx_buffer_h;
+typedef void* vx_queue_h;
+typedef void* vx_event_h;
 
 // device caps ids
 #define VX_CAPS_VERSION             0x0
@@ -71,6 +73,10 @@ typedef void* vx_buffer_h;
 #define VX_MEM_READ_WRITE           0x3
 #define VX_MEM_PIN_MEMORY           0x4
 
+// simulator checkpoint modes
+#define VX_CHECKPOINT_SAVE          0x0
+#define VX_CHECKPOINT_RESTORE       0x1
+
 // open the device and connect to it
 int vx_dev_open(vx_device_h* hdevice);
 
@@ -95,6 +101,10 @@ int vx_mem_access(vx_buffer_h hbuffer, uint64_t offset, uint64_t size, int flags
 // return device memory address
 int vx_mem_address(vx_buffer_h hbuffer, uint64_t* address);
 
+// return the pinned host memory of a buffer allocated with VX_MEM_PIN_MEMORY,
+// copies from/to that memory are transferred without staging when supported
+int vx_mem_host_ptr(vx_buffer_h hbuffer, void** host_ptr);
+
 // get device memory info
 int vx_mem_info(vx_device_h hdevice, uint64_t* mem_free, uint64_t* mem_used);
 
@@ -119,6 +129,49 @@ int vx_dcr_write(vx_device_h hdevice, uint32_t addr, uint32_t value);
 // query device performance counter
 int vx_mpm_query(vx_device_h hdevice, uint32_t addr, uint32_t core_id, uint64_t* value);
 
+// save or restore a simulator checkpoint of the device memory, caches and
+// configuration registers between kernel launches (simulators only).
+// Host-side allocations are not part of the checkpoint: after a restore, the
+// application replays its buffer allocations and skips the setup work.
+int vx_checkpoint(vx_device_h hdevice, const char* path, int mode);
+
+/////////////////////////////// COMMAND QUEUES ////////////////////////////////
+
+// Commands submitted to a queue execute asynchronously in submission order.
+// Commands from different queues may overlap, e.g. uploading the inputs of
+// the next kernel while the current one is running.
+// The returned events are optional (pass NULL) and must be released.
+
+// create a command queue
+int vx_queue_create(vx_device_h hdevice, vx_queue_h* hqueue);
+
+// wait for pending commands and release the queue
+int vx_queue_destroy(vx_queue_h hqueue);
+
+// wait for all pending commands, returns the first command error
+int vx_queue_finish(vx_queue_h hqueue);
+
+// make subsequent commands wait for an event from any queue
+int vx_queue_wait_event(vx_queue_h hqueue, vx_event_h hevent);
+
+// enqueue a copy from host to device memory, host_ptr must remain valid until completion
+int vx_copy_to_dev_async(vx_queue_h hqueue, vx_buffer_h hbuffer, const void* host_ptr, uint64_t dst_offset, uint64_t size, vx_event_h* hevent);
+
+// enqueue a copy from device memory to host, host_ptr must remain valid until completion
+int vx_copy_from_dev_async(vx_queue_h hqueue, void* host_ptr, vx_buffer_h hbuffer, uint64_t src_offset, uint64_t size, vx_event_h* hevent);
+
+// enqueue a kernel launch, completes when the device is ready again
+int vx_start_async(vx_queue_h hqueue, vx_buffer_h hkernel, vx_buffer_h harguments, vx_event_h* hevent);
+
+// wait for an event with milliseconds timeout, returns the command status
+int vx_event_wait(vx_event_h hevent, uint64_t timeout);
+
+// query an event, returns 1 while pending, otherwise the command status
+int vx_event_status(vx_event_h hevent);
+
+// release an event
+int vx_event_release(vx_event_h hevent);
+
 ////////////////////////////// UTILITY FUNCTIONS //////////////////////////////
 
 // upload bytes to device
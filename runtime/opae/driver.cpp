@@ -32,6 +32,9 @@
     return -1; \
 	}
 
+#define SET_API_OPTIONAL(func) \
+	opae_drv_funcs->func = (pfn_##func)dlsym(dl_handle, #func)
+
 void* dl_handle = nullptr;
 
 int drv_init(opae_drv_api_t* opae_drv_funcs) {
@@ -80,6 +83,8 @@ int drv_init(opae_drv_api_t* opae_drv_funcs) {
 	SET_API (fpgaReadMMIO64);
 	SET_API (fpgaErrStr);
 
+	SET_API_OPTIONAL (fpgaSimSetStatusCallback);
+
   return 0;
 }
 
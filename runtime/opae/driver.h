@@ -36,6 +36,10 @@ typedef fpga_result (*pfn_fpgaWriteMMIO64)(fpga_handle handle, uint32_t mmio_num
 typedef fpga_result (*pfn_fpgaReadMMIO64)(fpga_handle handle, uint32_t mmio_num, uint64_t offset, uint64_t *value);
 typedef const char *(*pfn_fpgaErrStr)(fpga_result e);
 
+// optional simulator extension
+typedef void (*pfn_fpgaStatusCallback)(void* arg, uint64_t state);
+typedef fpga_result (*pfn_fpgaSimSetStatusCallback)(fpga_handle handle, pfn_fpgaStatusCallback callback, void* arg);
+
 struct opae_drv_api_t {
 	pfn_fpgaGetProperties fpgaGetProperties;
 	pfn_fpgaPropertiesSetObjectType fpgaPropertiesSetObjectType;
@@ -53,6 +57,7 @@ struct opae_drv_api_t {
 	pfn_fpgaWriteMMIO64  	fpgaWriteMMIO64;
 	pfn_fpgaReadMMIO64    fpgaReadMMIO64;
 	pfn_fpgaErrStr     		fpgaErrStr;
+	pfn_fpgaSimSetStatusCallback fpgaSimSetStatusCallback;
 };
 
 int drv_init(opae_drv_api_t* opae_drv_funcs);
@@ -12,6 +12,7 @@
 // limitations under the License.
 
 #include <common.h>
+#include <ready_wait.h>
 
 #include "driver.h"
 
@@ -22,12 +23,14 @@
 #endif
 
 #include <algorithm>
+#include <array>
 #include <assert.h>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <list>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <stdio.h>
@@ -55,6 +58,10 @@ using namespace vortex;
 
 #define STATUS_STATE_BITS 8
 
+// staging ring used to overlap host copies with DMA transfers
+#define STAGING_RING_SIZE  2
+#define STAGING_CHUNK_SIZE (4 * 1024 * 1024)
+
 #define CHECK_HANDLE(handle, _expr, _cleanup)                                  \
   auto handle = _expr;                                                         \
   if (handle == nullptr) {                                                     \
@@ -82,10 +89,8 @@ public:
                   GLOBAL_MEM_SIZE - ALLOC_BASE_ADDR,
                   RAM_PAGE_SIZE,
                   CACHE_BLOCK_SIZE)
-    , staging_wsid_(0)
-    , staging_ioaddr_(0)
-    , staging_ptr_(nullptr)
-    , staging_size_(0)
+    , staging_ring_{}
+    , notify_enabled_(false)
   {}
 
   ~vx_device() {
@@ -93,9 +98,16 @@ public:
     vx_scope_stop(this);
   #endif
     if (fpga_ != nullptr) {
-      if (staging_size_ != 0) {
-        api_.fpgaReleaseBuffer(fpga_, staging_wsid_);
-        staging_size_ = 0;
+      if (notify_enabled_) {
+        api_.fpgaSimSetStatusCallback(fpga_, nullptr, nullptr);
+      }
+      for (auto& staging : staging_ring_) {
+        if (staging.ptr != nullptr) {
+          api_.fpgaReleaseBuffer(fpga_, staging.wsid);
+        }
+      }
+      for (auto& pinned : pinned_buffers_) {
+        api_.fpgaReleaseBuffer(fpga_, pinned.second.wsid);
       }
       api_.fpgaClose(fpga_);
     }
@@ -162,6 +174,19 @@ public:
       return -1;
     });
 
+    // get notified when the AFU goes idle if the driver supports it
+    if (api_.fpgaSimSetStatusCallback) {
+      CHECK_FPGA_ERR(api_.fpgaSimSetStatusCallback(fpga_, [](void* arg, uint64_t state) {
+        if (0 == state) {
+          reinterpret_cast<vx_device*>(arg)->notifier_.notify();
+        }
+      }, this), {
+        api_.fpgaClose(fpga_);
+        return -1;
+      });
+      notify_enabled_ = true;
+    }
+
     {
       // Load ISA CAPS
       CHECK_FPGA_ERR(api_.fpgaReadMMIO64(fpga_, 0, MMIO_ISA_CAPS, &isa_caps_), {
@@ -257,6 +282,15 @@ public:
       global_mem_.release(addr);
       return err;
     });
+    if (flags & VX_MEM_PIN_MEMORY) {
+      // allocate a pinned host mirror that the DMA engine can access directly
+      host_buffer_t pinned;
+      CHECK_ERR(this->prepare_buffer(aligned_size(size, CACHE_BLOCK_SIZE), &pinned), {
+        global_mem_.release(addr);
+        return err;
+      });
+      pinned_buffers_[addr] = pinned;
+    }
     *dev_addr = addr;
     return 0;
   }
@@ -273,9 +307,22 @@ public:
   }
 
   int mem_free(uint64_t dev_addr) {
+    auto it = pinned_buffers_.find(dev_addr);
+    if (it != pinned_buffers_.end()) {
+      api_.fpgaReleaseBuffer(fpga_, it->second.wsid);
+      pinned_buffers_.erase(it);
+    }
     return global_mem_.release(dev_addr);
   }
 
+  int mem_host_ptr(uint64_t dev_addr, void** host_ptr) {
+    auto it = pinned_buffers_.find(dev_addr);
+    if (it == pinned_buffers_.end())
+      return -1;
+    *host_ptr = it->second.ptr;
+    return 0;
+  }
+
   int mem_access(uint64_t /*dev_addr*/, uint64_t /*size*/, int /*flags*/) {
     return 0;
   }
@@ -303,33 +350,37 @@ public:
     if (this->ready_wait(VX_MAX_TIMEOUT) != 0)
       return -1;
 
-    if (this->ensure_staging(asize) != 0)
-      return -1;
-
-    // update staging buffer
-    memcpy(staging_ptr_, host_ptr, size);
-
-    auto ls_shift = (int)std::log2(CACHE_BLOCK_SIZE);
-
-    CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_ARG0, staging_ioaddr_ >> ls_shift), {
-      return -1;
-    });
-
-    CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_ARG1, dev_addr >> ls_shift), {
-      return -1;
-    });
-
-    CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_ARG2, asize >> ls_shift), {
-      return -1;
-    });
+    // zero-copy transfer from pinned memory
+    uint64_t ioaddr;
+    if (this->pinned_ioaddr(host_ptr, asize, &ioaddr)) {
+      CHECK_ERR(this->dma_command(CMD_MEM_WRITE, ioaddr, dev_addr, asize), {
+        return err;
+      });
+      return this->ready_wait(VX_MAX_TIMEOUT);
+    }
 
-    CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_TYPE, CMD_MEM_WRITE), {
+    if (this->ensure_staging() != 0)
       return -1;
-    });
 
-    // Wait for the write operation to finish
-    if (this->ready_wait(VX_MAX_TIMEOUT) != 0)
-      return -1;
+    // copy chunk i+1 into the next staging buffer while chunk i is in flight
+    auto src = (const uint8_t*)host_ptr;
+    uint64_t chunk = std::min<uint64_t>(size, STAGING_CHUNK_SIZE);
+    memcpy(staging_ring_[0].ptr, src, chunk);
+    for (uint64_t offset = 0, i = 0; offset < size; i = (i + 1) % STAGING_RING_SIZE) {
+      CHECK_ERR(this->dma_command(CMD_MEM_WRITE, staging_ring_[i].ioaddr, dev_addr + offset, aligned_size(chunk, CACHE_BLOCK_SIZE)), {
+        return err;
+      });
+      uint64_t next = offset + chunk;
+      uint64_t next_chunk = std::min<uint64_t>(size - next, STAGING_CHUNK_SIZE);
+      if (next_chunk != 0) {
+        memcpy(staging_ring_[(i + 1) % STAGING_RING_SIZE].ptr, src + next, next_chunk);
+      }
+      // Wait for the write operation to finish
+      if (this->ready_wait(VX_MAX_TIMEOUT) != 0)
+        return -1;
+      offset = next;
+      chunk = next_chunk;
+    }
 
     return 0;
   }
@@ -349,30 +400,39 @@ public:
     if (this->ready_wait(VX_MAX_TIMEOUT) != 0)
       return -1;
 
-    if (this->ensure_staging(asize) != 0)
-      return -1;
-
-    auto ls_shift = (int)std::log2(CACHE_BLOCK_SIZE);
-
-    CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_ARG0, staging_ioaddr_ >> ls_shift), {
-      return -1;
-    });
-    CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_ARG1, dev_addr >> ls_shift), {
-      return -1;
-    });
-    CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_ARG2, asize >> ls_shift), {
-      return -1;
-    });
-    CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_TYPE, CMD_MEM_READ), {
-      return -1;
-    });
+    // zero-copy transfer into pinned memory
+    uint64_t ioaddr;
+    if (this->pinned_ioaddr(host_ptr, asize, &ioaddr)) {
+      CHECK_ERR(this->dma_command(CMD_MEM_READ, ioaddr, dev_addr, asize), {
+        return err;
+      });
+      return this->ready_wait(VX_MAX_TIMEOUT);
+    }
 
-    // Wait for the write operation to finish
-    if (this->ready_wait(VX_MAX_TIMEOUT) != 0)
+    if (this->ensure_staging() != 0)
       return -1;
 
-    // read staging buffer
-    memcpy(host_ptr, staging_ptr_, size);
+    // read chunk i out of its staging buffer while chunk i+1 is in flight
+    auto dst = (uint8_t*)host_ptr;
+    uint64_t chunk = std::min<uint64_t>(size, STAGING_CHUNK_SIZE);
+    CHECK_ERR(this->dma_command(CMD_MEM_READ, staging_ring_[0].ioaddr, dev_addr, aligned_size(chunk, CACHE_BLOCK_SIZE)), {
+      return err;
+    });
+    for (uint64_t offset = 0, i = 0; offset < size; i = (i + 1) % STAGING_RING_SIZE) {
+      // Wait for the read operation to finish
+      if (this->ready_wait(VX_MAX_TIMEOUT) != 0)
+        return -1;
+      uint64_t next = offset + chunk;
+      uint64_t next_chunk = std::min<uint64_t>(size - next, STAGING_CHUNK_SIZE);
+      if (next_chunk != 0) {
+        CHECK_ERR(this->dma_command(CMD_MEM_READ, staging_ring_[(i + 1) % STAGING_RING_SIZE].ioaddr, dev_addr + next, aligned_size(next_chunk, CACHE_BLOCK_SIZE)), {
+          return err;
+        });
+      }
+      memcpy(dst + offset, staging_ring_[i].ptr, chunk);
+      offset = next;
+      chunk = next_chunk;
+    }
 
     return 0;
   }
@@ -404,16 +464,12 @@ public:
   }
 
   int ready_wait(uint64_t timeout) {
-    std::unordered_map<uint32_t, std::stringstream> print_bufs;
-
-    struct timespec sleep_time;
-    sleep_time.tv_sec = 0;
-    sleep_time.tv_nsec = 1000000;
-
-    // to milliseconds
-    uint64_t sleep_time_ms = (sleep_time.tv_sec * 1000) + (sleep_time.tv_nsec / 1000000);
+    uint64_t timeout_requested = timeout;
+    ready_poller poller(timeout);
+    auto max_sleep = std::chrono::microseconds(wait_policy_t::get().max_sleep_us);
 
     for (;;) {
+      uint64_t generation = notifier_.generation();
       uint64_t status;
       CHECK_FPGA_ERR(api_.fpgaReadMMIO64(fpga_, 0, MMIO_STATUS, &status), {
         return -1;
@@ -426,7 +482,7 @@ public:
         do {
           char cout_char = (cout_data >> 1) & 0xff;
           uint32_t cout_tid = (cout_data >> 9) & 0xff;
-          auto &ss_buf = print_bufs[cout_tid];
+          auto &ss_buf = print_bufs_[cout_tid];
           ss_buf << cout_char;
           if (cout_char == '\n') {
             std::cout << std::dec << "#" << cout_tid << ": " << ss_buf.str() << std::flush;
@@ -441,27 +497,47 @@ public:
 
       uint32_t state = status & ((1 << STATUS_STATE_BITS) - 1);
 
-      if (0 == state || 0 == timeout) {
-        for (auto &buf : print_bufs) {
-          auto str = buf.second.str();
-          if (!str.empty()) {
-            std::cout << "#" << buf.first << ": " << str << std::endl;
+      if (0 == state || poller.expired()) {
+        // partial console lines are kept across polls
+        if (0 == state || timeout_requested != 0) {
+          for (auto &buf : print_bufs_) {
+            auto str = buf.second.str();
+            if (!str.empty()) {
+              std::cout << "#" << buf.first << ": " << str << std::endl;
+            }
           }
+          print_bufs_.clear();
         }
         if (state != 0) {
-          fprintf(stdout, "[VXDRV] ready-wait timed out: state=%d\n", state);
+          // a zero timeout only polls the device
+          if (timeout_requested != 0) {
+            fprintf(stdout, "[VXDRV] ready-wait timed out: state=%d\n", state);
+          }
           return -1;
         }
         break;
       }
 
-      nanosleep(&sleep_time, nullptr);
-      timeout -= sleep_time_ms;
+      if (notify_enabled_) {
+        // wake up periodically to drain the console
+        notifier_.wait(generation, std::min(poller.remaining(), max_sleep));
+      } else {
+        poller.pause();
+      }
     };
 
     return 0;
   }
 
+  // uploads wait for the current run
+  bool overlap_uploads() const {
+    return false;
+  }
+
+  completion_notifier* notifier() {
+    return notify_enabled_ ? &notifier_ : nullptr;
+  }
+
   int dcr_write(uint32_t addr, uint32_t value) {
     CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_ARG0, addr), {
       return -1;
@@ -480,6 +556,11 @@ public:
     return dcrs_.read(addr, value);
   }
 
+  int checkpoint(const char* /*path*/, int /*mode*/) {
+    // checkpoints are only supported by the simx simulator
+    return -1;
+  }
+
   int mpm_query(uint32_t addr, uint32_t core_id, uint64_t * value) {
     uint32_t offset = addr - VX_CSR_MPM_BASE;
     if (offset > 31)
@@ -496,28 +577,68 @@ public:
 
 private:
 
-  int ensure_staging(uint64_t size) {
-    if (staging_size_ >= size)
-      return 0;
+  struct host_buffer_t {
+    uint8_t* ptr;
+    uint64_t wsid;
+    uint64_t ioaddr;
+    uint64_t size;
+  };
 
-    if (staging_size_ != 0) {
-      api_.fpgaReleaseBuffer(fpga_, staging_wsid_);
-      staging_size_ = 0;
-    }
-
-    // allocate new buffer
-    CHECK_FPGA_ERR(api_.fpgaPrepareBuffer(fpga_, size, (void **)&staging_ptr_, &staging_wsid_, 0), {
+  int prepare_buffer(uint64_t size, host_buffer_t* buffer) {
+    CHECK_FPGA_ERR(api_.fpgaPrepareBuffer(fpga_, size, (void **)&buffer->ptr, &buffer->wsid, 0), {
       return -1;
     });
-
     // get the physical address of the buffer in the accelerator
-    CHECK_FPGA_ERR(api_.fpgaGetIOAddress(fpga_, staging_wsid_, &staging_ioaddr_), {
-      api_.fpgaReleaseBuffer(fpga_, staging_wsid_);
+    CHECK_FPGA_ERR(api_.fpgaGetIOAddress(fpga_, buffer->wsid, &buffer->ioaddr), {
+      api_.fpgaReleaseBuffer(fpga_, buffer->wsid);
       return -1;
     });
+    buffer->size = size;
+    return 0;
+  }
+
+  int ensure_staging() {
+    for (auto& staging : staging_ring_) {
+      if (staging.ptr != nullptr)
+        continue;
+      CHECK_ERR(this->prepare_buffer(STAGING_CHUNK_SIZE, &staging), {
+        staging.ptr = nullptr;
+        return err;
+      });
+    }
+    return 0;
+  }
 
-    staging_size_ = size;
+  // return the I/O address of a host range located inside pinned memory
+  bool pinned_ioaddr(const void* host_ptr, uint64_t size, uint64_t* ioaddr) const {
+    auto ptr = (const uint8_t*)host_ptr;
+    for (auto& it : pinned_buffers_) {
+      auto& pinned = it.second;
+      if (ptr >= pinned.ptr && (ptr + size) <= (pinned.ptr + pinned.size)) {
+        uint64_t offset = ptr - pinned.ptr;
+        if (!is_aligned(offset, CACHE_BLOCK_SIZE))
+          return false;
+        *ioaddr = pinned.ioaddr + offset;
+        return true;
+      }
+    }
+    return false;
+  }
 
+  int dma_command(uint64_t cmd, uint64_t ioaddr, uint64_t dev_addr, uint64_t size) {
+    auto ls_shift = (int)std::log2(CACHE_BLOCK_SIZE);
+    CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_ARG0, ioaddr >> ls_shift), {
+      return -1;
+    });
+    CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_ARG1, dev_addr >> ls_shift), {
+      return -1;
+    });
+    CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_ARG2, size >> ls_shift), {
+      return -1;
+    });
+    CHECK_FPGA_ERR(api_.fpgaWriteMMIO64(fpga_, 0, MMIO_CMD_TYPE, cmd), {
+      return -1;
+    });
     return 0;
   }
 
@@ -528,11 +649,12 @@ private:
   uint64_t dev_caps_;
   uint64_t isa_caps_;
   uint64_t global_mem_size_;
-  uint64_t staging_wsid_;
-  uint64_t staging_ioaddr_;
-  uint8_t *staging_ptr_;
-  uint64_t staging_size_;
+  std::array<host_buffer_t, STAGING_RING_SIZE> staging_ring_;
+  std::map<uint64_t, host_buffer_t> pinned_buffers_;
+  completion_notifier notifier_;
+  bool notify_enabled_;
   std::unordered_map<uint32_t, std::array<uint64_t, 32>> mpm_cache_;
+  std::unordered_map<uint32_t, std::stringstream> print_bufs_;
 };
 
 #include <callbacks.inc>
\ No newline at end of file
@@ -12,6 +12,7 @@
 // limitations under the License.
 
 #include <common.h>
+#include <ready_wait.h>
 
 #include <mem.h>
 #include <util.h>
@@ -36,6 +37,7 @@ public:
                   GLOBAL_MEM_SIZE - ALLOC_BASE_ADDR,
                   RAM_PAGE_SIZE,
                   CACHE_BLOCK_SIZE)
+    , running_(false)
   {
     processor_.attach_ram(&ram_);
   }
@@ -120,6 +122,11 @@ public:
     return global_mem_.release(dev_addr);
   }
 
+  int mem_host_ptr(uint64_t /*dev_addr*/, void** /*host_ptr*/) {
+    // pinned host memory is not supported
+    return -1;
+  }
+
   int mem_access(uint64_t dev_addr, uint64_t size, int flags) {
     uint64_t asize = aligned_size(size, CACHE_BLOCK_SIZE);
     if (dev_addr + asize > GLOBAL_MEM_SIZE)
@@ -147,6 +154,11 @@ public:
     if (dest_addr + asize > GLOBAL_MEM_SIZE)
       return -1;
 
+    // the RTL model owns the memory while running
+    if (future_.valid()) {
+      future_.wait();
+    }
+
     ram_.enable_acl(false);
     ram_.write((const uint8_t*)src, dest_addr, size);
     ram_.enable_acl(true);
@@ -168,6 +180,10 @@ public:
     if (src_addr + asize > GLOBAL_MEM_SIZE)
       return -1;
 
+    if (future_.valid()) {
+      future_.wait();
+    }
+
     ram_.enable_acl(false);
     ram_.read((uint8_t*)dest, src_addr, size);
     ram_.enable_acl(true);
@@ -197,8 +213,11 @@ public:
     this->dcr_write(VX_DCR_BASE_STARTUP_ARG1, args_addr >> 32);
 
     // start new run
+    running_ = true;
     future_ = std::async(std::launch::async, [&]{
       processor_.run();
+      running_ = false;
+      notifier_.notify();
     });
 
     // clear mpm cache
@@ -210,19 +229,22 @@ public:
   int ready_wait(uint64_t timeout) {
     if (!future_.valid())
       return 0;
-    uint64_t timeout_sec = timeout / 1000;
-    std::chrono::seconds wait_time(1);
-    for (;;) {
-      // wait for 1 sec and check status
-      auto status = future_.wait_for(wait_time);
-      if (status == std::future_status::ready)
-        break;
-      if (0 == timeout_sec--)
-        return -1;
-    }
+    auto generation = notifier_.generation();
+    if (running_ && !notifier_.wait(generation, std::chrono::milliseconds(timeout)))
+      return -1;
+    future_.wait();
     return 0;
   }
 
+  // uploads wait for the current run
+  bool overlap_uploads() const {
+    return false;
+  }
+
+  completion_notifier* notifier() {
+    return &notifier_;
+  }
+
   int dcr_write(uint32_t addr, uint32_t value) {
     if (future_.valid()) {
       future_.wait(); // ensure prior run completed
@@ -236,6 +258,11 @@ public:
     return dcrs_.read(addr, value);
   }
 
+  int checkpoint(const char* /*path*/, int /*mode*/) {
+    // checkpoints are only supported by the simx simulator
+    return -1;
+  }
+
   int mpm_query(uint32_t addr, uint32_t core_id, uint64_t* value) {
     uint32_t offset = addr - VX_CSR_MPM_BASE;
     if (offset > 31)
@@ -257,6 +284,8 @@ private:
   MemoryAllocator     global_mem_;
   DeviceConfig        dcrs_;
   std::future<void>   future_;
+  std::atomic<bool>   running_;
+  completion_notifier notifier_;
   std::unordered_map<uint32_t, std::array<uint64_t, 32>> mpm_cache_;
 };
 
@@ -12,6 +12,7 @@
 // limitations under the License.
 
 #include <common.h>
+#include <ready_wait.h>
 
 #include <arch.h>
 #include <constants.h>
@@ -49,9 +50,39 @@ using namespace vortex;
 class vx_device {
 public:
   vx_device()
-      : arch_(NUM_THREADS, NUM_WARPS, NUM_CORES), ram_(0, MEM_PAGE_SIZE), processor_(arch_), global_mem_(ALLOC_BASE_ADDR, GLOBAL_MEM_SIZE - ALLOC_BASE_ADDR, MEM_PAGE_SIZE, CACHE_BLOCK_SIZE) {
+      : arch_(create_arch()), ram_(0, MEM_PAGE_SIZE), processor_(arch_), global_mem_(ALLOC_BASE_ADDR, GLOBAL_MEM_SIZE - ALLOC_BASE_ADDR, MEM_PAGE_SIZE, CACHE_BLOCK_SIZE), running_(false) {
     // attach memory module
     processor_.attach_ram(&ram_);
+    // enable multi-threaded simulation
+    auto sim_threads_s = getenv("VORTEX_SIMX_THREADS");
+    if (sim_threads_s) {
+      processor_.set_sim_threads(atoi(sim_threads_s));
+    }
+    // idle-cycle fast-forwarding, enabled by default
+    auto fast_forward_s = getenv("VORTEX_SIMX_FAST_FORWARD");
+    if (fast_forward_s) {
+      processor_.set_fast_forward(atoi(fast_forward_s) != 0);
+    }
+    // activity-driven ticking, enabled by default
+    auto activity_s = getenv("VORTEX_SIMX_ACTIVITY");
+    if (activity_s) {
+      processor_.set_activity_tracking(atoi(activity_s) != 0);
+    }
+    // sampled simulation, see Sampler::parse() for the spec format
+    auto sampling_s = getenv("VORTEX_SIMX_SAMPLING");
+    if (sampling_s && processor_.set_sampling(sampling_s) != 0) {
+      printf("[VXDRV] Warning: invalid VORTEX_SIMX_SAMPLING '%s'\n", sampling_s);
+    }
+    // binary pipeline trace
+    auto pipe_trace_s = getenv("VORTEX_SIMX_PIPE_TRACE");
+    if (pipe_trace_s && processor_.set_pipe_trace(pipe_trace_s) != 0) {
+      printf("[VXDRV] Warning: cannot create VORTEX_SIMX_PIPE_TRACE '%s'\n", pipe_trace_s);
+    }
+    // checkpoint the running kernel when the sampling trigger fires
+    auto checkpoint_s = getenv("VORTEX_SIMX_CHECKPOINT");
+    if (checkpoint_s) {
+      processor_.set_trigger_checkpoint(checkpoint_s);
+    }
 #ifdef VM_ENABLE
     std::cout << "*** VM ENABLED!! ***" << std::endl;
     CHECK_ERR(init_VM(), );
@@ -61,8 +92,6 @@ public:
   ~vx_device() {
 #ifdef VM_ENABLE
     global_mem_.release(PAGE_TABLE_BASE_ADDR);
-    // for (auto i = addr_mapping.begin(); i != addr_mapping.end(); i++)
-    //   page_table_mem_->release(i->second << MEM_PAGE_SIZE);
     delete virtual_mem_;
     delete page_table_mem_;
 #endif
@@ -82,13 +111,13 @@ public:
       _value = IMPLEMENTATION_ID;
       break;
     case VX_CAPS_NUM_THREADS:
-      _value = NUM_THREADS;
+      _value = arch_.num_threads();
       break;
     case VX_CAPS_NUM_WARPS:
-      _value = NUM_WARPS;
+      _value = arch_.num_warps();
       break;
     case VX_CAPS_NUM_CORES:
-      _value = NUM_CORES * NUM_CLUSTERS;
+      _value = arch_.num_cores() * arch_.num_clusters();
       break;
     case VX_CAPS_CACHE_LINE_SIZE:
       _value = CACHE_BLOCK_SIZE;
@@ -119,20 +148,18 @@ public:
 
 #ifdef VM_ENABLE
 
-  // physical (ppn) to virtual (vpn) mapping
-  uint64_t map_p2v(uint64_t ppn, uint32_t flags) {
-    DBGPRINT(" [RT:MAP_P2V] ppn: %lx\n", ppn);
-    if (addr_mapping.find(ppn) != addr_mapping.end())
-      return addr_mapping[ppn];
+  // size of the pages mapped at a given page table level
+  static uint64_t vm_page_size(uint32_t level) {
+    return uint64_t(1) << vm_page_log2_size(level);
+  }
 
-    // If ppn to vpn mapping doesnt exist, create mapping
-    DBGPRINT(" [RT:MAP_P2V] Not found. Allocate new page table or update a PTE.\n");
-    uint64_t vpn;
-    virtual_mem_->allocate(MEM_PAGE_SIZE, &vpn);
-    vpn = vpn >> MEM_PAGE_LOG2_SIZE;
-    CHECK_ERR(update_page_table(ppn, vpn, flags), );
-    addr_mapping[ppn] = vpn;
-    return vpn;
+  // highest page table level whose pages fit in the given size
+  static uint32_t vm_page_level(uint64_t size) {
+    uint32_t level = VM_SUPERPAGE_LEVEL;
+    while (level != 0 && size < vm_page_size(level)) {
+      --level;
+    }
+    return level;
   }
 
   bool need_trans(uint64_t dev_pAddr) {
@@ -157,7 +184,7 @@ public:
     return 1;
   }
 
-  uint64_t phy_to_virt_map(uint64_t size, uint64_t *dev_pAddr, uint32_t flags) {
+  int phy_to_virt_map(uint64_t size, uint64_t *dev_pAddr, uint32_t flags) {
     DBGPRINT(" [RT:PTV_MAP] size = 0x%lx, dev_pAddr= 0x%lx, flags = 0x%x\n", size, *dev_pAddr, flags);
     DBGPRINT(" [RT:PTV_MAP] bit mode: %d\n", XLEN);
 
@@ -167,18 +194,29 @@ public:
     }
 
     uint64_t init_pAddr = *dev_pAddr;
-    uint64_t init_vAddr = (map_p2v(init_pAddr >> MEM_PAGE_LOG2_SIZE, flags) << MEM_PAGE_LOG2_SIZE) | (init_pAddr & ((1 << MEM_PAGE_LOG2_SIZE) - 1));
-    uint64_t ppn = 0, vpn = 0;
-
-    // dev_pAddr can be of size greater than a page, but we have to map and update
-    // page tables on a page table granularity. So divide the allocation into pages.
-    // FUTURE Work: Super Page
-    for (ppn = (*dev_pAddr >> MEM_PAGE_LOG2_SIZE); ppn < ((*dev_pAddr) >> MEM_PAGE_LOG2_SIZE) + (size >> MEM_PAGE_LOG2_SIZE); ppn++) {
-      vpn = map_p2v(ppn, flags) >> MEM_PAGE_LOG2_SIZE;
-      DBGPRINT(" [RT:PTV_MAP] Search vpn in page table:0x%lx\n", vpn);
-      // Currently a 1-1 mapping is used, this can be changed here to support different
-      // mapping schemes
+    uint32_t max_level = vm_page_level(size);
+    uint64_t init_vAddr;
+    CHECK_ERR(virtual_mem_->allocate(size, vm_page_size(max_level), &init_vAddr), {
+      return err;
+    });
+
+    // Map the buffer with the largest pages allowed by the alignment of
+    // the remaining range, so that large buffers use superpages.
+    for (uint64_t offset = 0; offset < size;) {
+      uint64_t pAddr = init_pAddr + offset;
+      uint64_t vAddr = init_vAddr + offset;
+      uint32_t level = max_level;
+      while (level != 0
+          && ((((pAddr | vAddr) & (vm_page_size(level) - 1)) != 0)
+           || (size - offset) < vm_page_size(level))) {
+        --level;
+      }
+      CHECK_ERR(update_page_table(pAddr >> MEM_PAGE_LOG2_SIZE, vAddr >> MEM_PAGE_LOG2_SIZE, flags, level), {
+        return err;
+      });
+      offset += vm_page_size(level);
     }
+    vm_mappings_[init_vAddr] = {init_pAddr, size};
     DBGPRINT(" [RT:PTV_MAP] Mapped virtual addr: 0x%lx to physical addr: 0x%lx\n", init_vAddr, init_pAddr);
     // Sanity check
     assert(page_table_walk(init_vAddr) == init_pAddr && "ERROR: translated virtual Addresses are not the same with physical Address\n");
@@ -200,9 +238,16 @@ public:
 
     DBGPRINT("[RT:mem_alloc] size: 0x%lx, asize, 0x%lx,flag : 0x%d\n", size, asize, flags);
     // HW: when vm is supported this global_mem_ should be virtual memory allocator
+#ifdef VM_ENABLE
+    // align the backing memory for superpage mappings
+    CHECK_ERR(global_mem_.allocate(asize, vm_page_size(vm_page_level(asize)), &addr), {
+      return err;
+    });
+#else
     CHECK_ERR(global_mem_.allocate(asize, &addr), {
       return err;
     });
+#endif
     CHECK_ERR(this->mem_access(addr, asize, flags), {
       global_mem_.release(addr);
       return err;
@@ -210,7 +255,10 @@ public:
     *dev_addr = addr;
 #ifdef VM_ENABLE
     // VM address translation
-    phy_to_virt_map(asize, dev_addr, flags);
+    CHECK_ERR(phy_to_virt_map(asize, dev_addr, flags), {
+      global_mem_.release(addr);
+      return err;
+    });
 #endif
     return 0;
   }
@@ -234,18 +282,35 @@ public:
 
   int mem_free(uint64_t dev_addr) {
 #ifdef VM_ENABLE
-    uint64_t paddr = page_table_walk(dev_addr);
-    return global_mem_.release(paddr);
+    auto it = vm_mappings_.find(dev_addr);
+    if (it == vm_mappings_.end()) {
+      uint64_t paddr = page_table_walk(dev_addr);
+      return global_mem_.release(paddr);
+    }
+    auto mapping = it->second;
+    vm_mappings_.erase(it);
+    this->wait_idle();
+    for (uint64_t offset = 0; offset < mapping.size;) {
+      offset += unmap_page(dev_addr + offset);
+    }
+    virtual_mem_->release(dev_addr);
+    return global_mem_.release(mapping.paddr);
 #else
     return global_mem_.release(dev_addr);
 #endif
   }
 
+  int mem_host_ptr(uint64_t /*dev_addr*/, void** /*host_ptr*/) {
+    // pinned host memory is not supported
+    return -1;
+  }
+
   int mem_access(uint64_t dev_addr, uint64_t size, int flags) {
     uint64_t asize = aligned_size(size, CACHE_BLOCK_SIZE);
     if (dev_addr + asize > GLOBAL_MEM_SIZE)
       return -1;
 
+    this->wait_idle();
     ram_.set_acl(dev_addr, size, flags);
     return 0;
   }
@@ -263,6 +328,7 @@ public:
     if (dest_addr + asize > GLOBAL_MEM_SIZE)
       return -1;
 #ifdef VM_ENABLE
+    this->wait_idle();
     uint64_t pAddr = page_table_walk(dest_addr);
     // uint64_t pAddr;
     // try {
@@ -274,6 +340,13 @@ public:
     // }
     DBGPRINT("  [RT:upload] Upload data to vAddr = 0x%lx (pAddr=0x%lx)\n", dest_addr, pAddr);
     dest_addr = pAddr; // Overwirte
+#else
+    if (this->is_running()) {
+      // the device is busy, stage the data until the current run completes
+      auto data = (const uint8_t*)src;
+      pending_uploads_.emplace_back(dest_addr, std::vector<uint8_t>(data, data + size));
+      return 0;
+    }
 #endif
 
     ram_.enable_acl(false);
@@ -293,6 +366,9 @@ public:
     uint64_t asize = aligned_size(size, CACHE_BLOCK_SIZE);
     if (src_addr + asize > GLOBAL_MEM_SIZE)
       return -1;
+
+    this->wait_idle();
+
 #ifdef VM_ENABLE
     uint64_t pAddr = page_table_walk(src_addr);
     DBGPRINT("  [RT:download] Download data to vAddr = 0x%lx (pAddr=0x%lx)\n", src_addr, pAddr);
@@ -313,9 +389,7 @@ public:
 
   int start(uint64_t krnl_addr, uint64_t args_addr) {
     // ensure prior run completed
-    if (future_.valid()) {
-      future_.wait();
-    }
+    this->wait_idle();
 
     // set kernel info
     this->dcr_write(VX_DCR_BASE_STARTUP_ADDR0, krnl_addr & 0xffffffff);
@@ -324,7 +398,12 @@ public:
     this->dcr_write(VX_DCR_BASE_STARTUP_ARG1, args_addr >> 32);
 
     // start new run
-    future_ = std::async(std::launch::async, [&] { processor_.run(); });
+    running_ = true;
+    future_ = std::async(std::launch::async, [&] {
+      processor_.run();
+      running_ = false;
+      notifier_.notify();
+    });
 
     // clear mpm cache
     mpm_cache_.clear();
@@ -335,23 +414,29 @@ public:
   int ready_wait(uint64_t timeout) {
     if (!future_.valid())
       return 0;
-    uint64_t timeout_sec = timeout / 1000;
-    std::chrono::seconds wait_time(1);
-    for (;;) {
-      // wait for 1 sec and check status
-      auto status = future_.wait_for(wait_time);
-      if (status == std::future_status::ready)
-        break;
-      if (0 == timeout_sec--)
-        return -1;
-    }
+    auto generation = notifier_.generation();
+    if (running_ && !notifier_.wait(generation, std::chrono::milliseconds(timeout)))
+      return -1;
+    future_.wait();
+    this->flush_uploads();
     return 0;
   }
 
+  // uploads issued during a run are staged until it completes
+  bool overlap_uploads() const {
+  #ifdef VM_ENABLE
+    return false;
+  #else
+    return true;
+  #endif
+  }
+
+  completion_notifier* notifier() {
+    return &notifier_;
+  }
+
   int dcr_write(uint32_t addr, uint32_t value) {
-    if (future_.valid()) {
-      future_.wait(); // ensure prior run completed
-    }
+    this->wait_idle(); // ensure prior run completed
     processor_.dcr_write(addr, value);
     dcrs_.write(addr, value);
     return 0;
@@ -374,6 +459,15 @@ public:
     *value = mpm_cache_.at(core_id).at(offset);
     return 0;
   }
+
+  int checkpoint(const char* path, int mode) {
+    this->wait_idle();
+    if (mode == VX_CHECKPOINT_SAVE)
+      return processor_.save_checkpoint(path);
+    mpm_cache_.clear();
+    return processor_.restore_checkpoint(path);
+  }
+
 #ifdef VM_ENABLE
   /* VM Management */
 
@@ -465,8 +559,9 @@ public:
     return processor_.get_satp_mode();
   }
 
-  int16_t update_page_table(uint64_t ppn, uint64_t vpn, uint32_t flag) {
-    DBGPRINT("  [RT:Update PT] Mapping vpn 0x%05lx to ppn 0x%05lx(flags = %u)\n", vpn, ppn, flag);
+  // map a page, leaf_level > 0 maps a superpage
+  int16_t update_page_table(uint64_t ppn, uint64_t vpn, uint32_t flag, uint32_t leaf_level = 0) {
+    DBGPRINT("  [RT:Update PT] Mapping vpn 0x%05lx to ppn 0x%05lx(flags = %u, level = %u)\n", vpn, ppn, flag, leaf_level);
     // sanity check
 #if VM_ADDR_MODE == SV39
     assert((((ppn >> 44) == 0) && ((vpn >> 27) == 0)) && "Upper bits are not zero!");
@@ -481,35 +576,36 @@ public:
     uint64_t pt_addr = 0;
     uint64_t cur_base_ppn = get_base_ppn();
 
+    assert(leaf_level < level);
     while (i >= 0) {
       DBGPRINT("  [RT:Update PT]Start %u-level page table\n", i);
       pte_addr = get_pte_address(cur_base_ppn, vaddr.vpn[i]);
+      if (i == (int)leaf_level) {
+        // Reach to leaf
+        DBGPRINT("  [RT:Update PT] Reached to level %d. This should be a leaf node(flag = %x) \n", i, flag);
+        uint32_t pte_flag = (flag << 1) | 0x3;
+        PTE_t new_pte(ppn << MEM_PAGE_LOG2_SIZE, pte_flag);
+        write_pte(pte_addr, new_pte.pte_bytes);
+        break;
+      }
       pte_bytes = read_pte(pte_addr);
       PTE_t pte_chk(pte_bytes);
       DBGPRINT("  [RT:Update PT] PTE addr 0x%lx, PTE bytes 0x%lx\n", pte_addr, pte_bytes);
       if (pte_chk.v == 1 && ((pte_bytes & 0xFFFFFFFF) != 0xbaadf00d)) {
         DBGPRINT("  [RT:Update PT] PTE valid (ppn 0x%lx), continuing the walk...\n", pte_chk.ppn);
+        assert(!pte_chk.r && !pte_chk.w && !pte_chk.x && "ERROR: page already mapped by a superpage\n");
         cur_base_ppn = pte_chk.ppn;
       } else {
         // If valid bit not set, allocate a next level page table
         DBGPRINT("  [RT:Update PT] PTE Invalid (ppn 0x%lx) ...\n", pte_chk.ppn);
-        if (i == 0) {
-          // Reach to leaf
-          DBGPRINT("  [RT:Update PT] Reached to level 0. This should be a leaf node(flag = %x) \n", flag);
-          uint32_t pte_flag = (flag << 1) | 0x3;
-          PTE_t new_pte(ppn << MEM_PAGE_LOG2_SIZE, pte_flag);
-          write_pte(pte_addr, new_pte.pte_bytes);
-          break;
-        } else {
-          //  in device memory and store ppn in PTE. Set rwx = 000 in PTE
-          // to indicate this is a pointer to the next level of the page table.
-          // flag would READ: 0x1, Write 0x2, RW:0x3, which is matched with PTE flags if it is lsh by one.
-          alloc_page_table(&pt_addr);
-          uint32_t pte_flag = 0x1;
-          PTE_t new_pte(pt_addr, pte_flag);
-          write_pte(pte_addr, new_pte.pte_bytes);
-          cur_base_ppn = new_pte.ppn;
-        }
+        //  in device memory and store ppn in PTE. Set rwx = 000 in PTE
+        // to indicate this is a pointer to the next level of the page table.
+        // flag would READ: 0x1, Write 0x2, RW:0x3, which is matched with PTE flags if it is lsh by one.
+        alloc_page_table(&pt_addr);
+        uint32_t pte_flag = 0x1;
+        PTE_t new_pte(pt_addr, pte_flag);
+        write_pte(pte_addr, new_pte.pte_bytes);
+        cur_base_ppn = new_pte.ppn;
       }
       i--;
     }
@@ -564,10 +660,30 @@ public:
         break;
       }
     }
-    uint64_t paddr = (cur_base_ppn << MEM_PAGE_LOG2_SIZE) + vaddr.pgoff;
+    // leaves above level 0 map superpages
+    uint64_t pgoff = vAddr_bits & (vm_page_size(i) - 1);
+    uint64_t paddr = (cur_base_ppn << MEM_PAGE_LOG2_SIZE) + pgoff;
     return paddr;
   }
 
+  // clear the leaf entry mapping a virtual address, returns the page size
+  uint64_t unmap_page(uint64_t vAddr_bits) {
+    int i = PT_LEVEL - 1;
+    vAddr_t vaddr(vAddr_bits);
+    uint64_t cur_base_ppn = get_base_ppn();
+    while (true) {
+      uint64_t pte_addr = get_pte_address(cur_base_ppn, vaddr.vpn[i]);
+      PTE_t pte(read_pte(pte_addr));
+      if (pte.v == 0 || i == 0 || pte.r || pte.w || pte.x) {
+        DBGPRINT("  [RT:unmap_page] vAddr 0x%lx, level %d\n", vAddr_bits, i);
+        write_pte(pte_addr, 0);
+        return vm_page_size(i);
+      }
+      cur_base_ppn = pte.ppn;
+      --i;
+    }
+  }
+
   // void read_page_table(uint64_t addr) {
   //     uint8_t *dest = new uint8_t[MEM_PAGE_SIZE];
   //     download(dest,  addr,  MEM_PAGE_SIZE);
@@ -606,15 +722,57 @@ public:
 #endif // VM_ENABLE
 
 private:
+
+  // processor configuration, optionally loaded from VORTEX_SIMX_CONFIG
+  static Arch create_arch() {
+    Arch arch(NUM_THREADS, NUM_WARPS, NUM_CORES);
+    auto config_s = getenv("VORTEX_SIMX_CONFIG");
+    if (config_s && (arch.load(config_s) != 0 || arch.validate() != 0)) {
+      printf("[VXDRV] Error: invalid VORTEX_SIMX_CONFIG '%s'\n", config_s);
+      std::abort();
+    }
+    return arch;
+  }
+
+  bool is_running() const {
+    return running_;
+  }
+
+  // wait for the current run and apply the uploads staged during it
+  void wait_idle() {
+    if (future_.valid()) {
+      future_.wait();
+    }
+    this->flush_uploads();
+  }
+
+  void flush_uploads() {
+    if (pending_uploads_.empty())
+      return;
+    ram_.enable_acl(false);
+    for (auto& upload : pending_uploads_) {
+      ram_.write(upload.second.data(), upload.first, upload.second.size());
+    }
+    ram_.enable_acl(true);
+    pending_uploads_.clear();
+  }
+
   Arch arch_;
   RAM ram_;
   Processor processor_;
   MemoryAllocator global_mem_;
   DeviceConfig dcrs_;
   std::future<void> future_;
+  std::atomic<bool> running_;
+  completion_notifier notifier_;
+  std::vector<std::pair<uint64_t, std::vector<uint8_t>>> pending_uploads_;
   std::unordered_map<uint32_t, std::array<uint64_t, 32>> mpm_cache_;
 #ifdef VM_ENABLE
-  std::unordered_map<uint64_t, uint64_t> addr_mapping; // HW: key: ppn; value: vpn
+  struct vm_mapping_t {
+    uint64_t paddr;
+    uint64_t size;
+  };
+  std::unordered_map<uint64_t, vm_mapping_t> vm_mappings_; // key: virtual address
   MemoryAllocator *page_table_mem_;
   MemoryAllocator *virtual_mem_;
 #endif
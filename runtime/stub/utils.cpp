@@ -19,7 +19,9 @@
 #include <cstring>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
 #include <vortex.h>
+#include <mapped_file.h>
 #include <assert.h>
 
 class ProfilingMode {
@@ -84,25 +86,56 @@ extern int vx_upload_kernel_bytes(vx_device_h hdevice, const void* content, uint
   return 0;
 }
 
+#ifdef VX_ZSTD_ENABLE
+// decompress a zstd image into a host buffer
+static int decompress_file(const vortex::MappedFile& file, const char* filename, std::vector<uint8_t>& content) {
+  auto size = vortex::zstd_content_size(file.data(), file.size());
+  if (size < 0) {
+    std::cerr << "Error: " << filename << " does not record its decompressed size" << std::endl;
+    return -1;
+  }
+  content.resize(size);
+  auto window = [&](uint64_t offset, uint8_t** ptr)->uint64_t {
+    *ptr = content.data() + offset;
+    return content.size() - offset;
+  };
+  auto commit = [&](uint64_t, uint64_t) {};
+  if (vortex::zstd_decompress(file.data(), file.size(), window, commit) != size) {
+    std::cerr << "Error: " << filename << " is not a valid zstd image" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+#endif
+
 extern int vx_upload_kernel_file(vx_device_h hdevice, const char* filename, vx_buffer_h* hbuffer) {
   if (nullptr == hdevice || nullptr == filename || nullptr == hbuffer)
     return -1;
 
-  std::ifstream ifs(filename);
-  if (!ifs) {
+  vortex::MappedFile file;
+  if (file.open(filename) != 0) {
     std::cerr << "Error: " << filename << " not found" << std::endl;
     return -1;
   }
 
-  // read file content
-  ifs.seekg(0, ifs.end);
-  auto size = ifs.tellg();
-  std::vector<char> content(size);
-  ifs.seekg(0, ifs.beg);
-  ifs.read(content.data(), size);
+  if (file.is_compressed()) {
+  #ifdef VX_ZSTD_ENABLE
+    std::vector<uint8_t> content;
+    CHECK_ERR(decompress_file(file, filename, content), {
+      return err;
+    });
+    CHECK_ERR(vx_upload_kernel_bytes(hdevice, content.data(), content.size(), hbuffer), {
+      return err;
+    });
+    return 0;
+  #else
+    std::cerr << "Error: " << filename << " is compressed, zstd support is not enabled (build with ZSTD=1)" << std::endl;
+    return -1;
+  #endif
+  }
 
-  // upload buffer
-  CHECK_ERR(vx_upload_kernel_bytes(hdevice, content.data(), size, hbuffer), {
+  // upload the mapped file content
+  CHECK_ERR(vx_upload_kernel_bytes(hdevice, file.data(), file.size(), hbuffer), {
     return err;
   });
 
@@ -133,21 +166,53 @@ extern int vx_upload_file(vx_device_h hdevice, const char* filename, vx_buffer_h
   if (nullptr == hdevice || nullptr == filename || nullptr == hbuffer)
     return -1;
 
-  std::ifstream ifs(filename);
-  if (!ifs) {
+  vortex::MappedFile file;
+  if (file.open(filename) != 0) {
     std::cerr << "Error: " << filename << " not found" << std::endl;
     return -1;
   }
 
-  // read file content
-  ifs.seekg(0, ifs.end);
-  auto size = ifs.tellg();
-  std::vector<char> content(size);
-  ifs.seekg(0, ifs.beg);
-  ifs.read(content.data(), size);
+  if (file.is_compressed()) {
+  #ifdef VX_ZSTD_ENABLE
+    auto size = vortex::zstd_content_size(file.data(), file.size());
+    if (size <= 0) {
+      std::cerr << "Error: " << filename << " does not record its decompressed size" << std::endl;
+      return -1;
+    }
 
-  // upload buffer
-  CHECK_ERR(vx_upload_bytes(hdevice, content.data(), size, hbuffer), {
+    vx_buffer_h _hbuffer;
+    CHECK_ERR(vx_mem_alloc(hdevice, size, VX_MEM_READ, &_hbuffer), {
+      return err;
+    });
+
+    // decompress through a staging buffer straight into device memory
+    std::vector<uint8_t> staging(std::min<uint64_t>(size, 4 * 1024 * 1024));
+    int copy_err = 0;
+    auto window = [&](uint64_t, uint8_t** ptr)->uint64_t {
+      *ptr = staging.data();
+      return copy_err ? 0 : staging.size();
+    };
+    auto commit = [&](uint64_t offset, uint64_t bytes) {
+      if (copy_err == 0) {
+        copy_err = vx_copy_to_dev(_hbuffer, staging.data(), offset, bytes);
+      }
+    };
+    if (vortex::zstd_decompress(file.data(), file.size(), window, commit) != size || copy_err != 0) {
+      std::cerr << "Error: failed to upload " << filename << std::endl;
+      vx_mem_free(_hbuffer);
+      return -1;
+    }
+
+    *hbuffer = _hbuffer;
+    return 0;
+  #else
+    std::cerr << "Error: " << filename << " is compressed, zstd support is not enabled (build with ZSTD=1)" << std::endl;
+    return -1;
+  #endif
+  }
+
+  // upload the mapped file content
+  CHECK_ERR(vx_upload_bytes(hdevice, file.data(), file.size(), hbuffer), {
     return err;
   });
 
@@ -195,6 +260,12 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
   uint64_t stores = 0;
   uint64_t ifetch_lat = 0;
   uint64_t load_lat   = 0;
+  uint64_t decodes = 0;
+  uint64_t decode_hits = 0;
+  uint64_t tlb_hits = 0;
+  uint64_t tlb_misses = 0;
+  uint64_t tlb_walk_lat = 0;
+  uint64_t pwc_hits = 0;
   // PERF: l2cache
   uint64_t l2cache_reads = 0;
   uint64_t l2cache_writes = 0;
@@ -214,6 +285,27 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
   uint64_t mem_writes = 0;
   uint64_t mem_lat = 0;
   uint64_t mem_bank_stalls = 0;
+  // PERF: cache MSHRs (merged, full, occupancy histogram)
+  uint64_t l2cache_mshr[6] = {0};
+  uint64_t l3cache_mshr[6] = {0};
+
+  auto queryMshr = [&](uint32_t base_addr, unsigned core_id, uint64_t* counters)->int {
+    for (uint32_t i = 0; i < 6; ++i) {
+      CHECK_ERR(vx_mpm_query(hdevice, base_addr + i, core_id, &counters[i]), {
+        return err;
+      });
+    }
+    return 0;
+  };
+
+  auto printMshr = [&](const char* name, const uint64_t* counters) {
+    uint64_t cycles = counters[2] + counters[3] + counters[4] + counters[5];
+    fprintf(stream, "PERF: %s mshr merged=%ld\n", name, counters[0]);
+    fprintf(stream, "PERF: %s mshr full=%ld (%d%%)\n", name, counters[1], calcAvgPercent(counters[1], cycles));
+    fprintf(stream, "PERF: %s mshr occupancy: <=25%%: %d%%, <=50%%: %d%%, <=75%%: %d%%, <=100%%: %d%%\n", name,
+      calcAvgPercent(counters[2], cycles), calcAvgPercent(counters[3], cycles),
+      calcAvgPercent(counters[4], cycles), calcAvgPercent(counters[5], cycles));
+  };
 
   uint64_t num_cores;
   CHECK_ERR(vx_dev_caps(hdevice, VX_CAPS_NUM_CORES, &num_cores), {
@@ -426,6 +518,51 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
         if (num_cores > 1) fprintf(stream, "PERF: core%d: stores=%ld\n", core_id, stores_per_core);
         stores += stores_per_core;
       }
+      // decode cache (simulator only)
+      {
+        uint64_t decodes_per_core;
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DECODES, core_id, &decodes_per_core), {
+          return err;
+        });
+        uint64_t decode_hits_per_core;
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_DECODE_HITS, core_id, &decode_hits_per_core), {
+          return err;
+        });
+        if (num_cores > 1 && decodes_per_core != 0) {
+          int hit_ratio = calcRatio(decodes_per_core - decode_hits_per_core, decodes_per_core);
+          fprintf(stream, "PERF: core%d: decode cache lookups=%ld (hit ratio=%d%%)\n", core_id, decodes_per_core, hit_ratio);
+        }
+        decodes += decodes_per_core;
+        decode_hits += decode_hits_per_core;
+      }
+      // address translation (simulator only)
+      {
+        uint64_t tlb_hits_per_core;
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_TLB_HITS, core_id, &tlb_hits_per_core), {
+          return err;
+        });
+        uint64_t tlb_misses_per_core;
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_TLB_MISSES, core_id, &tlb_misses_per_core), {
+          return err;
+        });
+        uint64_t tlb_walk_lat_per_core;
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_TLB_WALK_LT, core_id, &tlb_walk_lat_per_core), {
+          return err;
+        });
+        uint64_t pwc_hits_per_core;
+        CHECK_ERR(vx_mpm_query(hdevice, VX_CSR_MPM_PWC_HITS, core_id, &pwc_hits_per_core), {
+          return err;
+        });
+        uint64_t tlb_lookups_per_core = tlb_hits_per_core + tlb_misses_per_core;
+        if (num_cores > 1 && tlb_lookups_per_core != 0) {
+          int hit_ratio = calcRatio(tlb_misses_per_core, tlb_lookups_per_core);
+          fprintf(stream, "PERF: core%d: tlb lookups=%ld (hit ratio=%d%%)\n", core_id, tlb_lookups_per_core, hit_ratio);
+        }
+        tlb_hits += tlb_hits_per_core;
+        tlb_misses += tlb_misses_per_core;
+        tlb_walk_lat += tlb_walk_lat_per_core;
+        pwc_hits += pwc_hits_per_core;
+      }
     } break;
     case VX_DCR_MPM_CLASS_MEM: {
       if (lmem_enable) {
@@ -588,6 +725,37 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
         });
       }
     } break;
+    case VX_DCR_MPM_CLASS_CACHE: {
+      char name[32];
+      uint64_t counters[6];
+      if (icache_enable) {
+        CHECK_ERR(queryMshr(VX_CSR_MPM_ICACHE_MSHR_MRG, core_id, counters), {
+          return err;
+        });
+        snprintf(name, sizeof(name), "core%d: icache", core_id);
+        printMshr(name, counters);
+      }
+      if (dcache_enable) {
+        CHECK_ERR(queryMshr(VX_CSR_MPM_DCACHE_MSHR_MRG, core_id, counters), {
+          return err;
+        });
+        snprintf(name, sizeof(name), "core%d: dcache", core_id);
+        printMshr(name, counters);
+      }
+      if (l2cache_enable) {
+        CHECK_ERR(queryMshr(VX_CSR_MPM_L2CACHE_MSHR_MRG, core_id, counters), {
+          return err;
+        });
+        for (int i = 0; i < 6; ++i) {
+          l2cache_mshr[i] += counters[i];
+        }
+      }
+      if (0 == core_id && l3cache_enable) {
+        CHECK_ERR(queryMshr(VX_CSR_MPM_L3CACHE_MSHR_MRG, core_id, l3cache_mshr), {
+          return err;
+        });
+      }
+    } break;
     default:
       break;
     }
@@ -636,6 +804,17 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
     fprintf(stream, "PERF: stores=%ld\n", stores);
     fprintf(stream, "PERF: ifetch latency=%d cycles\n", ifetch_avg_lat);
     fprintf(stream, "PERF: load latency=%d cycles\n", load_avg_lat);
+    if (decodes != 0) {
+      int hit_ratio = calcRatio(decodes - decode_hits, decodes);
+      fprintf(stream, "PERF: decode cache lookups=%ld (hit ratio=%d%%)\n", decodes, hit_ratio);
+    }
+    if (tlb_hits + tlb_misses != 0) {
+      uint64_t tlb_lookups = tlb_hits + tlb_misses;
+      int hit_ratio = calcRatio(tlb_misses, tlb_lookups);
+      int walk_avg_lat = (int)(double(tlb_walk_lat) / double(std::max<uint64_t>(tlb_misses, 1)));
+      fprintf(stream, "PERF: tlb lookups=%ld (hit ratio=%d%%)\n", tlb_lookups, hit_ratio);
+      fprintf(stream, "PERF: page walks=%ld (pwc hits=%ld, walk latency=%d cycles)\n", tlb_misses, pwc_hits, walk_avg_lat);
+    }
   } break;
   case VX_DCR_MPM_CLASS_MEM: {
     if (l2cache_enable) {
@@ -679,6 +858,17 @@ extern int vx_dump_perf(vx_device_h hdevice, FILE* stream) {
       fprintf(stream, "PERF: memory bank stalls=%ld (utilization=%d%%)\n", mem_bank_stalls, mem_bank_utilization);
     }
   } break;
+  case VX_DCR_MPM_CLASS_CACHE: {
+    if (l2cache_enable) {
+      for (int i = 0; i < 6; ++i) {
+        l2cache_mshr[i] /= num_cores;
+      }
+      printMshr("l2cache", l2cache_mshr);
+    }
+    if (l3cache_enable) {
+      printMshr("l3cache", l3cache_mshr);
+    }
+  } break;
   default:
     break;
   }
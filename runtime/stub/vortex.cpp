@@ -127,6 +127,10 @@ extern int vx_mem_address(vx_buffer_h hbuffer, uint64_t* address) {
   return (g_callbacks.mem_address)(hbuffer, address);
 }
 
+extern int vx_mem_host_ptr(vx_buffer_h hbuffer, void** host_ptr) {
+  return (g_callbacks.mem_host_ptr)(hbuffer, host_ptr);
+}
+
 extern int vx_mem_info(vx_device_h hdevice, uint64_t* mem_free, uint64_t* mem_used) {
   return (g_callbacks.mem_info)(hdevice, mem_free, mem_used);
 }
@@ -180,4 +184,55 @@ extern int vx_mpm_query(vx_device_h hdevice, uint32_t addr, uint32_t core_id, ui
   } else {
     return (g_callbacks.mpm_query)(hdevice, addr, core_id, value);
   }
-}
\ No newline at end of file
+}
+
+extern int vx_checkpoint(vx_device_h hdevice, const char* path, int mode) {
+  return (g_callbacks.checkpoint)(hdevice, path, mode);
+}
+
+extern int vx_queue_create(vx_device_h hdevice, vx_queue_h* hqueue) {
+  // kernels launched from queues use the profiling mode set at creation
+  int profiling_mode = get_profiling_mode();
+  if (profiling_mode != 0) {
+    CHECK_ERR(vx_dcr_write(hdevice, VX_DCR_BASE_MPM_CLASS, profiling_mode), {
+      return err;
+    });
+  }
+  return (g_callbacks.queue_create)(hdevice, hqueue);
+}
+
+extern int vx_queue_destroy(vx_queue_h hqueue) {
+  return (g_callbacks.queue_destroy)(hqueue);
+}
+
+extern int vx_queue_finish(vx_queue_h hqueue) {
+  return (g_callbacks.queue_finish)(hqueue);
+}
+
+extern int vx_queue_wait_event(vx_queue_h hqueue, vx_event_h hevent) {
+  return (g_callbacks.queue_wait_event)(hqueue, hevent);
+}
+
+extern int vx_copy_to_dev_async(vx_queue_h hqueue, vx_buffer_h hbuffer, const void* host_ptr, uint64_t dst_offset, uint64_t size, vx_event_h* hevent) {
+  return (g_callbacks.copy_to_dev_async)(hqueue, hbuffer, host_ptr, dst_offset, size, hevent);
+}
+
+extern int vx_copy_from_dev_async(vx_queue_h hqueue, void* host_ptr, vx_buffer_h hbuffer, uint64_t src_offset, uint64_t size, vx_event_h* hevent) {
+  return (g_callbacks.copy_from_dev_async)(hqueue, host_ptr, hbuffer, src_offset, size, hevent);
+}
+
+extern int vx_start_async(vx_queue_h hqueue, vx_buffer_h hkernel, vx_buffer_h harguments, vx_event_h* hevent) {
+  return (g_callbacks.start_async)(hqueue, hkernel, harguments, hevent);
+}
+
+extern int vx_event_wait(vx_event_h hevent, uint64_t timeout) {
+  return (g_callbacks.event_wait)(hevent, timeout);
+}
+
+extern int vx_event_status(vx_event_h hevent) {
+  return (g_callbacks.event_status)(hevent);
+}
+
+extern int vx_event_release(vx_event_h hevent) {
+  return (g_callbacks.event_release)(hevent);
+}
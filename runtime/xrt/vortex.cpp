@@ -12,6 +12,7 @@
 // limitations under the License.
 
 #include <common.h>
+#include <ready_wait.h>
 
 #ifdef SCOPE
 #include "scope.h"
@@ -45,6 +46,9 @@ using namespace vortex;
 // #define BANK_INTERLEAVE
 
 #define MMIO_CTL_ADDR 0x00
+#define MMIO_GIE_ADDR 0x04
+#define MMIO_IER_ADDR 0x08
+#define MMIO_ISR_ADDR 0x0C
 #define MMIO_DEV_ADDR 0x10
 #define MMIO_ISA_ADDR 0x18
 #define MMIO_DCR_ADDR 0x20
@@ -122,6 +126,11 @@ public:
       xrtBOFree(entry.second.xrtBuffer);
     #endif
     }
+  #ifdef XRTSIM
+    if (xrtDevice_) {
+      xrtSimSetInterruptCallback(xrtDevice_, nullptr, nullptr);
+    }
+  #endif
     if (xrtKernel_) {
       xrtKernelClose(xrtKernel_);
     }
@@ -195,6 +204,21 @@ public:
       return err;
     });
 
+  #ifdef XRTSIM
+    // get notified through the ap_done interrupt
+    CHECK_ERR(xrtSimSetInterruptCallback(xrtDevice_, [](void* arg) {
+      reinterpret_cast<vx_device*>(arg)->notifier_.notify();
+    }, this), {
+      return err;
+    });
+    CHECK_ERR(this->write_register(MMIO_IER_ADDR, 0x1), {
+      return err;
+    });
+    CHECK_ERR(this->write_register(MMIO_GIE_ADDR, 0x1), {
+      return err;
+    });
+  #endif
+
     CHECK_ERR(this->read_register(MMIO_DEV_ADDR, (uint32_t *)&dev_caps_), {
       return err;
     });
@@ -408,6 +432,11 @@ public:
     return 0;
   }
 
+  int mem_host_ptr(uint64_t /*dev_addr*/, void** /*host_ptr*/) {
+    // pinned host memory is not supported
+    return -1;
+  }
+
   int mem_access(uint64_t /*dev_addr*/, uint64_t /*size*/, int /*flags*/) {
     return 0;
   }
@@ -563,19 +592,11 @@ public:
   }
 
   int ready_wait(uint64_t timeout) {
-    struct timespec sleep_time;
-  #ifndef NDEBUG
-    sleep_time.tv_sec = 1;
-    sleep_time.tv_nsec = 0;
-  #else
-    sleep_time.tv_sec = 0;
-    sleep_time.tv_nsec = 1000000;
-  #endif
-
-    // to milliseconds
-    uint64_t sleep_time_ms = (sleep_time.tv_sec * 1000) + (sleep_time.tv_nsec / 1000000);
-
+    ready_poller poller(timeout);
     for (;;) {
+    #ifdef XRTSIM
+      uint64_t generation = notifier_.generation();
+    #endif
       uint32_t status = 0;
       CHECK_ERR(this->read_register(MMIO_CTL_ADDR, &status), {
         return err;
@@ -583,16 +604,39 @@ public:
       bool is_done = (status & CTL_AP_DONE) == CTL_AP_DONE;
       if (is_done)
         break;
-      if (0 == timeout) {
+      if (poller.expired()) {
         return -1;
       }
-      nanosleep(&sleep_time, nullptr);
-      timeout -= sleep_time_ms;
+    #ifdef XRTSIM
+      notifier_.wait(generation, poller.remaining());
+    #else
+      poller.pause();
+    #endif
     };
 
+  #ifdef XRTSIM
+    // acknowledge the interrupt
+    CHECK_ERR(this->write_register(MMIO_ISR_ADDR, 0x1), {
+      return err;
+    });
+  #endif
+
     return 0;
   }
 
+  // uploads are written to the device buffers during a run
+  bool overlap_uploads() const {
+    return true;
+  }
+
+  completion_notifier* notifier() {
+  #ifdef XRTSIM
+    return &notifier_;
+  #else
+    return nullptr;
+  #endif
+  }
+
   int dcr_write(uint32_t addr, uint32_t value) {
     CHECK_ERR(this->write_register(MMIO_DCR_ADDR, addr), {
       return err;
@@ -608,6 +652,11 @@ public:
     return dcrs_.read(addr, value);
   }
 
+  int checkpoint(const char* /*path*/, int /*mode*/) {
+    // checkpoints are only supported by the simx simulator
+    return -1;
+  }
+
   int mpm_query(uint32_t addr, uint32_t core_id, uint64_t *value) {
     uint32_t offset = addr - VX_CSR_MPM_BASE;
     if (offset > 31)
@@ -634,6 +683,9 @@ private:
   std::unordered_map<uint32_t, std::array<uint64_t, 32>> mpm_cache_;
   uint32_t lg2_num_banks_;
   uint32_t lg2_bank_size_;
+#ifdef XRTSIM
+  completion_notifier notifier_;
+#endif
 
 #ifdef BANK_INTERLEAVE
 
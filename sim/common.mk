@@ -4,4 +4,10 @@ include $(ROOT_DIR)/config.mk
 HW_DIR := $(VORTEX_HOME)/hw
 RTL_DIR := $(HW_DIR)/rtl
 DPI_DIR := $(HW_DIR)/dpi
-SCRIPT_DIR := $(HW_DIR)/scripts
\ No newline at end of file
+SCRIPT_DIR := $(HW_DIR)/scripts
+
+# Optional zstd support for compressed images
+ifdef ZSTD
+CXXFLAGS += -DVX_ZSTD_ENABLE
+LDFLAGS += -lzstd
+endif
@@ -0,0 +1,111 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace vortex {
+
+// Binary simulator checkpoint streams.
+// Values are stored raw in host byte order; checkpoints are only meant to be
+// restored by the same simulator build. Each component writes a short section
+// tag ahead of its state so that a mismatched layout fails loudly on restore
+// instead of silently corrupting the simulation.
+class CheckpointWriter {
+public:
+  CheckpointWriter(std::ostream& os) : os_(os) {}
+
+  void write(const void* data, uint64_t size) {
+    os_.write((const char*)data, size);
+    if (!os_)
+      throw std::runtime_error("checkpoint write failed");
+  }
+
+  template <typename T>
+  void write(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "invalid checkpoint type");
+    this->write(&value, sizeof(T));
+  }
+
+  template <typename T>
+  void write_vector(const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable_v<T>, "invalid checkpoint type");
+    this->write<uint64_t>(values.size());
+    this->write(values.data(), values.size() * sizeof(T));
+  }
+
+  void section(const char* name) {
+    char tag[4] = {};
+    memcpy(tag, name, std::min<size_t>(strlen(name), sizeof(tag)));
+    this->write(tag, sizeof(tag));
+  }
+
+private:
+  std::ostream& os_;
+};
+
+class CheckpointReader {
+public:
+  CheckpointReader(std::istream& is) : is_(is) {}
+
+  void read(void* data, uint64_t size) {
+    is_.read((char*)data, size);
+    if (!is_)
+      throw std::runtime_error("checkpoint is truncated");
+  }
+
+  template <typename T>
+  T read() {
+    static_assert(std::is_trivially_copyable_v<T>, "invalid checkpoint type");
+    T value;
+    this->read(&value, sizeof(T));
+    return value;
+  }
+
+  template <typename T>
+  void read_vector(std::vector<T>* values) {
+    static_assert(std::is_trivially_copyable_v<T>, "invalid checkpoint type");
+    values->resize(this->read<uint64_t>());
+    this->read(values->data(), values->size() * sizeof(T));
+  }
+
+  void section(const char* name) {
+    char expected[4] = {};
+    char tag[4];
+    memcpy(expected, name, std::min<size_t>(strlen(name), sizeof(expected)));
+    this->read(tag, sizeof(tag));
+    if (memcmp(tag, expected, sizeof(tag)) != 0)
+      throw std::runtime_error(std::string("checkpoint section mismatch: expected ") + name);
+  }
+
+  // read a configuration value and check it against the current one
+  template <typename T>
+  void check(const T& expected, const char* what) {
+    if (this->read<T>() != expected)
+      throw std::runtime_error(std::string("checkpoint configuration mismatch: ") + what);
+  }
+
+private:
+  std::istream& is_;
+};
+
+}
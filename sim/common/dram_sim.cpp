@@ -14,6 +14,11 @@
 #include "dram_sim.h"
 #include "util.h"
 #include <fstream>
+#include <sstream>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <assert.h>
 
 DISABLE_WARNING_PUSH
 DISABLE_WARNING_UNUSED_PARAMETER
@@ -27,7 +32,104 @@ DISABLE_WARNING_POP
 
 using namespace vortex;
 
+// Common front-end of the memory models: converts core cycles into memory
+// cycles and implements the run-ahead of the memory clock.
 class DramSim::Impl {
+public:
+	Impl(const Config& config)
+		: cpu_channel_size_(config.channel_size)
+		, scaled_dram_cycles_(static_cast<uint64_t>(config.clock_ratio * tick_cycles_))
+	{
+		this->reset();
+	}
+
+	virtual ~Impl() {}
+
+	virtual void reset() {
+		cpu_cycles_ = 0;
+		deferred_rsps_.clear();
+		ahead_cycles_ = 0;
+		capture_rsps_ = false;
+	}
+
+	void tick() {
+		if (ahead_cycles_ != 0) {
+			// consume a pre-simulated cycle
+			if (--ahead_cycles_ == 0) {
+				for (auto& rsp : deferred_rsps_) {
+					rsp.first(rsp.second);
+				}
+				deferred_rsps_.clear();
+			}
+			return;
+		}
+		this->step();
+	}
+
+	uint64_t run_ahead(uint64_t cycles) {
+		if (!deferred_rsps_.empty())
+			return ahead_cycles_ - 1;
+		capture_rsps_ = true;
+		while (ahead_cycles_ < cycles) {
+			this->step();
+			++ahead_cycles_;
+			if (!deferred_rsps_.empty())
+				break;
+		}
+		capture_rsps_ = false;
+		if (!deferred_rsps_.empty())
+			return ahead_cycles_ - 1;
+		return std::min(ahead_cycles_, cycles);
+	}
+
+	void skip(uint64_t cycles) {
+		assert(cycles < ahead_cycles_ || (cycles == ahead_cycles_ && deferred_rsps_.empty()));
+		ahead_cycles_ -= cycles;
+	}
+
+	void send_request(uint64_t addr, bool is_write, ResponseCallback response_cb, void* arg) {
+		// the model cannot rewind the cycles it has already simulated
+		assert(ahead_cycles_ == 0);
+		this->enqueue(addr, is_write, response_cb, arg);
+	}
+
+protected:
+	uint32_t cpu_channel_size_;
+
+	void complete(ResponseCallback callback, void* arg) {
+		if (capture_rsps_) {
+			deferred_rsps_.emplace_back(callback, arg);
+		} else {
+			callback(arg);
+		}
+	}
+
+	// accept a new request
+	virtual void enqueue(uint64_t addr, bool is_write, ResponseCallback response_cb, void* arg) = 0;
+
+	// advance the memory clock by one cycle
+	virtual void dram_tick() = 0;
+
+private:
+	static const uint32_t tick_cycles_ = 1000;
+	uint32_t scaled_dram_cycles_;
+	uint64_t cpu_cycles_;
+	std::vector<std::pair<ResponseCallback, void*>> deferred_rsps_;
+	uint64_t ahead_cycles_;
+	bool capture_rsps_;
+
+	void step() {
+		cpu_cycles_ += tick_cycles_;
+		while (cpu_cycles_ >= scaled_dram_cycles_) {
+			this->dram_tick();
+			cpu_cycles_ -= scaled_dram_cycles_;
+		}
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class DramSim::RamulatorImpl : public DramSim::Impl {
 private:
 	struct mem_req_t {
 		uint64_t addr;
@@ -36,15 +138,35 @@ private:
 		void* arg;
 	};
 
+	// default presets of a memory standard
+	struct preset_t {
+		const char* org;
+		const char* timing;
+		uint32_t access_size; // bytes per memory request
+		bool has_ranks;
+	};
+
 	Ramulator::IFrontEnd* ramulator_frontend_;
 	Ramulator::IMemorySystem* ramulator_memorysystem_;
-	uint32_t cpu_channel_size_;
-	uint64_t cpu_cycles_;
-	uint32_t scaled_dram_cycles_;
-	static const uint32_t tick_cycles_ = 1000;
-	static const uint32_t dram_channel_size_ = 16; // 128 bits
+	uint32_t dram_channel_size_;
 	std::queue<mem_req_t> pending_reqs_;
 
+	static const preset_t& get_preset(DramStandard standard) {
+		static const preset_t ddr4   {"DDR4_8Gb_x8",    "DDR4_2400R",  64, true};
+		static const preset_t ddr5   {"DDR5_16Gb_x8",   "DDR5_3200AN", 64, true};
+		static const preset_t hbm2   {"HBM2_8Gb",       "HBM2_2Gbps",  16, false};
+		static const preset_t hbm3   {"HBM3_8Gb",       "HBM3_2Gbps",  64, false};
+		static const preset_t lpddr5 {"LPDDR5_8Gb_x16", "LPDDR5_6400", 32, true};
+		switch (standard) {
+		case DramStandard::DDR4:   return ddr4;
+		case DramStandard::DDR5:   return ddr5;
+		case DramStandard::HBM2:   return hbm2;
+		case DramStandard::HBM3:   return hbm3;
+		case DramStandard::LPDDR5: return lpddr5;
+		}
+		std::abort();
+	}
+
 	void handle_pending_requests() {
 		if (pending_reqs_.empty())
 			return;
@@ -52,15 +174,15 @@ private:
 		auto req_type = req.is_write ? Ramulator::Request::Type::Write : Ramulator::Request::Type::Read;
 		std::function<void(Ramulator::Request&)> callback = nullptr;
 		if (req.callback) {
-			callback = [req_callback = std::move(req.callback), req_arg = std::move(req.arg)](Ramulator::Request& /*dram_req*/) {
-				req_callback(req_arg);
+			callback = [this, req_callback = std::move(req.callback), req_arg = std::move(req.arg)](Ramulator::Request& /*dram_req*/) {
+				this->complete(req_callback, req_arg);
 			};
 		}
 		if (ramulator_frontend_->receive_external_requests(req_type, req.addr, 0, callback)) {
 			if (req.is_write) {
 				// Ramulator does not handle write responses, so we fire the callback ourselves.
 				if (req.callback) {
-					req.callback(req.arg);
+					this->complete(req.callback, req.arg);
 				}
 			}
 			pending_reqs_.pop();
@@ -68,39 +190,43 @@ private:
 	}
 
 public:
-	Impl(uint32_t num_channels, uint32_t channel_size, float clock_ratio) {
+	RamulatorImpl(const Config& config) : Impl(config) {
+		auto& ramulator = config.ramulator;
+		auto& preset = get_preset(ramulator.standard);
+		std::ostringstream standard;
+		standard << ramulator.standard;
+		dram_channel_size_ = preset.access_size;
+
 		YAML::Node dram_config;
 		dram_config["Frontend"]["impl"] = "GEM5";
 		dram_config["MemorySystem"]["impl"] = "GenericDRAM";
 		dram_config["MemorySystem"]["clock_ratio"] = 1;
-		dram_config["MemorySystem"]["DRAM"]["impl"] = "HBM2";
-		dram_config["MemorySystem"]["DRAM"]["org"]["preset"] = "HBM2_8Gb";
-		dram_config["MemorySystem"]["DRAM"]["org"]["density"] = 8192;
-		dram_config["MemorySystem"]["DRAM"]["org"]["channel"] = num_channels;
-		dram_config["MemorySystem"]["DRAM"]["timing"]["preset"] = "HBM2_2Gbps";
+		dram_config["MemorySystem"]["DRAM"]["impl"] = standard.str();
+		dram_config["MemorySystem"]["DRAM"]["org"]["preset"] = ramulator.org_preset.empty() ? preset.org : ramulator.org_preset;
+		dram_config["MemorySystem"]["DRAM"]["org"]["channel"] = config.num_channels;
+		if (preset.has_ranks) {
+			dram_config["MemorySystem"]["DRAM"]["org"]["rank"] = ramulator.num_ranks;
+		}
+		dram_config["MemorySystem"]["DRAM"]["timing"]["preset"] = ramulator.timing_preset.empty() ? preset.timing : ramulator.timing_preset;
 		dram_config["MemorySystem"]["Controller"]["impl"] = "Generic";
-		dram_config["MemorySystem"]["Controller"]["Scheduler"]["impl"] = "FRFCFS";
+		dram_config["MemorySystem"]["Controller"]["Scheduler"]["impl"] = ramulator.scheduler;
 		dram_config["MemorySystem"]["Controller"]["RefreshManager"]["impl"] = "AllBank";
 		dram_config["MemorySystem"]["Controller"]["RowPolicy"]["impl"] = "OpenRowPolicy";
-		{
+		if (!ramulator.trace.empty()) {
 			YAML::Node draw_plugin;
 			draw_plugin["ControllerPlugin"]["impl"] = "TraceRecorder";
-			draw_plugin["ControllerPlugin"]["path"] = "./trace/ramulator.log";
+			draw_plugin["ControllerPlugin"]["path"] = ramulator.trace;
 			dram_config["MemorySystem"]["Controller"]["plugins"].push_back(draw_plugin);
 		}
-		dram_config["MemorySystem"]["AddrMapper"]["impl"] = "RoBaRaCoCh";
+		dram_config["MemorySystem"]["AddrMapper"]["impl"] = ramulator.addr_mapping;
 
 		ramulator_frontend_ = Ramulator::Factory::create_frontend(dram_config);
 		ramulator_memorysystem_ = Ramulator::Factory::create_memory_system(dram_config);
 		ramulator_frontend_->connect_memory_system(ramulator_memorysystem_);
 		ramulator_memorysystem_->connect_frontend(ramulator_frontend_);
-
-		cpu_channel_size_ = channel_size;
-		scaled_dram_cycles_ = static_cast<uint64_t>(clock_ratio * tick_cycles_);
-		this->reset();
 	}
 
-	~Impl() {
+	~RamulatorImpl() {
 		std::ofstream nullstream("ramulator.stats.log");
 		auto original_buf = std::cout.rdbuf();
 		std::cout.rdbuf(nullstream.rdbuf());
@@ -109,21 +235,9 @@ public:
 		std::cout.rdbuf(original_buf);
 	}
 
-	void reset() {
-		cpu_cycles_ = 0;
-	}
+protected:
 
-	void tick() {
-		cpu_cycles_ += tick_cycles_;
-		while (cpu_cycles_ >= scaled_dram_cycles_) {
-			this->handle_pending_requests();
-			ramulator_memorysystem_->tick();
-			cpu_cycles_ -= scaled_dram_cycles_;
-		}
-	}
-
-	void send_request(uint64_t addr, bool is_write, ResponseCallback response_cb, void* arg) {
-		// enqueue the request
+	void enqueue(uint64_t addr, bool is_write, ResponseCallback response_cb, void* arg) override {
 		if (cpu_channel_size_ > dram_channel_size_) {
 			uint32_t n = cpu_channel_size_ / dram_channel_size_;
 			for (uint32_t i = 0; i < n; ++i) {
@@ -142,14 +256,154 @@ public:
 			pending_reqs_.push({dram_byte_addr, is_write, response_cb, arg});
 		}
 	}
+
+	void dram_tick() override {
+		this->handle_pending_requests();
+		ramulator_memorysystem_->tick();
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Analytical model: each channel has open-row banks and a data bus that
+// transfers bus_width bytes per cycle. A request waits for its bank, pays
+// a row hit, row miss or row conflict access time, then serializes on the
+// channel bus; a fixed latency is added on top. Requests are timed when
+// they arrive, so the model only walks the channel response queues.
+class DramSim::SimpleImpl : public DramSim::Impl {
+private:
+	struct bank_t {
+		uint64_t row;
+		uint64_t ready; // next cycle a column command can issue
+	};
+
+	struct rsp_t {
+		uint64_t cycle;
+		ResponseCallback callback;
+		void* arg;
+	};
+
+	struct channel_t {
+		std::vector<bank_t> banks;
+		uint64_t bus_free; // next cycle the data bus is available
+		std::queue<rsp_t> rsps;
+	};
+
+	static constexpr uint64_t no_row = uint64_t(-1);
+
+	DramTiming timing_;
+	std::vector<channel_t> channels_;
+	uint32_t lg2_channels_;
+	uint32_t lg2_row_blocks_;
+	uint32_t lg2_banks_;
+	uint32_t burst_cycles_;
+	uint64_t dram_cycles_;
+	uint32_t pending_;
+
+public:
+	SimpleImpl(const Config& config)
+		: Impl(config)
+		, timing_(config.timing)
+		, channels_(config.num_channels)
+		, lg2_channels_(log2ceil(config.num_channels))
+		, lg2_row_blocks_(log2ceil(std::max<uint32_t>(config.timing.row_size / config.channel_size, 1)))
+		, lg2_banks_(log2ceil(config.timing.num_banks))
+		, burst_cycles_((config.channel_size + config.timing.bus_width - 1) / config.timing.bus_width)
+		, pending_(0)
+	{
+		for (auto& channel : channels_) {
+			channel.banks.resize(config.timing.num_banks);
+		}
+		this->reset_timing();
+	}
+
+	void reset() override {
+		Impl::reset();
+		this->reset_timing();
+	}
+
+protected:
+
+	void enqueue(uint64_t addr, bool is_write, ResponseCallback response_cb, void* arg) override {
+		__unused (is_write);
+		// same channel interleaving as the memory crossbar, then row:bank:column
+		uint64_t block = addr / cpu_channel_size_;
+		auto& channel = channels_.at(block & ((1ull << lg2_channels_) - 1));
+		uint64_t row_block = (block >> lg2_channels_) >> lg2_row_blocks_;
+		auto& bank = channel.banks.at(row_block & ((1ull << lg2_banks_) - 1));
+		uint64_t row = row_block >> lg2_banks_;
+
+		uint64_t issue = std::max(dram_cycles_, bank.ready);
+		if (bank.row != row) {
+			if (bank.row != no_row) {
+				issue += timing_.tRP;
+			}
+			issue += timing_.tRCD;
+			bank.row = row;
+		}
+		uint64_t data = std::max(issue + timing_.tCL, channel.bus_free);
+		channel.bus_free = data + burst_cycles_;
+		bank.ready = data - timing_.tCL + burst_cycles_;
+
+		channel.rsps.push({channel.bus_free + timing_.latency, response_cb, arg});
+		++pending_;
+	}
+
+	void dram_tick() override {
+		++dram_cycles_;
+		if (pending_ == 0)
+			return;
+		for (auto& channel : channels_) {
+			// responses of a channel complete in order
+			while (!channel.rsps.empty()) {
+				auto& rsp = channel.rsps.front();
+				if (rsp.cycle > dram_cycles_)
+					break;
+				if (rsp.callback) {
+					this->complete(rsp.callback, rsp.arg);
+				}
+				channel.rsps.pop();
+				--pending_;
+			}
+		}
+	}
+
+private:
+
+	void reset_timing() {
+		dram_cycles_ = 0;
+		for (auto& channel : channels_) {
+			for (auto& bank : channel.banks) {
+				bank.row = no_row;
+				bank.ready = 0;
+			}
+			channel.bus_free = 0;
+			// drop in-flight responses, their callbacks target the reset requester
+			channel.rsps = std::queue<rsp_t>();
+		}
+		pending_ = 0;
+	}
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 DramSim::DramSim(uint32_t num_channels, uint32_t channel_size, float clock_ratio)
-	: impl_(new Impl(num_channels, channel_size, clock_ratio))
+	: DramSim(Config{DramModel::Ramulator, num_channels, channel_size, clock_ratio, DramTiming(), RamulatorConfig()})
 {}
 
+DramSim::DramSim(const Config& config) {
+	switch (config.model) {
+	case DramModel::Ramulator:
+		impl_ = new RamulatorImpl(config);
+		break;
+	case DramModel::Simple:
+		impl_ = new SimpleImpl(config);
+		break;
+	default:
+		std::abort();
+	}
+}
+
 DramSim::~DramSim() {
   delete impl_;
 }
@@ -164,4 +418,12 @@ void DramSim::tick() {
 
 void DramSim::send_request(uint64_t addr, bool is_write, ResponseCallback callback, void* arg) {
   impl_->send_request(addr, is_write, callback, arg);
+}
+
+uint64_t DramSim::run_ahead(uint64_t cycles) {
+  return impl_->run_ahead(cycles);
+}
+
+void DramSim::skip(uint64_t cycles) {
+  impl_->skip(cycles);
 }
\ No newline at end of file
@@ -11,15 +11,104 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#pragma once
+
 #include <stdint.h>
+#include <ostream>
+#include <string>
 
 namespace vortex {
 
+enum class DramModel {
+  Ramulator, // cycle-accurate Ramulator HBM2 model
+  Simple     // analytical open-row model
+};
+
+inline std::ostream &operator<<(std::ostream &os, const DramModel& model) {
+  switch (model) {
+  case DramModel::Ramulator: os << "ramulator"; break;
+  case DramModel::Simple:    os << "simple"; break;
+  }
+  return os;
+}
+
+enum class DramStandard {
+  DDR4,
+  DDR5,
+  HBM2,
+  HBM3,
+  LPDDR5
+};
+
+inline std::ostream &operator<<(std::ostream &os, const DramStandard& standard) {
+  switch (standard) {
+  case DramStandard::DDR4:   os << "DDR4"; break;
+  case DramStandard::DDR5:   os << "DDR5"; break;
+  case DramStandard::HBM2:   os << "HBM2"; break;
+  case DramStandard::HBM3:   os << "HBM3"; break;
+  case DramStandard::LPDDR5: os << "LPDDR5"; break;
+  }
+  return os;
+}
+
+// Ramulator model parameters.
+// Empty presets select the default ones of the standard.
+struct RamulatorConfig {
+  DramStandard standard;
+  uint32_t     num_ranks;     // ranks per channel (DDR and LPDDR only)
+  std::string  org_preset;    // organization preset, e.g. "DDR4_8Gb_x8"
+  std::string  timing_preset; // timing preset, e.g. "DDR4_2400R"
+  std::string  addr_mapping;  // address mapper, e.g. "RoBaRaCoCh"
+  std::string  scheduler;     // controller scheduler, e.g. "FRFCFS"
+  std::string  trace;         // command trace file, empty to disable
+
+  RamulatorConfig()
+    : standard(DramStandard::HBM2)
+    , num_ranks(1)
+    , addr_mapping("RoBaRaCoCh")
+    , scheduler("FRFCFS")
+  {}
+};
+
+// Analytical model parameters, in memory clock cycles.
+// The defaults approximate the Ramulator HBM2_2Gbps preset.
+struct DramTiming {
+  uint32_t latency;   // fixed controller and interconnect latency
+  uint32_t num_banks; // banks per channel
+  uint32_t row_size;  // row buffer size in bytes
+  uint32_t tCL;       // column access latency
+  uint32_t tRCD;      // row activation latency
+  uint32_t tRP;       // row precharge latency
+  uint32_t bus_width; // bytes transferred per cycle per channel
+
+  DramTiming()
+    : latency(12)
+    , num_banks(16)
+    , row_size(1024)
+    , tCL(7)
+    , tRCD(7)
+    , tRP(7)
+    , bus_width(8)
+  {}
+};
+
 class DramSim {
 public:
   typedef void (*ResponseCallback)(void *arg);
 
+  struct Config {
+    DramModel  model;
+    uint32_t   num_channels;
+    uint32_t   channel_size; // request size in bytes
+    float      clock_ratio;  // memory clock / core clock
+    DramTiming timing;       // analytical model only
+    RamulatorConfig ramulator; // Ramulator model only
+  };
+
   DramSim(uint32_t num_channels, uint32_t channel_size, float clock_ratio);
+
+  DramSim(const Config& config);
+
   ~DramSim();
 
   void reset();
@@ -29,9 +118,19 @@ public:
   // addr: per-channel block address
   void send_request(uint64_t addr, bool is_write, ResponseCallback response_cb, void* arg);
 
+  // pre-simulate up to the given number of cycles, stopping at the first
+  // cycle that completes a request, whose callbacks are deferred until that
+  // cycle is ticked. Returns the number of cycles without completions.
+  uint64_t run_ahead(uint64_t cycles);
+
+  // consume pre-simulated cycles without completions
+  void skip(uint64_t cycles);
+
 private:
 	class Impl;
+	class RamulatorImpl;
+	class SimpleImpl;
 	Impl* impl_;
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,148 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef VX_ZSTD_ENABLE
+#include <zstd.h>
+#endif
+
+namespace vortex {
+
+// Read-only, memory-mapped view of a file.
+// The content is paged in by the host on demand, so loading an image costs
+// a single copy into the destination memory.
+class MappedFile {
+public:
+  MappedFile() : data_(nullptr), size_(0) {}
+
+  ~MappedFile() {
+    this->close();
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // returns 0 on success
+  int open(const char* filename) {
+    this->close();
+    int fd = ::open(filename, O_RDONLY);
+    if (fd < 0)
+      return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      ::close(fd);
+      return -1;
+    }
+    size_ = st.st_size;
+    if (size_ != 0) {
+      auto ptr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (ptr == MAP_FAILED) {
+        ::close(fd);
+        size_ = 0;
+        return -1;
+      }
+      madvise(ptr, size_, MADV_SEQUENTIAL);
+      data_ = (const uint8_t*)ptr;
+    }
+    ::close(fd);
+    return 0;
+  }
+
+  void close() {
+    if (data_) {
+      munmap((void*)data_, size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  const uint8_t* data() const {
+    return data_;
+  }
+
+  uint64_t size() const {
+    return size_;
+  }
+
+  // compressed images are zstd frames
+  bool is_compressed() const {
+    return size_ >= 4
+        && data_[0] == 0x28 && data_[1] == 0xb5
+        && data_[2] == 0x2f && data_[3] == 0xfd;
+  }
+
+private:
+  const uint8_t* data_;
+  uint64_t size_;
+};
+
+#ifdef VX_ZSTD_ENABLE
+
+// Streams the decompressed content of a zstd image into caller-provided
+// windows: window(offset, &ptr) returns the number of bytes available at ptr
+// for the output at the given offset, commit(offset, size) is invoked once
+// a window has been filled. Returns the decompressed size or -1 on error.
+template <typename Window, typename Commit>
+int64_t zstd_decompress(const uint8_t* src, uint64_t size, const Window& window, const Commit& commit) {
+  auto dctx = ZSTD_createDCtx();
+  if (dctx == nullptr)
+    return -1;
+  ZSTD_inBuffer in{src, size, 0};
+  uint64_t offset = 0;
+  int64_t ret = 0;
+  size_t status = 1;
+  while (in.pos < in.size || status != 0) {
+    uint8_t* ptr;
+    uint64_t avail = window(offset, &ptr);
+    if (avail == 0) {
+      ret = -1;
+      break;
+    }
+    ZSTD_outBuffer out{ptr, avail, 0};
+    size_t prev_in = in.pos;
+    status = ZSTD_decompressStream(dctx, &out, &in);
+    if (ZSTD_isError(status)) {
+      ret = -1;
+      break;
+    }
+    if (out.pos != 0) {
+      commit(offset, out.pos);
+      offset += out.pos;
+    } else if (in.pos == prev_in) {
+      // truncated input
+      ret = -1;
+      break;
+    }
+  }
+  ZSTD_freeDCtx(dctx);
+  return (ret < 0) ? -1 : int64_t(offset);
+}
+
+// returns the decompressed size of a zstd image, or -1 if not recorded
+inline int64_t zstd_content_size(const uint8_t* src, uint64_t size) {
+  auto content_size = ZSTD_getFrameContentSize(src, size);
+  if (content_size == ZSTD_CONTENTSIZE_UNKNOWN
+   || content_size == ZSTD_CONTENTSIZE_ERROR)
+    return -1;
+  return int64_t(content_size);
+}
+
+#endif
+
+}
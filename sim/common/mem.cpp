@@ -19,6 +19,12 @@
 #include "util.h"
 #include <VX_config.h>
 #include <bitset>
+#include <cstring>
+#include <algorithm>
+#include <sys/mman.h>
+#include <array>
+#include "mapped_file.h"
+#include "checkpoint.h"
 
 using namespace vortex;
 
@@ -139,10 +145,10 @@ MemoryUnit::MemoryUnit(uint64_t pageSize)
 #endif
   , amo_reservation_({0x0, false})
 #ifdef VM_ENABLE
-  , TLB_HIT(0)
-  , TLB_MISS(0)
-  , TLB_EVICT(0)
-  , PTW(0)
+  , l1_tlb_(TLB_SIZE, TLB_NUM_WAYS, TlbReplPolicy(TLB_REPL_POLICY))
+  , l2_tlb_(L2_TLB_SIZE, L2_TLB_NUM_WAYS, TlbReplPolicy(TLB_REPL_POLICY))
+  , pwc_(PWC_SIZE)
+  , latency_(0)
   , satp_(NULL) {};
 #else
   {
@@ -160,67 +166,32 @@ void MemoryUnit::attach(MemDevice &m, uint64_t start, uint64_t end) {
 
 #ifdef VM_ENABLE
 std::pair<bool, uint64_t> MemoryUnit::tlbLookup(uint64_t vAddr, ACCESS_TYPE type, uint64_t* size_bits) {
-
-  //Find entry while accounting for different sizes.
-  for (auto entry : tlb_)
-  {
-    if(entry.first == vAddr >> entry.second.size_bits)
-    {
-        *size_bits = entry.second.size_bits;
-        vAddr = vAddr >> (*size_bits);
+  auto entry = l1_tlb_.lookup(vAddr);
+  if (entry == nullptr) {
+    // L1 miss, lookup the second level TLB
+    entry = l2_tlb_.lookup(vAddr);
+    if (entry == nullptr) {
+      return std::make_pair(false, 0);
     }
+    latency_ += L2_TLB_LATENCY;
+    ++perf_stats_.tlb_l2_hits;
+    l1_tlb_.insert(entry->vpn, entry->pfn, entry->flags, entry->size_bits);
   }
 
-
-  auto iter = tlb_.find(vAddr);
-  if (iter != tlb_.end()) {
-    TLBEntry e = iter->second;
-
-    //Set mru bit if it is a hit.
-    iter->second.mru_bit = true;
-
-    //If at full capacity and no other unset bits.
-    // Clear all bits except the one we just looked up.
-    if (tlb_.size() == TLB_SIZE)
-    {
-      // bool no_cleared = true;
-      // for (auto& entry : tlb_)
-      // {
-      //   no_cleared = no_cleared & entry.second.mru_bit;
-      // }
-
-      // if(no_cleared)
-      // {
-        for (auto& entry : tlb_)
-        {
-          entry.second.mru_bit = false;
-        }
-        iter->second.mru_bit = true;
-      //}
-
-    }
-    //Check access permissions.
-    if ( (type == ACCESS_TYPE::FETCH) & ((e.r == 0) | (e.x == 0)) )
-    {
-      throw Page_Fault_Exception("Page Fault : Incorrect permissions.");
-    }
-    else if ( (type == ACCESS_TYPE::LOAD) & (e.r == 0) )
-    {
-      throw Page_Fault_Exception("Page Fault : Incorrect permissions.");
-    }
-    else if ( (type == ACCESS_TYPE::STORE) & (e.w == 0) )
-    {
-      throw Page_Fault_Exception("Page Fault : Incorrect permissions.");
-    }
-    else
-    {
-      //TLB Hit
-      return std::make_pair(true, iter->second.pfn);
-    }
-  } else {
-    //TLB Miss
-    return std::make_pair(false, 0);
+  // Check access permissions.
+  bool r = (entry->flags >> 1) & 1;
+  bool w = (entry->flags >> 2) & 1;
+  bool x = (entry->flags >> 3) & 1;
+  if ((type == ACCESS_TYPE::FETCH) & (!r | !x)) {
+    throw Page_Fault_Exception("Page Fault : Incorrect permissions.");
+  } else if ((type == ACCESS_TYPE::LOAD) & !r) {
+    throw Page_Fault_Exception("Page Fault : Incorrect permissions.");
+  } else if ((type == ACCESS_TYPE::STORE) & !w) {
+    throw Page_Fault_Exception("Page Fault : Incorrect permissions.");
   }
+
+  *size_bits = entry->size_bits;
+  return std::make_pair(true, entry->pfn);
 }
 #else
 MemoryUnit::TLBEntry MemoryUnit::tlbLookup(uint64_t vAddr, uint32_t flagMask) {
@@ -309,26 +280,12 @@ bool MemoryUnit::amo_check(uint64_t addr) {
 #ifdef VM_ENABLE
 
 void MemoryUnit::tlbAdd(uint64_t virt, uint64_t phys, uint32_t flags, uint64_t size_bits) {
-  // HW: evict TLB by Most Recently Used
-  if (tlb_.size() == TLB_SIZE - 1) {
-    for (auto& entry : tlb_)
-    {
-      entry.second.mru_bit = false;
-    }
-
-  } else if (tlb_.size() == TLB_SIZE) {
-    uint64_t del;
-    for (auto entry : tlb_) {
-      if (!entry.second.mru_bit)
-      {
-        del = entry.first;
-        break;
-      }
-    }
-    tlb_.erase(tlb_.find(del));
-    TLB_EVICT++;
+  uint64_t vpn = virt >> size_bits;
+  uint64_t pfn = phys >> size_bits;
+  if (l1_tlb_.insert(vpn, pfn, flags, size_bits)) {
+    ++perf_stats_.tlb_evictions;
   }
-  tlb_[virt / pageSize_] = TLBEntry(phys / pageSize_, flags, size_bits);
+  l2_tlb_.insert(vpn, pfn, flags, size_bits);
 }
 #else
 
@@ -337,10 +294,18 @@ void MemoryUnit::tlbAdd(uint64_t virt, uint64_t phys, uint32_t flags) {
 }
 #endif
 
+#ifdef VM_ENABLE
+void MemoryUnit::tlbRm(uint64_t va) {
+  l1_tlb_.invalidate(va);
+  l2_tlb_.invalidate(va);
+  pwc_.flush();
+}
+#else
 void MemoryUnit::tlbRm(uint64_t va) {
   if (tlb_.find(va / pageSize_) != tlb_.end())
     tlb_.erase(tlb_.find(va / pageSize_));
 }
+#endif
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -419,9 +384,27 @@ bool ACLManager::check(uint64_t addr, uint64_t size, int flags) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// uninitialized memory reads as "baadf00d"
+static void fill_uninit(uint8_t* dst, uint64_t addr, uint64_t size) {
+  if (0 == (addr & 0x3) && 0 == (size & 0x3)) {
+    uint32_t pattern = 0xbaadf00d;
+    for (uint64_t i = 0; i < size; i += 4) {
+      std::memcpy(dst + i, &pattern, 4);
+    }
+    return;
+  }
+  for (uint64_t i = 0; i < size; ++i) {
+    dst[i] = (0xbaadf00d >> (((addr + i) & 0x3) * 8)) & 0xff;
+  }
+}
+
 RAM::RAM(uint64_t capacity, uint32_t page_size)
   : capacity_(capacity)
   , page_bits_(log2ceil(page_size))
+  , page_size_(page_size)
+  , chunk_ptr_(nullptr)
+  , chunk_avail_(0)
+  , num_pages_(0)
   , last_page_(nullptr)
   , last_page_index_(0)
   , check_acl_(false) {
@@ -438,44 +421,79 @@ RAM::~RAM() {
 }
 
 void RAM::clear() {
-  for (auto& page : pages_) {
-    delete[] page.second;
+  for (auto leaf : dir_) {
+    delete leaf;
+  }
+  for (auto& entry : far_dir_) {
+    delete entry.second;
+  }
+  for (auto& chunk : chunks_) {
+    munmap(chunk.first, chunk.second);
   }
+  dir_.clear();
+  far_dir_.clear();
+  chunks_.clear();
+  chunk_ptr_ = nullptr;
+  chunk_avail_ = 0;
+  num_pages_ = 0;
+  last_page_ = nullptr;
+  last_page_index_ = 0;
 }
 
 uint64_t RAM::size() const {
-  return uint64_t(pages_.size()) << page_bits_;
-}
-
-uint8_t *RAM::get(uint64_t address) const {
-  if (capacity_ != 0 && address >= capacity_) {
-    throw OutOfRange();
-  }
-  uint32_t page_size   = 1 << page_bits_;
-  uint32_t page_offset = address & (page_size - 1);
-  uint64_t page_index  = address >> page_bits_;
+  return num_pages_ << page_bits_;
+}
+
+uint8_t* RAM::alloc_page(uint64_t page_index, bool fill) const {
+  // page storage is carved out of anonymous mappings, which the host
+  // commits lazily as zero pages on first touch.
+  auto map_chunk = [&](uint64_t size)->uint8_t* {
+    auto ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (ptr == MAP_FAILED)
+      throw std::bad_alloc();
+    chunks_.emplace_back((uint8_t*)ptr, size);
+    return (uint8_t*)ptr;
+  };
 
   uint8_t* page;
-  if (last_page_ && last_page_index_ == page_index) {
-    page = last_page_;
+  if (page_size_ >= CHUNK_SIZE) {
+    page = map_chunk(page_size_);
   } else {
-    auto it = pages_.find(page_index);
-    if (it != pages_.end()) {
-      page = it->second;
-    } else {
-      uint8_t *ptr = new uint8_t[page_size];
-      // set uninitialized data to "baadf00d"
-      for (uint32_t i = 0; i < page_size; ++i) {
-        ptr[i] = (0xbaadf00d >> ((i & 0x3) * 8)) & 0xff;
-      }
-      pages_.emplace(page_index, ptr);
-      page = ptr;
+    if (chunk_avail_ < page_size_) {
+      chunk_ptr_ = map_chunk(CHUNK_SIZE);
+      chunk_avail_ = CHUNK_SIZE;
     }
-    last_page_ = page;
-    last_page_index_ = page_index;
+    page = chunk_ptr_;
+    chunk_ptr_ += page_size_;
+    chunk_avail_ -= page_size_;
+  }
+
+  if (fill) {
+    fill_uninit(page, 0, page_size_);
   }
 
-  return page + page_offset;
+  auto dir_index = page_index >> LEAF_BITS;
+  leaf_t** slot;
+  if (dir_index < MAX_DIR_SIZE) {
+    if (dir_index >= dir_.size()) {
+      dir_.resize(dir_index + 1, nullptr);
+    }
+    slot = &dir_[dir_index];
+  } else {
+    slot = &far_dir_[dir_index];
+  }
+  if (*slot == nullptr) {
+    *slot = new leaf_t();
+  }
+  (*slot)->pages[page_index & (LEAF_SIZE - 1)] = page;
+  ++num_pages_;
+
+  return page;
+}
+
+uint8_t *RAM::get(uint64_t address) const {
+  this->check_range(address, 1);
+  return this->map_page(address >> page_bits_, true) + (address & (page_size_ - 1));
 }
 
 void RAM::read(void* data, uint64_t addr, uint64_t size) {
@@ -483,19 +501,83 @@ void RAM::read(void* data, uint64_t addr, uint64_t size) {
   if (check_acl_ && acl_mngr_.check(addr, size, 0x1) == false) {
     throw BadAddress();
   }
-  uint8_t* d = (uint8_t*)data;
-  for (uint64_t i = 0; i < size; i++) {
-    d[i] = *this->get(addr + i);
+  this->check_range(addr, size);
+  auto d = (uint8_t*)data;
+  uint64_t offset = addr & (page_size_ - 1);
+
+  // fast path: access within a single mapped page
+  if (offset + size <= page_size_) {
+    uint64_t page_index = addr >> page_bits_;
+    uint8_t* page = (last_page_ && page_index == last_page_index_) ? last_page_ : this->lookup(page_index);
+    if (page) {
+      last_page_ = page;
+      last_page_index_ = page_index;
+      switch (size) {
+      case 4: std::memcpy(d, page + offset, 4); break;
+      case 8: std::memcpy(d, page + offset, 8); break;
+      default: std::memcpy(d, page + offset, size); break;
+      }
+      return;
+    }
   }
+
+  this->read_pages(d, addr, size);
 }
 
 void RAM::write(const void* data, uint64_t addr, uint64_t size) {
   if (check_acl_ && acl_mngr_.check(addr, size, 0x2) == false) {
     throw BadAddress();
   }
-  const uint8_t* d = (const uint8_t*)data;
-  for (uint64_t i = 0; i < size; i++) {
-    *this->get(addr + i) = d[i];
+  this->check_range(addr, size);
+  auto d = (const uint8_t*)data;
+  uint64_t offset = addr & (page_size_ - 1);
+
+  // fast path: access within a single page
+  if (offset + size <= page_size_) {
+    auto page = this->map_page(addr >> page_bits_, size != page_size_);
+    switch (size) {
+    case 4: std::memcpy(page + offset, d, 4); break;
+    case 8: std::memcpy(page + offset, d, 8); break;
+    default: std::memcpy(page + offset, d, size); break;
+    }
+    return;
+  }
+
+  // page-granular copy, fully overwritten pages skip initialization
+  while (size != 0) {
+    uint64_t chunk = std::min<uint64_t>(page_size_ - offset, size);
+    auto page = this->map_page(addr >> page_bits_, chunk != page_size_);
+    std::memcpy(page + offset, d, chunk);
+    addr += chunk;
+    d += chunk;
+    size -= chunk;
+    offset = 0;
+  }
+}
+
+void RAM::peek(void* data, uint64_t addr, uint64_t size) const {
+  if (check_acl_ && acl_mngr_.check(addr, size, 0x1) == false) {
+    throw BadAddress();
+  }
+  this->check_range(addr, size);
+  this->read_pages((uint8_t*)data, addr, size);
+}
+
+void RAM::read_pages(uint8_t* data, uint64_t addr, uint64_t size) const {
+  uint64_t offset = addr & (page_size_ - 1);
+  while (size != 0) {
+    uint64_t chunk = std::min<uint64_t>(page_size_ - offset, size);
+    auto page = this->lookup(addr >> page_bits_);
+    if (page) {
+      std::memcpy(data, page + offset, chunk);
+    } else {
+      // unmapped pages are not allocated on reads
+      fill_uninit(data, addr, chunk);
+    }
+    addr += chunk;
+    data += chunk;
+    size -= chunk;
+    offset = 0;
   }
 }
 
@@ -506,69 +588,130 @@ void RAM::set_acl(uint64_t addr, uint64_t size, int flags) {
   acl_mngr_.set(addr, size, flags);
 }
 
+void RAM::save(CheckpointWriter& ckpt) const {
+  ckpt.section("RAM");
+  ckpt.write<uint64_t>(page_size_);
+  ckpt.write<uint64_t>(num_pages_);
+  auto save_leaf = [&](uint64_t dir_index, const leaf_t* leaf) {
+    if (leaf == nullptr)
+      return;
+    for (uint32_t i = 0; i < LEAF_SIZE; ++i) {
+      auto page = leaf->pages[i];
+      if (page == nullptr)
+        continue;
+      ckpt.write<uint64_t>((dir_index << LEAF_BITS) | i);
+      ckpt.write(page, page_size_);
+    }
+  };
+  for (uint64_t i = 0; i < dir_.size(); ++i) {
+    save_leaf(i, dir_[i]);
+  }
+  for (auto& entry : far_dir_) {
+    save_leaf(entry.first, entry.second);
+  }
+}
+
+void RAM::restore(CheckpointReader& ckpt) {
+  ckpt.section("RAM");
+  ckpt.check<uint64_t>(page_size_, "memory page size");
+  auto num_pages = ckpt.read<uint64_t>();
+  this->clear();
+  for (uint64_t i = 0; i < num_pages; ++i) {
+    auto page_index = ckpt.read<uint64_t>();
+    ckpt.read(this->map_page(page_index, false), page_size_);
+  }
+}
+
 void RAM::loadBinImage(const char* filename, uint64_t destination) {
-  std::ifstream ifs(filename);
-  if (!ifs) {
+  MappedFile file;
+  if (file.open(filename) != 0) {
     std::cerr << "Error: " << filename << " not found" << std::endl;
     std::abort();
   }
 
-  ifs.seekg(0, ifs.end);
-  size_t size = ifs.tellg();
-  std::vector<uint8_t> content(size);
-  ifs.seekg(0, ifs.beg);
-  ifs.read((char*)content.data(), size);
-
   this->clear();
-  this->write(content.data(), destination, size);
-}
 
-void RAM::loadHexImage(const char* filename) {
-  auto hti = [&](char c)->uint32_t {
-    if (c >= 'A' && c <= 'F')
-      return c - 'A' + 10;
-    if (c >= 'a' && c <= 'f')
-      return c - 'a' + 10;
-    return c - '0';
+  if (!file.is_compressed()) {
+    this->write(file.data(), destination, file.size());
+    return;
+  }
+
+#ifdef VX_ZSTD_ENABLE
+  // decompress straight into the RAM pages
+  auto window = [&](uint64_t offset, uint8_t** ptr)->uint64_t {
+    uint64_t addr = destination + offset;
+    uint64_t page_offset = addr & (page_size_ - 1);
+    this->check_range(addr, 1);
+    *ptr = this->map_page(addr >> page_bits_, page_offset != 0) + page_offset;
+    return page_size_ - page_offset;
   };
+  auto commit = [&](uint64_t, uint64_t) {};
+  auto size = zstd_decompress(file.data(), file.size(), window, commit);
+  if (size < 0) {
+    std::cerr << "Error: " << filename << " is not a valid zstd image" << std::endl;
+    std::abort();
+  }
+  // pages were mapped uninitialized, fill the tail of the last one
+  uint64_t end = destination + size;
+  uint64_t tail = end & (page_size_ - 1);
+  if (tail != 0) {
+    fill_uninit(this->map_page(end >> page_bits_, false) + tail, end, page_size_ - tail);
+  }
+#else
+  std::cerr << "Error: " << filename << " is compressed, zstd support is not enabled (build with ZSTD=1)" << std::endl;
+  std::abort();
+#endif
+}
 
-  auto hToI = [&](const char *c, uint32_t size)->uint32_t {
+void RAM::loadHexImage(const char* filename) {
+  static const auto hex_table = []() {
+    std::array<uint8_t, 256> table{};
+    for (int c = '0'; c <= '9'; ++c) table[c] = c - '0';
+    for (int c = 'a'; c <= 'f'; ++c) table[c] = c - 'a' + 10;
+    for (int c = 'A'; c <= 'F'; ++c) table[c] = c - 'A' + 10;
+    return table;
+  }();
+
+  auto hToI = [&](const uint8_t *c, uint32_t size)->uint32_t {
     uint32_t value = 0;
     for (uint32_t i = 0; i < size; i++) {
-      value += hti(c[i]) << ((size - i - 1) * 4);
+      value = (value << 4) | hex_table[c[i]];
     }
     return value;
   };
 
-  std::ifstream ifs(filename);
-  if (!ifs) {
+  MappedFile file;
+  if (file.open(filename) != 0) {
     std::cerr << "Error: " << filename << " not found" << std::endl;
     std::abort();
   }
 
-  ifs.seekg(0, ifs.end);
-  size_t size = ifs.tellg();
-  std::vector<char> content(size);
-  ifs.seekg(0, ifs.beg);
-  ifs.read(content.data(), size);
-
+  auto line = file.data();
+  auto end = line + file.size();
   uint32_t offset = 0;
-  char *line = content.data();
+  uint8_t record[256];
 
   this->clear();
 
-  while (true) {
-    if (line[0] == ':') {
+  while (line < end) {
+    auto eol = (const uint8_t*)std::memchr(line, '\n', end - line);
+    if (eol == nullptr) {
+      eol = end;
+    }
+    if (line[0] == ':' && (eol - line) >= 11) {
       uint32_t byteCount = hToI(line + 1, 2);
       uint32_t nextAddr = hToI(line + 3, 4) + offset;
       uint32_t key = hToI(line + 7, 2);
       switch (key) {
       case 0:
+        if ((eol - line) < 9 + byteCount * 2) {
+          std::cerr << "Error: " << filename << " has a truncated record" << std::endl;
+          std::abort();
+        }
         for (uint32_t i = 0; i < byteCount; i++) {
-          uint32_t addr  = nextAddr + i;
-          uint32_t value = hToI(line + 9 + i * 2, 2);
-          *this->get(addr) = value;
+          record[i] = (hex_table[line[9 + i * 2]] << 4) | hex_table[line[10 + i * 2]];
         }
+        this->write(record, nextAddr, byteCount);
         break;
       case 2:
         offset = hToI(line + 9, 4) << 4;
@@ -580,14 +723,7 @@ void RAM::loadHexImage(const char* filename) {
         break;
       }
     }
-    while (*line != '\n' && size != 0) {
-      ++line;
-      --size;
-    }
-    if (size <= 1)
-      break;
-    ++line;
-    --size;
+    line = eol + 1;
   }
 }
 
@@ -660,23 +796,21 @@ uint64_t MemoryUnit::vAddr_to_pAddr(uint64_t vAddr, ACCESS_TYPE type)
     std::pair<bool, uint64_t> tlb_access = tlbLookup(vAddr, type,  &size_bits);
     if (tlb_access.first)
     {
-
         pfn = tlb_access.second;
-        TLB_HIT++;
+        ++perf_stats_.tlb_hits;
     }
     else //Else walk the PT.
     {
         std::pair<uint64_t, uint8_t> ptw_access = page_table_walk(vAddr, type, &size_bits);
-        tlbAdd(vAddr>>size_bits, ptw_access.first, ptw_access.second,size_bits);
-        pfn = ptw_access.first; TLB_MISS++; PTW++;
-        unique_translations.insert(vAddr>>size_bits);
-        PERF_UNIQUE_PTW = unique_translations.size();
-
+        pfn = ptw_access.first;
+        tlbAdd(vAddr, pfn << size_bits, ptw_access.second, size_bits);
+        ++perf_stats_.tlb_misses;
     }
 
     //Construct final address using pfn and offset.
-    DBGPRINT("  [MMU: V2P] translated vAddr: 0x%lx to pAddr 0x%lx\n",vAddr,((pfn << size_bits) + (vAddr & ((1 << size_bits) - 1))));
-    return (pfn << size_bits) + (vAddr & ((1 << size_bits) - 1));
+    uint64_t pAddr = (pfn << size_bits) + (vAddr & ((uint64_t(1) << size_bits) - 1));
+    DBGPRINT("  [MMU: V2P] translated vAddr: 0x%lx to pAddr 0x%lx\n", vAddr, pAddr);
+    return pAddr;
 }
 
 uint64_t MemoryUnit::get_pte_address(uint64_t base_ppn, uint64_t vpn)
@@ -693,14 +827,36 @@ std::pair<uint64_t, uint8_t> MemoryUnit::page_table_walk(uint64_t vAddr_bits, AC
   uint32_t flags =0;
   uint64_t pte_addr = 0, pte_bytes = 0;
   uint64_t cur_base_ppn = get_base_ppn();
-  // Need to fix for super page
-  *size_bits = 12;
+
+  // virtual page number bits translated above a given level
+  auto vpn_prefix = [&](int lvl) {
+    uint64_t prefix = 0;
+    for (int j = level-1; j > lvl; --j) {
+      prefix = (prefix << 16) | vaddr.vpn[j];
+    }
+    return prefix;
+  };
+
+  // Resume from the deepest cached non-leaf entry.
+  for (int j = 0; j < i; ++j) {
+    uint64_t base_ppn;
+    if (pwc_.lookup(j, vpn_prefix(j), &base_ppn)) {
+      DBGPRINT("  [MMU:PTW] PWC hit: level=%d, base_ppn=0x%lx\n", j, base_ppn);
+      ++perf_stats_.pwc_hits;
+      cur_base_ppn = base_ppn;
+      i = j;
+      break;
+    }
+  }
 
   while (true)
   {
     // Read PTE.
     pte_addr = get_pte_address(cur_base_ppn, vaddr.vpn[i]);
     decoder_.read(&pte_bytes, pte_addr, PTE_SIZE);
+    ++perf_stats_.walk_reads;
+    perf_stats_.walk_latency += PTW_MEM_LATENCY;
+    latency_ += PTW_MEM_LATENCY;
     PTE_t pte(pte_bytes);
     DBGPRINT("  [MMU:PTW] Level[%u] pte_addr=0x%lx, pte_bytes =0x%lx, pte.ppn= 0x%lx, pte.flags = %u)\n", i, pte_addr, pte_bytes, pte.ppn, pte.flags);
 
@@ -726,6 +882,7 @@ std::pair<uint64_t, uint8_t> MemoryUnit::page_table_walk(uint64_t vAddr_bits, AC
       {
         // Continue on to next level.
         cur_base_ppn= pte.ppn;
+        pwc_.insert(i, vpn_prefix(i), cur_base_ppn);
         DBGPRINT("  [MMU:PTW] next base_ppn: 0x%lx\n", cur_base_ppn);
         continue;
       }
@@ -749,7 +906,15 @@ std::pair<uint64_t, uint8_t> MemoryUnit::page_table_walk(uint64_t vAddr_bits, AC
         assert(0);
         throw Page_Fault_Exception("  [MMU:PTW] Page Fault : TYPE STORE, Incorrect permissions.");
       }
-      cur_base_ppn = pte.ppn;
+      // A leaf above level 0 maps a superpage, its ppn must be aligned.
+      *size_bits = vm_page_log2_size(i);
+      uint64_t ppn_shift = *size_bits - MEM_PAGE_LOG2_SIZE;
+      if (pte.ppn & ((uint64_t(1) << ppn_shift) - 1))
+      {
+        assert(0);
+        throw Page_Fault_Exception("  [MMU:PTW] Page Fault : Misaligned superpage.");
+      }
+      cur_base_ppn = pte.ppn >> ppn_shift;
       flags = pte.flags;
       break;
     }
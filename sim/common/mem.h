@@ -25,11 +25,14 @@
 #include <unordered_set>
 #include <stdexcept>
 #include <cassert>
+#include "tlb.h"
 #endif
 
 
 namespace vortex {
 
+class CheckpointWriter;
+class CheckpointReader;
 
 #ifdef VM_ENABLE
 
@@ -43,6 +46,16 @@ enum ACCESS_TYPE {
   STORE,
   FETCH
 };
+
+// log2 size of the pages mapped by a leaf entry at a given page table level,
+// level 0 maps base pages and upper levels map superpages.
+inline uint32_t vm_page_log2_size(uint32_t level) {
+#if VM_ADDR_MODE == SV39
+  return MEM_PAGE_LOG2_SIZE + level * 9;
+#else
+  return MEM_PAGE_LOG2_SIZE + level * 10;
+#endif
+}
 class SATP_t
 {
   private:
@@ -194,6 +207,26 @@ public:
   };
 
 #ifdef VM_ENABLE
+  struct PerfStats {
+    uint64_t tlb_hits;
+    uint64_t tlb_l2_hits;
+    uint64_t tlb_misses;
+    uint64_t tlb_evictions;
+    uint64_t pwc_hits;
+    uint64_t walk_reads;
+    uint64_t walk_latency;
+
+    PerfStats()
+      : tlb_hits(0)
+      , tlb_l2_hits(0)
+      , tlb_misses(0)
+      , tlb_evictions(0)
+      , pwc_hits(0)
+      , walk_reads(0)
+      , walk_latency(0)
+    {}
+  };
+
   MemoryUnit(uint64_t pageSize = MEM_PAGE_SIZE);
   ~MemoryUnit(){
     if ( this->satp_ != NULL)
@@ -219,6 +252,27 @@ public:
 
 #ifdef VM_ENABLE
   void tlbAdd(uint64_t virt, uint64_t phys, uint32_t flags, uint64_t size_bits);
+
+  // translate an address, accounting for the translation latency
+  uint64_t translate(uint64_t vAddr, ACCESS_TYPE type) {
+    return this->vAddr_to_pAddr(vAddr, type);
+  }
+
+  // return and clear the latency of the translations done since the last call
+  uint32_t take_latency() {
+    auto latency = latency_;
+    latency_ = 0;
+    return latency;
+  }
+
+  const PerfStats& perf_stats() const {
+    return perf_stats_;
+  }
+
+  void reset_stats() {
+    perf_stats_ = PerfStats();
+  }
+
   uint8_t is_satp_unset();
   uint64_t get_satp();
   uint8_t get_mode();
@@ -229,9 +283,17 @@ public:
 #endif
 
   void tlbRm(uint64_t vaddr);
+#ifdef VM_ENABLE
+  void tlbFlush() {
+    l1_tlb_.flush();
+    l2_tlb_.flush();
+    pwc_.flush();
+  }
+#else
   void tlbFlush() {
     tlb_.clear();
   }
+#endif
 
 private:
 
@@ -267,43 +329,17 @@ private:
     std::vector<entry_t> entries_;
   };
 
+#ifndef VM_ENABLE
   struct TLBEntry {
     TLBEntry() {}
-  #ifdef VM_ENABLE
-    TLBEntry(uint32_t pfn, uint32_t flags, uint64_t size_bits)
-      : pfn(pfn)
-      , flags(flags)
-      , mru_bit(true)
-      , size_bits (size_bits)
-    {
-      d = bit(7);
-      a = bit(6);
-      g = bit(5);
-      u = bit(4);
-      x = bit(3);
-      w = bit(2);
-      r = bit(1);
-      v = bit(0);
-    }
-    bool bit(uint8_t idx)
-    {
-        return (flags) & (1 << idx);
-    }
-
-    uint32_t pfn;
-    uint32_t flags;
-    bool mru_bit;
-    uint64_t size_bits;
-    bool d, a, g, u, x, w, r, v;
-  #else
     TLBEntry(uint32_t pfn, uint32_t flags)
       : pfn(pfn)
       , flags(flags)
     {}
     uint32_t pfn;
     uint32_t flags;
-  #endif
   };
+#endif
 
 #ifdef VM_ENABLE
   std::pair<bool, uint64_t> tlbLookup(uint64_t vAddr, ACCESS_TYPE type, uint64_t* size_bits);
@@ -320,7 +356,9 @@ private:
 
 
 
+#ifndef VM_ENABLE
   std::unordered_map<uint64_t, TLBEntry> tlb_;
+#endif
   uint64_t  pageSize_;
   ADecoder  decoder_;
 #ifndef VM_ENABLE
@@ -329,8 +367,11 @@ private:
 
   amo_reservation_t amo_reservation_;
 #ifdef VM_ENABLE
-  std::unordered_set<uint64_t> unique_translations;
-  uint64_t TLB_HIT, TLB_MISS, TLB_EVICT, PTW, PERF_UNIQUE_PTW;
+  TLB l1_tlb_;
+  TLB l2_tlb_;
+  PageWalkCache pwc_;
+  PerfStats perf_stats_;
+  uint32_t latency_;
   SATP_t *satp_;
 #endif
 
@@ -371,9 +412,16 @@ public:
   void read(void* data, uint64_t addr, uint64_t size) override;
   void write(const void* data, uint64_t addr, uint64_t size) override;
 
+  // read without side effects, safe to call concurrently with other peeks
+  void peek(void* data, uint64_t addr, uint64_t size) const;
+
   void loadBinImage(const char* filename, uint64_t destination);
   void loadHexImage(const char* filename);
 
+  // save or restore the content of all mapped pages
+  void save(CheckpointWriter& ckpt) const;
+  void restore(CheckpointReader& ckpt);
+
   uint8_t& operator[](uint64_t address) {
     return *this->get(address);
   }
@@ -390,11 +438,66 @@ public:
 
 private:
 
+  // pages are indexed through a two-level radix table: a flat directory of
+  // leaf tables, each mapping LEAF_BITS of the page index to page storage.
+  // Directory entries beyond MAX_DIR_SIZE (sparse high addresses) are hashed.
+  static constexpr uint32_t LEAF_BITS    = 10;
+  static constexpr uint32_t LEAF_SIZE    = 1 << LEAF_BITS;
+  static constexpr uint64_t MAX_DIR_SIZE = 1 << 16;
+  static constexpr uint64_t CHUNK_SIZE   = 2 * 1024 * 1024;
+
+  struct leaf_t {
+    uint8_t* pages[LEAF_SIZE];
+  };
+
+  // returns the page storage or nullptr if the page is not mapped
+  uint8_t* lookup(uint64_t page_index) const {
+    auto dir_index = page_index >> LEAF_BITS;
+    leaf_t* leaf;
+    if (dir_index < dir_.size()) {
+      leaf = dir_[dir_index];
+    } else {
+      auto it = far_dir_.find(dir_index);
+      leaf = (it != far_dir_.end()) ? it->second : nullptr;
+    }
+    return leaf ? leaf->pages[page_index & (LEAF_SIZE - 1)] : nullptr;
+  }
+
+  // returns the page storage, mapping it if needed (fill=false skips the
+  // uninitialized pattern when the caller overwrites the whole page)
+  uint8_t* map_page(uint64_t page_index, bool fill) const {
+    if (page_index == last_page_index_ && last_page_)
+      return last_page_;
+    auto page = this->lookup(page_index);
+    if (page == nullptr) {
+      page = this->alloc_page(page_index, fill);
+    }
+    last_page_ = page;
+    last_page_index_ = page_index;
+    return page;
+  }
+
+  uint8_t* alloc_page(uint64_t page_index, bool fill) const;
+
+  void read_pages(uint8_t* data, uint64_t addr, uint64_t size) const;
+
+  void check_range(uint64_t addr, uint64_t size) const {
+    if (capacity_ != 0 && (addr >= capacity_ || size > capacity_ - addr)) {
+      throw OutOfRange();
+    }
+  }
+
   uint8_t *get(uint64_t address) const;
 
   uint64_t capacity_;
   uint32_t page_bits_;
-  mutable std::unordered_map<uint64_t, uint8_t*> pages_;
+  uint64_t page_size_;
+  mutable std::vector<leaf_t*> dir_;
+  mutable std::unordered_map<uint64_t, leaf_t*> far_dir_;
+  mutable std::vector<std::pair<uint8_t*, uint64_t>> chunks_;
+  mutable uint8_t* chunk_ptr_;
+  mutable uint64_t chunk_avail_;
+  mutable uint64_t num_pages_;
   mutable uint8_t* last_page_;
   mutable uint64_t last_page_index_;
   ACLManager acl_mngr_;
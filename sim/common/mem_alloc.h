@@ -95,8 +95,8 @@ public:
     auto newPage = this->createPage(addr, size);
 
     // allocate space on free block
-    auto freeBlock = newPage->findFreeBlock(size);
-    newPage->allocate(size, freeBlock);
+    auto freeBlock = newPage->findFreeBlock(size, blockAlign_);
+    newPage->allocate(size, blockAlign_, freeBlock);
 
     // Update allocated size
     allocated_ += size;
@@ -105,6 +105,11 @@ public:
   }
 
   int allocate(uint64_t size, uint64_t* addr) {
+    return this->allocate(size, blockAlign_, addr);
+  }
+
+  // allocate a block starting at a multiple of the given alignment
+  int allocate(uint64_t size, uint64_t alignment, uint64_t* addr) {
     if (size == 0 || addr == nullptr) {
       printf("Error: invalid arguments\n");
       return -1;
@@ -112,12 +117,15 @@ public:
 
     // Align allocation size
     size = alignSize(size, blockAlign_);
+    if (alignment < blockAlign_) {
+      alignment = blockAlign_;
+    }
 
     // Walk thru all pages to find a free block
     block_t* freeBlock = nullptr;
     auto currPage = pages_;
     while (currPage) {
-      freeBlock = currPage->findFreeBlock(size);
+      freeBlock = currPage->findFreeBlock(size, alignment);
       if (freeBlock != nullptr)
         break;
       currPage = currPage->next;
@@ -127,7 +135,7 @@ public:
     if (freeBlock == nullptr) {
       auto pageSize = alignSize(size, pageAlign_);
       uint64_t pageAddr;
-      if (!this->findNextAddress(pageSize, &pageAddr)) {
+      if (!this->findNextAddress(pageSize, alignment, &pageAddr)) {
         printf("Error: out of memory (Can't find next address)\n");
         return -1;
       }
@@ -136,11 +144,11 @@ public:
         printf("Error: out of memory (Can't create a page)\n");
         return -1;
       }
-      freeBlock = currPage->findFreeBlock(size);
+      freeBlock = currPage->findFreeBlock(size, alignment);
     }
 
     // allocate space on free block
-    currPage->allocate(size, freeBlock);
+    freeBlock = currPage->allocate(size, alignment, freeBlock);
 
     // Return the free block address
     *addr = freeBlock->addr;
@@ -238,11 +246,21 @@ private:
       return (usedList_ == nullptr);
     }
 
-    void allocate(uint64_t size, block_t* freeBlock) {
+    block_t* allocate(uint64_t size, uint64_t alignment, block_t* freeBlock) {
       // Remove the block from the free lists
       this->removeFreeMList(freeBlock);
       this->removeFreeSList(freeBlock);
 
+      // Split off the unaligned head of the free block
+      uint64_t headBytes = alignSize(freeBlock->addr, alignment) - freeBlock->addr;
+      if (headBytes != 0) {
+        auto headBlock = new block_t(freeBlock->addr, headBytes);
+        freeBlock->addr += headBytes;
+        freeBlock->size -= headBytes;
+        this->insertFreeMList(headBlock);
+        this->insertFreeSList(headBlock);
+      }
+
       // If the free block we have found is larger than what we are looking for,
       // we may be able to split our free block in two.
       uint64_t extraBytes = freeBlock->size - size;
@@ -261,6 +279,7 @@ private:
 
       // Insert the free block into the used list
       this->insertUsedList(freeBlock);
+      return freeBlock;
     }
 
     void release(block_t* usedBlock) {
@@ -317,21 +336,19 @@ private:
       this->insertFreeSList(usedBlock);
     }
 
-    block_t* findFreeBlock(uint64_t size) {
-      auto freeBlock = freeSList_;
-      if (freeBlock) {
-        // The free S-list is already sorted with the largest block first
-        // Quick check if the head block has enough space.
-        if (freeBlock->size >= size) {
-          // Find the smallest matching block in the S-list
-          while (freeBlock->nextFreeS && (freeBlock->nextFreeS->size >= size)) {
-            freeBlock = freeBlock->nextFreeS;
-          }
-          // Return the free block
-          return freeBlock;
+    block_t* findFreeBlock(uint64_t size, uint64_t alignment) {
+      // The free S-list is already sorted with the largest block first,
+      // find the smallest block with enough space past its aligned start.
+      block_t* found = nullptr;
+      for (auto freeBlock = freeSList_;
+           freeBlock && (freeBlock->size >= size);
+           freeBlock = freeBlock->nextFreeS) {
+        uint64_t headBytes = alignSize(freeBlock->addr, alignment) - freeBlock->addr;
+        if (freeBlock->size >= size + headBytes) {
+          found = freeBlock;
         }
       }
-      return nullptr;
+      return found;
     }
 
     block_t* findUsedBlock(uint64_t addr) {
@@ -493,14 +510,9 @@ private:
     delete page;
   }
 
-  bool findNextAddress(uint64_t size, uint64_t* addr) {
-    if (pages_ == nullptr) {
-      *addr = baseAddress_;
-      return true;
-    }
-
+  bool findNextAddress(uint64_t size, uint64_t alignment, uint64_t* addr) {
     page_t* current = pages_;
-    uint64_t endOfLastPage = baseAddress_;
+    uint64_t endOfLastPage = alignSize(baseAddress_, alignment);
 
     while (current != nullptr) {
       uint64_t startOfCurrentPage = current->addr;
@@ -510,7 +522,7 @@ private:
       }
       // Update the end of the last page to the end of the current page
       // Move to the next page in the sorted list
-      endOfLastPage = current->addr + current->size;
+      endOfLastPage = alignSize(current->addr + current->size, alignment);
       current = current->next;
     }
 
@@ -14,59 +14,227 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
+#include <vector>
+#include <ostream>
+#include <typeinfo>
+#include <cxxabi.h>
 #include <cassert>
+#include <cstdlib>
+#include <algorithm>
 
 namespace vortex {
 
-// Memory pool for fixed-size objects with fallback to new/delete
-template<typename T, size_t PoolSize = 64>
-class MemoryPool {
+// Registry of the live pools, used to report their statistics
+class MemoryPoolBase {
 public:
-  MemoryPool() {
-    // Allocate raw memory without constructing objects
-    pool_ = static_cast<char*>(aligned_alloc(alignof(T), sizeof(T) * PoolSize));
-    // Initialize free list using pointer arithmetic
-    for (size_t i = 0; i < PoolSize; ++i) {
-      *reinterpret_cast<void**>(pool_ + i * sizeof(T)) =
-        (i < PoolSize - 1) ? pool_ + (i + 1) * sizeof(T) : nullptr;
+  MemoryPoolBase() {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    registry().push_back(this);
+  }
+
+  virtual ~MemoryPoolBase() {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    auto& pools = registry();
+    for (auto it = pools.begin(); it != pools.end(); ++it) {
+      if (*it == this) {
+        pools.erase(it);
+        break;
+      }
+    }
+  }
+
+  virtual void dump_stats(std::ostream& os) const = 0;
+
+  static void dump_all(std::ostream& os) {
+    std::lock_guard<std::mutex> lock(registry_mutex());
+    for (auto pool : registry()) {
+      pool->dump_stats(os);
     }
-    free_list_ = pool_;
   }
 
-  ~MemoryPool() noexcept {
-    free(pool_);
+private:
+  static std::vector<MemoryPoolBase*>& registry() {
+    static std::vector<MemoryPoolBase*> pools;
+    return pools;
+  }
+
+  static std::mutex& registry_mutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+};
+
+// print the statistics of all memory pools
+inline void mempool_dump_stats(std::ostream& os) {
+  MemoryPoolBase::dump_all(os);
+}
+
+// Growable slab allocator for fixed-size objects, one instance per type.
+// Each thread allocates from and frees to its own free list without locking.
+// Free lists exchange objects with the shared pool in batches of one chunk:
+// a thread refills an empty list with a batch, and returns a batch when its
+// list holds two, so objects freed by another thread get reused. A new chunk
+// is allocated only when the shared pool is empty. Pools are never destroyed,
+// since pooled objects may still be released during static destruction.
+template <typename T>
+class MemoryPool : public MemoryPoolBase {
+public:
+  static MemoryPool& instance() {
+    static auto pool = new MemoryPool();
+    return *pool;
   }
 
   T* allocate() {
-    if (free_list_) {
-      void* block = free_list_;
-      free_list_ = *reinterpret_cast<void**>(block);
-      return static_cast<T*>(block);
+    auto& cache = local_cache;
+    if (cache.head == nullptr) {
+      this->refill(cache);
     }
-    return static_cast<T*>(::operator new(sizeof(T)));
+    auto node = cache.head;
+    cache.head = node->next;
+    --cache.size;
+    ++cache.allocs;
+    return reinterpret_cast<T*>(node);
   }
 
   void deallocate(T* ptr) noexcept {
-    if (belongs_to_pool(ptr)) {
-      *reinterpret_cast<void**>(ptr) = free_list_;
-      free_list_ = ptr;
-    } else {
-      ::operator delete(ptr);
+    auto& cache = local_cache;
+    if (cache.head == nullptr) {
+      register_thread();
+    }
+    auto node = reinterpret_cast<node_t*>(ptr);
+    node->next = cache.head;
+    cache.head = node;
+    if (++cache.size >= 2 * batch_size) {
+      this->drain(cache);
     }
   }
 
+  // number of objects allocated from the system
+  uint64_t capacity() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return uint64_t(chunks_.size()) * batch_size;
+  }
+
+  void dump_stats(std::ostream& os) const override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& cache = local_cache;
+    uint64_t allocs = allocs_ + cache.allocs;
+    uint64_t capacity = uint64_t(chunks_.size()) * batch_size;
+    uint64_t free = uint64_t(batches_.size()) * batch_size + loose_size_ + cache.size;
+    int status;
+    char* name = abi::__cxa_demangle(typeid(T).name(), nullptr, nullptr, &status);
+    os << "PERF: mempool " << (status == 0 ? name : typeid(T).name())
+       << ": size=" << slot_size
+       << ", chunks=" << chunks_.size()
+       << ", capacity=" << capacity
+       << ", in_use=" << (capacity - free)
+       << ", allocs=" << allocs << std::endl;
+    std::free(name);
+  }
+
 private:
-  char* pool_ = nullptr;
-  void* free_list_ = nullptr;
+  struct node_t {
+    node_t* next;
+  };
+
+  static constexpr size_t slot_align = std::max(alignof(T), alignof(node_t));
+  static constexpr size_t slot_size = (std::max(sizeof(T), sizeof(node_t)) + slot_align - 1) / slot_align * slot_align;
+  // objects per chunk, sized for chunks of about 64 KB
+  static constexpr uint32_t batch_size = std::max<size_t>(64, 65536 / slot_size);
 
-  bool belongs_to_pool(T* ptr) const noexcept {
-    return ptr >= reinterpret_cast<T*>(pool_) &&
-           ptr < reinterpret_cast<T*>(pool_ + sizeof(T) * PoolSize);
+  // per-thread free list, trivially destructible so that it remains
+  // usable until the thread terminates
+  struct cache_t {
+    node_t*  head = nullptr;
+    uint32_t size = 0;
+    uint64_t allocs = 0;
+  };
+
+  // returns the thread free list to the shared pool on thread exit
+  struct guard_t {
+    void touch() {}
+    ~guard_t() {
+      MemoryPool::instance().release(local_cache);
+    }
+  };
+
+  static inline thread_local cache_t local_cache;
+
+  static void register_thread() {
+    static thread_local guard_t guard;
+    guard.touch();
+  }
+
+  mutable std::mutex mutex_;
+  std::vector<char*> chunks_;
+  std::vector<node_t*> batches_; // free lists of batch_size objects
+  node_t*  loose_ = nullptr;     // objects left by terminated threads
+  uint32_t loose_size_ = 0;
+  uint64_t allocs_ = 0;
+
+  MemoryPool() = default;
+
+  void refill(cache_t& cache) {
+    register_thread();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!batches_.empty()) {
+      cache.head = batches_.back();
+      cache.size = batch_size;
+      batches_.pop_back();
+    } else if (loose_ != nullptr) {
+      cache.head = loose_;
+      cache.size = loose_size_;
+      loose_ = nullptr;
+      loose_size_ = 0;
+    } else {
+      auto chunk = static_cast<char*>(aligned_alloc(slot_align, slot_size * batch_size));
+      if (chunk == nullptr)
+        throw std::bad_alloc();
+      for (uint32_t i = 0; i < batch_size; ++i) {
+        reinterpret_cast<node_t*>(chunk + i * slot_size)->next =
+          (i + 1 < batch_size) ? reinterpret_cast<node_t*>(chunk + (i + 1) * slot_size) : nullptr;
+      }
+      chunks_.push_back(chunk);
+      cache.head = reinterpret_cast<node_t*>(chunk);
+      cache.size = batch_size;
+    }
+  }
+
+  // move one batch from the thread free list to the shared pool
+  void drain(cache_t& cache) {
+    auto batch = cache.head;
+    auto tail = batch;
+    for (uint32_t i = 1; i < batch_size; ++i) {
+      tail = tail->next;
+    }
+    cache.head = tail->next;
+    cache.size -= batch_size;
+    tail->next = nullptr;
+    std::lock_guard<std::mutex> lock(mutex_);
+    batches_.push_back(batch);
+  }
+
+  void release(cache_t& cache) {
+    while (cache.size >= batch_size) {
+      this->drain(cache);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (cache.head != nullptr) {
+      auto node = cache.head;
+      cache.head = node->next;
+      node->next = loose_;
+      loose_ = node;
+      ++loose_size_;
+    }
+    cache.size = 0;
+    allocs_ += cache.allocs;
+    cache.allocs = 0;
   }
 };
 
-// Custom allocator using the memory pool with fallback
-template <typename T, size_t PoolSize = 64>
+// Custom allocator using the per-type memory pool
+template <typename T>
 class PoolAllocator {
 public:
   using value_type = T;
@@ -74,43 +242,35 @@ public:
   PoolAllocator() = default;
 
   template <typename U>
-  PoolAllocator(const PoolAllocator<U, PoolSize>&) noexcept {}
+  PoolAllocator(const PoolAllocator<U>&) noexcept {}
 
   T* allocate(std::size_t n) {
     if (n != 1) throw std::bad_alloc();
-    return get_pool().allocate();
+    return MemoryPool<T>::instance().allocate();
   }
 
   void deallocate(T* p, std::size_t n) noexcept {
-    if (n == 1) get_pool().deallocate(p);
+    if (n == 1) MemoryPool<T>::instance().deallocate(p);
   }
 
   template<typename U>
   struct rebind {
-    using other = PoolAllocator<U, PoolSize>;
+    using other = PoolAllocator<U>;
   };
 
   using propagate_on_container_move_assignment = std::true_type;
   using is_always_equal = std::true_type;
-
-private:
-  template<typename, size_t> friend class PoolAllocator;
-
-  static MemoryPool<T, PoolSize>& get_pool() {
-    static MemoryPool<T, PoolSize> pool;
-    return pool;
-  }
 };
 
 // Comparisons required by STL containers
-template<typename T1, typename T2, size_t N>
-bool operator==(const PoolAllocator<T1, N>&, const PoolAllocator<T2, N>&) noexcept {
+template<typename T1, typename T2>
+bool operator==(const PoolAllocator<T1>&, const PoolAllocator<T2>&) noexcept {
   return true;
 }
 
-template<typename T1, typename T2, size_t N>
-bool operator!=(const PoolAllocator<T1, N>&, const PoolAllocator<T2, N>&) noexcept {
+template<typename T1, typename T2>
+bool operator!=(const PoolAllocator<T1>&, const PoolAllocator<T2>&) noexcept {
   return false;
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,217 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+namespace vortex {
+
+// Binary pipeline trace.
+// Each pipeline event is a fixed-size record; records are collected in
+// per-core blocks so that cores ticked on different host threads never
+// contend, and full blocks are written out by a background thread.
+//
+// File layout:
+//   header  : pipe_trace_hdr_t
+//   blocks  : pipe_trace_blk_t followed by <count> pipe_trace_rec_t
+// Records within a block are in time order; blocks of different cores
+// interleave in completion order.
+
+enum class PipeStage : uint8_t {
+  Schedule,
+  IBuffer,
+  Dispatch,
+  Commit,
+  Count
+};
+
+enum class PipeUnit : uint8_t {
+  None,
+  ALU,
+  LSU,
+  SFU,
+  FPU,
+  TCU,
+  VPU,
+  Count
+};
+
+struct pipe_trace_hdr_t {
+  char     magic[4];        // "VXPT"
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t ticks_per_cycle; // timestamp units per clock cycle
+};
+
+struct pipe_trace_blk_t {
+  uint32_t core_id;
+  uint32_t count;
+};
+
+struct pipe_trace_rec_t {
+  uint64_t timestamp;
+  uint64_t uuid;
+  uint64_t PC;
+  uint64_t tmask;
+  uint32_t core_id;
+  uint16_t wid;
+  PipeStage stage;
+  PipeUnit unit;
+};
+
+static_assert(sizeof(pipe_trace_rec_t) == 40, "invalid pipe trace record size");
+
+class PipeTraceWriter {
+public:
+  static constexpr uint32_t VERSION    = 1;
+  static constexpr uint32_t BLOCK_SIZE = 4096; // records per block
+  static constexpr uint32_t MAX_QUEUED = 64;   // blocks waiting to be written
+
+  PipeTraceWriter() : file_(nullptr), stop_(false) {}
+
+  ~PipeTraceWriter() {
+    this->close();
+  }
+
+  PipeTraceWriter(const PipeTraceWriter&) = delete;
+  PipeTraceWriter& operator=(const PipeTraceWriter&) = delete;
+
+  // returns 0 on success
+  int open(const char* filename, uint32_t num_cores, uint32_t ticks_per_cycle) {
+    this->close();
+    file_ = fopen(filename, "wb");
+    if (file_ == nullptr)
+      return -1;
+    pipe_trace_hdr_t hdr{{'V', 'X', 'P', 'T'}, VERSION, sizeof(pipe_trace_rec_t), ticks_per_cycle};
+    fwrite(&hdr, sizeof(hdr), 1, file_);
+    blocks_.resize(num_cores);
+    for (uint32_t i = 0; i < num_cores; ++i) {
+      blocks_.at(i) = this->alloc_block(i);
+    }
+    stop_ = false;
+    thread_ = std::thread(&PipeTraceWriter::flush_thread, this);
+    return 0;
+  }
+
+  void close() {
+    if (file_ == nullptr)
+      return;
+    for (auto& block : blocks_) {
+      if (!block->recs.empty()) {
+        this->submit(std::move(block));
+      }
+    }
+    blocks_.clear();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+    fclose(file_);
+    file_ = nullptr;
+    free_.clear();
+  }
+
+  bool is_open() const {
+    return (file_ != nullptr);
+  }
+
+  // append a record; each core must be traced from a single host thread.
+  // Cores beyond <num_cores> are added on demand, which is only safe when
+  // all cores are traced from the same host thread.
+  void record(const pipe_trace_rec_t& rec) {
+    while (rec.core_id >= blocks_.size()) {
+      blocks_.push_back(this->alloc_block(blocks_.size()));
+    }
+    auto& block = blocks_.at(rec.core_id);
+    block->recs.push_back(rec);
+    if (block->recs.size() == BLOCK_SIZE) {
+      this->submit(std::move(block));
+      block = this->alloc_block(rec.core_id);
+    }
+  }
+
+private:
+
+  struct block_t {
+    uint32_t core_id;
+    std::vector<pipe_trace_rec_t> recs;
+  };
+
+  std::unique_ptr<block_t> alloc_block(uint32_t core_id) {
+    std::unique_ptr<block_t> block;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!free_.empty()) {
+        block = std::move(free_.back());
+        free_.pop_back();
+      }
+    }
+    if (!block) {
+      block.reset(new block_t());
+      block->recs.reserve(BLOCK_SIZE);
+    }
+    block->core_id = core_id;
+    return block;
+  }
+
+  void submit(std::unique_ptr<block_t> block) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // bound the memory footprint when the disk cannot keep up
+    cv_.wait(lock, [&]{ return queued_.size() < MAX_QUEUED; });
+    queued_.push_back(std::move(block));
+    lock.unlock();
+    cv_.notify_all();
+  }
+
+  void flush_thread() {
+    for (;;) {
+      std::unique_ptr<block_t> block;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&]{ return stop_ || !queued_.empty(); });
+        if (queued_.empty())
+          break;
+        block = std::move(queued_.front());
+        queued_.pop_front();
+      }
+      cv_.notify_all();
+      pipe_trace_blk_t blk{block->core_id, (uint32_t)block->recs.size()};
+      fwrite(&blk, sizeof(blk), 1, file_);
+      fwrite(block->recs.data(), sizeof(pipe_trace_rec_t), block->recs.size(), file_);
+      block->recs.clear();
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_.push_back(std::move(block));
+    }
+  }
+
+  FILE* file_;
+  std::vector<std::unique_ptr<block_t>> blocks_;
+  std::deque<std::unique_ptr<block_t>> queued_;
+  std::vector<std::unique_ptr<block_t>> free_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::thread thread_;
+  bool stop_;
+};
+
+}
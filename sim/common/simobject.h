@@ -13,17 +13,30 @@
 
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <vector>
 #include <list>
 #include <queue>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <type_traits>
+#include <exception>
 #include <assert.h>
 #include "mempool.h"
 #include "util.h"
 #include "linked_list.h"
 
+// number of cycles covered by the registered events timing wheel
+#ifndef SIM_EVENT_WHEEL_SIZE
+#define SIM_EVENT_WHEEL_SIZE 1024
+#endif
+
 namespace vortex {
 
 class SimObjectBase;
@@ -44,6 +57,16 @@ public:
     return source_;
   }
 
+  // object woken up when a packet is delivered to this port,
+  // the owning module unless the port is consumed by another object.
+  SimObjectBase* reader() const {
+    return reader_;
+  }
+
+  void set_reader(SimObjectBase* reader) {
+    reader_ = reader;
+  }
+
   virtual bool empty() const = 0;
 
   virtual bool full() const = 0;
@@ -58,6 +81,7 @@ protected:
     , capacity_(capacity)
     , sink_(nullptr)
     , source_(nullptr)
+    , reader_(module)
   {}
 
   virtual void do_pop() = 0;
@@ -68,6 +92,7 @@ protected:
   uint32_t       capacity_;
   SimPortBase*   sink_;
   SimPortBase*   source_;
+  SimObjectBase* reader_;
 
   LinkedListNode<SimPortBase> pop_list_;
   LinkedListNode<SimPortBase> push_list_;
@@ -156,7 +181,7 @@ public:
   const Pkt& front() const {
     __assert(sink_ == nullptr, "cannot be called on a stub port!")
     __assert(!this->empty(), "port is empty!");
-    return queue_.front();
+    return queue_.front().pkt;
   }
 
   Pkt& front() {
@@ -183,20 +208,7 @@ protected:
   TxCallback tx_cb_;
   TxCallback sink_transfer_;
 
-  void transfer(const Pkt& pkt, uint64_t cycles) {
-    if (tx_cb_) {
-      tx_cb_(pkt, cycles);
-    }
-    if (sink_) {
-      if (sink_transfer_) {
-        sink_transfer_(pkt, cycles);
-      } else {
-        reinterpret_cast<SimPort<Pkt>*>(sink_)->transfer(pkt, cycles);
-      }
-    } else {
-      queue_.push({pkt, cycles});
-    }
-  }
+  void transfer(const Pkt& pkt, uint64_t cycles);
 
   void do_pop() override {
     queue_.pop();
@@ -264,7 +276,7 @@ public:
 protected:
   Func func_;
   Pkt  pkt_;
-  static inline PoolAllocator<SimCallEvent<Pkt>, 64> allocator_;
+  static inline PoolAllocator<SimCallEvent<Pkt>> allocator_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -297,15 +309,18 @@ public:
 protected:
   const SimPort<Pkt>* port_;
   Pkt pkt_;
-  static inline PoolAllocator<SimPortEvent<Pkt>, 64> allocator_;
+  static inline PoolAllocator<SimPortEvent<Pkt>> allocator_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 class SimContext {
 private:
-  SimContext() {}
+  SimContext(uint32_t partition) : partition_(partition) {}
+
+  uint32_t partition_;
 
+  friend class SimObjectBase;
   friend class SimPlatform;
 };
 
@@ -321,18 +336,40 @@ public:
     return name_;
   }
 
+  // resume ticking a sleeping object after the given delay,
+  // used by objects whose state is updated outside of their ports.
+  void wakeup(uint64_t delay = 0);
+
 protected:
 
-  SimObjectBase(const SimContext&, const std::string& name) : name_(name) {}
+  SimObjectBase(const SimContext& ctx, const std::string& name)
+    : name_(name)
+    , partition_(ctx.partition_)
+    , index_(0)
+    , sleepable_(false)
+    , sleep_cycle_(0)
+  {}
 
 private:
 
   std::string name_;
+  uint32_t    partition_;
+  uint32_t    index_;
+  bool        sleepable_;
+  uint64_t    sleep_cycle_;
 
   virtual void do_reset() = 0;
 
   virtual void do_tick() = 0;
 
+  virtual bool do_idle() const = 0;
+
+  virtual void do_skip(uint64_t cycles) = 0;
+
+  virtual uint64_t do_run_ahead(uint64_t cycles) = 0;
+
+  virtual bool do_sleepable() const = 0;
+
   friend class SimPortBase;
   friend class SimPlatform;
 };
@@ -353,6 +390,23 @@ protected:
     : SimObjectBase(ctx, name)
   {}
 
+  // Idle-cycle hooks, shadowed by objects that support fast-forwarding.
+  // An object is idle when ticking it without new port inputs would only
+  // update its counters; skip() then applies those updates in bulk.
+  bool idle() const {
+    return false;
+  }
+
+  void skip(uint64_t cycles) {
+    __unused (cycles);
+  }
+
+  // objects with internal timing return how many of the upcoming cycles
+  // are free of activity, within the given bound.
+  uint64_t run_ahead(uint64_t cycles) {
+    return cycles;
+  }
+
 private:
 
   const Impl* impl() const {
@@ -370,6 +424,25 @@ private:
   void do_tick() override {
     this->impl()->tick();
   }
+
+  bool do_idle() const override {
+    return this->impl()->idle();
+  }
+
+  void do_skip(uint64_t cycles) override {
+    this->impl()->skip(cycles);
+  }
+
+  uint64_t do_run_ahead(uint64_t cycles) override {
+    return this->impl()->run_ahead(cycles);
+  }
+
+  // objects can sleep while idle if they report idleness,
+  // objects with internal timing are ticked every cycle.
+  bool do_sleepable() const override {
+    return !std::is_same_v<decltype(&Impl::idle), decltype(&SimObject::idle)>
+        && std::is_same_v<decltype(&Impl::run_ahead), decltype(&SimObject::run_ahead)>;
+  }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -392,8 +465,15 @@ public:
 
   template <typename Impl, typename... Args>
   typename SimObject<Impl>::Ptr create_object(Args&&... args) {
-    auto obj = std::make_shared<Impl>(SimContext{}, std::forward<Args>(args)...);
+    auto obj = std::make_shared<Impl>(SimContext(partition_), std::forward<Args>(args)...);
+    SimObjectBase* base = obj.get();
+    base->index_ = objects_.size();
+    base->sleepable_ = base->do_sleepable();
     objects_.push_back(obj);
+    if ((base->index_ % 64) == 0) {
+      active_.push_back(0);
+    }
+    active_.back() |= (uint64_t(1) << (base->index_ % 64));
     return obj;
   }
 
@@ -401,45 +481,170 @@ public:
   void schedule(const typename SimCallEvent<Pkt>::Func& callback,
                 const Pkt& pkt,
                 uint64_t delay) {
-    if (delay == 0) {
-      auto evt = new SimCallEvent<Pkt>(callback, pkt, delta_);
-      imm_events_.push_back(evt);
-      ++delta_;
-    } else {
-      auto evt = new SimCallEvent<Pkt>(callback, pkt, cycles_ + delay);
-      reg_events_.push_back(evt);
+    auto& part = this->current_partition();
+    auto evt = new SimCallEvent<Pkt>(callback, pkt, this->event_cycles(part, delay));
+    this->insert_event(part, evt, delay);
+  }
+
+  // assign objects created from now on to the given partition
+  void set_partition(uint32_t partition) {
+    partition_ = partition;
+  }
+
+  uint32_t partition() const {
+    return partition_;
+  }
+
+  // number of host threads used to tick partitions concurrently (0: serial mode)
+  void set_num_threads(uint32_t num_threads) {
+    assert(this->events_empty() && "pending events!");
+    this->wakeup_all();
+    this->stop_workers();
+    num_threads_ = num_threads;
+    this->map_partitions();
+    this->start_workers();
+  }
+
+  uint32_t num_threads() const {
+    return num_threads_;
+  }
+
+  // only tick the objects that have work to do, an idle object sleeps
+  // until a packet is delivered to one of its ports or it is woken up,
+  // its skipped cycles are then accounted in bulk (serial mode only).
+  void set_activity_tracking(bool enable) {
+    if (!enable) {
+      this->wakeup_all();
+    }
+    tracking_ = enable;
+  }
+
+  bool activity_tracking() const {
+    return tracking_;
+  }
+
+  // bring the state of sleeping objects up to date with the current cycle,
+  // must be called before sampling their performance counters.
+  void catch_up() {
+    for (uint32_t i = 0, n = objects_.size(); i < n; ++i) {
+      if (this->is_active(i))
+        continue;
+      auto object = objects_[i].get();
+      uint64_t next_cycle = this->next_tick(object);
+      if (next_cycle > object->sleep_cycle_) {
+        object->do_skip(next_cycle - object->sleep_cycle_);
+        object->sleep_cycle_ = next_cycle;
+      }
+    }
+  }
+
+  // wait for all lower partitions to complete the current cycle,
+  // the calling partition then has a deterministic view of their state.
+  void sync() {
+    if (num_threads_ == 0 || current_ == nullptr)
+      return;
+    uint64_t tick_id = cycles_ + 1;
+    for (uint32_t p = 0; p < current_->id; ++p) {
+      auto& part = *partitions_.at(p);
+      while (part.ticked.load(std::memory_order_acquire) != tick_id) {
+        std::this_thread::yield();
+      }
     }
   }
 
   void reset() {
-    assert(imm_events_.empty() && "immediate events not cleared!");
-    assert(reg_events_.empty() && "registered events not cleared!");
-    imm_events_.clear();
-    reg_events_.clear();
+    assert(this->events_empty() && "pending events!");
+    this->map_partitions();
     for (auto& object : objects_) {
       object->do_reset();
     }
+    for (uint32_t i = 0, n = objects_.size(); i < n; ++i) {
+      active_[i / 64] |= (uint64_t(1) << (i % 64));
+    }
     cycles_ = 0;
-    delta_ = 0;
   }
 
   void tick() {
-    // execute objects
-    this->fire_immediate_events();
-    for (auto& object : objects_) {
-      object->do_tick();
-      this->fire_immediate_events();
+    if (num_threads_ == 0) {
+      auto& part = *partitions_.front();
+      // execute active objects, objects woken up ahead of
+      // the current position are ticked during the same cycle
+      this->fire_immediate_events(part);
+      for (uint32_t i = this->next_active(0), n = objects_.size(); i < n; i = this->next_active(i + 1)) {
+        tick_pos_ = i + 1;
+        objects_[i]->do_tick();
+        this->fire_immediate_events(part);
+      }
+      tick_pos_ = 0;
+
+      // realize objects
+      this->realize_ports(part);
+
+      // put idle objects to sleep
+      if (tracking_) {
+        this->sleep_idle_objects();
+      }
+
+      // advance the clock
+      ++cycles_;
+
+      // fire registered events
+      this->fire_registered_events(part);
+    } else {
+      // execute partitions
+      this->run_phase(phase_tick);
+
+      // advance the clock
+      ++cycles_;
+      outbox_idx_ ^= 1;
+
+      // deliver cross-partition events and fire registered events
+      this->run_phase(phase_fire);
     }
+  }
 
-    // realize objects
-    for (auto it = pop_list_.begin(); it != pop_list_.end();) {
-      it->do_pop();
-      it = pop_list_.erase(it);
+  // advance the clock over the upcoming cycles during which no object has
+  // work to do, stopping one cycle before the next scheduled event so that
+  // it is delivered by a regular tick. Returns the number of skipped cycles.
+  uint64_t fast_forward() {
+    if (num_threads_ != 0)
+      return 0;
+    auto& part = *partitions_.front();
+    if (!part.imm_events.empty()
+     || !part.reg_wheel[(cycles_ + 1) & WHEEL_MASK].empty())
+      return 0;
+    // sleeping objects are idle
+    uint32_t num_objects = objects_.size();
+    for (uint32_t i = this->next_active(0); i < num_objects; i = this->next_active(i + 1)) {
+      if (!objects_[i]->do_idle())
+        return 0;
+    }
+
+    // find the next event
+    uint64_t limit = WHEEL_SIZE;
+    for (uint64_t delay = 2; delay < WHEEL_SIZE; ++delay) {
+      if (!part.reg_wheel[(cycles_ + delay) & WHEEL_MASK].empty()) {
+        limit = delay;
+        break;
+      }
+    }
+    if (limit == WHEEL_SIZE && !part.far_events.empty()) {
+      limit = part.far_events.top().cycles - cycles_;
+    }
+
+    for (uint32_t i = this->next_active(0); i < num_objects; i = this->next_active(i + 1)) {
+      limit = std::min(limit, objects_[i]->do_run_ahead(limit));
+      if (limit <= 1)
+        return 0;
     }
-    push_list_.clear();
 
-    // fire registered events
-    this->fire_registered_events();
+    // sleeping objects account for the skipped cycles when woken up
+    uint64_t skipped = limit - 1;
+    for (uint32_t i = this->next_active(0); i < num_objects; i = this->next_active(i + 1)) {
+      objects_[i]->do_skip(skipped);
+    }
+    cycles_ += skipped;
+    return skipped;
   }
 
   uint64_t cycles() const {
@@ -448,90 +653,467 @@ public:
 
 private:
 
-  SimPlatform() : cycles_(0), delta_(0) {}
+  typedef LinkedList<SimEventBase, &SimEventBase::list_> EventList;
+
+  static constexpr uint64_t WHEEL_SIZE = SIM_EVENT_WHEEL_SIZE;
+  static constexpr uint64_t WHEEL_MASK = WHEEL_SIZE - 1;
+  static_assert(ispow2(WHEEL_SIZE), "invalid SIM_EVENT_WHEEL_SIZE value");
+
+  struct far_event_t {
+    uint64_t      cycles;
+    uint64_t      order;
+    SimEventBase* event;
+    bool operator>(const far_event_t& other) const {
+      return (cycles != other.cycles) ? (cycles > other.cycles) : (order > other.order);
+    }
+  };
+
+  typedef std::priority_queue<far_event_t, std::vector<far_event_t>, std::greater<far_event_t>> FarEventQueue;
+
+  struct remote_event_t {
+    SimEventBase* event;
+    bool          immediate;
+  };
+
+  // a group of objects ticked by the same host thread with private event queues,
+  // in serial mode the first partition holds every object.
+  struct partition_t {
+    uint32_t id;
+    std::vector<SimObjectBase*> objects;
+    std::array<EventList, WHEEL_SIZE> reg_wheel;
+    FarEventQueue far_events;
+    uint64_t far_order;
+    EventList imm_events;
+    uint32_t delta;
+    LinkedList<SimPortBase, &SimPortBase::push_list_> push_list;
+    LinkedList<SimPortBase, &SimPortBase::pop_list_> pop_list;
+    // outgoing cross-partition events indexed by destination, double-buffered
+    // so that a cycle's events are delivered while the next ones are issued.
+    std::array<std::vector<std::vector<remote_event_t>>, 2> outbox;
+    std::atomic<uint64_t> ticked;
+
+    partition_t(uint32_t id) : id(id), far_order(0), delta(0), ticked(0) {}
+  };
+
+  enum phase_t {
+    phase_tick,
+    phase_fire,
+    phase_exit
+  };
+
+  SimPlatform()
+    : cycles_(0)
+    , partition_(0)
+    , num_threads_(0)
+    , tracking_(true)
+    , tick_pos_(0)
+    , outbox_idx_(0)
+    , phase_(phase_tick)
+    , phase_seq_(0)
+    , phase_done_(0) {
+    partitions_.emplace_back(new partition_t(0));
+  }
 
   virtual ~SimPlatform() {
     this->cleanup();
   }
 
   void cleanup() {
+    this->stop_workers();
+    num_threads_ = 0;
+    for (auto& part : partitions_) {
+      part->objects.clear();
+    }
     objects_.clear();
-    assert(imm_events_.empty() && "immediate events not cleared!");
-    assert(reg_events_.empty() && "registered events not cleared!");
-    imm_events_.clear();
-    reg_events_.clear();
+    active_.clear();
+    assert(this->events_empty() && "pending events!");
+    for (auto& part : partitions_) {
+      this->clear_events(*part);
+    }
+  }
+
+  bool is_active(uint32_t index) const {
+    return (active_[index / 64] >> (index % 64)) & 1;
+  }
+
+  // index of the first active object from the given position
+  uint32_t next_active(uint32_t index) const {
+    uint32_t n = active_.size();
+    uint32_t w = index / 64;
+    if (w >= n)
+      return objects_.size();
+    uint64_t bits = active_[w] & (~uint64_t(0) << (index % 64));
+    while (bits == 0) {
+      if (++w == n)
+        return objects_.size();
+      bits = active_[w];
+    }
+    return w * 64 + __builtin_ctzll(bits);
+  }
+
+  // first cycle an object woken up now would be ticked,
+  // objects behind the current tick position wait for the next cycle.
+  uint64_t next_tick(const SimObjectBase* object) const {
+    return cycles_ + (object->index_ < tick_pos_);
+  }
+
+  void wakeup(SimObjectBase* object) {
+    uint32_t index = object->index_;
+    if (this->is_active(index))
+      return;
+    // replay the idle cycles the object has slept through
+    uint64_t next_cycle = this->next_tick(object);
+    if (next_cycle > object->sleep_cycle_) {
+      object->do_skip(next_cycle - object->sleep_cycle_);
+    }
+    active_[index / 64] |= (uint64_t(1) << (index % 64));
+  }
+
+  void wakeup_all() {
+    this->catch_up();
+    for (uint32_t i = 0, n = objects_.size(); i < n; ++i) {
+      active_[i / 64] |= (uint64_t(1) << (i % 64));
+    }
+  }
+
+  void sleep_idle_objects() {
+    uint32_t num_objects = objects_.size();
+    for (uint32_t i = this->next_active(0); i < num_objects; i = this->next_active(i + 1)) {
+      auto object = objects_[i].get();
+      if (object->sleepable_ && object->do_idle()) {
+        active_[i / 64] &= ~(uint64_t(1) << (i % 64));
+        object->sleep_cycle_ = cycles_ + 1;
+      }
+    }
+  }
+
+  partition_t& current_partition() {
+    return current_ ? *current_ : *partitions_.front();
+  }
+
+  uint64_t event_cycles(const partition_t& part, uint64_t delay) const {
+    // immediate events are tagged with their issue order
+    return (delay == 0) ? part.delta : (cycles_ + delay);
+  }
+
+  void insert_event(partition_t& part, SimEventBase* evt, uint64_t delay) {
+    if (delay == 0) {
+      part.imm_events.push_back(evt);
+      ++part.delta;
+    } else if (delay < WHEEL_SIZE) {
+      // each wheel slot holds the events of a single cycle in issue order
+      part.reg_wheel[evt->cycles() & WHEEL_MASK].push_back(evt);
+    } else {
+      // beyond the wheel window, ordered by cycle then issue order
+      part.far_events.push({evt->cycles(), part.far_order++, evt});
+    }
+  }
+
+  bool events_empty() const {
+    for (auto& part : partitions_) {
+      if (!part->imm_events.empty() || !part->far_events.empty())
+        return false;
+      for (auto& slot : part->reg_wheel) {
+        if (!slot.empty())
+          return false;
+      }
+      for (auto& outbox : part->outbox) {
+        for (auto& events : outbox) {
+          if (!events.empty())
+            return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  void clear_events(partition_t& part) {
+    part.imm_events.clear();
+    for (auto& slot : part.reg_wheel) {
+      slot.clear();
+    }
+    FarEventQueue empty;
+    std::swap(part.far_events, empty);
+    part.far_order = 0;
+    part.delta = 0;
+    for (auto& outbox : part.outbox) {
+      for (auto& events : outbox) {
+        events.clear();
+      }
+    }
+    part.ticked.store(0, std::memory_order_relaxed);
   }
 
   template <typename Pkt>
   void schedule_push(SimPort<Pkt>* port, const Pkt& pkt, uint64_t delay) {
+    auto& part = this->current_partition();
     if (port->capacity() != 0) {
-      __assert(0 == push_list_.count(port), "cannot enqueue a port multiple times during the same cycle!");
-      push_list_.push_back(port);
+      __assert(0 == part.push_list.count(port), "cannot enqueue a port multiple times during the same cycle!");
+      part.push_list.push_back(port);
     }
     // schedule update event
-    if (delay == 0) {
-      auto evt = new SimPortEvent<Pkt>(port, pkt, delta_);
-      imm_events_.push_back(evt);
-      ++delta_;
-    } else {
-      auto evt = new SimPortEvent<Pkt>(port, pkt, cycles_ + delay);
-      reg_events_.push_back(evt);
+    auto evt = new SimPortEvent<Pkt>(port, pkt, this->event_cycles(part, delay));
+    if (num_threads_ != 0) {
+      // events crossing partitions are delivered at the end of the cycle
+      uint32_t dst = this->sink_partition(port);
+      if (dst != part.id) {
+        part.outbox[outbox_idx_][dst].push_back({evt, (delay == 0)});
+        part.delta += (delay == 0);
+        return;
+      }
     }
+    this->insert_event(part, evt, delay);
   }
 
   template <typename Pkt>
   void schedule_pop(SimPort<Pkt>* port) {
-    __assert(0 == pop_list_.count(port), "cannot dequeue a port multiple times during the same cycle!");
-    pop_list_.push_back(port);
+    auto& part = this->current_partition();
+    __assert(0 == part.pop_list.count(port), "cannot dequeue a port multiple times during the same cycle!");
+    part.pop_list.push_back(port);
+  }
+
+  uint32_t sink_partition(const SimPortBase* port) const {
+    while (port->sink_) {
+      port = port->sink_;
+    }
+    return port->module_->partition_;
+  }
+
+  void fire_immediate_events(partition_t& part) {
+    // fire all events that are scheduled for the current cycle in issue order,
+    // events issued while firing are appended and drained in the same pass
+    while (!part.imm_events.empty()) {
+      auto event = part.imm_events.front();
+      part.imm_events.pop_front();
+      event->fire();
+      delete event;
+    }
+    part.delta = 0;
+  }
+
+  void fire_registered_events(partition_t& part) {
+    // move far events entering the wheel window, they were issued before
+    // any event of the same cycle that can still be inserted directly
+    while (!part.far_events.empty()
+        && part.far_events.top().cycles < cycles_ + WHEEL_SIZE) {
+      auto event = part.far_events.top().event;
+      part.far_events.pop();
+      part.reg_wheel[event->cycles() & WHEEL_MASK].push_back(event);
+    }
+
+    // fire all events that are scheduled for the current cycle
+    auto& slot = part.reg_wheel[cycles_ & WHEEL_MASK];
+    while (!slot.empty()) {
+      auto event = slot.front();
+      assert(event->cycles() == cycles_);
+      slot.pop_front();
+      event->fire();
+      delete event;
+    }
   }
 
-  void fire_immediate_events() {
-    // fire all events that are scheduled for the current cycle in issue order
-    for (uint32_t delta = 0; delta < delta_; ++delta) {
-      for (auto evt_it = imm_events_.begin(), evt_it_end = imm_events_.end(); evt_it != evt_it_end;) {
-        auto event = &*evt_it;
-        if (event->cycles() == delta) {
+  void realize_ports(partition_t& part) {
+    for (auto it = part.pop_list.begin(); it != part.pop_list.end();) {
+      it->do_pop();
+      it = part.pop_list.erase(it);
+    }
+    part.push_list.clear();
+  }
+
+  void tick_partition(partition_t& part) {
+    // release the outbox delivered during the last fire phase
+    for (auto& events : part.outbox[outbox_idx_ ^ 1]) {
+      events.clear();
+    }
+
+    // execute objects
+    this->fire_immediate_events(part);
+    for (auto object : part.objects) {
+      object->do_tick();
+      this->fire_immediate_events(part);
+    }
+
+    // realize objects
+    this->realize_ports(part);
+
+    part.ticked.store(cycles_ + 1, std::memory_order_release);
+  }
+
+  void fire_partition(partition_t& part) {
+    // deliver incoming events in source partition order
+    for (auto& src : partitions_) {
+      for (auto& remote : src->outbox[outbox_idx_ ^ 1].at(part.id)) {
+        auto event = remote.event;
+        if (remote.immediate) {
           event->fire();
-          evt_it = imm_events_.erase(evt_it);
           delete event;
         } else {
-          ++evt_it;
+          this->insert_event(part, event, event->cycles() - cycles_ + 1);
         }
       }
-    };
-    delta_ = 0;
+    }
+    this->fire_registered_events(part);
+  }
+
+  void run_partitions(uint32_t tid, phase_t phase) {
+    // partitions are statically assigned in increasing order,
+    // which guarantees forward progress of sync().
+    for (uint32_t p = tid, n = partitions_.size(); p < n; p += num_threads_) {
+      auto& part = *partitions_.at(p);
+      current_ = &part;
+      try {
+        if (phase == phase_tick) {
+          this->tick_partition(part);
+        } else {
+          this->fire_partition(part);
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        if (!error_) {
+          error_ = std::current_exception();
+        }
+        part.ticked.store(cycles_ + 1, std::memory_order_release);
+      }
+    }
+    current_ = nullptr;
   }
 
-  void fire_registered_events() {
-    // advance the clock
-    ++cycles_;
+  void start_phase(phase_t phase) {
+    {
+      std::lock_guard<std::mutex> lock(phase_mutex_);
+      phase_ = phase;
+      phase_seq_.fetch_add(1, std::memory_order_release);
+    }
+    phase_cv_.notify_all();
+  }
 
-    // fire all events that are scheduled for the current cycle
-    for (auto evt_it = reg_events_.begin(), evt_it_end = reg_events_.end(); evt_it != evt_it_end;) {
-      auto event = &*evt_it;
-      if (event->cycles() == cycles_) {
-        event->fire();
-        evt_it = reg_events_.erase(evt_it);
-        delete event;
-      } else {
-        ++evt_it;
+  void run_phase(phase_t phase) {
+    this->start_phase(phase);
+    this->run_partitions(0, phase);
+    while (phase_done_.load(std::memory_order_acquire) != workers_.size()) {
+      std::this_thread::yield();
+    }
+    phase_done_.store(0, std::memory_order_relaxed);
+    if (error_) {
+      auto error = error_;
+      error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  void worker_loop(uint32_t tid, uint64_t seq) {
+    for (;;) {
+      // wait for the next phase, sleep when the simulation is idle
+      uint32_t spins = 0;
+      while (phase_seq_.load(std::memory_order_acquire) == seq) {
+        if (++spins > 4096) {
+          std::unique_lock<std::mutex> lock(phase_mutex_);
+          phase_cv_.wait(lock, [&]() {
+            return phase_seq_.load(std::memory_order_acquire) != seq;
+          });
+        } else if (spins > 1024) {
+          std::this_thread::yield();
+        }
       }
+      ++seq;
+      if (phase_ == phase_exit)
+        break;
+      this->run_partitions(tid, phase_);
+      phase_done_.fetch_add(1, std::memory_order_acq_rel);
+    }
+  }
+
+  void map_partitions() {
+    uint32_t num_partitions = 1;
+    if (num_threads_ != 0) {
+      for (auto& object : objects_) {
+        num_partitions = std::max(num_partitions, object->partition_ + 1);
+      }
+    }
+    while (partitions_.size() < num_partitions) {
+      partitions_.emplace_back(new partition_t(partitions_.size()));
+    }
+    for (auto& part : partitions_) {
+      part->objects.clear();
+      for (auto& outbox : part->outbox) {
+        outbox.resize(num_partitions);
+      }
+      part->ticked.store(0, std::memory_order_relaxed);
+    }
+    if (num_threads_ != 0) {
+      for (auto& object : objects_) {
+        partitions_.at(object->partition_)->objects.push_back(object.get());
+      }
+    }
+    outbox_idx_ = 0;
+  }
+
+  void start_workers() {
+    if (num_threads_ == 0)
+      return;
+    num_threads_ = std::min<uint32_t>(num_threads_, partitions_.size());
+    uint64_t seq = phase_seq_.load(std::memory_order_relaxed);
+    for (uint32_t tid = 1; tid < num_threads_; ++tid) {
+      workers_.emplace_back(&SimPlatform::worker_loop, this, tid, seq);
+    }
+  }
+
+  void stop_workers() {
+    if (!workers_.empty()) {
+      this->start_phase(phase_exit);
+      for (auto& worker : workers_) {
+        worker.join();
+      }
+      workers_.clear();
     }
   }
 
   std::vector<SimObjectBase::Ptr> objects_;
-  LinkedList<SimEventBase, &SimEventBase::list_> reg_events_;
-  LinkedList<SimEventBase, &SimEventBase::list_> imm_events_;
-  LinkedList<SimPortBase, &SimPortBase::push_list_> push_list_;
-  LinkedList<SimPortBase, &SimPortBase::pop_list_> pop_list_;
+  std::vector<uint64_t> active_;
+  std::vector<std::unique_ptr<partition_t>> partitions_;
   uint64_t cycles_;
-  uint32_t delta_;
+  uint32_t partition_;
+  uint32_t num_threads_;
+  bool tracking_;
+  uint32_t tick_pos_;
+  uint32_t outbox_idx_;
+  std::vector<std::thread> workers_;
+  phase_t phase_;
+  std::atomic<uint64_t> phase_seq_;
+  std::atomic<size_t> phase_done_;
+  std::mutex phase_mutex_;
+  std::condition_variable phase_cv_;
+  std::exception_ptr error_;
+  std::mutex error_mutex_;
+
+  static inline thread_local partition_t* current_ = nullptr;
 
   template <typename U> friend class SimPort;
+  friend class SimObjectBase;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
+template <typename Pkt>
+void SimPort<Pkt>::transfer(const Pkt& pkt, uint64_t cycles) {
+  if (tx_cb_) {
+    tx_cb_(pkt, cycles);
+  }
+  if (sink_) {
+    if (sink_transfer_) {
+      sink_transfer_(pkt, cycles);
+    } else {
+      reinterpret_cast<SimPort<Pkt>*>(sink_)->transfer(pkt, cycles);
+    }
+  } else {
+    // wake up the reader before its input changes
+    if (reader_) {
+      SimPlatform::instance().wakeup(reader_);
+    }
+    queue_.push({pkt, cycles});
+  }
+}
+
 template <typename Pkt>
 void SimPort<Pkt>::push(const Pkt& pkt, uint64_t delay) {
   __assert(source_ == nullptr, "cannot be called on a sink port!")
@@ -549,6 +1131,19 @@ uint64_t SimPort<Pkt>::pop() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+inline void SimObjectBase::wakeup(uint64_t delay) {
+  auto& platform = SimPlatform::instance();
+  if (delay == 0) {
+    platform.wakeup(this);
+  } else {
+    platform.schedule<SimObjectBase*>([](SimObjectBase* const& object) {
+      SimPlatform::instance().wakeup(object);
+    }, this, delay);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 template <typename Impl>
 template <typename... Args>
 typename SimObject<Impl>::Ptr SimObject<Impl>::Create(Args&&... args) {
@@ -0,0 +1,200 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <cassert>
+
+namespace vortex {
+
+enum class TlbReplPolicy {
+  LRU    = 0,
+  FIFO   = 1,
+  Random = 2
+};
+
+// Set-associative translation lookaside buffer.
+// Entries are tagged with the virtual page number at the size they were
+// mapped with, so that pages of different sizes can coexist; a lookup probes
+// each page size currently held in the buffer.
+class TLB {
+public:
+  struct entry_t {
+    uint64_t vpn;
+    uint64_t pfn;
+    uint32_t flags;
+    uint32_t size_bits;
+    uint64_t stamp;
+    bool     valid;
+  };
+
+  TLB(uint32_t num_entries, uint32_t num_ways, TlbReplPolicy policy)
+    : num_sets_(num_entries / num_ways)
+    , num_ways_(num_ways)
+    , policy_(policy)
+    , entries_(num_entries)
+    , stamp_(0)
+    , rand_(0x2545f4914f6cdd1dull)
+    , size_mask_(0) {
+    assert(num_ways != 0 && (num_entries % num_ways) == 0);
+    assert((num_sets_ & (num_sets_ - 1)) == 0);
+    this->flush();
+  }
+
+  // return the entry mapping the virtual address, or nullptr
+  entry_t* lookup(uint64_t vaddr) {
+    for (auto mask = size_mask_; mask != 0; mask &= (mask - 1)) {
+      uint32_t size_bits = __builtin_ctzll(mask);
+      uint64_t vpn = vaddr >> size_bits;
+      auto set = this->set(vpn);
+      for (uint32_t w = 0; w < num_ways_; ++w) {
+        auto& entry = set[w];
+        if (entry.valid && entry.vpn == vpn && entry.size_bits == size_bits) {
+          if (policy_ == TlbReplPolicy::LRU) {
+            entry.stamp = ++stamp_;
+          }
+          return &entry;
+        }
+      }
+    }
+    return nullptr;
+  }
+
+  // insert a translation, returns true if a valid entry was evicted
+  bool insert(uint64_t vpn, uint64_t pfn, uint32_t flags, uint32_t size_bits) {
+    auto set = this->set(vpn);
+    entry_t* victim = nullptr;
+    for (uint32_t w = 0; w < num_ways_; ++w) {
+      auto& entry = set[w];
+      if (!entry.valid
+       || (entry.vpn == vpn && entry.size_bits == size_bits)) {
+        victim = &entry;
+        break;
+      }
+    }
+    bool evicted = false;
+    if (victim == nullptr) {
+      if (policy_ == TlbReplPolicy::Random) {
+        rand_ ^= rand_ << 13;
+        rand_ ^= rand_ >> 7;
+        rand_ ^= rand_ << 17;
+        victim = &set[rand_ % num_ways_];
+      } else {
+        // oldest insertion (FIFO) or least recent use (LRU)
+        victim = &set[0];
+        for (uint32_t w = 1; w < num_ways_; ++w) {
+          if (set[w].stamp < victim->stamp) {
+            victim = &set[w];
+          }
+        }
+      }
+      evicted = true;
+    }
+    *victim = {vpn, pfn, flags, size_bits, ++stamp_, true};
+    size_mask_ |= (1ull << size_bits);
+    return evicted;
+  }
+
+  // drop the translation of a virtual address
+  void invalidate(uint64_t vaddr) {
+    auto entry = this->lookup(vaddr);
+    if (entry) {
+      entry->valid = false;
+    }
+  }
+
+  void flush() {
+    for (auto& entry : entries_) {
+      entry.valid = false;
+      entry.stamp = 0;
+    }
+    size_mask_ = 0;
+  }
+
+private:
+
+  entry_t* set(uint64_t vpn) {
+    return &entries_[(vpn & (num_sets_ - 1)) * num_ways_];
+  }
+
+  uint32_t num_sets_;
+  uint32_t num_ways_;
+  TlbReplPolicy policy_;
+  std::vector<entry_t> entries_;
+  uint64_t stamp_;
+  uint64_t rand_;
+  uint64_t size_mask_;
+};
+
+// Fully associative cache of non-leaf page table entries.
+// An entry maps the virtual address bits translated above a given level to
+// the base page of the next level table, letting a page walk skip the
+// upper levels of the page table.
+class PageWalkCache {
+public:
+  PageWalkCache(uint32_t size)
+    : entries_(size)
+    , stamp_(0) {
+    this->flush();
+  }
+
+  bool lookup(uint32_t level, uint64_t prefix, uint64_t* base_ppn) {
+    for (auto& entry : entries_) {
+      if (entry.valid && entry.level == level && entry.prefix == prefix) {
+        entry.stamp = ++stamp_;
+        *base_ppn = entry.base_ppn;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void insert(uint32_t level, uint64_t prefix, uint64_t base_ppn) {
+    if (entries_.empty())
+      return;
+    auto victim = &entries_[0];
+    for (auto& entry : entries_) {
+      if (!entry.valid) {
+        victim = &entry;
+        break;
+      }
+      if (entry.stamp < victim->stamp) {
+        victim = &entry;
+      }
+    }
+    *victim = {prefix, base_ppn, ++stamp_, level, true};
+  }
+
+  void flush() {
+    for (auto& entry : entries_) {
+      entry.valid = false;
+    }
+  }
+
+private:
+
+  struct entry_t {
+    uint64_t prefix;
+    uint64_t base_ppn;
+    uint64_t stamp;
+    uint32_t level;
+    bool     valid;
+  };
+
+  std::vector<entry_t> entries_;
+  uint64_t stamp_;
+};
+
+}
@@ -152,6 +152,16 @@ extern fpga_result fpgaReadMMIO64(fpga_handle handle, uint32_t mmio_num, uint64_
   return FPGA_OK;
 }
 
+extern fpga_result fpgaSimSetStatusCallback(fpga_handle handle, fpga_status_callback callback, void* arg) {
+  if (NULL == handle)
+    return FPGA_INVALID_PARAM;
+
+  auto sim = reinterpret_cast<opae_sim*>(handle);
+  sim->set_status_callback(callback, arg);
+
+  return FPGA_OK;
+}
+
 extern const char *fpgaErrStr(fpga_result e) {
   return "";
 }
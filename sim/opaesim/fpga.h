@@ -47,6 +47,12 @@ typedef void *fpga_properties;
 
 typedef uint8_t fpga_guid[16];
 
+// Simulator extension: the callback is invoked from the simulation thread
+// whenever the AFU command state changes.
+typedef void (*fpga_status_callback)(void* arg, uint64_t state);
+
+fpga_result fpgaSimSetStatusCallback(fpga_handle handle, fpga_status_callback callback, void* arg);
+
 #ifdef __cplusplus
 }
 #endif
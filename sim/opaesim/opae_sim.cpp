@@ -98,6 +98,9 @@ public:
   , dram_sim_(PLATFORM_MEMORY_NUM_BANKS, PLATFORM_MEMORY_DATA_SIZE, MEM_CLOCK_RATIO)
   , stop_(false)
   , host_buffer_ids_(0)
+  , status_callback_(nullptr)
+  , status_arg_(nullptr)
+  , afu_state_(0)
 #ifdef VCD_OUTPUT
   , tfp_(nullptr)
 #endif
@@ -238,6 +241,12 @@ public:
     device_->vcp2af_sRxPort_c0_mmioWrValid = 0;
   }
 
+  void set_status_callback(opae_status_callback_t callback, void* arg) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    status_callback_ = callback;
+    status_arg_ = arg;
+  }
+
 private:
 
   void reset() {
@@ -289,6 +298,14 @@ private:
     device_->clk = 1;
     this->eval();
 
+    // notify the host of command state changes
+    if (device_->afu_state != afu_state_) {
+      afu_state_ = device_->afu_state;
+      if (status_callback_) {
+        status_callback_(status_arg_, afu_state_);
+      }
+    }
+
   #ifndef NDEBUG
     fflush(stdout);
   #endif
@@ -526,6 +543,10 @@ private:
 
   std::queue<mem_req_t*> dram_queue_;
 
+  opae_status_callback_t status_callback_;
+  void* status_arg_;
+  uint8_t afu_state_;
+
 #ifdef VCD_OUTPUT
   VerilatedVcdC *tfp_;
 #endif
@@ -568,3 +589,7 @@ void opae_sim::write_mmio64(uint32_t mmio_num, uint64_t offset, uint64_t value)
 void opae_sim::read_mmio64(uint32_t mmio_num, uint64_t offset, uint64_t *value) {
   impl_->read_mmio64(mmio_num, offset, value);
 }
+
+void opae_sim::set_status_callback(opae_status_callback_t callback, void* arg) {
+  impl_->set_status_callback(callback, arg);
+}
@@ -17,6 +17,8 @@
 
 namespace vortex {
 
+typedef void (*opae_status_callback_t)(void* arg, uint64_t state);
+
 class opae_sim {
 public:
 
@@ -37,6 +39,8 @@ public:
 
   void read_mmio64(uint32_t mmio_num, uint64_t offset, uint64_t *value);
 
+  void set_status_callback(opae_status_callback_t callback, void* arg);
+
 private:
 
   class Impl;
@@ -86,9 +86,14 @@ module vortex_afu_shim import local_mem_cfg_pkg::*; import ccip_if_pkg::*; (
   output logic                avs_read [`PLATFORM_MEMORY_NUM_BANKS],
   output t_local_mem_byte_mask avs_byteenable [`PLATFORM_MEMORY_NUM_BANKS],
   output t_local_mem_burst_cnt avs_burstcount [`PLATFORM_MEMORY_NUM_BANKS],
-  input                       avs_readdatavalid [`PLATFORM_MEMORY_NUM_BANKS]
+  input                       avs_readdatavalid [`PLATFORM_MEMORY_NUM_BANKS],
+
+  // AFU command state, monitored by the simulator to notify status changes
+  output logic [7:0]          afu_state
 );
 
+assign afu_state = 8'(afu.state);
+
 t_if_ccip_Rx cp2af_sRxPort;
 t_if_ccip_Tx af2cp_sTxPort;
 
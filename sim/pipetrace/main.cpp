@@ -0,0 +1,318 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <unistd.h>
+#include <pipe_trace.h>
+
+using namespace vortex;
+
+static constexpr uint64_t NO_TIME = std::numeric_limits<uint64_t>::max();
+
+static const char* trace_file = nullptr;
+static const char* csv_file = nullptr;
+static const char* json_file = nullptr;
+
+static void show_usage() {
+  std::cout << "Usage: [-o: csv output] [-j: json timeline output] [-h: help] <pipe-trace>" << std::endl;
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "o:j:h")) != -1) {
+    switch (c) {
+    case 'o':
+      csv_file = optarg;
+      break;
+    case 'j':
+      json_file = optarg;
+      break;
+    case 'h':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+  if (optind < argc) {
+    trace_file = argv[optind];
+  } else {
+    show_usage();
+    exit(-1);
+  }
+}
+
+// per-instruction pipeline timeline, in timestamp units
+struct instr_t {
+  uint64_t uuid;
+  uint64_t PC;
+  uint64_t tmask;
+  uint32_t core_id;
+  uint32_t wid;
+  PipeUnit unit;
+  uint64_t time[(int)PipeStage::Count];
+};
+
+class PerfCounter {
+public:
+  PerfCounter(const char* name)
+    : name_(name)
+    , total_(0)
+    , count_(0)
+    , min_(0)
+    , max_(0)
+    , min_uuid_(0)
+    , max_uuid_(0)
+  {}
+
+  void update(uint64_t uuid, uint64_t value) {
+    if (count_ == 0 || value < min_) {
+      min_ = value;
+      min_uuid_ = uuid;
+    }
+    if (count_ == 0 || value > max_) {
+      max_ = value;
+      max_uuid_ = uuid;
+    }
+    total_ += value;
+    ++count_;
+  }
+
+  void dump() const {
+    uint64_t avg = count_ ? (total_ / count_) : 0;
+    std::cout << name_ << " latency: avg=" << avg
+              << ", min=" << min_ << " (#" << min_uuid_ << ")"
+              << ", max=" << max_ << " (#" << max_uuid_ << ")" << std::endl;
+  }
+
+private:
+  const char* name_;
+  uint64_t total_;
+  uint64_t count_;
+  uint64_t min_;
+  uint64_t max_;
+  uint64_t min_uuid_;
+  uint64_t max_uuid_;
+};
+
+static const char* unit_name(PipeUnit unit) {
+  switch (unit) {
+  case PipeUnit::ALU: return "ALU";
+  case PipeUnit::LSU: return "LSU";
+  case PipeUnit::SFU: return "SFU";
+  case PipeUnit::FPU: return "FPU";
+  case PipeUnit::TCU: return "TCU";
+  case PipeUnit::VPU: return "VPU";
+  default: return "";
+  }
+}
+
+// name of the interval starting at the given stage
+static const char* stage_name(PipeStage stage) {
+  switch (stage) {
+  case PipeStage::Schedule: return "schedule";
+  case PipeStage::IBuffer:  return "issue";
+  case PipeStage::Dispatch: return "execute";
+  default: return "";
+  }
+}
+
+static int load_trace(const char* filename, std::vector<instr_t>* instrs, uint32_t* ticks_per_cycle) {
+  std::ifstream ifs(filename, std::ios::binary);
+  if (!ifs) {
+    std::cerr << "Error: failed to open " << filename << std::endl;
+    return -1;
+  }
+
+  pipe_trace_hdr_t hdr;
+  if (!ifs.read((char*)&hdr, sizeof(hdr))
+   || memcmp(hdr.magic, "VXPT", 4) != 0
+   || hdr.version != PipeTraceWriter::VERSION
+   || hdr.record_size != sizeof(pipe_trace_rec_t)
+   || hdr.ticks_per_cycle == 0) {
+    std::cerr << "Error: invalid pipe trace " << filename << std::endl;
+    return -1;
+  }
+  *ticks_per_cycle = hdr.ticks_per_cycle;
+
+  // the uuid is only unique per core
+  std::unordered_map<uint32_t, std::unordered_map<uint64_t, uint32_t>> lookup;
+  std::vector<pipe_trace_rec_t> recs;
+  pipe_trace_blk_t blk;
+  while (ifs.read((char*)&blk, sizeof(blk))) {
+    recs.resize(blk.count);
+    if (!ifs.read((char*)recs.data(), blk.count * sizeof(pipe_trace_rec_t))) {
+      std::cerr << "Warning: pipe trace is truncated" << std::endl;
+      break;
+    }
+    auto& core_lookup = lookup[blk.core_id];
+    for (auto& rec : recs) {
+      if (rec.stage >= PipeStage::Count)
+        continue;
+      auto it = core_lookup.find(rec.uuid);
+      if (it == core_lookup.end()) {
+        instr_t instr;
+        instr.uuid    = rec.uuid;
+        instr.PC      = rec.PC;
+        instr.tmask   = rec.tmask;
+        instr.core_id = rec.core_id;
+        instr.wid     = rec.wid;
+        instr.unit    = rec.unit;
+        std::fill_n(instr.time, (int)PipeStage::Count, NO_TIME);
+        it = core_lookup.emplace(rec.uuid, instrs->size()).first;
+        instrs->push_back(instr);
+      }
+      auto& instr = instrs->at(it->second);
+      if (rec.unit != PipeUnit::None) {
+        instr.unit = rec.unit;
+      }
+      auto& time = instr.time[(int)rec.stage];
+      if (rec.stage == PipeStage::Commit) {
+        // multi-cycle writebacks, keep the last one
+        time = (time == NO_TIME) ? rec.timestamp : std::max(time, rec.timestamp);
+      } else {
+        time = std::min(time, rec.timestamp);
+      }
+    }
+  }
+
+  std::sort(instrs->begin(), instrs->end(), [](const instr_t& a, const instr_t& b) {
+    if (a.core_id != b.core_id)
+      return a.core_id < b.core_id;
+    return a.uuid < b.uuid;
+  });
+  return 0;
+}
+
+static void print_time(std::ostream& os, uint64_t time, uint32_t ticks_per_cycle) {
+  if (time != NO_TIME) {
+    os << (time / ticks_per_cycle);
+  }
+}
+
+static int write_csv(const char* filename, const std::vector<instr_t>& instrs, uint32_t ticks_per_cycle) {
+  std::ofstream ofs(filename);
+  if (!ofs) {
+    std::cerr << "Error: failed to create " << filename << std::endl;
+    return -1;
+  }
+  ofs << "uuid,PC,core_id,warp_id,unit,tmask,schedule,ibuffer,dispatch,commit" << std::endl;
+  for (auto& instr : instrs) {
+    ofs << instr.uuid << ",0x" << std::hex << instr.PC << std::dec
+        << "," << instr.core_id << "," << instr.wid
+        << "," << unit_name(instr.unit) << ",0x" << std::hex << instr.tmask << std::dec;
+    for (int s = 0; s < (int)PipeStage::Count; ++s) {
+      ofs << ",";
+      print_time(ofs, instr.time[s], ticks_per_cycle);
+    }
+    ofs << std::endl;
+  }
+  return 0;
+}
+
+// Chrome trace event format, loadable in Perfetto and chrome://tracing.
+// Each core is a process and each warp a thread; timestamps are cycles.
+static int write_json(const char* filename, const std::vector<instr_t>& instrs, uint32_t ticks_per_cycle) {
+  std::ofstream ofs(filename);
+  if (!ofs) {
+    std::cerr << "Error: failed to create " << filename << std::endl;
+    return -1;
+  }
+  ofs << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << std::endl;
+  bool first = true;
+  uint32_t last_core = std::numeric_limits<uint32_t>::max();
+  for (auto& instr : instrs) {
+    if (instr.core_id != last_core) {
+      last_core = instr.core_id;
+      ofs << (first ? "" : ",\n")
+          << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << instr.core_id
+          << ",\"args\":{\"name\":\"core" << instr.core_id << "\"}}";
+      first = false;
+    }
+    // each stage lasts until the next recorded one
+    for (int s = 0; s < (int)PipeStage::Commit; ++s) {
+      auto start = instr.time[s];
+      if (start == NO_TIME)
+        continue;
+      auto end = NO_TIME;
+      for (int n = s + 1; n < (int)PipeStage::Count && end == NO_TIME; ++n) {
+        end = instr.time[n];
+      }
+      if (end == NO_TIME || end < start)
+        continue;
+      ofs << ",\n{\"name\":\"" << stage_name(PipeStage(s)) << "\""
+          << ",\"cat\":\"" << unit_name(instr.unit) << "\""
+          << ",\"ph\":\"X\",\"pid\":" << instr.core_id << ",\"tid\":" << instr.wid
+          << ",\"ts\":" << (start / ticks_per_cycle)
+          << ",\"dur\":" << ((end - start) / ticks_per_cycle)
+          << ",\"args\":{\"uuid\":" << instr.uuid
+          << ",\"PC\":\"0x" << std::hex << instr.PC
+          << "\",\"tmask\":\"0x" << instr.tmask << std::dec << "\"}}";
+    }
+  }
+  ofs << "\n]}" << std::endl;
+  return 0;
+}
+
+static void dump_latencies(const std::vector<instr_t>& instrs, uint32_t ticks_per_cycle) {
+  PerfCounter perf_sched("Schedule");
+  PerfCounter perf_issue("Issue");
+  PerfCounter perf_exec("Execute");
+  uint32_t S = (int)PipeStage::Schedule;
+  uint32_t I = (int)PipeStage::IBuffer;
+  uint32_t D = (int)PipeStage::Dispatch;
+  uint32_t C = (int)PipeStage::Commit;
+  for (auto& instr : instrs) {
+    auto& t = instr.time;
+    if (t[S] != NO_TIME && t[I] != NO_TIME && t[I] >= t[S]) {
+      perf_sched.update(instr.uuid, (t[I] - t[S]) / ticks_per_cycle);
+    }
+    if (t[I] != NO_TIME && t[D] != NO_TIME && t[D] >= t[I]) {
+      perf_issue.update(instr.uuid, (t[D] - t[I]) / ticks_per_cycle);
+    }
+    if (t[D] != NO_TIME && t[C] != NO_TIME && t[C] >= t[D]) {
+      perf_exec.update(instr.uuid, (t[C] - t[D]) / ticks_per_cycle);
+    }
+  }
+  perf_sched.dump();
+  perf_issue.dump();
+  perf_exec.dump();
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  std::vector<instr_t> instrs;
+  uint32_t ticks_per_cycle;
+  if (load_trace(trace_file, &instrs, &ticks_per_cycle) != 0)
+    return -1;
+
+  std::cout << "Loaded " << instrs.size() << " instructions" << std::endl;
+  dump_latencies(instrs, ticks_per_cycle);
+
+  if (csv_file && write_csv(csv_file, instrs, ticks_per_cycle) != 0)
+    return -1;
+
+  if (json_file && write_json(json_file, instrs, ticks_per_cycle) != 0)
+    return -1;
+
+  return 0;
+}
@@ -78,12 +78,12 @@ int main(int argc, char **argv) {
 	// load program
 	{
 		std::string program_ext(fileExtension(program));
-		if (program_ext == "bin") {
+		if (program_ext == "bin" || program_ext == "zst") {
 			ram.loadBinImage(program, startup_addr);
 		} else if (program_ext == "hex") {
 			ram.loadHexImage(program);
 		} else {
-			std::cerr << "Error: only *.bin or *.hex images supported." << std::endl;
+			std::cerr << "Error: only *.bin, *.bin.zst or *.hex images supported." << std::endl;
 			return -1;
 		}
 	}
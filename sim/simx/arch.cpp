@@ -0,0 +1,494 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "arch.h"
+#include <iostream>
+#include <fstream>
+#include <nlohmann_json.hpp>
+
+using namespace vortex;
+
+Arch::Arch(uint16_t num_threads, uint16_t num_warps, uint16_t num_cores)
+  : num_threads_(num_threads)
+  , num_warps_(num_warps)
+  , num_cores_(num_cores)
+  , num_clusters_(NUM_CLUSTERS)
+  , socket_size_(SOCKET_SIZE)
+  , num_barriers_(NUM_BARRIERS)
+  , local_mem_base_(LMEM_BASE_ADDR)
+  , issue_width_(ISSUE_WIDTH)
+  , num_opcs_(NUM_OPCS)
+  , num_alu_blocks_(NUM_ALU_BLOCKS)
+  , num_fpu_blocks_(NUM_FPU_BLOCKS)
+  , num_lsu_blocks_(NUM_LSU_BLOCKS)
+  , num_sfu_blocks_(NUM_SFU_BLOCKS)
+  , num_vpu_blocks_(NUM_VPU_BLOCKS)
+  , num_tcu_blocks_(NUM_TCU_BLOCKS)
+  , icache_{ICACHE_ENABLED, NUM_ICACHES, ICACHE_SIZE, ICACHE_NUM_WAYS, 1, ICACHE_MSHR_SIZE, false, ICACHE_MEM_PORTS, ReplPolicy(ICACHE_REPL_POLICY), PrefetchConfig()}
+  , dcache_{DCACHE_ENABLED, NUM_DCACHES, DCACHE_SIZE, DCACHE_NUM_WAYS, DCACHE_NUM_BANKS, DCACHE_MSHR_SIZE, DCACHE_WRITEBACK, L1_MEM_PORTS, ReplPolicy(DCACHE_REPL_POLICY), PrefetchConfig()}
+  , l2cache_{L2_ENABLED, 1, L2_CACHE_SIZE, L2_NUM_WAYS, L2_NUM_BANKS, L2_MSHR_SIZE, L2_WRITEBACK, L2_MEM_PORTS, ReplPolicy(L2_REPL_POLICY), PrefetchConfig()}
+  , l3cache_{L3_ENABLED, 1, L3_CACHE_SIZE, L3_NUM_WAYS, L3_NUM_BANKS, L3_MSHR_SIZE, L3_WRITEBACK, L3_MEM_PORTS, ReplPolicy(L3_REPL_POLICY), PrefetchConfig()}
+  , dram_{PLATFORM_MEMORY_NUM_BANKS, MEM_CLOCK_RATIO, DramModel::Ramulator, DramTiming(), RamulatorConfig()}
+{
+  if (num_threads != NUM_THREADS)
+    overrides_.insert("num_threads");
+  if (num_warps != NUM_WARPS)
+    overrides_.insert("num_warps");
+  if (num_cores != NUM_CORES)
+    overrides_.insert("num_cores");
+  if (!overrides_.empty()) {
+    this->update();
+  }
+}
+
+// re-derive the dependent parameters that were not overridden,
+// following the rules in VX_config.vh
+void Arch::update() {
+  auto derived = [&](const char* key) {
+    return (overrides_.count(key) == 0);
+  };
+  if (derived("socket_size")) {
+    socket_size_ = MIN(4, num_cores_);
+  }
+  if (derived("issue_width")) {
+    issue_width_ = UP(num_warps_ / 16);
+  }
+  if (derived("num_opcs")) {
+    num_opcs_ = UP(num_warps_ / (4 * issue_width_));
+  }
+  if (derived("num_alu_blocks")) {
+    num_alu_blocks_ = issue_width_;
+  }
+  if (derived("num_fpu_blocks")) {
+    num_fpu_blocks_ = issue_width_;
+  }
+  if (derived("num_vpu_blocks")) {
+    num_vpu_blocks_ = issue_width_;
+  }
+  if (derived("num_tcu_blocks")) {
+    num_tcu_blocks_ = issue_width_;
+  }
+  if (derived("icache.num_caches")) {
+    icache_.num_caches = icache_.enabled ? UP(socket_size_ / 4) : 0;
+  }
+  if (derived("dcache.num_caches")) {
+    dcache_.num_caches = dcache_.enabled ? UP(socket_size_ / 4) : 0;
+  }
+  if (derived("dcache.num_banks")) {
+    dcache_.num_banks = dcache_.enabled ? MIN(this->dcache_num_reqs(), 16) : 1;
+  }
+  if (derived("dcache.mem_ports")) {
+    bool l1_enabled = icache_.enabled || dcache_.enabled;
+    dcache_.mem_ports = MIN(l1_enabled ? dcache_.num_banks : this->dcache_num_reqs(), dram_.num_banks);
+  }
+  if (derived("l2cache.num_banks")) {
+    l2cache_.num_banks = MIN(this->l2_num_reqs(), 16);
+  }
+  if (derived("l2cache.mem_ports")) {
+    l2cache_.mem_ports = MIN(l2cache_.enabled ? l2cache_.num_banks : this->l2_num_reqs(), dram_.num_banks);
+  }
+  if (derived("l3cache.num_banks")) {
+    l3cache_.num_banks = MIN(this->l3_num_reqs(), 16);
+  }
+  if (derived("l3cache.mem_ports")) {
+    l3cache_.mem_ports = MIN(l3cache_.enabled ? l3cache_.num_banks : this->l3_num_reqs(), dram_.num_banks);
+  }
+}
+
+static bool parse_number(const std::string& str, uint64_t* value) {
+  if (str.empty())
+    return false;
+  char* end;
+  *value = strtoull(str.c_str(), &end, 0);
+  return (*end == '\0');
+}
+
+static bool parse_bool(const std::string& str, bool* value) {
+  if (str == "true") {
+    *value = true;
+    return true;
+  }
+  if (str == "false") {
+    *value = false;
+    return true;
+  }
+  uint64_t number;
+  if (!parse_number(str, &number) || number > 1)
+    return false;
+  *value = (number != 0);
+  return true;
+}
+
+static bool parse_policy(const std::string& str, ReplPolicy* value) {
+  static const ReplPolicy policies[] = {
+    ReplPolicy::Random, ReplPolicy::FIFO, ReplPolicy::PLRU,
+    ReplPolicy::LRU, ReplPolicy::SRRIP, ReplPolicy::BRRIP
+  };
+  for (auto policy : policies) {
+    std::ostringstream name;
+    name << policy;
+    if (str == name.str()) {
+      *value = policy;
+      return true;
+    }
+  }
+  uint64_t number;
+  if (!parse_number(str, &number) || number > uint64_t(ReplPolicy::BRRIP))
+    return false;
+  *value = ReplPolicy(number);
+  return true;
+}
+
+static bool parse_model(const std::string& str, DramModel* value) {
+  static const DramModel models[] = {
+    DramModel::Ramulator, DramModel::Simple
+  };
+  for (auto model : models) {
+    std::ostringstream name;
+    name << model;
+    if (str == name.str()) {
+      *value = model;
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool parse_standard(const std::string& str, DramStandard* value) {
+  static const DramStandard standards[] = {
+    DramStandard::DDR4, DramStandard::DDR5, DramStandard::HBM2,
+    DramStandard::HBM3, DramStandard::LPDDR5
+  };
+  for (auto standard : standards) {
+    std::ostringstream name;
+    name << standard;
+    if (str == name.str()) {
+      *value = standard;
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool parse_ratio(const std::string& str, float* value) {
+  if (str.empty())
+    return false;
+  char* end;
+  *value = strtof(str.c_str(), &end);
+  return (*end == '\0' && *value > 0);
+}
+
+int Arch::set(const std::string& key, const std::string& value) {
+  uint32_t* field = nullptr;
+  bool* flag = nullptr;
+  ReplPolicy* policy = nullptr;
+  std::string* text = nullptr;
+
+  auto pos = key.find('.');
+  if (key == "dram.clock_ratio") {
+    if (!parse_ratio(value, &dram_.clock_ratio))
+      return -1;
+    overrides_.insert(key);
+    this->update();
+    return 0;
+  } else if (key == "dram.model") {
+    if (!parse_model(value, &dram_.model))
+      return -1;
+    overrides_.insert(key);
+    return 0;
+  } else if (key == "dram.standard") {
+    if (!parse_standard(value, &dram_.ramulator.standard))
+      return -1;
+    overrides_.insert(key);
+    return 0;
+  } else if (key == "dram.org_preset") {
+    text = &dram_.ramulator.org_preset;
+  } else if (key == "dram.timing_preset") {
+    text = &dram_.ramulator.timing_preset;
+  } else if (key == "dram.addr_mapping") {
+    text = &dram_.ramulator.addr_mapping;
+  } else if (key == "dram.scheduler") {
+    text = &dram_.ramulator.scheduler;
+  } else if (key == "dram.trace") {
+    text = &dram_.ramulator.trace;
+  } else if (key == "dram.num_banks") {
+    field = &dram_.num_banks;
+  } else if (key == "dram.num_ranks") {
+    field = &dram_.ramulator.num_ranks;
+  } else if (key == "dram.latency") {
+    field = &dram_.timing.latency;
+  } else if (key == "dram.row_banks") {
+    field = &dram_.timing.num_banks;
+  } else if (key == "dram.row_size") {
+    field = &dram_.timing.row_size;
+  } else if (key == "dram.tcl") {
+    field = &dram_.timing.tCL;
+  } else if (key == "dram.trcd") {
+    field = &dram_.timing.tRCD;
+  } else if (key == "dram.trp") {
+    field = &dram_.timing.tRP;
+  } else if (key == "dram.bus_width") {
+    field = &dram_.timing.bus_width;
+  } else if (pos != std::string::npos) {
+    auto level = key.substr(0, pos);
+    auto param = key.substr(pos + 1);
+    CacheArch* cache;
+    if (level == "icache") {
+      cache = &icache_;
+    } else if (level == "dcache") {
+      cache = &dcache_;
+    } else if (level == "l2cache") {
+      cache = &l2cache_;
+    } else if (level == "l3cache") {
+      cache = &l3cache_;
+    } else {
+      return -1;
+    }
+    bool is_l1 = (cache == &icache_ || cache == &dcache_);
+    if (param == "enabled") {
+      flag = &cache->enabled;
+    } else if (param == "num_caches" && is_l1) {
+      field = &cache->num_caches;
+    } else if (param == "size") {
+      field = &cache->size;
+    } else if (param == "num_ways") {
+      field = &cache->num_ways;
+    } else if (param == "num_banks" && cache != &icache_) {
+      field = &cache->num_banks;
+    } else if (param == "mshr_size") {
+      field = &cache->mshr_size;
+    } else if (param == "writeback" && cache != &icache_) {
+      flag = &cache->writeback;
+    } else if (param == "mem_ports") {
+      field = &cache->mem_ports;
+    } else if (param == "repl_policy") {
+      policy = &cache->repl_policy;
+    } else if (param == "prefetch.next_line") {
+      flag = &cache->prefetch.next_line;
+    } else if (param == "prefetch.stride") {
+      flag = &cache->prefetch.stride;
+    } else if (param == "prefetch.stream") {
+      flag = &cache->prefetch.stream;
+    } else if (param == "prefetch.degree") {
+      field = &cache->prefetch.degree;
+    } else if (param == "prefetch.queue_size") {
+      field = &cache->prefetch.queue_size;
+    } else if (param == "prefetch.mshr_limit") {
+      field = &cache->prefetch.mshr_limit;
+    } else if (param == "prefetch.protect_demand") {
+      flag = &cache->prefetch.protect_demand;
+    } else {
+      return -1;
+    }
+  } else if (key == "num_threads") {
+    field = &num_threads_;
+  } else if (key == "num_warps") {
+    field = &num_warps_;
+  } else if (key == "num_cores") {
+    field = &num_cores_;
+  } else if (key == "num_clusters") {
+    field = &num_clusters_;
+  } else if (key == "socket_size") {
+    field = &socket_size_;
+  } else if (key == "num_barriers") {
+    field = &num_barriers_;
+  } else if (key == "issue_width") {
+    field = &issue_width_;
+  } else if (key == "num_opcs") {
+    field = &num_opcs_;
+  } else if (key == "num_alu_blocks") {
+    field = &num_alu_blocks_;
+  } else if (key == "num_fpu_blocks") {
+    field = &num_fpu_blocks_;
+  } else if (key == "num_lsu_blocks") {
+    field = &num_lsu_blocks_;
+  } else if (key == "num_vpu_blocks") {
+    field = &num_vpu_blocks_;
+  } else if (key == "num_tcu_blocks") {
+    field = &num_tcu_blocks_;
+  } else {
+    return -1;
+  }
+
+  if (field) {
+    uint64_t number;
+    if (!parse_number(value, &number) || number == 0 || number > 0xffffffff)
+      return -1;
+    *field = number;
+  } else if (policy) {
+    if (!parse_policy(value, policy))
+      return -1;
+  } else if (text) {
+    *text = value;
+  } else {
+    if (!parse_bool(value, flag))
+      return -1;
+  }
+
+  overrides_.insert(key);
+  this->update();
+  return 0;
+}
+
+int Arch::set(const std::string& param) {
+  auto pos = param.find('=');
+  if (pos == std::string::npos)
+    return -1;
+  return this->set(param.substr(0, pos), param.substr(pos + 1));
+}
+
+static int load_json(Arch* arch, const std::string& prefix, const nlohmann::json& obj) {
+  for (auto& item : obj.items()) {
+    auto key = prefix + item.key();
+    auto& value = item.value();
+    int err;
+    if (value.is_object()) {
+      err = load_json(arch, key + ".", value);
+    } else if (value.is_boolean()) {
+      err = arch->set(key, value.get<bool>() ? "true" : "false");
+    } else if (value.is_number_unsigned()) {
+      err = arch->set(key, std::to_string(value.get<uint64_t>()));
+    } else if (value.is_number_float()) {
+      err = arch->set(key, std::to_string(value.get<double>()));
+    } else if (value.is_string()) {
+      err = arch->set(key, value.get<std::string>());
+    } else {
+      err = -1;
+    }
+    if (err != 0) {
+      std::cerr << "Error: invalid architecture parameter: " << key << "=" << value << std::endl;
+      return err;
+    }
+  }
+  return 0;
+}
+
+int Arch::load(const char* filename) {
+  std::ifstream ifs(filename);
+  if (!ifs) {
+    std::cerr << "Error: failed to open " << filename << std::endl;
+    return -1;
+  }
+  auto json = nlohmann::json::parse(ifs, nullptr, false);
+  if (json.is_discarded() || !json.is_object()) {
+    std::cerr << "Error: invalid architecture file " << filename << std::endl;
+    return -1;
+  }
+  return load_json(this, "", json);
+}
+
+int Arch::validate() const {
+  auto check = [](bool cond, const char* msg) {
+    if (!cond) {
+      std::cerr << "Error: invalid architecture: " << msg << std::endl;
+    }
+    return cond;
+  };
+  auto check_cache = [&](const CacheArch& cache, const char* name, uint32_t num_inputs) {
+    if (!check(ispow2(cache.size) && ispow2(cache.num_ways) && ispow2(cache.num_banks), name))
+      return false;
+    if (!check(cache.mem_ports <= (cache.enabled ? cache.num_banks : num_inputs), name))
+      return false;
+    if (!check(cache.prefetch.mshr_limit <= 100, name))
+      return false;
+    return true;
+  };
+  if (!check(num_warps_ <= MAX_NUM_WARPS, "num_warps")
+   || !check(num_cores_ * num_clusters_ <= MAX_NUM_CORES, "num_cores")
+   || !check(socket_size_ <= num_cores_, "socket_size")
+   || !check(num_threads_ % NUM_ALU_LANES == 0, "num_threads")
+   || !check(num_warps_ % issue_width_ == 0, "issue_width")
+   || !check(num_opcs_ <= this->per_issue_warps(), "num_opcs")
+   || !check(issue_width_ % num_alu_blocks_ == 0, "num_alu_blocks")
+   || !check(issue_width_ % num_fpu_blocks_ == 0, "num_fpu_blocks")
+   || !check(issue_width_ % num_lsu_blocks_ == 0, "num_lsu_blocks")
+   || !check(issue_width_ % num_vpu_blocks_ == 0, "num_vpu_blocks")
+   || !check(issue_width_ % num_tcu_blocks_ == 0, "num_tcu_blocks")
+   || !check(icache_.mem_ports <= dcache_.mem_ports, "icache.mem_ports")
+   || !check(ispow2(dram_.num_banks), "dram.num_banks")
+   || !check(ispow2(dram_.ramulator.num_ranks), "dram.num_ranks")
+   || !check(!dram_.ramulator.addr_mapping.empty(), "dram.addr_mapping")
+   || !check(!dram_.ramulator.scheduler.empty(), "dram.scheduler")
+   || !check(ispow2(dram_.timing.num_banks), "dram.row_banks")
+   || !check(ispow2(dram_.timing.row_size), "dram.row_size")
+   || !check_cache(icache_, "icache", 1)
+   || !check_cache(dcache_, "dcache", this->dcache_num_reqs())
+   || !check_cache(l2cache_, "l2cache", this->l2_num_reqs())
+   || !check_cache(l3cache_, "l3cache", this->l3_num_reqs()))
+    return -1;
+  return 0;
+}
+
+void Arch::dump(std::ostream& os) const {
+  auto dump_cache = [&](const char* name, const CacheArch& cache) {
+    os << ", " << name << "={enabled=" << cache.enabled
+       << ", size=" << cache.size
+       << ", ways=" << cache.num_ways
+       << ", banks=" << cache.num_banks
+       << ", mshr=" << cache.mshr_size
+       << ", repl=" << cache.repl_policy
+       << ", mem_ports=" << cache.mem_ports;
+    if (cache.prefetch.enabled()) {
+      os << ", prefetch={next_line=" << cache.prefetch.next_line
+         << ", stride=" << cache.prefetch.stride
+         << ", stream=" << cache.prefetch.stream
+         << ", degree=" << cache.prefetch.degree << "}";
+    }
+    os << "}";
+  };
+  os << "CONFIGS:"
+     << " num_threads=" << num_threads_
+     << ", num_warps=" << num_warps_
+     << ", num_cores=" << num_cores_
+     << ", num_clusters=" << num_clusters_
+     << ", socket_size=" << socket_size_
+     << ", local_mem_base=0x" << std::hex << local_mem_base_ << std::dec
+     << ", num_barriers=" << num_barriers_
+     << ", issue_width=" << issue_width_
+     << ", alu_blocks=" << num_alu_blocks_
+     << ", fpu_blocks=" << num_fpu_blocks_
+     << ", lsu_blocks=" << num_lsu_blocks_;
+  dump_cache("icache", icache_);
+  dump_cache("dcache", dcache_);
+  dump_cache("l2cache", l2cache_);
+  dump_cache("l3cache", l3cache_);
+  os << ", dram={banks=" << dram_.num_banks
+     << ", clock_ratio=" << dram_.clock_ratio
+     << ", model=" << dram_.model;
+  if (dram_.model == DramModel::Simple) {
+    os << ", latency=" << dram_.timing.latency
+       << ", row_banks=" << dram_.timing.num_banks
+       << ", row_size=" << dram_.timing.row_size
+       << ", tCL=" << dram_.timing.tCL
+       << ", tRCD=" << dram_.timing.tRCD
+       << ", tRP=" << dram_.timing.tRP
+       << ", bus_width=" << dram_.timing.bus_width;
+  } else {
+    auto& ramulator = dram_.ramulator;
+    os << ", standard=" << ramulator.standard
+       << ", ranks=" << ramulator.num_ranks;
+    if (!ramulator.org_preset.empty()) {
+      os << ", org=" << ramulator.org_preset;
+    }
+    if (!ramulator.timing_preset.empty()) {
+      os << ", timing=" << ramulator.timing_preset;
+    }
+    os << ", mapping=" << ramulator.addr_mapping
+       << ", scheduler=" << ramulator.scheduler;
+    if (!ramulator.trace.empty()) {
+      os << ", trace=" << ramulator.trace;
+    }
+  }
+  os << "}";
+  os << std::endl;
+}
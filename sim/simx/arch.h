@@ -15,33 +15,88 @@
 
 #include <string>
 #include <sstream>
+#include <unordered_set>
 
 #include <cstdlib>
 #include <stdio.h>
+#include <dram_sim.h>
 #include "types.h"
 
 namespace vortex {
 
+// Cache hierarchy level parameters
+struct CacheArch {
+  bool     enabled;
+  uint32_t num_caches;  // instances per socket (L1 only)
+  uint32_t size;
+  uint32_t num_ways;
+  uint32_t num_banks;
+  uint32_t mshr_size;
+  bool     writeback;
+  uint32_t mem_ports;
+  ReplPolicy repl_policy;
+  PrefetchConfig prefetch;
+};
+
+// Main memory parameters
+struct DramArch {
+  uint32_t   num_banks;   // memory channels
+  float      clock_ratio; // memory clock / core clock
+  DramModel  model;
+  DramTiming timing;      // analytical model parameters
+  RamulatorConfig ramulator; // Ramulator model parameters
+};
+
+// Processor configuration.
+// All parameters default to the compile-time values from VX_config.h and can
+// be overridden at runtime with set() or load(). Parameters that are derived
+// in VX_config.h (socket size, issue width, functional unit blocks, cache
+// banks and memory ports) follow the same rules from the overridden values,
+// unless they are overridden themselves.
 class Arch {
 private:
-  uint16_t num_threads_;
-  uint16_t num_warps_;
-  uint16_t num_cores_;
-  uint16_t num_clusters_;
-  uint16_t socket_size_;
-  uint16_t num_barriers_;
+  uint32_t num_threads_;
+  uint32_t num_warps_;
+  uint32_t num_cores_;
+  uint32_t num_clusters_;
+  uint32_t socket_size_;
+  uint32_t num_barriers_;
   uint64_t local_mem_base_;
+  uint32_t issue_width_;
+  uint32_t num_opcs_;
+  uint32_t num_alu_blocks_;
+  uint32_t num_fpu_blocks_;
+  uint32_t num_lsu_blocks_;
+  uint32_t num_sfu_blocks_;
+  uint32_t num_vpu_blocks_;
+  uint32_t num_tcu_blocks_;
+  CacheArch icache_;
+  CacheArch dcache_;
+  CacheArch l2cache_;
+  CacheArch l3cache_;
+  DramArch  dram_;
+  std::unordered_set<std::string> overrides_;
+
+  void update();
 
 public:
-  Arch(uint16_t num_threads, uint16_t num_warps, uint16_t num_cores)   
-    : num_threads_(num_threads)
-    , num_warps_(num_warps)
-    , num_cores_(num_cores)
-    , num_clusters_(NUM_CLUSTERS)
-    , socket_size_(SOCKET_SIZE)
-    , num_barriers_(NUM_BARRIERS)
-    , local_mem_base_(LMEM_BASE_ADDR)
-  {}
+  Arch(uint16_t num_threads, uint16_t num_warps, uint16_t num_cores);
+
+  // override a parameter, e.g. "num_cores=4" or "dcache.size=32768"
+  // returns 0 on success
+  int set(const std::string& key, const std::string& value);
+
+  // parse a "<key>=<value>" parameter, returns 0 on success
+  int set(const std::string& param);
+
+  // load parameters from a JSON file, nested objects map to dotted keys
+  // returns 0 on success
+  int load(const char* filename);
+
+  // check the configuration consistency, returns 0 on success
+  int validate() const;
+
+  void dump(std::ostream& os) const;
 
   uint16_t num_barriers() const {
     return num_barriers_;
@@ -71,6 +126,80 @@ public:
     return socket_size_;
   }
 
+  uint32_t num_sockets() const {
+    return (num_cores_ + socket_size_ - 1) / socket_size_;
+  }
+
+  uint32_t issue_width() const {
+    return issue_width_;
+  }
+
+  uint32_t per_issue_warps() const {
+    return num_warps_ / issue_width_;
+  }
+
+  uint32_t num_opcs() const {
+    return num_opcs_;
+  }
+
+  uint32_t num_alu_blocks() const {
+    return num_alu_blocks_;
+  }
+
+  uint32_t num_fpu_blocks() const {
+    return num_fpu_blocks_;
+  }
+
+  uint32_t num_lsu_blocks() const {
+    return num_lsu_blocks_;
+  }
+
+  uint32_t num_sfu_blocks() const {
+    return num_sfu_blocks_;
+  }
+
+  uint32_t num_vpu_blocks() const {
+    return num_vpu_blocks_;
+  }
+
+  uint32_t num_tcu_blocks() const {
+    return num_tcu_blocks_;
+  }
+
+  const CacheArch& icache() const {
+    return icache_;
+  }
+
+  const CacheArch& dcache() const {
+    return dcache_;
+  }
+
+  const CacheArch& l2cache() const {
+    return l2cache_;
+  }
+
+  const CacheArch& l3cache() const {
+    return l3cache_;
+  }
+
+  const DramArch& dram() const {
+    return dram_;
+  }
+
+  // dcache inputs per core
+  uint32_t dcache_num_reqs() const {
+    return num_lsu_blocks_ * DCACHE_CHANNELS;
+  }
+
+  // l2cache inputs per cluster
+  uint32_t l2_num_reqs() const {
+    return this->num_sockets() * dcache_.mem_ports;
+  }
+
+  // l3cache inputs
+  uint32_t l3_num_reqs() const {
+    return num_clusters_ * l2cache_.mem_ports;
+  }
 };
 
-}
\ No newline at end of file
+}
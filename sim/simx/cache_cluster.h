@@ -34,7 +34,8 @@ public:
 		, CoreRspPorts(num_inputs, std::vector<SimPort<MemRsp>>(cache_config.num_inputs, this))
 		, MemReqPorts(cache_config.mem_ports, this)
 		, MemRspPorts(cache_config.mem_ports, this)
-		, caches_(MAX(num_units, 0x1)) {
+		, caches_(MAX(num_units, 0x1))
+		, lg2_inputs_per_unit_(log2ceil(num_inputs / MAX(num_units, 0x1))) {
 
 		CacheSim::Config cache_config2(cache_config);
 		if (0 == num_units) {
@@ -87,6 +88,27 @@ public:
 
 	void tick() {}
 
+	bool idle() const {
+		return true;
+	}
+
+	// warm the cache unit serving the given input
+	bool warm(uint32_t input, uint64_t addr, bool* write) {
+		return caches_.at(input >> lg2_inputs_per_unit_)->warm(addr, write);
+	}
+
+	void save(CheckpointWriter& ckpt) const {
+		for (auto cache : caches_) {
+			cache->save(ckpt);
+		}
+	}
+
+	void restore(CheckpointReader& ckpt) {
+		for (auto cache : caches_) {
+			cache->restore(ckpt);
+		}
+	}
+
 	CacheSim::PerfStats perf_stats() const {
 		CacheSim::PerfStats perf;
 		for (auto cache : caches_) {
@@ -97,6 +119,7 @@ public:
 
 private:
   std::vector<CacheSim::Ptr> caches_;
+  uint32_t lg2_inputs_per_unit_;
 };
 
 }
@@ -19,6 +19,8 @@
 #include <vector>
 #include <list>
 #include <queue>
+#include <deque>
+#include <algorithm>
 
 using namespace vortex;
 
@@ -102,65 +104,603 @@ struct params_t {
 	}
 };
 
-struct line_t {
-	uint64_t tag;
-	uint32_t lru_ctr;
-	bool     valid;
-	bool     dirty;
+// Tag storage of a cache bank.
+// The tags of a set are packed in one contiguous array and the valid, dirty
+// and prefetched bits are kept as per-set way masks, so that a lookup is a
+// branch-free compare over the whole set that the compiler can vectorize.
+// The prefetched bit marks lines filled by a prefetch and not yet accessed.
+class TagArray {
+public:
+	TagArray(uint32_t num_sets, uint32_t num_ways)
+		: num_ways_(num_ways)
+		, ways_mask_((num_ways < 64) ? ((uint64_t(1) << num_ways) - 1) : ~uint64_t(0))
+		, tags_(num_sets * num_ways)
+		, valid_(num_sets)
+		, dirty_(num_sets)
+		, prefetched_(num_sets)
+	{
+		assert(num_ways <= 64);
+		this->reset();
+	}
 
 	void reset() {
-		valid = false;
-		dirty = false;
+		std::fill(valid_.begin(), valid_.end(), 0);
+		std::fill(dirty_.begin(), dirty_.end(), 0);
+		std::fill(prefetched_.begin(), prefetched_.end(), 0);
+	}
+
+	// returns the hit way, or -1 on a miss
+	int lookup(uint32_t set_id, uint64_t tag) const {
+		auto tags = tags_.data() + set_id * num_ways_;
+		uint64_t matches = 0;
+		for (uint32_t i = 0; i < num_ways_; ++i) {
+			matches |= uint64_t(tags[i] == tag) << i;
+		}
+		matches &= valid_[set_id];
+		return matches ? count_trailing_zeros(matches) : -1;
+	}
+
+	// returns the first invalid way, or -1 if the set is full
+	int free_way(uint32_t set_id) const {
+		uint64_t free_ways = ~valid_[set_id] & ways_mask_;
+		return free_ways ? count_trailing_zeros(free_ways) : -1;
+	}
+
+	uint64_t tag(uint32_t set_id, uint32_t way) const {
+		return tags_[set_id * num_ways_ + way];
+	}
+
+	bool dirty(uint32_t set_id, uint32_t way) const {
+		return (dirty_[set_id] >> way) & 1;
+	}
+
+	void set_dirty(uint32_t set_id, uint32_t way) {
+		dirty_[set_id] |= (uint64_t(1) << way);
+	}
+
+	bool prefetched(uint32_t set_id, uint32_t way) const {
+		return (prefetched_[set_id] >> way) & 1;
+	}
+
+	void clear_prefetched(uint32_t set_id, uint32_t way) {
+		prefetched_[set_id] &= ~(uint64_t(1) << way);
+	}
+
+	void fill(uint32_t set_id, uint32_t way, uint64_t tag, bool dirty, bool prefetched) {
+		uint64_t mask = uint64_t(1) << way;
+		tags_[set_id * num_ways_ + way] = tag;
+		valid_[set_id] |= mask;
+		dirty_[set_id] = dirty ? (dirty_[set_id] | mask) : (dirty_[set_id] & ~mask);
+		prefetched_[set_id] = prefetched ? (prefetched_[set_id] | mask) : (prefetched_[set_id] & ~mask);
 	}
+
+	void save(CheckpointWriter& ckpt) const {
+		ckpt.write_vector(tags_);
+		ckpt.write_vector(valid_);
+		ckpt.write_vector(dirty_);
+		ckpt.write_vector(prefetched_);
+	}
+
+	void restore(CheckpointReader& ckpt) {
+		auto num_lines = tags_.size();
+		ckpt.read_vector(&tags_);
+		ckpt.read_vector(&valid_);
+		ckpt.read_vector(&dirty_);
+		ckpt.read_vector(&prefetched_);
+		if (tags_.size() != num_lines
+		 || valid_.size() != dirty_.size()
+		 || valid_.size() != prefetched_.size())
+			throw std::runtime_error("checkpoint configuration mismatch: cache lines");
+	}
+
+private:
+	uint32_t num_ways_;
+	uint64_t ways_mask_;
+	std::vector<uint64_t> tags_;
+	std::vector<uint64_t> valid_;
+	std::vector<uint64_t> dirty_;
+	std::vector<uint64_t> prefetched_;
 };
 
-struct set_t {
-	std::vector<line_t> lines;
+///////////////////////////////////////////////////////////////////////////////
 
-	set_t(uint32_t num_ways)
-		: lines(num_ways)
+// Replacement policy of a cache bank.
+// Invalid ways are always filled first; victim() is only called on full sets.
+class IReplPolicy {
+public:
+	virtual ~IReplPolicy() {}
+	virtual void reset() = 0;
+	// access to a resident line
+	virtual void hit(uint32_t set_id, uint32_t way) = 0;
+	// insertion of a new line
+	virtual void fill(uint32_t set_id, uint32_t way) = 0;
+	// select the line to replace
+	virtual uint32_t victim(uint32_t set_id) = 0;
+	virtual void save(CheckpointWriter& ckpt) const = 0;
+	virtual void restore(CheckpointReader& ckpt) = 0;
+};
+
+// pseudo-random victim (xorshift), reproducible across runs
+class RandomRepl : public IReplPolicy {
+public:
+	RandomRepl(uint32_t num_ways) : num_ways_(num_ways) {
+		this->reset();
+	}
+	void reset() override {
+		state_ = 0x9e3779b97f4a7c15ull;
+	}
+	void hit(uint32_t, uint32_t) override {}
+	void fill(uint32_t, uint32_t) override {}
+	uint32_t victim(uint32_t) override {
+		state_ ^= state_ << 13;
+		state_ ^= state_ >> 7;
+		state_ ^= state_ << 17;
+		return state_ & (num_ways_ - 1);
+	}
+	void save(CheckpointWriter& ckpt) const override {
+		ckpt.write(state_);
+	}
+	void restore(CheckpointReader& ckpt) override {
+		state_ = ckpt.read<uint64_t>();
+	}
+private:
+	uint32_t num_ways_;
+	uint64_t state_;
+};
+
+// round-robin victim per set, as in the RTL
+class FifoRepl : public IReplPolicy {
+public:
+	FifoRepl(uint32_t num_sets, uint32_t num_ways)
+		: num_ways_(num_ways)
+		, next_(num_sets)
 	{}
+	void reset() override {
+		std::fill(next_.begin(), next_.end(), 0);
+	}
+	void hit(uint32_t, uint32_t) override {}
+	void fill(uint32_t, uint32_t) override {}
+	uint32_t victim(uint32_t set_id) override {
+		auto& next = next_.at(set_id);
+		uint32_t way = next;
+		next = (next + 1) & (num_ways_ - 1);
+		return way;
+	}
+	void save(CheckpointWriter& ckpt) const override {
+		ckpt.write_vector(next_);
+	}
+	void restore(CheckpointReader& ckpt) override {
+		ckpt.read_vector(&next_);
+	}
+private:
+	uint32_t num_ways_;
+	std::vector<uint8_t> next_;
+};
 
-	void reset() {
-		for (auto& line : lines) {
-			line.reset();
+// tree pseudo-LRU, as in the RTL: one bit per tree node pointing away from
+// the most recently used half
+class PlruRepl : public IReplPolicy {
+public:
+	PlruRepl(uint32_t num_sets, uint32_t num_ways)
+		: log2_ways_(log2ceil(num_ways))
+		, trees_(num_sets)
+	{}
+	void reset() override {
+		std::fill(trees_.begin(), trees_.end(), 0);
+	}
+	void hit(uint32_t set_id, uint32_t way) override {
+		this->touch(set_id, way);
+	}
+	void fill(uint32_t set_id, uint32_t way) override {
+		this->touch(set_id, way);
+	}
+	uint32_t victim(uint32_t set_id) override {
+		auto tree = trees_.at(set_id);
+		uint32_t node = 0;
+		uint32_t way = 0;
+		for (uint32_t level = 0; level < log2_ways_; ++level) {
+			uint32_t dir = (tree >> node) & 1;
+			way = (way << 1) | dir;
+			node = 2 * node + 1 + dir;
+		}
+		return way;
+	}
+	void save(CheckpointWriter& ckpt) const override {
+		ckpt.write_vector(trees_);
+	}
+	void restore(CheckpointReader& ckpt) override {
+		ckpt.read_vector(&trees_);
+	}
+private:
+	void touch(uint32_t set_id, uint32_t way) {
+		auto& tree = trees_.at(set_id);
+		uint32_t node = 0;
+		for (int level = log2_ways_ - 1; level >= 0; --level) {
+			uint32_t dir = (way >> level) & 1;
+			// point to the other half
+			tree = dir ? (tree & ~(uint64_t(1) << node)) : (tree | (uint64_t(1) << node));
+			node = 2 * node + 1 + dir;
+		}
+	}
+	uint32_t log2_ways_;
+	std::vector<uint64_t> trees_;
+};
+
+// true LRU using per-line access stamps
+class LruRepl : public IReplPolicy {
+public:
+	LruRepl(uint32_t num_sets, uint32_t num_ways)
+		: num_ways_(num_ways)
+		, stamps_(num_sets * num_ways)
+	{}
+	void reset() override {
+		std::fill(stamps_.begin(), stamps_.end(), 0);
+		clock_ = 0;
+	}
+	void hit(uint32_t set_id, uint32_t way) override {
+		stamps_.at(set_id * num_ways_ + way) = ++clock_;
+	}
+	void fill(uint32_t set_id, uint32_t way) override {
+		stamps_.at(set_id * num_ways_ + way) = ++clock_;
+	}
+	uint32_t victim(uint32_t set_id) override {
+		auto stamps = stamps_.data() + set_id * num_ways_;
+		uint32_t way = 0;
+		for (uint32_t i = 1; i < num_ways_; ++i) {
+			if (stamps[i] < stamps[way])
+				way = i;
+		}
+		return way;
+	}
+	void save(CheckpointWriter& ckpt) const override {
+		ckpt.write_vector(stamps_);
+		ckpt.write(clock_);
+	}
+	void restore(CheckpointReader& ckpt) override {
+		ckpt.read_vector(&stamps_);
+		clock_ = ckpt.read<uint64_t>();
+	}
+private:
+	uint32_t num_ways_;
+	std::vector<uint64_t> stamps_;
+	uint64_t clock_;
+};
+
+// re-reference interval prediction with 2-bit RRPVs (Jaleel et al., ISCA'10).
+// SRRIP inserts lines with a long re-reference interval; BRRIP inserts them
+// with a distant one, except for one fill out of BRRIP_PERIOD.
+class RripRepl : public IReplPolicy {
+public:
+	static constexpr uint8_t  RRPV_MAX     = 3;
+	static constexpr uint32_t BRRIP_PERIOD = 32;
+
+	RripRepl(uint32_t num_sets, uint32_t num_ways, bool bimodal)
+		: num_ways_(num_ways)
+		, bimodal_(bimodal)
+		, rrpvs_(num_sets * num_ways)
+	{}
+	void reset() override {
+		std::fill(rrpvs_.begin(), rrpvs_.end(), RRPV_MAX);
+		fills_ = 0;
+	}
+	void hit(uint32_t set_id, uint32_t way) override {
+		rrpvs_.at(set_id * num_ways_ + way) = 0;
+	}
+	void fill(uint32_t set_id, uint32_t way) override {
+		bool distant = bimodal_ && (++fills_ % BRRIP_PERIOD) != 0;
+		rrpvs_.at(set_id * num_ways_ + way) = distant ? RRPV_MAX : (RRPV_MAX - 1);
+	}
+	uint32_t victim(uint32_t set_id) override {
+		auto rrpvs = rrpvs_.data() + set_id * num_ways_;
+		// age the set until a line reaches the distant interval
+		uint8_t max_rrpv = 0;
+		for (uint32_t i = 0; i < num_ways_; ++i) {
+			max_rrpv = std::max(max_rrpv, rrpvs[i]);
+		}
+		uint8_t age = RRPV_MAX - max_rrpv;
+		uint32_t way = num_ways_;
+		for (uint32_t i = 0; i < num_ways_; ++i) {
+			rrpvs[i] += age;
+			if (way == num_ways_ && rrpvs[i] == RRPV_MAX)
+				way = i;
+		}
+		return way;
+	}
+	void save(CheckpointWriter& ckpt) const override {
+		ckpt.write_vector(rrpvs_);
+		ckpt.write(fills_);
+	}
+	void restore(CheckpointReader& ckpt) override {
+		ckpt.read_vector(&rrpvs_);
+		fills_ = ckpt.read<uint32_t>();
+	}
+private:
+	uint32_t num_ways_;
+	bool bimodal_;
+	std::vector<uint8_t> rrpvs_;
+	uint32_t fills_;
+};
+
+static IReplPolicy* create_repl_policy(ReplPolicy policy, uint32_t num_sets, uint32_t num_ways) {
+	switch (policy) {
+	case ReplPolicy::Random: return new RandomRepl(num_ways);
+	case ReplPolicy::FIFO:   return new FifoRepl(num_sets, num_ways);
+	case ReplPolicy::PLRU:   return new PlruRepl(num_sets, num_ways);
+	case ReplPolicy::LRU:    return new LruRepl(num_sets, num_ways);
+	case ReplPolicy::SRRIP:  return new RripRepl(num_sets, num_ways, false);
+	case ReplPolicy::BRRIP:  return new RripRepl(num_sets, num_ways, true);
+	default:
+		std::abort();
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Prefetch engine of a cache.
+// Engines are trained with the demand accesses of all the cache banks, in
+// line address units, and push the lines to prefetch into their own queue.
+// A trigger is a demand miss or the first hit on a prefetched line.
+// Prefetches do not cross page boundaries, and when the queue is full the
+// oldest request is dropped since it is the most likely to be late.
+class IPrefetchEngine {
+public:
+	IPrefetchEngine(const PrefetchConfig& config, uint32_t page_lines_log2)
+		: degree_(config.degree)
+		, queue_size_(config.queue_size)
+		, page_lines_log2_(page_lines_log2)
+	{}
+	virtual ~IPrefetchEngine() {}
+	virtual void reset() {
+		queue_.clear();
+	}
+	virtual void train(uint64_t line, uint64_t pc, bool trigger) = 0;
+	bool empty() const {
+		return queue_.empty();
+	}
+	uint64_t front() const {
+		return queue_.front();
+	}
+	void pop() {
+		queue_.pop_front();
+	}
+protected:
+	void push(uint64_t line, uint64_t trigger_line) {
+		if ((line >> page_lines_log2_) != (trigger_line >> page_lines_log2_))
+			return;
+		if (std::find(queue_.begin(), queue_.end(), line) != queue_.end())
+			return;
+		if (queue_.size() == queue_size_) {
+			queue_.pop_front();
 		}
+		queue_.push_back(line);
 	}
+	uint32_t degree_;
+private:
+	uint32_t queue_size_;
+	uint32_t page_lines_log2_;
+	std::deque<uint64_t> queue_;
+};
 
-	int tag_lookup(uint64_t tag, int* free_line_id, int* repl_line_id) {
-		uint32_t max_cnt = 0;
-		int hit_line_id = -1;
-		*free_line_id = -1;
-		*repl_line_id = -1;
-		for (uint32_t i = 0, n = lines.size(); i < n; ++i) {
-			auto& line = lines.at(i);
-			if (max_cnt < line.lru_ctr) {
-				max_cnt = line.lru_ctr;
-				*repl_line_id = i;
+// prefetch the lines following a trigger
+class NextLinePrefetcher : public IPrefetchEngine {
+public:
+	using IPrefetchEngine::IPrefetchEngine;
+	void train(uint64_t line, uint64_t, bool trigger) override {
+		if (!trigger)
+			return;
+		for (uint32_t i = 1; i <= degree_; ++i) {
+			this->push(line + i, line);
+		}
+	}
+};
+
+// reference prediction table indexed by PC (Chen & Baer, 1995): an entry
+// tracks the last line and stride of a load, and prefetches along the stride
+// once it has repeated. Accesses to the same line are ignored so that the
+// lanes of a warp do not reset the stride.
+class StridePrefetcher : public IPrefetchEngine {
+public:
+	static constexpr uint32_t TABLE_SIZE     = 64;
+	static constexpr uint8_t  CONF_MAX       = 3;
+	static constexpr uint8_t  CONF_THRESHOLD = 2;
+
+	StridePrefetcher(const PrefetchConfig& config, uint32_t page_lines_log2)
+		: IPrefetchEngine(config, page_lines_log2)
+		, table_(TABLE_SIZE)
+	{}
+	void reset() override {
+		IPrefetchEngine::reset();
+		for (auto& entry : table_) {
+			entry = entry_t();
+		}
+	}
+	void train(uint64_t line, uint64_t pc, bool) override {
+		if (pc == 0)
+			return; // no issuing instruction
+		auto& entry = table_.at((pc >> 2) % TABLE_SIZE);
+		if (!entry.valid || entry.pc != pc) {
+			entry.valid = true;
+			entry.pc = pc;
+			entry.last_line = line;
+			entry.stride = 0;
+			entry.confidence = 0;
+			return;
+		}
+		int64_t stride = int64_t(line - entry.last_line);
+		if (stride == 0)
+			return;
+		if (stride == entry.stride) {
+			if (entry.confidence < CONF_MAX)
+				++entry.confidence;
+		} else if (entry.confidence != 0) {
+			--entry.confidence;
+		} else {
+			entry.stride = stride;
+		}
+		entry.last_line = line;
+		if (entry.confidence >= CONF_THRESHOLD) {
+			for (uint32_t i = 1; i <= degree_; ++i) {
+				this->push(line + entry.stride * i, line);
 			}
-			if (line.valid) {
-				if (line.tag == tag) {
-					hit_line_id = i;
-					line.lru_ctr = 0;
-				} else {
-					++line.lru_ctr;
+		}
+	}
+private:
+	struct entry_t {
+		bool     valid = false;
+		uint64_t pc = 0;
+		uint64_t last_line = 0;
+		int64_t  stride = 0;
+		uint8_t  confidence = 0;
+	};
+	std::vector<entry_t> table_;
+};
+
+// stream buffer style detector: a trigger allocates a stream, and the next
+// trigger within WINDOW lines sets its direction; a stream that keeps its
+// direction prefetches ahead of the trigger.
+class StreamPrefetcher : public IPrefetchEngine {
+public:
+	static constexpr uint32_t NUM_STREAMS = 16;
+	static constexpr uint64_t WINDOW      = 16;
+
+	StreamPrefetcher(const PrefetchConfig& config, uint32_t page_lines_log2)
+		: IPrefetchEngine(config, page_lines_log2)
+		, streams_(NUM_STREAMS)
+		, clock_(0)
+	{}
+	void reset() override {
+		IPrefetchEngine::reset();
+		for (auto& stream : streams_) {
+			stream = stream_t();
+		}
+		clock_ = 0;
+	}
+	void train(uint64_t line, uint64_t, bool trigger) override {
+		if (!trigger)
+			return;
+		++clock_;
+		// find the closest stream
+		stream_t* match = nullptr;
+		uint64_t match_distance = WINDOW + 1;
+		for (auto& stream : streams_) {
+			if (!stream.valid)
+				continue;
+			uint64_t distance = (line > stream.last_line) ? (line - stream.last_line) : (stream.last_line - line);
+			if (distance < match_distance) {
+				match = &stream;
+				match_distance = distance;
+			}
+		}
+		if (match) {
+			match->lru = clock_;
+			if (match_distance == 0)
+				return;
+			int dir = (line > match->last_line) ? 1 : -1;
+			if (dir == match->dir) {
+				for (uint32_t i = 1; i <= degree_; ++i) {
+					this->push(line + dir * int64_t(i), line);
 				}
-			} else {
-				*free_line_id = i;
 			}
+			match->dir = dir;
+			match->last_line = line;
+			return;
 		}
-		return hit_line_id;
+		// allocate a new stream, replacing the least recently used one
+		auto victim = std::min_element(streams_.begin(), streams_.end(), [](const stream_t& a, const stream_t& b) {
+			return a.lru < b.lru;
+		});
+		victim->valid = true;
+		victim->last_line = line;
+		victim->dir = 0;
+		victim->lru = clock_;
 	}
+private:
+	struct stream_t {
+		bool     valid = false;
+		uint64_t last_line = 0;
+		int      dir = 0;
+		uint64_t lru = 0;
+	};
+	std::vector<stream_t> streams_;
+	uint64_t clock_;
 };
 
+// Prefetchers of a cache, shared by its banks
+class Prefetcher {
+public:
+	static constexpr uint32_t PAGE_SIZE_LOG2 = 12;
+
+	Prefetcher(SimObjectBase* owner, const PrefetchConfig& config, uint32_t log2_line_size)
+		: owner_(owner)
+		, line_size_log2_(log2_line_size)
+	{
+		uint32_t page_lines_log2 = (PAGE_SIZE_LOG2 > log2_line_size) ? (PAGE_SIZE_LOG2 - log2_line_size) : 0;
+		if (config.next_line) {
+			engines_.emplace_back(new NextLinePrefetcher(config, page_lines_log2));
+		}
+		if (config.stride) {
+			engines_.emplace_back(new StridePrefetcher(config, page_lines_log2));
+		}
+		if (config.stream) {
+			engines_.emplace_back(new StreamPrefetcher(config, page_lines_log2));
+		}
+	}
+
+	void reset() {
+		for (auto& engine : engines_) {
+			engine->reset();
+		}
+	}
+
+	// demand access from a cache bank
+	void train(uint64_t addr, uint64_t pc, bool trigger) {
+		for (auto& engine : engines_) {
+			engine->train(addr >> line_size_log2_, pc, trigger);
+		}
+		// the queues are drained by the cache
+		if (!this->empty()) {
+			owner_->wakeup();
+		}
+	}
+
+	bool empty() const {
+		for (auto& engine : engines_) {
+			if (!engine->empty())
+				return false;
+		}
+		return true;
+	}
+
+	uint32_t num_engines() const {
+		return engines_.size();
+	}
+
+	IPrefetchEngine& engine(uint32_t index) {
+		return *engines_.at(index);
+	}
+
+	uint64_t addr(uint64_t line) const {
+		return line << line_size_log2_;
+	}
+
+private:
+	SimObjectBase* owner_;
+	uint32_t line_size_log2_;
+	std::vector<std::unique_ptr<IPrefetchEngine>> engines_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 struct bank_req_t {
 
   using Ptr = std::shared_ptr<bank_req_t>;
 
 	enum ReqType {
 		None   = 0,
-		Replay = 2,
-		Core   = 3
+		Replay   = 2,
+		Core     = 3,
+		Prefetch = 4
 	};
 
 	uint64_t addr_tag;
@@ -168,6 +708,7 @@ struct bank_req_t {
 	uint32_t cid;
 	uint64_t req_tag;
 	uint64_t uuid;
+	uint64_t pc;
 	ReqType  type;
 	bool     write;
 
@@ -193,6 +734,9 @@ struct bank_req_t {
 struct mshr_entry_t {
 	bank_req_t bank_req;
 	uint32_t line_id;
+	int32_t  next;        // next request to the same line, or next free entry
+	int32_t  bucket_next; // next pending line in the hash bucket
+	int32_t  last;        // last request to the line (primary misses)
 
 	mshr_entry_t() {}
 
@@ -201,13 +745,21 @@ struct mshr_entry_t {
 	}
 };
 
+// Miss status holding registers of a cache bank.
+// Pending lines are indexed by a hash table on their set and tag, with the
+// requests to a line chained behind its primary miss, so that allocation,
+// lookup and release take constant time. Free entries and the requests
+// ready for replay are kept in lists.
 class MSHR {
 public:
 	MSHR(uint32_t size)
 		: entries_(size)
-		, ready_reqs_(0)
-		, size_(0)
-	{}
+		, buckets_(uint32_t(1) << log2ceil(2 * size))
+		, hash_shift_(64 - log2ceil(2 * size))
+		, ready_(size)
+	{
+		this->reset();
+	}
 
 	uint32_t capacity() const {
 		return entries_.size();
@@ -230,70 +782,173 @@ public:
 		return (ready_reqs_ != 0);
 	}
 
-	bool lookup(const bank_req_t& bank_req) {
-		for (auto& entry : entries_) {;
-			if (entry.bank_req.type != bank_req_t::None
-		 	 && entry.bank_req.set_id == bank_req.set_id
-		   && entry.bank_req.addr_tag == bank_req.addr_tag) {
-				return true;
-			}
-		}
-		return false;
+	// returns the primary miss pending on the same line, if any
+	const bank_req_t* lookup(const bank_req_t& bank_req) const {
+		int id = this->find(bank_req.set_id, bank_req.addr_tag);
+		return (id != -1) ? &entries_.at(id).bank_req : nullptr;
 	}
 
 	int enqueue(const bank_req_t& bank_req, uint32_t line_id) {
-		assert(bank_req.type == bank_req_t::Core);
-		for (uint32_t i = 0, n = entries_.size(); i < n; ++i) {
-			auto& entry = entries_.at(i);
-			if (entry.bank_req.type == bank_req_t::None) {
-				entry.bank_req = bank_req;
-				entry.line_id = line_id;
-				++size_;
-				return i;
-			}
+		assert(bank_req.type == bank_req_t::Core || bank_req.type == bank_req_t::Prefetch);
+		int id = this->allocate();
+		auto& entry = entries_.at(id);
+		entry.bank_req = bank_req;
+		entry.line_id = line_id;
+		int root_id = this->find(bank_req.set_id, bank_req.addr_tag);
+		if (root_id != -1) {
+			// secondary miss, chain it behind the primary one
+			auto& root_entry = entries_.at(root_id);
+			entries_.at(root_entry.last).next = id;
+			root_entry.last = id;
+		} else {
+			// primary miss, index the line
+			auto& bucket = buckets_.at(this->hash(bank_req.set_id, bank_req.addr_tag));
+			entry.bucket_next = bucket;
+			entry.last = id;
+			bucket = id;
 		}
-		std::abort();
-		return -1;
+		return id;
 	}
 
-	mshr_entry_t& replay(uint32_t id) {
+	// the line of a primary miss is filled: unindex it and mark all the demand
+	// requests to the line for replay. Reports whether any of them is a write.
+	mshr_entry_t& replay(uint32_t id, bool* write) {
 		auto& root_entry = entries_.at(id);
-		assert(root_entry.bank_req.type == bank_req_t::Core);
+		assert(root_entry.bank_req.type == bank_req_t::Core || root_entry.bank_req.type == bank_req_t::Prefetch);
 		assert(ready_reqs_ == 0);
-		// mark all related mshr entries for replay
-		for (auto& entry : entries_) {
-			if (entry.bank_req.type == bank_req_t::Core
-			 && entry.bank_req.set_id == root_entry.bank_req.set_id
-			 && entry.bank_req.addr_tag == root_entry.bank_req.addr_tag) {
+		this->unindex(id);
+		ready_head_ = 0;
+		*write = false;
+		for (int32_t i = id; i != -1; i = entries_.at(i).next) {
+			auto& entry = entries_.at(i);
+			if (entry.bank_req.type == bank_req_t::Core) {
 				entry.bank_req.type = bank_req_t::Replay;
-				++ready_reqs_;
+				*write |= entry.bank_req.write;
+				ready_.at(ready_reqs_++) = i;
 			}
 		}
 		return root_entry;
 	}
 
+	// free a prefetch entry once its line is filled
+	void release(uint32_t id) {
+		assert(entries_.at(id).bank_req.type == bank_req_t::Prefetch);
+		this->deallocate(id);
+	}
+
 	void dequeue(bank_req_t* out) {
 		assert(ready_reqs_ > 0);
-		for (auto& entry : entries_) {
-			if (entry.bank_req.type == bank_req_t::Replay) {
-				*out = entry.bank_req;
-				entry.bank_req.type = bank_req_t::None;
-				--ready_reqs_;
-				--size_;
-				break;
-			}
-		}
+		auto id = ready_.at(ready_head_++);
+		*out = entries_.at(id).bank_req;
+		this->deallocate(id);
+		--ready_reqs_;
 	}
 
 	void reset() {
-		for (auto& entry : entries_) {
+		for (uint32_t i = 0, n = entries_.size(); i < n; ++i) {
+			auto& entry = entries_.at(i);
 			entry.reset();
+			entry.next = (i + 1 < n) ? (i + 1) : -1;
 		}
+		std::fill(buckets_.begin(), buckets_.end(), -1);
+		free_ = entries_.empty() ? -1 : 0;
+		ready_head_ = 0;
+		ready_reqs_ = 0;
 		size_ = 0;
 	}
 
+	// saves the requests in replay order, then the pending lines.
+	// in-flight prefetches are not saved, their fills would never arrive.
+	void save(CheckpointWriter& ckpt) const {
+		std::vector<mshr_entry_t> entries;
+		for (uint32_t i = 0; i < ready_reqs_; ++i) {
+			entries.push_back(entries_.at(ready_.at(ready_head_ + i)));
+		}
+		for (auto bucket : buckets_) {
+			for (int32_t root = bucket; root != -1; root = entries_.at(root).bucket_next) {
+				for (int32_t i = root; i != -1; i = entries_.at(i).next) {
+					auto& entry = entries_.at(i);
+					if (entry.bank_req.type != bank_req_t::Prefetch) {
+						entries.push_back(entry);
+					}
+				}
+			}
+		}
+		ckpt.write<uint32_t>(entries_.size());
+		ckpt.write_vector(entries);
+	}
+
+	void restore(CheckpointReader& ckpt) {
+		ckpt.check<uint32_t>(entries_.size(), "mshr size");
+		std::vector<mshr_entry_t> entries;
+		ckpt.read_vector(&entries);
+		if (entries.size() > entries_.size())
+			throw std::runtime_error("checkpoint configuration mismatch: mshr entries");
+		this->reset();
+		for (auto& entry : entries) {
+			if (entry.bank_req.type == bank_req_t::Replay) {
+				int id = this->allocate();
+				entries_.at(id).bank_req = entry.bank_req;
+				ready_.at(ready_reqs_++) = id;
+			} else {
+				this->enqueue(entry.bank_req, entry.line_id);
+			}
+		}
+	}
+
 private:
+
+	uint32_t hash(uint32_t set_id, uint64_t addr_tag) const {
+		uint64_t key = addr_tag ^ (uint64_t(set_id) << 40);
+		return (key * 0x9e3779b97f4a7c15ull) >> hash_shift_;
+	}
+
+	int32_t find(uint32_t set_id, uint64_t addr_tag) const {
+		int32_t id = buckets_.at(this->hash(set_id, addr_tag));
+		while (id != -1) {
+			auto& entry = entries_.at(id);
+			if (entry.bank_req.set_id == set_id
+			 && entry.bank_req.addr_tag == addr_tag)
+				break;
+			id = entry.bucket_next;
+		}
+		return id;
+	}
+
+	void unindex(int32_t id) {
+		auto& root_req = entries_.at(id).bank_req;
+		auto link = &buckets_.at(this->hash(root_req.set_id, root_req.addr_tag));
+		while (*link != id) {
+			link = &entries_.at(*link).bucket_next;
+		}
+		*link = entries_.at(id).bucket_next;
+	}
+
+	int32_t allocate() {
+		assert(free_ != -1);
+		int32_t id = free_;
+		auto& entry = entries_.at(id);
+		free_ = entry.next;
+		entry.next = -1;
+		entry.bucket_next = -1;
+		++size_;
+		return id;
+	}
+
+	void deallocate(int32_t id) {
+		auto& entry = entries_.at(id);
+		entry.bank_req.type = bank_req_t::None;
+		entry.next = free_;
+		free_ = id;
+		--size_;
+	}
+
 	std::vector<mshr_entry_t> entries_;
+	std::vector<int32_t> buckets_;
+	uint32_t hash_shift_;
+	std::vector<uint32_t> ready_;
+	int32_t  free_;
+	uint32_t ready_head_;
 	uint32_t ready_reqs_;
 	uint32_t size_;
 };
@@ -306,23 +961,31 @@ public:
   SimPort<MemReq> mem_req_port;
   SimPort<MemRsp> mem_rsp_port;
 
+	SimPort<MemReq> pf_req_port;
+
   CacheBank(const SimContext& ctx,
 	          const char* name,
 	          const CacheSim::Config& config,
 				    const params_t& params,
-						uint32_t bank_id)
+						uint32_t bank_id,
+						Prefetcher* prefetcher)
     : SimObject<CacheBank>(ctx, name)
 		, core_req_port(this)
 		, core_rsp_port(this)
 		, mem_req_port(this)
 		, mem_rsp_port(this)
+		, pf_req_port(this)
 		, config_(config)
 	  , params_(params)
 		, bank_id_(bank_id)
-		, sets_(params.sets_per_bank, params.lines_per_set)
+		, prefetcher_(prefetcher)
+		, tags_(params.sets_per_bank, params.lines_per_set)
+		, repl_(create_repl_policy(config.repl_policy, params.sets_per_bank, params.lines_per_set))
 		, mshr_(config.mshr_size)
 		, pipe_req_(TFifo<bank_req_t>::Create("", config.latency-1))
 	{
+		pipe_req_->set_reader(this);
+		repl_->reset();
 		this->reset();
 	}
 
@@ -332,6 +995,8 @@ public:
     pending_read_reqs_ = 0;
 		pending_write_reqs_ = 0;
 		pending_fill_reqs_ = 0;
+		pending_prefetches_ = 0;
+		std::fill(std::begin(pollution_filter_), std::end(pollution_filter_), 0);
   }
 
   void tick() {
@@ -343,14 +1008,145 @@ public:
 
 		// calculate memory latency
 		perf_stats_.mem_latency += pending_fill_reqs_;
+
+		this->update_mshr_stats(1);
+	}
+
+	bool idle() const {
+		return !mshr_.has_ready_reqs()
+		    && mem_rsp_port.empty()
+		    && pipe_req_->empty()
+		    && (core_req_port.empty() || this->mshr_stalled())
+		    && (pf_req_port.empty() || this->prefetch_throttled());
+	}
+
+	void skip(uint64_t cycles) {
+		if (this->mshr_stalled()) {
+			perf_stats_.mshr_stalls += cycles;
+		}
+		perf_stats_.mem_latency += pending_fill_reqs_ * cycles;
+		this->update_mshr_stats(cycles);
 	}
 
 	const CacheSim::PerfStats& perf_stats() const {
 		return perf_stats_;
 	}
 
+	bool warm(uint64_t addr, bool* write) {
+		auto set_id = params_.addr_set_id(addr);
+		auto addr_tag = params_.addr_tag(addr);
+		int hit_line_id = tags_.lookup(set_id, addr_tag);
+		if (hit_line_id != -1) {
+			repl_->hit(set_id, hit_line_id);
+			if (*write) {
+				if (!config_.write_back)
+					return true;
+				tags_.set_dirty(set_id, hit_line_id);
+			}
+			return false;
+		}
+		if (*write && !config_.write_back) {
+			// no allocation on write-through misses
+			return true;
+		}
+		// fill the line
+		int line_id = tags_.free_way(set_id);
+		if (line_id == -1) {
+			line_id = repl_->victim(set_id);
+		}
+		tags_.fill(set_id, line_id, addr_tag, *write, false);
+		repl_->fill(set_id, line_id);
+		*write = false;
+		return true;
+	}
+
+	void save(CheckpointWriter& ckpt) const {
+		tags_.save(ckpt);
+		repl_->save(ckpt);
+		mshr_.save(ckpt);
+		ckpt.write<uint32_t>(pending_mshr_size_ - pending_prefetches_);
+	}
+
+	void restore(CheckpointReader& ckpt) {
+		tags_.restore(ckpt);
+		repl_->restore(ckpt);
+		mshr_.restore(ckpt);
+		pending_mshr_size_ = ckpt.read<uint32_t>();
+	}
+
 private:
 
+	// the next core request is waiting for a free MSHR entry
+	bool mshr_stalled() const {
+		if (core_req_port.empty())
+			return false;
+		auto& core_req = core_req_port.front();
+		return (!core_req.write || config_.write_back)
+		    && (pending_mshr_size_ >= mshr_.capacity());
+	}
+
+	void update_mshr_stats(uint64_t cycles) {
+		constexpr uint32_t bins = CacheSim::PerfStats::MSHR_OCC_BINS;
+		auto size = mshr_.size();
+		uint32_t bin = size ? ((size * bins - 1) / mshr_.capacity()) : 0;
+		perf_stats_.mshr_occupancy[bin] += cycles;
+		if (mshr_.full()) {
+			perf_stats_.mshr_full += cycles;
+		}
+	}
+
+	// prefetches are held while the MSHR occupancy is above the limit
+	bool prefetch_throttled() const {
+		return (pending_mshr_size_ * 100) >= (mshr_.capacity() * config_.prefetch.mshr_limit);
+	}
+
+	uint32_t pollution_index(uint32_t set_id, uint64_t addr_tag) const {
+		return (addr_tag * params_.sets_per_bank + set_id) % POLLUTION_FILTER_SIZE;
+	}
+
+	// select the line to replace for a new fill, or -1 if a prefetch may not
+	// evict the victim, and write the victim back if dirty
+	int allocate_line(const bank_req_t& bank_req) {
+		int line_id = tags_.free_way(bank_req.set_id);
+		if (line_id != -1)
+			return line_id;
+		line_id = repl_->victim(bank_req.set_id);
+		bool victim_prefetched = tags_.prefetched(bank_req.set_id, line_id);
+		if (bank_req.type == bank_req_t::Prefetch) {
+			if (config_.prefetch.protect_demand && !victim_prefetched)
+				return -1;
+			if (!victim_prefetched) {
+				// remember the demand line evicted by the prefetch
+				auto index = this->pollution_index(bank_req.set_id, tags_.tag(bank_req.set_id, line_id));
+				pollution_filter_[index / 64] |= (uint64_t(1) << (index % 64));
+			}
+		}
+		if (config_.write_back && tags_.dirty(bank_req.set_id, line_id)) {
+			// write back dirty line
+			MemReq mem_req;
+			mem_req.addr  = params_.mem_addr(bank_id_, bank_req.set_id, tags_.tag(bank_req.set_id, line_id));
+			mem_req.write = true;
+			mem_req.cid   = bank_req.cid;
+			this->mem_req_port.push(mem_req);
+			DT(3, this->name() << "-writeback: " << mem_req);
+			++perf_stats_.evictions;
+		}
+		return line_id;
+	}
+
+	void send_fill(const bank_req_t& bank_req, uint32_t mshr_id) {
+		MemReq mem_req;
+		mem_req.addr  = params_.mem_addr(bank_id_, bank_req.set_id, bank_req.addr_tag);
+		mem_req.write = false;
+		mem_req.tag   = mshr_id;
+		mem_req.cid   = bank_req.cid;
+		mem_req.uuid  = bank_req.uuid;
+		mem_req.pc    = bank_req.pc;
+		this->mem_req_port.push(mem_req);
+		DT(3, this->name() << "-fill-req: " << mem_req);
+		++pending_fill_reqs_;
+	}
+
 	void processInputs() {
 		// proces inputs in prioroty order
 		do {
@@ -369,14 +1165,24 @@ private:
 				auto& mem_rsp = mem_rsp_port.front();
 				DT(3, this->name() << "-fill-rsp: " << mem_rsp);
 				// update MSHR
-				auto& entry = mshr_.replay(mem_rsp.tag);
-				auto& set   = sets_.at(entry.bank_req.set_id);
-				auto& line  = set.lines.at(entry.line_id);
-				line.valid  = true;
-				line.tag    = entry.bank_req.addr_tag;
-				mshr_.dequeue(&bank_req);
-				--pending_mshr_size_;
-				pipe_req_->push(bank_req);
+				bool write;
+				auto& entry = mshr_.replay(mem_rsp.tag, &write);
+				auto& fill_req = entry.bank_req;
+				// a late prefetch is consumed by the requests merged into it
+				bool prefetched = (fill_req.type == bank_req_t::Prefetch) && !mshr_.has_ready_reqs();
+				// merged write-back writes dirty the line as well
+				tags_.fill(fill_req.set_id, entry.line_id, fill_req.addr_tag, write && config_.write_back, prefetched);
+				repl_->fill(fill_req.set_id, entry.line_id);
+				if (fill_req.type == bank_req_t::Prefetch) {
+					mshr_.release(mem_rsp.tag);
+					--pending_mshr_size_;
+					--pending_prefetches_;
+				}
+				if (mshr_.has_ready_reqs()) {
+					mshr_.dequeue(&bank_req);
+					--pending_mshr_size_;
+					pipe_req_->push(bank_req);
+				}
 				mem_rsp_port.pop();
 				--pending_fill_reqs_;
 				break;
@@ -399,6 +1205,7 @@ private:
 				bank_req.set_id = params_.addr_set_id(core_req.addr);
 				bank_req.addr_tag = params_.addr_tag(core_req.addr);
 				bank_req.req_tag = core_req.tag;
+				bank_req.pc = core_req.pc;
 				bank_req.write = core_req.write;
 				pipe_req_->push(bank_req);
 				if (core_req.write)
@@ -408,6 +1215,25 @@ private:
 				core_req_port.pop();
 				break;
 			}
+
+			// fourth: schedule prefetch
+			if (!this->pf_req_port.empty() && !this->prefetch_throttled()) {
+				auto& pf_req = pf_req_port.front();
+				++pending_mshr_size_;
+				++pending_prefetches_;
+				DT(3, this->name() << "-prefetch-req: " << pf_req);
+				bank_req.type = bank_req_t::Prefetch;
+				bank_req.cid = pf_req.cid;
+				bank_req.uuid = pf_req.uuid;
+				bank_req.set_id = params_.addr_set_id(pf_req.addr);
+				bank_req.addr_tag = params_.addr_tag(pf_req.addr);
+				bank_req.req_tag = 0;
+				bank_req.pc = pf_req.pc;
+				bank_req.write = false;
+				pipe_req_->push(bank_req);
+				pf_req_port.pop();
+				break;
+			}
 		} while (false);
 	}
 
@@ -428,16 +1254,19 @@ private:
 			}
 		} break;
 		case bank_req_t::Core: {
-			int32_t free_line_id = -1;
-			int32_t repl_line_id = 0;
-			auto& set = sets_.at(bank_req.set_id);
 			// tag lookup
-			int hit_line_id = set.tag_lookup(bank_req.addr_tag, &free_line_id, &repl_line_id);
+			int hit_line_id = tags_.lookup(bank_req.set_id, bank_req.addr_tag);
 			if (hit_line_id != -1) {
 				// Hit handling
+				repl_->hit(bank_req.set_id, hit_line_id);
+				bool pf_hit = tags_.prefetched(bank_req.set_id, hit_line_id);
+				if (pf_hit) {
+					tags_.clear_prefetched(bank_req.set_id, hit_line_id);
+					++perf_stats_.pf_useful;
+				}
+				this->train_prefetcher(bank_req, pf_hit);
 				if (bank_req.write) {
 					// handle write has_hit
-					auto& hit_line = set.lines.at(hit_line_id);
 					if (!config_.write_back) {
 						// forward write request to memory
 						MemReq mem_req;
@@ -449,7 +1278,7 @@ private:
 						DT(3, this->name() << "-writethrough: " << mem_req);
 					} else {
 						// mark line as dirty
-						hit_line.dirty = true;
+						tags_.set_dirty(bank_req.set_id, hit_line_id);
 					}
 				}
 				// send core response
@@ -465,18 +1294,14 @@ private:
 					++perf_stats_.write_misses;
 				else
 					++perf_stats_.read_misses;
-
-				if (free_line_id == -1 && config_.write_back) {
-					// write back dirty line
-					auto& repl_line = set.lines.at(repl_line_id);
-					if (repl_line.dirty) {
-						MemReq mem_req;
-						mem_req.addr  = params_.mem_addr(bank_id_, bank_req.set_id, repl_line.tag);
-						mem_req.write = true;
-						mem_req.cid   = bank_req.cid;
-						this->mem_req_port.push(mem_req);
-						DT(3, this->name() << "-writeback: " << mem_req);
-						++perf_stats_.evictions;
+				this->train_prefetcher(bank_req, true);
+				if (prefetcher_) {
+					auto index = this->pollution_index(bank_req.set_id, bank_req.addr_tag);
+					auto& bits = pollution_filter_[index / 64];
+					uint64_t mask = uint64_t(1) << (index % 64);
+					if (bits & mask) {
+						++perf_stats_.pf_polluting;
+						bits &= ~mask;
 					}
 				}
 
@@ -501,26 +1326,47 @@ private:
 				} else {
 					// MSHR lookup
 					auto mshr_pending = mshr_.lookup(bank_req);
+					if (mshr_pending) {
+						++perf_stats_.mshr_merged;
+						if (mshr_pending->type == bank_req_t::Prefetch)
+							++perf_stats_.pf_late;
+					}
+
+					// select the line to replace, secondary misses reuse the pending fill
+					int line_id = 0;
+					if (!mshr_pending) {
+						line_id = this->allocate_line(bank_req);
+					}
 
 					// allocate MSHR
-					auto mshr_id = mshr_.enqueue(bank_req, (free_line_id != -1) ? free_line_id : repl_line_id);
+					auto mshr_id = mshr_.enqueue(bank_req, line_id);
 					DT(3, this->name() << "-mshr-enqueue: " << bank_req);
 
 					// send fill request
 					if (!mshr_pending) {
-						MemReq mem_req;
-						mem_req.addr  = params_.mem_addr(bank_id_, bank_req.set_id, bank_req.addr_tag);
-						mem_req.write = false;
-						mem_req.tag   = mshr_id;
-						mem_req.cid   = bank_req.cid;
-						mem_req.uuid  = bank_req.uuid;
-						this->mem_req_port.push(mem_req);
-						DT(3, this->name() << "-fill-req: " << mem_req);
-						++pending_fill_reqs_;
+						this->send_fill(bank_req, mshr_id);
 					}
 				}
 			}
 		} break;
+		case bank_req_t::Prefetch: {
+			// drop prefetches of resident or pending lines,
+			// or that would evict a protected demand line
+			int line_id = -1;
+			if (tags_.lookup(bank_req.set_id, bank_req.addr_tag) == -1
+			 && !mshr_.lookup(bank_req)) {
+				line_id = this->allocate_line(bank_req);
+			}
+			if (line_id == -1) {
+				--pending_mshr_size_;
+				--pending_prefetches_;
+				break;
+			}
+			auto mshr_id = mshr_.enqueue(bank_req, line_id);
+			DT(3, this->name() << "-prefetch: " << bank_req);
+			this->send_fill(bank_req, mshr_id);
+			++perf_stats_.pf_issued;
+		} break;
 		default:
 			std::abort();
 		}
@@ -528,11 +1374,23 @@ private:
 		pipe_req_->pop();
 	}
 
+	void train_prefetcher(const bank_req_t& bank_req, bool trigger) {
+		if (prefetcher_) {
+			auto addr = params_.mem_addr(bank_id_, bank_req.set_id, bank_req.addr_tag);
+			prefetcher_->train(addr, bank_req.pc, trigger);
+		}
+	}
+
+	// demand lines evicted by a prefetch (Srinath et al., HPCA'07)
+	static constexpr uint32_t POLLUTION_FILTER_SIZE = 4096;
+
 	CacheSim::Config config_;
 	params_t params_;
 	uint32_t bank_id_;
+	Prefetcher* prefetcher_;
 
-  std::vector<set_t> sets_;
+	TagArray tags_;
+	std::unique_ptr<IReplPolicy> repl_;
 	MSHR mshr_;
 	uint32_t pending_mshr_size_;
 	TFifo<bank_req_t>::Ptr pipe_req_;
@@ -542,6 +1400,8 @@ private:
 	uint64_t pending_read_reqs_;
 	uint64_t pending_write_reqs_;
 	uint64_t pending_fill_reqs_;
+	uint32_t pending_prefetches_;
+	uint64_t pollution_filter_[POLLUTION_FILTER_SIZE / 64];
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -602,10 +1462,16 @@ public:
 				return params_.addr_bank_id(req.addr);
 			});
 
+		// Create prefetchers
+		if (config_.prefetch.enabled()) {
+			prefetcher_.reset(new Prefetcher(simobject, config_.prefetch, config_.L));
+			pf_busy_banks_.reserve(num_banks);
+		}
+
 		// Create cache banks
 		for (uint32_t i = 0, n = num_banks; i < n; ++i) {
 			snprintf(sname, 100, "%s-bank%d", simobject->name().c_str(), i);
-			banks_.at(i) = CacheBank::Create(sname, config, params_, i);
+			banks_.at(i) = CacheBank::Create(sname, config, params_, i, prefetcher_.get());
 
 			// bind core ports
 			bank_core_xbar_->ReqOut.at(i).bind(&banks_.at(i)->core_req_port);
@@ -615,6 +1481,14 @@ public:
 			banks_.at(i)->mem_req_port.bind(&bank_mem_arb->ReqIn.at(i));
 			bank_mem_arb->RspIn.at(i).bind(&banks_.at(i)->mem_rsp_port);
 		}
+
+		// responses are forwarded to the core ports by this object
+		for (uint32_t i = 0; i < config_.mem_ports; ++i) {
+			nc_mem_arbs_.at(i)->RspIn.at(1).set_reader(simobject);
+		}
+		for (uint32_t i = 0; i < config_.num_inputs; ++i) {
+			bank_core_xbar_->RspIn.at(i).set_reader(simobject);
+		}
 	}
 
   void reset() {
@@ -623,6 +1497,10 @@ public:
 
 		// calculate cache initialization cycles
 		init_cycles_ = params_.sets_per_bank;
+
+		if (prefetcher_) {
+			prefetcher_->reset();
+		}
 	}
 
   void tick() {
@@ -671,6 +1549,30 @@ public:
 			}
 			core_req_port.pop();
 		}
+
+		// schedule prefetches
+		if (prefetcher_) {
+			this->processPrefetches();
+		}
+	}
+
+	bool idle() const {
+		if (config_.bypass)
+			return true;
+		if (init_cycles_ != 0)
+			return false;
+		for (uint32_t i = 0, n = config_.mem_ports; i < n; ++i) {
+			if (!nc_mem_arbs_.at(i)->RspIn.at(1).empty())
+				return false;
+		}
+		for (uint32_t req_id = 0, n = config_.num_inputs; req_id < n; ++req_id) {
+			if (!bank_core_xbar_->RspIn.at(req_id).empty()
+			 || !simobject_->CoreReqPorts.at(req_id).empty())
+				return false;
+		}
+		if (prefetcher_ && !prefetcher_->empty())
+			return false;
+		return true;
 	}
 
 	PerfStats perf_stats() const {
@@ -684,8 +1586,61 @@ public:
 		return perf_stats;
 	}
 
+	bool warm(uint64_t addr, bool* write) {
+		if (config_.bypass)
+			return true;
+		return banks_.at(params_.addr_bank_id(addr))->warm(addr, write);
+	}
+
+	void save(CheckpointWriter& ckpt) const {
+		ckpt.section("CSIM");
+		ckpt.write<uint32_t>(banks_.size());
+		ckpt.write<uint32_t>(params_.sets_per_bank);
+		ckpt.write<uint32_t>(uint32_t(config_.repl_policy));
+		if (config_.bypass)
+			return;
+		for (auto& bank : banks_) {
+			bank->save(ckpt);
+		}
+	}
+
+	void restore(CheckpointReader& ckpt) {
+		ckpt.section("CSIM");
+		ckpt.check<uint32_t>(banks_.size(), "cache banks");
+		ckpt.check<uint32_t>(params_.sets_per_bank, "cache sets");
+		ckpt.check<uint32_t>(uint32_t(config_.repl_policy), "cache replacement policy");
+		if (config_.bypass)
+			return;
+		for (auto& bank : banks_) {
+			bank->restore(ckpt);
+		}
+	}
+
 private:
 
+	// forward the head of each prefetch queue to its bank, one per bank
+	void processPrefetches() {
+		auto& busy_banks = pf_busy_banks_;
+		busy_banks.clear();
+		for (uint32_t i = 0, n = prefetcher_->num_engines(); i < n; ++i) {
+			auto& engine = prefetcher_->engine(i);
+			if (engine.empty())
+				continue;
+			auto addr = prefetcher_->addr(engine.front());
+			auto bank_id = params_.addr_bank_id(addr);
+			auto& pf_req_port = banks_.at(bank_id)->pf_req_port;
+			if (!pf_req_port.empty()
+			 || std::find(busy_banks.begin(), busy_banks.end(), bank_id) != busy_banks.end())
+				continue;
+			MemReq pf_req;
+			pf_req.addr = addr;
+			pf_req_port.push(pf_req, 0);
+			DT(3, simobject_->name() << "-prefetch-req: " << pf_req);
+			busy_banks.push_back(bank_id);
+			engine.pop();
+		}
+	}
+
 	void processBypassResponse(const MemRsp& mem_rsp) {
 		uint32_t req_id = mem_rsp.tag & ((1 << params_.log2_num_inputs)-1);
 		uint64_t tag = mem_rsp.tag >> params_.log2_num_inputs;
@@ -718,6 +1673,8 @@ private:
 	MemArbiter::Ptr bank_arb_;
 	std::vector<MemArbiter::Ptr> nc_mem_arbs_;
 	MemCrossBar::Ptr bank_core_xbar_;
+	std::unique_ptr<Prefetcher> prefetcher_;
+	std::vector<uint32_t> pf_busy_banks_; // reused across cycles
 	uint32_t init_cycles_;
 };
 
@@ -744,6 +1701,22 @@ void CacheSim::tick() {
   impl_->tick();
 }
 
+bool CacheSim::idle() const {
+  return impl_->idle();
+}
+
+bool CacheSim::warm(uint64_t addr, bool* write) {
+  return impl_->warm(addr, write);
+}
+
+void CacheSim::save(CheckpointWriter& ckpt) const {
+  impl_->save(ckpt);
+}
+
+void CacheSim::restore(CheckpointReader& ckpt) {
+  impl_->restore(ckpt);
+}
+
 CacheSim::PerfStats CacheSim::perf_stats() const {
   return impl_->perf_stats();
 }
\ No newline at end of file
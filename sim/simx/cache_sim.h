@@ -15,6 +15,7 @@
 
 #include <simobject.h>
 #include "mem_sim.h"
+#include <checkpoint.h>
 
 namespace vortex {
 
@@ -22,21 +23,25 @@ class CacheSim : public SimObject<CacheSim> {
 public:
 	struct Config {
 		bool    bypass;         // cache bypass
-		uint8_t C;              // log2 cache size
-		uint8_t L;              // log2 line size
-		uint8_t W;              // log2 word size
-		uint8_t A;              // log2 associativity
-		uint8_t B;              // log2 number of banks
+		uint32_t C;             // log2 cache size
+		uint32_t L;             // log2 line size
+		uint32_t W;             // log2 word size
+		uint32_t A;             // log2 associativity
+		uint32_t B;             // log2 number of banks
 		uint8_t addr_width;     // word address bits
-		uint8_t num_inputs;     // number of inputs
-		uint8_t mem_ports;      // memory ports
+		uint32_t num_inputs;    // number of inputs
+		uint32_t mem_ports;     // memory ports
 		bool    write_back;     // is write-back
 		bool    write_reponse;  // enable write response
-		uint16_t mshr_size;     // MSHR buffer size
+		uint32_t mshr_size;     // MSHR buffer size
 		uint8_t latency;        // pipeline latency
+		ReplPolicy repl_policy; // replacement policy
+		PrefetchConfig prefetch; // prefetchers
 	};
 
 	struct PerfStats {
+		static constexpr uint32_t MSHR_OCC_BINS = 4;
+
 		uint64_t reads;
 		uint64_t writes;
 		uint64_t read_misses;
@@ -45,6 +50,13 @@ public:
 		uint64_t bank_stalls;
 		uint64_t mshr_stalls;
 		uint64_t mem_latency;
+		uint64_t pf_issued;     // prefetch fills sent to memory
+		uint64_t pf_useful;     // prefetched lines hit by a demand access
+		uint64_t pf_late;       // demand misses on an in-flight prefetch
+		uint64_t pf_polluting;  // demand misses on lines evicted by a prefetch
+		uint64_t mshr_merged;   // secondary misses merged into a pending fill
+		uint64_t mshr_full;     // bank cycles with all MSHR entries allocated
+		uint64_t mshr_occupancy[MSHR_OCC_BINS]; // bank cycles per MSHR occupancy quartile
 
 		PerfStats()
 			: reads(0)
@@ -55,6 +67,13 @@ public:
 			, bank_stalls(0)
 			, mshr_stalls(0)
 			, mem_latency(0)
+			, pf_issued(0)
+			, pf_useful(0)
+			, pf_late(0)
+			, pf_polluting(0)
+			, mshr_merged(0)
+			, mshr_full(0)
+			, mshr_occupancy()
 		{}
 
 		PerfStats& operator+=(const PerfStats& rhs) {
@@ -66,6 +85,15 @@ public:
 			this->bank_stalls += rhs.bank_stalls;
 			this->mshr_stalls += rhs.mshr_stalls;
 			this->mem_latency += rhs.mem_latency;
+			this->pf_issued += rhs.pf_issued;
+			this->pf_useful += rhs.pf_useful;
+			this->pf_late += rhs.pf_late;
+			this->pf_polluting += rhs.pf_polluting;
+			this->mshr_merged += rhs.mshr_merged;
+			this->mshr_full += rhs.mshr_full;
+			for (uint32_t i = 0; i < MSHR_OCC_BINS; ++i) {
+				this->mshr_occupancy[i] += rhs.mshr_occupancy[i];
+			}
 			return *this;
 		}
 	};
@@ -82,6 +110,16 @@ public:
 
 	void tick();
 
+	bool idle() const;
+
+	// update the tags for an access without timing (cache warm-up),
+	// returns true if the access reaches memory, with *write set to its type
+	bool warm(uint64_t addr, bool* write);
+
+	// save or restore the tag arrays and MSHRs
+	void save(CheckpointWriter& ckpt) const;
+	void restore(CheckpointReader& ckpt);
+
 	PerfStats perf_stats() const;
 
 private:
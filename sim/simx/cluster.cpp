@@ -12,6 +12,7 @@
 // limitations under the License.
 
 #include "cluster.h"
+#include "processor_impl.h"
 
 using namespace vortex;
 
@@ -21,13 +22,14 @@ Cluster::Cluster(const SimContext& ctx,
                  const Arch &arch,
                  const DCRS &dcrs)
   : SimObject(ctx, StrFormat("cluster%d", cluster_id))
-  , mem_req_ports(L2_MEM_PORTS, this)
-  , mem_rsp_ports(L2_MEM_PORTS, this)
+  , mem_req_ports(arch.l2cache().mem_ports, this)
+  , mem_rsp_ports(arch.l2cache().mem_ports, this)
   , cluster_id_(cluster_id)
   , processor_(processor)
-  , sockets_(NUM_SOCKETS)
+  , sockets_(arch.num_sockets())
   , barriers_(arch.num_barriers(), 0)
   , cores_per_socket_(arch.socket_size())
+  , mem_overlay_(nullptr)
 {
   char sname[100];
 
@@ -42,33 +44,37 @@ Cluster::Cluster(const SimContext& ctx,
 
   // Create l2cache
 
+  auto& l2 = arch.l2cache();
   snprintf(sname, 100, "%s-l2cache", this->name().c_str());
   l2cache_ = CacheSim::Create(sname, CacheSim::Config{
-    !L2_ENABLED,
-    log2ceil(L2_CACHE_SIZE),// C
+    !l2.enabled,
+    log2ceil(l2.size),      // C
     log2ceil(MEM_BLOCK_SIZE),// L
     log2ceil(L1_LINE_SIZE), // W
-    log2ceil(L2_NUM_WAYS),  // A
-    log2ceil(L2_NUM_BANKS), // B
+    log2ceil(l2.num_ways),  // A
+    log2ceil(l2.num_banks), // B
     XLEN,                   // address bits
-    L2_NUM_REQS,            // request size
-    L2_MEM_PORTS,           // memory ports
-    L2_WRITEBACK,           // write-back
+    arch.l2_num_reqs(),     // request size
+    l2.mem_ports,           // memory ports
+    l2.writeback,           // write-back
     false,                  // write response
-    L2_MSHR_SIZE,           // mshr size
+    l2.mshr_size,           // mshr size
     2,                      // pipeline latency
+    l2.repl_policy,         // replacement policy
+    l2.prefetch,            // prefetchers
   });
 
   // connect l2cache core interfaces
+  uint32_t l1_mem_ports = arch.dcache().mem_ports;
   for (uint32_t i = 0; i < sockets_per_cluster; ++i) {
-    for (uint32_t j = 0; j < L1_MEM_PORTS; ++j) {
-      sockets_.at(i)->mem_req_ports.at(j).bind(&l2cache_->CoreReqPorts.at(i * L1_MEM_PORTS + j));
-      l2cache_->CoreRspPorts.at(i * L1_MEM_PORTS + j).bind(&sockets_.at(i)->mem_rsp_ports.at(j));
+    for (uint32_t j = 0; j < l1_mem_ports; ++j) {
+      sockets_.at(i)->mem_req_ports.at(j).bind(&l2cache_->CoreReqPorts.at(i * l1_mem_ports + j));
+      l2cache_->CoreRspPorts.at(i * l1_mem_ports + j).bind(&sockets_.at(i)->mem_rsp_ports.at(j));
     }
   }
 
   // connect l2cache memory interfaces
-  for (uint32_t i = 0; i < L2_MEM_PORTS; ++i) {
+  for (uint32_t i = 0; i < l2.mem_ports; ++i) {
     l2cache_->MemReqPorts.at(i).bind(&this->mem_req_ports.at(i));
     this->mem_rsp_ports.at(i).bind(&l2cache_->MemRspPorts.at(i));
   }
@@ -88,9 +94,20 @@ void Cluster::tick() {
   //--
 }
 
-void Cluster::attach_ram(RAM* ram) {
+bool Cluster::idle() const {
+  return true;
+}
+
+void Cluster::attach_ram(MemOverlay* mem) {
+  mem_overlay_ = mem;
   for (auto& socket : sockets_) {
-    socket->attach_ram(ram);
+    socket->attach_ram(mem);
+  }
+}
+
+void Cluster::mem_sync() {
+  if (mem_overlay_) {
+    mem_overlay_->sync();
   }
 }
 
@@ -145,6 +162,37 @@ void Cluster::barrier(uint32_t bar_id, uint32_t count, uint32_t core_id) {
     }
 }
 
+void Cluster::warm_l2cache(uint64_t addr, bool write) {
+  if (l2cache_->warm(addr, &write)) {
+    processor_->warm_l3cache(addr, write);
+  }
+}
+
+void Cluster::save(CheckpointWriter& ckpt) const {
+  l2cache_->save(ckpt);
+  for (auto& socket : sockets_) {
+    socket->save(ckpt);
+  }
+}
+
+void Cluster::restore(CheckpointReader& ckpt) {
+  l2cache_->restore(ckpt);
+  for (auto& socket : sockets_) {
+    socket->restore(ckpt);
+  }
+}
+
+void Cluster::save_state(CheckpointWriter& ckpt) const {
+  ckpt.write_vector(barriers_);
+}
+
+void Cluster::restore_state(CheckpointReader& ckpt) {
+  auto num_barriers = barriers_.size();
+  ckpt.read_vector(&barriers_);
+  if (barriers_.size() != num_barriers)
+    throw std::runtime_error("checkpoint configuration mismatch: number of barriers");
+}
+
 Cluster::PerfStats Cluster::perf_stats() const {
   PerfStats perf_stats;
   perf_stats.l2cache = l2cache_->perf_stats();
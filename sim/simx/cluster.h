@@ -21,6 +21,7 @@
 #include "core.h"
 #include "socket.h"
 #include "constants.h"
+#include "mem_overlay.h"
 
 namespace vortex {
 
@@ -55,7 +56,12 @@ public:
 
   void tick();
 
-  void attach_ram(RAM* ram);
+  bool idle() const;
+
+  void attach_ram(MemOverlay* mem);
+
+  // wait for lower clusters to complete the cycle before an atomic access
+  void mem_sync();
 
   #ifdef VM_ENABLE
   void set_satp(uint64_t satp);
@@ -67,6 +73,20 @@ public:
 
   void barrier(uint32_t bar_id, uint32_t count, uint32_t core_id);
 
+  const std::vector<Socket::Ptr>& sockets() const {
+    return sockets_;
+  }
+
+  void warm_l2cache(uint64_t addr, bool write);
+
+  // save or restore the cache state
+  void save(CheckpointWriter& ckpt) const;
+  void restore(CheckpointReader& ckpt);
+
+  // save or restore the barrier state of a running kernel
+  void save_state(CheckpointWriter& ckpt) const;
+  void restore_state(CheckpointReader& ckpt);
+
   PerfStats perf_stats() const;
 
 private:
@@ -76,6 +96,7 @@ private:
   std::vector<CoreMask>       barriers_;
   CacheSim::Ptr               l2cache_;
   uint32_t                    cores_per_socket_;
+  MemOverlay*                 mem_overlay_;
 };
 
 } // namespace vortex
\ No newline at end of file
@@ -24,6 +24,10 @@
 #define MEM_CLOCK_RATIO   1
 #endif
 
+#ifndef DECODE_CACHE_SIZE
+#define DECODE_CACHE_SIZE 4096
+#endif
+
 namespace vortex {
 
 inline constexpr uint32_t XLENB           = (XLEN / 8);
@@ -20,6 +20,7 @@
 #include "arch.h"
 #include "mem.h"
 #include "core.h"
+#include "socket.h"
 #include "debug.h"
 #include "constants.h"
 
@@ -34,8 +35,8 @@ Core::Core(const SimContext& ctx,
   : SimObject(ctx, StrFormat("core%d", core_id))
   , icache_req_ports(1, this)
   , icache_rsp_ports(1, this)
-  , dcache_req_ports(DCACHE_NUM_REQS, this)
-  , dcache_rsp_ports(DCACHE_NUM_REQS, this)
+  , dcache_req_ports(arch.dcache_num_reqs(), this)
+  , dcache_rsp_ports(arch.dcache_num_reqs(), this)
   , core_id_(core_id)
   , socket_(socket)
   , arch_(arch)
@@ -48,23 +49,25 @@ Core::Core(const SimContext& ctx,
   , emulator_(arch, dcrs, this)
   , ibuffers_(arch.num_warps(), IBUF_SIZE)
   , scoreboard_(arch_)
-  , operands_(ISSUE_WIDTH)
+  , operands_(arch.issue_width())
   , dispatchers_((uint32_t)FUType::Count)
   , func_units_((uint32_t)FUType::Count)
-  , lmem_switch_(NUM_LSU_BLOCKS)
-  , mem_coalescers_(NUM_LSU_BLOCKS)
+  , lmem_switch_(arch.num_lsu_blocks())
+  , mem_coalescers_(arch.num_lsu_blocks())
   , pending_icache_(arch_.num_warps())
-  , commit_arbs_(ISSUE_WIDTH)
-  , ibuffer_arbs_(ISSUE_WIDTH, {ArbiterType::RoundRobin, PER_ISSUE_WARPS})
+  , commit_arbs_(arch.issue_width())
+  , ibuffer_arbs_(arch.issue_width(), {ArbiterType::RoundRobin, arch.per_issue_warps()})
+  , draining_(false)
+  , pipe_trace_(nullptr)
 {
   char sname[100];
 
-  for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+  for (uint32_t iw = 0; iw < arch_.issue_width(); ++iw) {
     operands_.at(iw) = Operands::Create(this);
   }
 
   // create the memory coalescer
-  for (uint32_t b = 0; b < NUM_LSU_BLOCKS; ++b) {
+  for (uint32_t b = 0; b < arch_.num_lsu_blocks(); ++b) {
     snprintf(sname, 100, "%s-coalescer%d", this->name().c_str(), b);
     mem_coalescers_.at(b) = MemCoalescer::Create(sname, LSU_CHANNELS, DCACHE_CHANNELS, DCACHE_WORD_SIZE, LSUQ_OUT_SIZE, 1);
   }
@@ -80,28 +83,28 @@ Core::Core(const SimContext& ctx,
   });
 
   // create lmem switch
-  for (uint32_t b = 0; b < NUM_LSU_BLOCKS; ++b) {
+  for (uint32_t b = 0; b < arch_.num_lsu_blocks(); ++b) {
     snprintf(sname, 100, "%s-lmem_switch%d", this->name().c_str(), b);
     lmem_switch_.at(b) = LocalMemSwitch::Create(sname, 1);
   }
 
   // create dcache adapter
-  std::vector<LsuMemAdapter::Ptr> lsu_dcache_adapter(NUM_LSU_BLOCKS);
-  for (uint32_t b = 0; b < NUM_LSU_BLOCKS; ++b) {
+  std::vector<LsuMemAdapter::Ptr> lsu_dcache_adapter(arch_.num_lsu_blocks());
+  for (uint32_t b = 0; b < arch_.num_lsu_blocks(); ++b) {
     snprintf(sname, 100, "%s-lsu_dcache_adapter%d", this->name().c_str(), b);
     lsu_dcache_adapter.at(b) = LsuMemAdapter::Create(sname, DCACHE_CHANNELS, 1);
   }
 
   // create lmem arbiter
   snprintf(sname, 100, "%s-lmem_arb", this->name().c_str());
-  auto lmem_arb = LsuArbiter::Create(sname, ArbiterType::RoundRobin, NUM_LSU_BLOCKS, 1);
+  auto lmem_arb = LsuArbiter::Create(sname, ArbiterType::RoundRobin, arch_.num_lsu_blocks(), 1);
 
   // create lmem adapter
   snprintf(sname, 100, "%s-lsu_lmem_adapter", this->name().c_str());
   auto lsu_lmem_adapter = LsuMemAdapter::Create(sname, LSU_CHANNELS, 1);
 
   // connect lmem switch
-  for (uint32_t b = 0; b < NUM_LSU_BLOCKS; ++b) {
+  for (uint32_t b = 0; b < arch_.num_lsu_blocks(); ++b) {
     lmem_switch_.at(b)->ReqDC.bind(&mem_coalescers_.at(b)->ReqIn);
     lmem_switch_.at(b)->ReqLmem.bind(&lmem_arb->ReqIn.at(b));
 
@@ -120,13 +123,13 @@ Core::Core(const SimContext& ctx,
   }
 
   // connect dcache coalescer
-  for (uint32_t b = 0; b < NUM_LSU_BLOCKS; ++b) {
+  for (uint32_t b = 0; b < arch_.num_lsu_blocks(); ++b) {
     mem_coalescers_.at(b)->ReqOut.bind(&lsu_dcache_adapter.at(b)->ReqIn);
     lsu_dcache_adapter.at(b)->RspIn.bind(&mem_coalescers_.at(b)->RspOut);
   }
 
   // connect dcache adapter
-  for (uint32_t b = 0; b < NUM_LSU_BLOCKS; ++b) {
+  for (uint32_t b = 0; b < arch_.num_lsu_blocks(); ++b) {
     for (uint32_t c = 0; c < DCACHE_CHANNELS; ++c) {
       uint32_t p = b * DCACHE_CHANNELS + c;
       lsu_dcache_adapter.at(b)->ReqOut.at(c).bind(&dcache_req_ports.at(p));
@@ -135,15 +138,15 @@ Core::Core(const SimContext& ctx,
   }
 
   // initialize dispatchers
-  dispatchers_.at((int)FUType::ALU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, NUM_ALU_BLOCKS, NUM_ALU_LANES);
-  dispatchers_.at((int)FUType::FPU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, NUM_FPU_BLOCKS, NUM_FPU_LANES);
-  dispatchers_.at((int)FUType::LSU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, NUM_LSU_BLOCKS, NUM_LSU_LANES);
-  dispatchers_.at((int)FUType::SFU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, NUM_SFU_BLOCKS, NUM_SFU_LANES);
+  dispatchers_.at((int)FUType::ALU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, arch_.num_alu_blocks(), NUM_ALU_LANES);
+  dispatchers_.at((int)FUType::FPU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, arch_.num_fpu_blocks(), NUM_FPU_LANES);
+  dispatchers_.at((int)FUType::LSU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, arch_.num_lsu_blocks(), NUM_LSU_LANES);
+  dispatchers_.at((int)FUType::SFU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, arch_.num_sfu_blocks(), NUM_SFU_LANES);
 #ifdef EXT_V_ENABLE
-  dispatchers_.at((int)FUType::VPU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, NUM_VPU_BLOCKS, NUM_VPU_LANES);
+  dispatchers_.at((int)FUType::VPU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, arch_.num_vpu_blocks(), NUM_VPU_LANES);
 #endif
 #ifdef EXT_TCU_ENABLE
-  dispatchers_.at((int)FUType::TCU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, NUM_TCU_BLOCKS, NUM_TCU_LANES);
+  dispatchers_.at((int)FUType::TCU) = SimPlatform::instance().create_object<Dispatcher>(this, 2, arch_.num_tcu_blocks(), NUM_TCU_LANES);
 #endif
 
   // initialize execute units
@@ -159,7 +162,7 @@ Core::Core(const SimContext& ctx,
 #endif
 
   // bind commit arbiters
-  for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+  for (uint32_t iw = 0; iw < arch_.issue_width(); ++iw) {
     snprintf(sname, 100, "%s-commit-arb%d", this->name().c_str(), iw);
     auto arbiter = TraceArbiter::Create(sname, ArbiterType::RoundRobin, (uint32_t)FUType::Count, 1);
     for (uint32_t fu = 0; fu < (uint32_t)FUType::Count; ++fu) {
@@ -168,6 +171,17 @@ Core::Core(const SimContext& ctx,
     commit_arbs_.at(iw) = arbiter;
   }
 
+  // wake up the core on pipeline outputs
+  for (uint32_t iw = 0; iw < arch_.issue_width(); ++iw) {
+    operands_.at(iw)->Output.set_reader(this);
+    commit_arbs_.at(iw)->Outputs.at(0).set_reader(this);
+  }
+  for (auto& dispatch : dispatchers_) {
+    for (auto& output : dispatch->Outputs) {
+      output.set_reader(this);
+    }
+  }
+
   this->reset();
 }
 
@@ -199,6 +213,9 @@ void Core::reset() {
   pending_instrs_.clear();
   pending_ifetches_ = 0;
 
+  draining_ = false;
+  parked_warps_.reset();
+
   perf_stats_ = PerfStats();
 }
 
@@ -215,6 +232,9 @@ void Core::tick() {
 }
 
 void Core::schedule() {
+  if (draining_)
+    return;
+
   auto trace = emulator_.step();
   if (trace == nullptr) {
     ++perf_stats_.sched_idle;
@@ -225,6 +245,7 @@ void Core::schedule() {
   emulator_.suspend(trace->wid);
 
   DT(3, "pipeline-schedule: " << *trace);
+  this->trace_pipe(PipeStage::Schedule, trace);
 
   // advance to fetch stage
   fetch_latch_.push(trace);
@@ -250,12 +271,18 @@ void Core::fetch() {
   if (fetch_latch_.empty())
     return;
   auto trace = fetch_latch_.front();
+  if (trace->fetch_tlb_latency != 0) {
+    // wait for the address translation
+    --trace->fetch_tlb_latency;
+    return;
+  }
   MemReq mem_req;
   mem_req.addr  = trace->PC;
   mem_req.write = false;
   mem_req.tag   = pending_icache_.allocate(trace);
   mem_req.cid   = trace->cid;
   mem_req.uuid  = trace->uuid;
+  mem_req.pc    = trace->PC;
   icache_req_ports.at(0).push(mem_req, 2);
   DT(3, "icache-req: addr=0x" << std::hex << mem_req.addr << ", tag=0x" << mem_req.tag << std::dec << ", " << *trace);
   fetch_latch_.pop();
@@ -296,7 +323,7 @@ void Core::decode() {
 
 void Core::issue() {
   // dispatch operands
-  for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+  for (uint32_t iw = 0; iw < arch_.issue_width(); ++iw) {
     auto& operand = operands_.at(iw);
     if (operand->Output.empty())
       continue;
@@ -306,11 +333,11 @@ void Core::issue() {
   }
 
   // issue ibuffer instructions
-  for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+  for (uint32_t iw = 0; iw < arch_.issue_width(); ++iw) {
     bool has_instrs = false;
-    BitVector<> ready_set(PER_ISSUE_WARPS);
-    for (uint32_t w = 0; w < PER_ISSUE_WARPS; ++w) {
-      uint32_t wid = w * ISSUE_WIDTH + iw;
+    BitVector<> ready_set(arch_.per_issue_warps());
+    for (uint32_t w = 0; w < arch_.per_issue_warps(); ++w) {
+      uint32_t wid = w * arch_.issue_width() + iw;
       auto& ibuffer = ibuffers_.at(wid);
       if (ibuffer.empty())
         continue;
@@ -329,29 +356,7 @@ void Core::issue() {
           }
           DTN(4, "}, " << *trace << std::endl);
         }
-        for (uint32_t j = 0, n = uses.size(); j < n; ++j) {
-          auto& use = uses.at(j);
-          switch (use.fu_type) {
-          case FUType::ALU: ++perf_stats_.scrb_alu; break;
-          case FUType::FPU: ++perf_stats_.scrb_fpu; break;
-          case FUType::LSU: ++perf_stats_.scrb_lsu; break;
-          case FUType::SFU: {
-            ++perf_stats_.scrb_sfu;
-            if (std::get_if<WctlType>(&use.op_type)) {
-              ++perf_stats_.scrb_wctl;
-            } else if (std::get_if<CsrType>(&use.op_type)) {
-              ++perf_stats_.scrb_csrs;
-            }
-          } break;
-        #ifdef EXT_V_ENABLE
-          case FUType::VPU: ++perf_stats_.scrb_vpu; break;
-        #endif
-        #ifdef EXT_TCU_ENABLE
-          case FUType::TCU: ++perf_stats_.scrb_tcu; break;
-        #endif
-          default: assert(false);
-          }
-        }
+        this->count_scrb_stalls(uses, 1);
       } else {
         trace->log_once(false);
         ready_set.set(w); // mark instruction as ready
@@ -361,11 +366,12 @@ void Core::issue() {
     if (ready_set.any()) {
       // select one instruction from ready set
       auto w = ibuffer_arbs_.at(iw).grant(ready_set);
-      uint32_t wid = w * ISSUE_WIDTH + iw;
+      uint32_t wid = w * arch_.issue_width() + iw;
       auto& ibuffer = ibuffers_.at(wid);
       auto trace = ibuffer.top();
       // update scoreboard
       DT(3, "pipeline-ibuffer: " << *trace);
+      this->trace_pipe(PipeStage::IBuffer, trace);
       if (trace->wb) {
         scoreboard_.reserve(trace);
       }
@@ -381,11 +387,36 @@ void Core::issue() {
   }
 }
 
+void Core::count_scrb_stalls(const std::vector<Scoreboard::reg_use_t>& uses, uint64_t cycles) {
+  for (auto& use : uses) {
+    switch (use.fu_type) {
+    case FUType::ALU: perf_stats_.scrb_alu += cycles; break;
+    case FUType::FPU: perf_stats_.scrb_fpu += cycles; break;
+    case FUType::LSU: perf_stats_.scrb_lsu += cycles; break;
+    case FUType::SFU: {
+      perf_stats_.scrb_sfu += cycles;
+      if (std::get_if<WctlType>(&use.op_type)) {
+        perf_stats_.scrb_wctl += cycles;
+      } else if (std::get_if<CsrType>(&use.op_type)) {
+        perf_stats_.scrb_csrs += cycles;
+      }
+    } break;
+  #ifdef EXT_V_ENABLE
+    case FUType::VPU: perf_stats_.scrb_vpu += cycles; break;
+  #endif
+  #ifdef EXT_TCU_ENABLE
+    case FUType::TCU: perf_stats_.scrb_tcu += cycles; break;
+  #endif
+    default: assert(false);
+    }
+  }
+}
+
 void Core::execute() {
   for (uint32_t fu = 0; fu < (uint32_t)FUType::Count; ++fu) {
     auto& dispatch = dispatchers_.at(fu);
     auto& func_unit = func_units_.at(fu);
-    for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+    for (uint32_t iw = 0; iw < arch_.issue_width(); ++iw) {
       if (dispatch->Outputs.at(iw).empty())
         continue;
       auto trace = dispatch->Outputs.at(iw).front();
@@ -397,7 +428,7 @@ void Core::execute() {
 
 void Core::commit() {
   // process completed instructions
-  for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+  for (uint32_t iw = 0; iw < arch_.issue_width(); ++iw) {
     auto& commit_arb = commit_arbs_.at(iw);
     if (commit_arb->Outputs.at(0).empty())
       continue;
@@ -405,6 +436,7 @@ void Core::commit() {
 
     // advance to commit stage
     DT(3, "pipeline-commit: " << *trace);
+    this->trace_pipe(PipeStage::Commit, trace);
     assert(trace->cid == core_id_);
 
     // update scoreboard
@@ -434,6 +466,57 @@ void Core::commit() {
   }
 }
 
+bool Core::idle() const {
+  for (uint32_t iw = 0; iw < arch_.issue_width(); ++iw) {
+    if (!commit_arbs_.at(iw)->Outputs.at(0).empty()
+     || !operands_.at(iw)->Output.empty())
+      return false;
+  }
+  for (auto& dispatch : dispatchers_) {
+    for (auto& output : dispatch->Outputs) {
+      if (!output.empty())
+        return false;
+    }
+  }
+
+  // buffered instructions wait on the scoreboard
+  for (auto& ibuffer : ibuffers_) {
+    if (!ibuffer.empty() && !scoreboard_.in_use(ibuffer.top()))
+      return false;
+  }
+
+  // decoded instructions wait on a full ibuffer
+  if (!decode_latch_.empty()
+   && !ibuffers_.at(decode_latch_.front()->wid).full())
+    return false;
+
+  return fetch_latch_.empty()
+      && icache_rsp_ports.at(0).empty()
+      && emulator_.idle();
+}
+
+void Core::skip(uint64_t cycles) {
+  for (uint32_t iw = 0; iw < arch_.issue_width(); ++iw) {
+    bool has_instrs = false;
+    for (uint32_t w = 0; w < arch_.per_issue_warps(); ++w) {
+      auto& ibuffer = ibuffers_.at(w * arch_.issue_width() + iw);
+      if (ibuffer.empty())
+        continue;
+      has_instrs = true;
+      this->count_scrb_stalls(scoreboard_.get_uses(ibuffer.top()), cycles);
+    }
+    if (has_instrs) {
+      perf_stats_.scrb_stalls += cycles;
+    }
+  }
+  if (!decode_latch_.empty()) {
+    perf_stats_.ibuf_stalls += cycles;
+  }
+  perf_stats_.ifetch_latency += pending_ifetches_ * cycles;
+  perf_stats_.sched_idle += cycles;
+  perf_stats_.cycles += cycles;
+}
+
 int Core::get_exitcode() const {
   return emulator_.get_exitcode();
 }
@@ -451,26 +534,200 @@ bool Core::running() const {
 }
 
 void Core::resume(uint32_t wid) {
+  this->wakeup();
   emulator_.resume(wid);
 }
 
 bool Core::barrier(uint32_t bar_id, uint32_t count, uint32_t wid) {
+  this->wakeup();
   return emulator_.barrier(bar_id, count, wid);
 }
 
 bool Core::wspawn(uint32_t num_warps, Word nextPC) {
+  this->wakeup();
   return emulator_.wspawn(num_warps, nextPC);
 }
 
-void Core::attach_ram(RAM* ram) {
+bool Core::step_functional(uint64_t* PC) {
+  auto trace = emulator_.step();
+  if (trace == nullptr) {
+    // start a new round over the warps that already stepped
+    if (parked_warps_.none())
+      return false;
+    this->release_parked_warps();
+    trace = emulator_.step();
+    if (trace == nullptr)
+      return false;
+  }
+
+  DT(3, "functional-step: " << *trace);
+
+  // hold the warp until the next round, or until its control instruction releases it
+  auto wid = trace->wid;
+  emulator_.suspend(wid);
+  parked_warps_.reset(wid);
+  bool release = true;
+  if (auto wctl_type = std::get_if<WctlType>(&trace->op_type)) {
+    if (*wctl_type == WctlType::WSPAWN) {
+      auto trace_data = std::dynamic_pointer_cast<SfuTraceData>(trace->data);
+      release = emulator_.wspawn(trace_data->arg1, trace_data->arg2);
+    } else if (*wctl_type == WctlType::BAR) {
+      auto trace_data = std::dynamic_pointer_cast<SfuTraceData>(trace->data);
+      release = emulator_.barrier(trace_data->arg1, trace_data->arg2, wid);
+    }
+  }
+  if (release) {
+    parked_warps_.set(wid);
+  }
+
+  this->warm_caches(trace);
+
+  perf_stats_.instrs += trace->tmask.count();
+#ifdef EXT_V_ENABLE
+  if (std::get_if<VsetType>(&trace->op_type)
+   || std::get_if<VlsType>(&trace->op_type)
+   || std::get_if<VopType>(&trace->op_type)) {
+    perf_stats_.vinstrs += trace->tmask.count();
+  }
+#endif
+
+  *PC = trace->PC;
+
+  trace->~instr_trace_t();
+  trace_pool_.deallocate(trace, 1);
+  return true;
+}
+
+void Core::warm_caches(const instr_trace_t* trace) {
+  uint32_t core_index = core_id_ % arch_.socket_size();
+  socket_->warm_icache(core_index, trace->PC);
+
+  if (!trace->data)
+    return;
+  auto& addrs = warm_addrs_;
+  addrs.clear();
+#ifdef EXT_V_ENABLE
+  if (std::get_if<VlsType>(&trace->op_type)) {
+    auto trace_data = std::dynamic_pointer_cast<VecUnit::MemTraceData>(trace->data);
+    for (uint32_t t = 0; t < trace_data->mem_addrs.size(); ++t) {
+      if (trace->tmask.test(t)) {
+        addrs.insert(addrs.end(), trace_data->mem_addrs.at(t).begin(), trace_data->mem_addrs.at(t).end());
+      }
+    }
+  } else
+#endif
+  if (std::get_if<LsuType>(&trace->op_type)) {
+    auto trace_data = std::dynamic_pointer_cast<LsuTraceData>(trace->data);
+    for (uint32_t t = 0; t < trace_data->mem_addrs.size(); ++t) {
+      if (trace->tmask.test(t)) {
+        addrs.push_back(trace_data->mem_addrs.at(t));
+      }
+    }
+  } else {
+    return;
+  }
+
+  bool is_fence, is_write;
+  LsuUnit::decode_op(trace, &is_fence, &is_write);
+
+  // one access per cache line, as issued by the memory coalescer
+  uint64_t prev_line = -1ull;
+  for (auto& addr : addrs) {
+    uint64_t line = addr.addr / L1_LINE_SIZE;
+    if (line == prev_line || get_addr_type(addr.addr) != AddrType::Global)
+      continue;
+    socket_->warm_dcache(core_index, addr.addr, is_write);
+    prev_line = line;
+  }
+}
+
+void Core::end_functional() {
+  this->release_parked_warps();
+  this->wakeup();
+}
+
+void Core::release_parked_warps() {
+  for (uint32_t wid = 0, nw = arch_.num_warps(); wid < nw; ++wid) {
+    if (parked_warps_.test(wid) && emulator_.suspended(wid)) {
+      emulator_.resume(wid);
+    }
+  }
+  parked_warps_.reset();
+}
+
+void Core::set_draining(bool enable) {
+  draining_ = enable;
+  if (!enable) {
+    // resume scheduling
+    this->wakeup();
+  }
+}
+
+void Core::save(CheckpointWriter& ckpt) const {
+  ckpt.section("CORE");
+  ckpt.write(perf_stats_);
+  local_mem_->save(ckpt);
+  emulator_.save(ckpt);
+}
+
+void Core::restore(CheckpointReader& ckpt) {
+  ckpt.section("CORE");
+  perf_stats_ = ckpt.read<PerfStats>();
+  local_mem_->restore(ckpt);
+  emulator_.restore(ckpt);
+  this->wakeup();
+}
+
+void Core::record_pipe(PipeStage stage, const instr_trace_t* trace) {
+  PipeUnit unit;
+  switch (trace->fu_type) {
+  case FUType::ALU: unit = PipeUnit::ALU; break;
+  case FUType::LSU: unit = PipeUnit::LSU; break;
+  case FUType::FPU: unit = PipeUnit::FPU; break;
+  case FUType::SFU: unit = PipeUnit::SFU; break;
+#ifdef EXT_V_ENABLE
+  case FUType::VPU: unit = PipeUnit::VPU; break;
+#endif
+#ifdef EXT_TCU_ENABLE
+  case FUType::TCU: unit = PipeUnit::TCU; break;
+#endif
+  default: unit = PipeUnit::None; break;
+  }
+  uint64_t tmask = 0;
+  for (uint32_t t = 0, n = std::min<uint32_t>(trace->tmask.size(), 64); t < n; ++t) {
+    tmask |= uint64_t(trace->tmask.test(t)) << t;
+  }
+  pipe_trace_->record({
+    SimPlatform::instance().cycles(),
+    trace->uuid,
+    trace->PC,
+    tmask,
+    core_id_,
+    (uint16_t)trace->wid,
+    stage,
+    unit
+  });
+}
+
+void Core::attach_ram(MemDevice* ram) {
   emulator_.attach_ram(ram);
 }
 
 const Core::PerfStats& Core::perf_stats() const {
   perf_stats_.opds_stalls = 0;
-  for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+  for (uint32_t iw = 0; iw < arch_.issue_width(); ++iw) {
     perf_stats_.opds_stalls += operands_.at(iw)->total_stalls();
   }
+  auto& decode_perf = emulator_.decode_perf_stats();
+  perf_stats_.decodes = decode_perf.lookups;
+  perf_stats_.decode_hits = decode_perf.hits;
+#ifdef VM_ENABLE
+  auto& tlb_perf = emulator_.tlb_perf_stats();
+  perf_stats_.tlb_hits = tlb_perf.tlb_hits;
+  perf_stats_.tlb_misses = tlb_perf.tlb_misses;
+  perf_stats_.tlb_walk_latency = tlb_perf.walk_latency;
+  perf_stats_.pwc_hits = tlb_perf.pwc_hits;
+#endif
   return perf_stats_;
 }
 
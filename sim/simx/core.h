@@ -34,6 +34,7 @@
 #include "func_unit.h"
 #include "mem_coalescer.h"
 #include "VX_config.h"
+#include <pipe_trace.h>
 
 namespace vortex {
 
@@ -69,6 +70,14 @@ public:
     uint64_t stores;
     uint64_t ifetch_latency;
     uint64_t load_latency;
+    uint64_t decodes;
+    uint64_t decode_hits;
+  #ifdef VM_ENABLE
+    uint64_t tlb_hits;
+    uint64_t tlb_misses;
+    uint64_t tlb_walk_latency;
+    uint64_t pwc_hits;
+  #endif
 
     PerfStats()
       : cycles(0)
@@ -96,6 +105,14 @@ public:
       , stores(0)
       , ifetch_latency(0)
       , load_latency(0)
+      , decodes(0)
+      , decode_hits(0)
+    #ifdef VM_ENABLE
+      , tlb_hits(0)
+      , tlb_misses(0)
+      , tlb_walk_latency(0)
+      , pwc_hits(0)
+    #endif
     {}
   };
 
@@ -118,7 +135,11 @@ public:
 
   void tick();
 
-  void attach_ram(RAM* ram);
+  bool idle() const;
+
+  void skip(uint64_t cycles);
+
+  void attach_ram(MemDevice* ram);
 #ifdef VM_ENABLE
   void set_satp(uint64_t satp);
 #endif
@@ -131,6 +152,28 @@ public:
 
   bool wspawn(uint32_t num_warps, Word nextPC);
 
+  // execute the next instruction without timing, warming up the caches,
+  // returns false if no warp is ready
+  bool step_functional(uint64_t* PC);
+
+  // release the warps held between functional rounds
+  void end_functional();
+
+  // stop scheduling new instructions
+  void set_draining(bool enable);
+
+  // save or restore the state of a running kernel
+  void save(CheckpointWriter& ckpt) const;
+  void restore(CheckpointReader& ckpt);
+
+  bool drained() const {
+    return pending_instrs_.empty();
+  }
+
+  uint64_t instrs() const {
+    return perf_stats_.instrs;
+  }
+
   uint32_t id() const {
     return core_id_;
   }
@@ -175,6 +218,17 @@ public:
     return trace_pool_;
   }
 
+  // binary pipeline tracing (nullptr: disabled)
+  void set_pipe_trace(PipeTraceWriter* pipe_trace) {
+    pipe_trace_ = pipe_trace;
+  }
+
+  void trace_pipe(PipeStage stage, const instr_trace_t* trace) {
+    if (pipe_trace_) {
+      this->record_pipe(stage, trace);
+    }
+  }
+
   const PerfStats& perf_stats() const;
 
   int get_exitcode() const;
@@ -188,6 +242,14 @@ private:
   void execute();
   void commit();
 
+  void count_scrb_stalls(const std::vector<Scoreboard::reg_use_t>& uses, uint64_t cycles);
+
+  void warm_caches(const instr_trace_t* trace);
+
+  void release_parked_warps();
+
+  void record_pipe(PipeStage stage, const instr_trace_t* trace);
+
   uint32_t core_id_;
   Socket* socket_;
   const Arch& arch_;
@@ -215,7 +277,7 @@ private:
   PipelineLatch decode_latch_;
 
   HashTable<instr_trace_t*> pending_icache_;
-  std::list<instr_trace_t*, PoolAllocator<instr_trace_t*, 64>> pending_instrs_;
+  std::list<instr_trace_t*, PoolAllocator<instr_trace_t*>> pending_instrs_;
 
   uint64_t pending_ifetches_;
 
@@ -226,7 +288,13 @@ private:
   uint32_t commit_exe_;
   std::vector<Arbiter> ibuffer_arbs_;
 
-  PoolAllocator<instr_trace_t, 64> trace_pool_;
+  PoolAllocator<instr_trace_t> trace_pool_;
+
+  bool draining_;
+  WarpMask parked_warps_;
+  std::vector<mem_addr_size_t> warm_addrs_;
+
+  PipeTraceWriter* pipe_trace_;
 
   friend class LsuUnit;
   friend class AluUnit;
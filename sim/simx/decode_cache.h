@@ -0,0 +1,105 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <util.h>
+#include <vector>
+#include <deque>
+#include "instr.h"
+
+namespace vortex {
+
+// Direct-mapped cache of decoded instructions indexed by PC.
+// An entry holds all micro-instructions produced by a single fetch.
+// Writes overlapping the cached code range flush the whole cache.
+class DecodeCache {
+public:
+  struct PerfStats {
+    uint64_t lookups;
+    uint64_t hits;
+
+    PerfStats()
+      : lookups(0)
+      , hits(0)
+    {}
+  };
+
+  struct entry_t {
+    uint64_t PC;
+    uint32_t code;
+    bool     valid;
+    std::vector<Instr::Ptr> instrs;
+  };
+
+  DecodeCache(uint32_t size)
+    : entries_(size)
+    , mask_(size - 1)
+    , code_start_(-1ull)
+    , code_end_(0) {
+    assert(ispow2(size));
+  }
+
+  const entry_t* lookup(uint64_t PC) {
+    ++perf_stats_.lookups;
+    auto& entry = entries_[(PC >> 2) & mask_];
+    if (!entry.valid || entry.PC != PC)
+      return nullptr;
+    ++perf_stats_.hits;
+    return &entry;
+  }
+
+  void insert(uint64_t PC, uint32_t code, const std::deque<Instr::Ptr>& instrs) {
+    auto& entry = entries_[(PC >> 2) & mask_];
+    entry.PC = PC;
+    entry.code = code;
+    entry.valid = true;
+    entry.instrs.assign(instrs.begin(), instrs.end());
+    code_start_ = std::min(code_start_, PC);
+    code_end_ = std::max(code_end_, PC + sizeof(uint32_t));
+  }
+
+  void invalidate(uint64_t addr, uint64_t size) {
+    if (addr < code_end_ && (addr + size) > code_start_) {
+      this->clear();
+    }
+  }
+
+  void clear() {
+    if (code_end_ == 0)
+      return;
+    for (auto& entry : entries_) {
+      entry.valid = false;
+      entry.instrs.clear();
+    }
+    code_start_ = -1ull;
+    code_end_ = 0;
+  }
+
+  const PerfStats& perf_stats() const {
+    return perf_stats_;
+  }
+
+  void reset_stats() {
+    perf_stats_ = PerfStats();
+  }
+
+private:
+  std::vector<entry_t> entries_;
+  uint64_t mask_;
+  uint64_t code_start_;
+  uint64_t code_end_;
+  PerfStats perf_stats_;
+};
+
+}
@@ -18,14 +18,14 @@ using namespace vortex;
 
 Dispatcher::Dispatcher(const SimContext& ctx, Core* core, uint32_t buf_size, uint32_t block_size, uint32_t num_lanes)
   : SimObject<Dispatcher>(ctx, "dispatcher")
-  , Outputs(ISSUE_WIDTH, this)
-  , Inputs(ISSUE_WIDTH, this)
+  , Outputs(core->arch().issue_width(), this)
+  , Inputs(core->arch().issue_width(), this)
   , arch_(core->arch())
   , core_(core)
   , buf_size_(buf_size)
   , block_size_(block_size)
   , num_lanes_(num_lanes)
-  , num_blocks_(ISSUE_WIDTH / block_size)
+  , num_blocks_(core->arch().issue_width() / block_size)
   , num_packets_(core->arch().num_threads() / num_lanes)
   , batch_idx_(0)
   , block_pids_(block_size, 0)
@@ -98,6 +98,7 @@ void Dispatcher::tick() {
       ++block_sent;
     }
     DT(3, "pipeline-dispatch: " << *new_trace);
+    core_->trace_pipe(PipeStage::Dispatch, new_trace);
     output.push(new_trace, 1);
   }
 
@@ -110,3 +111,19 @@ void Dispatcher::tick() {
     }
   }
 };
+
+bool Dispatcher::idle() const {
+  for (auto& input : Inputs) {
+    if (!input.empty())
+      return false;
+  }
+  return true;
+}
+
+void Dispatcher::skip(uint64_t cycles) {
+  // empty batches are rotated every cycle
+  batch_idx_ = (batch_idx_ + cycles) % num_blocks_;
+  for (auto& bp : block_pids_) {
+    bp = 0;
+  }
+}
@@ -34,6 +34,10 @@ public:
 
 	virtual void tick();
 
+	bool idle() const;
+
+	void skip(uint64_t cycles);
+
 private:
 	const Arch& arch_;
 	Core*    core_;
@@ -27,12 +27,13 @@
 #include "cluster.h"
 #include "processor_impl.h"
 #include "local_mem.h"
+#include "constants.h"
 
 using namespace vortex;
 
 warp_t::warp_t(uint32_t num_threads)
-  : ireg_file(MAX_NUM_REGS, std::vector<Word>(num_threads))
-  , freg_file(MAX_NUM_REGS, std::vector<uint64_t>(num_threads))
+  : ireg_file(MAX_NUM_REGS, num_threads)
+  , freg_file(MAX_NUM_REGS, num_threads)
   , tmask(num_threads)
   , PC(0)
   , uuid(0)
@@ -44,27 +45,31 @@ void warp_t::reset(uint64_t startup_addr) {
   this->uuid = 0;
   this->fcsr = 0;
 
-  for (auto& reg_file : this->ireg_file) {
-    for (auto& reg : reg_file) {
+  uint32_t num_threads = this->tmask.size();
+
+  for (uint32_t r = 0; r < ireg_file.num_regs(); ++r) {
+    auto reg_data = this->ireg_file[r];
+    for (uint32_t t = 0; t < num_threads; ++t) {
     #ifndef NDEBUG
-      reg = 0;
+      reg_data[t] = 0;
     #else
-      reg = std::rand();
+      reg_data[t] = std::rand();
     #endif
     }
   }
 
   // set x0 to zero
-  for (auto& reg : this->ireg_file.at(0)) {
-    reg = 0;
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    this->ireg_file[0][t] = 0;
   }
 
-  for (auto& reg_file : this->freg_file) {
-    for (auto& reg : reg_file) {
+  for (uint32_t r = 0; r < freg_file.num_regs(); ++r) {
+    auto reg_data = this->freg_file[r];
+    for (uint32_t t = 0; t < num_threads; ++t) {
     #ifndef NDEBUG
-      reg = 0;
+      reg_data[t] = 0;
     #else
-      reg = std::rand();
+      reg_data[t] = std::rand();
     #endif
     }
   }
@@ -85,6 +90,12 @@ Emulator::Emulator(const Arch &arch, const DCRS &dcrs, Core* core)
   #ifdef EXT_V_ENABLE
     , vec_unit_(core->vec_unit())
   #endif
+    , decode_cache_(DECODE_CACHE_SIZE)
+    , rd_data_(arch.num_threads())
+    , rs1_data_(arch.num_threads())
+    , rs2_data_(arch.num_threads())
+    , rs3_data_(arch.num_threads())
+    , lane_mask_(arch.num_threads())
 {
   std::srand(50);
   this->reset();
@@ -119,6 +130,16 @@ void Emulator::reset() {
 
   csr_mscratch_ = startup_arg;
 
+  // a new kernel may have been loaded
+  decode_cache_.clear();
+  decode_cache_.reset_stats();
+
+#ifdef VM_ENABLE
+  mmu_.tlbFlush();
+  mmu_.take_latency();
+  mmu_.reset_stats();
+#endif
+
   stalled_warps_.reset();
   active_warps_.reset();
 
@@ -128,7 +149,7 @@ void Emulator::reset() {
   wspawn_.valid = false;
 }
 
-void Emulator::attach_ram(RAM* ram) {
+void Emulator::attach_ram(MemDevice* ram) {
   // bind RAM to memory unit
 #if (XLEN == 64)
   mmu_.attach(*ram, 0, 0x7FFFFFFFFF); //39bit SV39
@@ -137,6 +158,111 @@ void Emulator::attach_ram(RAM* ram) {
 #endif
 }
 
+template <typename T>
+static void save_regfile(CheckpointWriter& ckpt, const RegFile<T>& regfile) {
+  for (uint32_t r = 0; r < regfile.num_regs(); ++r) {
+    ckpt.write(regfile[r], regfile.num_threads() * sizeof(T));
+  }
+}
+
+template <typename T>
+static void restore_regfile(CheckpointReader& ckpt, RegFile<T>& regfile) {
+  for (uint32_t r = 0; r < regfile.num_regs(); ++r) {
+    ckpt.read(regfile[r], regfile.num_threads() * sizeof(T));
+  }
+}
+
+static void save_tmask(CheckpointWriter& ckpt, const ThreadMask& tmask) {
+  for (uint32_t t = 0; t < tmask.size(); ++t) {
+    ckpt.write<uint8_t>(tmask.test(t));
+  }
+}
+
+static void restore_tmask(CheckpointReader& ckpt, ThreadMask& tmask) {
+  for (uint32_t t = 0; t < tmask.size(); ++t) {
+    tmask.set(t, ckpt.read<uint8_t>() != 0);
+  }
+}
+
+void Emulator::save(CheckpointWriter& ckpt) const {
+#ifdef EXT_V_ENABLE
+  // the vector register files are private to the vector unit
+  throw std::runtime_error("checkpointing a running kernel is not supported with the vector extension");
+#endif
+  ckpt.section("EMU");
+  ckpt.write<uint32_t>(warps_.size());
+  ckpt.write<uint32_t>(arch_.num_threads());
+  for (auto& warp : warps_) {
+    // decoded micro-ops are not saved, the warp must be at an instruction boundary
+    if (!warp.ibuffer.empty())
+      throw std::runtime_error("checkpoint taken in the middle of a macro instruction");
+    save_regfile(ckpt, warp.ireg_file);
+    save_regfile(ckpt, warp.freg_file);
+    save_tmask(ckpt, warp.tmask);
+    auto ipdom_stack = warp.ipdom_stack;
+    for (; !ipdom_stack.empty(); ipdom_stack.pop()) {
+      ckpt.write<uint8_t>(1);
+      auto& entry = ipdom_stack.top();
+      save_tmask(ckpt, entry.orig_tmask);
+      save_tmask(ckpt, entry.else_tmask);
+      ckpt.write(entry.PC);
+      ckpt.write(entry.fallthrough);
+    }
+    ckpt.write<uint8_t>(0);
+    ckpt.write(warp.PC);
+    ckpt.write(warp.fcsr);
+    ckpt.write(warp.uuid);
+  }
+  ckpt.write(active_warps_);
+  ckpt.write(stalled_warps_);
+  ckpt.write_vector(barriers_);
+  ckpt.write(csr_mscratch_);
+  ckpt.write(wspawn_);
+}
+
+void Emulator::restore(CheckpointReader& ckpt) {
+  ckpt.section("EMU");
+  ckpt.check<uint32_t>(warps_.size(), "number of warps");
+  ckpt.check<uint32_t>(arch_.num_threads(), "number of threads");
+  for (auto& warp : warps_) {
+    warp.ibuffer.clear();
+    restore_regfile(ckpt, warp.ireg_file);
+    restore_regfile(ckpt, warp.freg_file);
+    restore_tmask(ckpt, warp.tmask);
+    // entries were saved from the top of the stack down
+    std::vector<ipdom_entry_t> ipdom_entries;
+    while (ckpt.read<uint8_t>() != 0) {
+      ThreadMask orig_tmask(arch_.num_threads());
+      ThreadMask else_tmask(arch_.num_threads());
+      restore_tmask(ckpt, orig_tmask);
+      restore_tmask(ckpt, else_tmask);
+      ipdom_entries.emplace_back(orig_tmask, else_tmask, ckpt.read<Word>());
+      ipdom_entries.back().fallthrough = ckpt.read<bool>();
+    }
+    warp.ipdom_stack = {};
+    for (auto it = ipdom_entries.rbegin(); it != ipdom_entries.rend(); ++it) {
+      warp.ipdom_stack.push(*it);
+    }
+    warp.PC = ckpt.read<Word>();
+    warp.fcsr = ckpt.read<Byte>();
+    warp.uuid = ckpt.read<uint32_t>();
+  }
+  active_warps_ = ckpt.read<WarpMask>();
+  stalled_warps_ = ckpt.read<WarpMask>();
+  auto num_barriers = barriers_.size();
+  ckpt.read_vector(&barriers_);
+  if (barriers_.size() != num_barriers)
+    throw std::runtime_error("checkpoint configuration mismatch: number of barriers");
+  csr_mscratch_ = ckpt.read<Word>();
+  wspawn_ = ckpt.read<wspawn_t>();
+
+  // the memory image may differ from the one decoded or translated so far
+  decode_cache_.clear();
+#ifdef VM_ENABLE
+  mmu_.tlbFlush();
+#endif
+}
+
 uint32_t Emulator::fetch(uint32_t wid, uint64_t uuid) {
   auto& warp = warps_.at(wid);
   __unused(uuid);
@@ -149,6 +275,36 @@ uint32_t Emulator::fetch(uint32_t wid, uint64_t uuid) {
   return instr_code;
 }
 
+void Emulator::fetch_decode(uint32_t wid, uint64_t uuid) {
+  auto& warp = warps_.at(wid);
+
+  // reuse previously decoded instructions
+  auto entry = decode_cache_.lookup(warp.PC);
+  if (entry) {
+    DP(1, "Fetch: code=0x" << std::hex << entry->code << std::dec << ", cid=" << core_->id() << ", wid=" << wid << ", tmask=" << warp.tmask
+           << ", PC=0x" << std::hex << warp.PC << " (#" << std::dec << uuid << ")");
+    for (auto& instr : entry->instrs) {
+    #ifdef NDEBUG
+      warp.ibuffer.push_back(instr);
+    #else
+      // cached instructions are shared, make a copy with the new uuid
+      auto instr_copy = std::allocate_shared<Instr>(instr_pool_, *instr);
+      instr_copy->setUUID(uuid);
+      warp.ibuffer.push_back(instr_copy);
+    #endif
+    }
+  #ifdef VM_ENABLE
+    // the fetch still goes through address translation
+    mmu_.translate(warp.PC, ACCESS_TYPE::FETCH);
+  #endif
+    return;
+  }
+
+  auto instr_code = this->fetch(wid, uuid);
+  this->decode(instr_code, wid, uuid);
+  decode_cache_.insert(warp.PC, instr_code, warp.ibuffer);
+}
+
 instr_trace_t* Emulator::step() {
   int scheduled_warp = -1;
 
@@ -182,23 +338,24 @@ instr_trace_t* Emulator::step() {
   auto& warp = warps_.at(scheduled_warp);
   assert(warp.tmask.any());
 
+#ifdef VM_ENABLE
+  uint32_t fetch_tlb_latency = 0;
+#endif
+
+  // unique universal instruction ID, shared by the micro-ops of an instruction
+  uint32_t g_wid = core_->id() * arch_.num_warps() + scheduled_warp;
+  if (warp.ibuffer.empty()) {
+    ++warp.uuid;
+  }
+  uint64_t uuid = (uint64_t(g_wid) << 32) | (warp.uuid - 1);
+
   // fetch next instruction if ibuffer is empty
   if (warp.ibuffer.empty()) {
-    uint64_t uuid = 0;
-  #ifndef NDEBUG
-    {
-      // generate unique universal instruction ID
-      uint32_t instr_uuid = warp.uuid++;
-      uint32_t g_wid = core_->id() * arch_.num_warps() + scheduled_warp;
-      uuid = (uint64_t(g_wid) << 32) | instr_uuid;
-    }
+    // fetch and decode
+    this->fetch_decode(scheduled_warp, uuid);
+  #ifdef VM_ENABLE
+    fetch_tlb_latency = mmu_.take_latency();
   #endif
-
-    // Fetch
-    auto instr_code = this->fetch(scheduled_warp, uuid);
-
-    // decode
-    this->decode(instr_code, scheduled_warp, uuid);
   } else {
     // we have a micro-instruction in the ibuffer
     // adjust PC back to original (incremented in execute())
@@ -210,7 +367,13 @@ instr_trace_t* Emulator::step() {
   warp.ibuffer.pop_front();
 
   // Execute
-  auto trace = this->execute(*instr, scheduled_warp);
+  auto trace = this->execute(*instr, scheduled_warp, uuid);
+
+#ifdef VM_ENABLE
+  // translation delays are replayed by the timing pipeline
+  trace->fetch_tlb_latency = fetch_tlb_latency;
+  trace->tlb_latency = mmu_.take_latency();
+#endif
 
   return trace;
 }
@@ -219,8 +382,14 @@ bool Emulator::running() const {
   return active_warps_.any();
 }
 
+bool Emulator::idle() const {
+  if (wspawn_.valid && active_warps_.count() == 1)
+    return false;
+  return (active_warps_ & ~stalled_warps_).none();
+}
+
 int Emulator::get_exitcode() const {
-  return warps_.at(0).ireg_file.at(3).at(0);
+  return warps_.at(0).ireg_file[3][0];
 }
 
 void Emulator::suspend(uint32_t wid) {
@@ -353,6 +522,7 @@ void Emulator::dcache_write(const void* data, uint64_t addr, uint32_t size) {
       {
         // mmu_.write(data, addr, size, 0);
         mmu_.write(data, addr, size, ACCESS_TYPE::STORE);
+        decode_cache_.invalidate(addr, size);
       }
       catch (Page_Fault_Exception& page_fault)
       {
@@ -374,6 +544,7 @@ void Emulator::dcache_write(const void* data, uint64_t addr, uint32_t size) {
       core_->local_mem()->write(data, addr, size);
     } else {
       mmu_.write(data, addr, size, 0);
+      decode_cache_.invalidate(addr, size);
     }
   }
   DPH(2, "Mem Write: addr=0x" << std::hex << addr << ", data=0x" << ByteStream(data, size) << std::dec << " (size=" << size << ", type=" << type << ")" << std::endl);
@@ -395,6 +566,10 @@ bool Emulator::dcache_amo_check(uint64_t addr) {
   return false;
 }
 
+void Emulator::dcache_amo_sync() {
+  core_->socket()->cluster()->mem_sync();
+}
+
 void Emulator::writeToStdOut(const void* data, uint64_t addr, uint32_t size) {
   if (size != 1)
     std::abort();
@@ -445,6 +620,7 @@ Word Emulator::get_csr(uint32_t addr, uint32_t wid, uint32_t tid) {
   case VX_CSR_MEPC:
   case VX_CSR_MNSTATUS:
   case VX_CSR_MCAUSE:
+  case VX_CSR_SIM_MARKER:
     return 0;
 
   case VX_CSR_FFLAGS: return warps_.at(wid).fcsr & 0x1F;
@@ -475,6 +651,9 @@ Word Emulator::get_csr(uint32_t addr, uint32_t wid, uint32_t tid) {
      || (addr >= VX_CSR_MPM_BASE_H && addr < (VX_CSR_MPM_BASE_H + 32))) {
       // user-defined MPM CSRs
       auto perf_class = dcrs_.base_dcrs.read(VX_DCR_BASE_MPM_CLASS);
+      // update the counters of sleeping objects
+      SimPlatform::instance().catch_up();
+      core_perf = core_->perf_stats();
       switch (perf_class) {
       case VX_DCR_MPM_CLASS_NONE:
         break;
@@ -502,16 +681,26 @@ Word Emulator::get_csr(uint32_t addr, uint32_t wid, uint32_t tid) {
         CSR_READ_64(VX_CSR_MPM_STORES, core_perf.stores);
         CSR_READ_64(VX_CSR_MPM_IFETCH_LT, core_perf.ifetch_latency);
         CSR_READ_64(VX_CSR_MPM_LOAD_LT, core_perf.load_latency);
+        CSR_READ_64(VX_CSR_MPM_DECODES, core_perf.decodes);
+        CSR_READ_64(VX_CSR_MPM_DECODE_HITS, core_perf.decode_hits);
+      #ifdef VM_ENABLE
+        CSR_READ_64(VX_CSR_MPM_TLB_HITS, core_perf.tlb_hits);
+        CSR_READ_64(VX_CSR_MPM_TLB_MISSES, core_perf.tlb_misses);
+        CSR_READ_64(VX_CSR_MPM_TLB_WALK_LT, core_perf.tlb_walk_latency);
+        CSR_READ_64(VX_CSR_MPM_PWC_HITS, core_perf.pwc_hits);
+      #endif
         }
       } break;
       case VX_DCR_MPM_CLASS_MEM: {
+        // processor counters are updated by the memory partition
+        SimPlatform::instance().sync();
         auto proc_perf = core_->socket()->cluster()->processor()->perf_stats();
         auto cluster_perf = core_->socket()->cluster()->perf_stats();
         auto socket_perf = core_->socket()->perf_stats();
         auto lmem_perf = core_->local_mem()->perf_stats();
 
         uint64_t coalescer_misses = 0;
-        for (uint i = 0; i < NUM_LSU_BLOCKS; ++i) {
+        for (uint i = 0, n = arch_.num_lsu_blocks(); i < n; ++i) {
           coalescer_misses += core_->mem_coalescer(i)->perf_stats().misses;
         }
 
@@ -553,6 +742,42 @@ Word Emulator::get_csr(uint32_t addr, uint32_t wid, uint32_t tid) {
         CSR_READ_64(VX_CSR_MPM_LMEM_BANK_ST, lmem_perf.bank_stalls);
         }
       } break;
+      case VX_DCR_MPM_CLASS_CACHE: {
+        SimPlatform::instance().sync();
+        auto proc_perf = core_->socket()->cluster()->processor()->perf_stats();
+        auto cluster_perf = core_->socket()->cluster()->perf_stats();
+        auto socket_perf = core_->socket()->perf_stats();
+
+        switch (addr) {
+        CSR_READ_64(VX_CSR_MPM_ICACHE_MSHR_MRG, socket_perf.icache.mshr_merged);
+        CSR_READ_64(VX_CSR_MPM_ICACHE_MSHR_FULL, socket_perf.icache.mshr_full);
+        CSR_READ_64(VX_CSR_MPM_ICACHE_MSHR_OCC0, socket_perf.icache.mshr_occupancy[0]);
+        CSR_READ_64(VX_CSR_MPM_ICACHE_MSHR_OCC1, socket_perf.icache.mshr_occupancy[1]);
+        CSR_READ_64(VX_CSR_MPM_ICACHE_MSHR_OCC2, socket_perf.icache.mshr_occupancy[2]);
+        CSR_READ_64(VX_CSR_MPM_ICACHE_MSHR_OCC3, socket_perf.icache.mshr_occupancy[3]);
+
+        CSR_READ_64(VX_CSR_MPM_DCACHE_MSHR_MRG, socket_perf.dcache.mshr_merged);
+        CSR_READ_64(VX_CSR_MPM_DCACHE_MSHR_FULL, socket_perf.dcache.mshr_full);
+        CSR_READ_64(VX_CSR_MPM_DCACHE_MSHR_OCC0, socket_perf.dcache.mshr_occupancy[0]);
+        CSR_READ_64(VX_CSR_MPM_DCACHE_MSHR_OCC1, socket_perf.dcache.mshr_occupancy[1]);
+        CSR_READ_64(VX_CSR_MPM_DCACHE_MSHR_OCC2, socket_perf.dcache.mshr_occupancy[2]);
+        CSR_READ_64(VX_CSR_MPM_DCACHE_MSHR_OCC3, socket_perf.dcache.mshr_occupancy[3]);
+
+        CSR_READ_64(VX_CSR_MPM_L2CACHE_MSHR_MRG, cluster_perf.l2cache.mshr_merged);
+        CSR_READ_64(VX_CSR_MPM_L2CACHE_MSHR_FULL, cluster_perf.l2cache.mshr_full);
+        CSR_READ_64(VX_CSR_MPM_L2CACHE_MSHR_OCC0, cluster_perf.l2cache.mshr_occupancy[0]);
+        CSR_READ_64(VX_CSR_MPM_L2CACHE_MSHR_OCC1, cluster_perf.l2cache.mshr_occupancy[1]);
+        CSR_READ_64(VX_CSR_MPM_L2CACHE_MSHR_OCC2, cluster_perf.l2cache.mshr_occupancy[2]);
+        CSR_READ_64(VX_CSR_MPM_L2CACHE_MSHR_OCC3, cluster_perf.l2cache.mshr_occupancy[3]);
+
+        CSR_READ_64(VX_CSR_MPM_L3CACHE_MSHR_MRG, proc_perf.l3cache.mshr_merged);
+        CSR_READ_64(VX_CSR_MPM_L3CACHE_MSHR_FULL, proc_perf.l3cache.mshr_full);
+        CSR_READ_64(VX_CSR_MPM_L3CACHE_MSHR_OCC0, proc_perf.l3cache.mshr_occupancy[0]);
+        CSR_READ_64(VX_CSR_MPM_L3CACHE_MSHR_OCC1, proc_perf.l3cache.mshr_occupancy[1]);
+        CSR_READ_64(VX_CSR_MPM_L3CACHE_MSHR_OCC2, proc_perf.l3cache.mshr_occupancy[2]);
+        CSR_READ_64(VX_CSR_MPM_L3CACHE_MSHR_OCC3, proc_perf.l3cache.mshr_occupancy[3]);
+        }
+      } break;
       default:
         std::cerr << "Error: invalid MPM CLASS: value=" << perf_class << std::endl;
         std::abort();
@@ -568,6 +793,8 @@ Word Emulator::get_csr(uint32_t addr, uint32_t wid, uint32_t tid) {
 
 void Emulator::set_csr(uint32_t addr, Word value, uint32_t wid, uint32_t tid) {
   __unused (tid);
+  // notify the sampled simulation triggers
+  core_->socket()->cluster()->processor()->csr_event(addr, value);
   switch (addr) {
   case VX_CSR_FFLAGS:
     warps_.at(wid).fcsr = (warps_.at(wid).fcsr & ~0x1F) | (value & 0x1F);
@@ -584,6 +811,8 @@ void Emulator::set_csr(uint32_t addr, Word value, uint32_t wid, uint32_t tid) {
   case VX_CSR_SATP:
   #ifdef VM_ENABLE
     mmu_.set_satp(value);
+    // cached instructions are indexed by virtual address
+    decode_cache_.clear();
   #endif
     break;
   case VX_CSR_MSTATUS:
@@ -596,6 +825,7 @@ void Emulator::set_csr(uint32_t addr, Word value, uint32_t wid, uint32_t tid) {
   case VX_CSR_PMPADDR0:
   case VX_CSR_MNSTATUS:
   case VX_CSR_MCAUSE:
+  case VX_CSR_SIM_MARKER:
     break;
   default: {
     #ifdef EXT_V_ENABLE
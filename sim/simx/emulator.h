@@ -17,9 +17,13 @@
 #include <vector>
 #include <sstream>
 #include <stack>
+#include <cstring>
+#include <util.h>
 #include <mem.h>
+#include <checkpoint.h>
 #include "types.h"
 #include "instr.h"
+#include "decode_cache.h"
 #ifdef EXT_TCU_ENABLE
 #include "tensor_unit.h"
 #endif
@@ -51,9 +55,74 @@ struct ipdom_entry_t {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Flat register file storing the thread values of each register contiguously,
+// rows are padded to a cache line so that lane loops can be vectorized.
+template <typename T>
+class RegFile {
+public:
+  static constexpr uint32_t ALIGNMENT = 64;
+
+  RegFile(uint32_t num_regs, uint32_t num_threads)
+    : num_regs_(num_regs)
+    , num_threads_(num_threads)
+    , stride_(row_size(num_threads) / sizeof(T))
+    , data_(allocate(num_regs_ * stride_)) {
+    std::memset(data_, 0, num_regs_ * stride_ * sizeof(T));
+  }
+
+  RegFile(const RegFile& other)
+    : num_regs_(other.num_regs_)
+    , num_threads_(other.num_threads_)
+    , stride_(other.stride_)
+    , data_(allocate(num_regs_ * stride_)) {
+    std::memcpy(data_, other.data_, num_regs_ * stride_ * sizeof(T));
+  }
+
+  ~RegFile() {
+    aligned_free(data_);
+  }
+
+  RegFile& operator=(const RegFile&) = delete;
+
+  uint32_t num_regs() const {
+    return num_regs_;
+  }
+
+  uint32_t num_threads() const {
+    return num_threads_;
+  }
+
+  T* operator[](uint32_t reg) {
+    assert(reg < num_regs_);
+    return data_ + reg * stride_;
+  }
+
+  const T* operator[](uint32_t reg) const {
+    assert(reg < num_regs_);
+    return data_ + reg * stride_;
+  }
+
+private:
+
+  static uint32_t row_size(uint32_t num_threads) {
+    return (num_threads * sizeof(T) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  }
+
+  static T* allocate(uint32_t count) {
+    return static_cast<T*>(aligned_malloc(count * sizeof(T), ALIGNMENT));
+  }
+
+  uint32_t num_regs_;
+  uint32_t num_threads_;
+  uint32_t stride_;
+  T*       data_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 struct warp_t {
-  std::vector<std::vector<Word>>    ireg_file;
-  std::vector<std::vector<uint64_t>>freg_file;
+  RegFile<Word>                     ireg_file;
+  RegFile<uint64_t>                 freg_file;
   std::deque<Instr::Ptr>            ibuffer;
   std::stack<ipdom_entry_t>         ipdom_stack;
   ThreadMask                        tmask;
@@ -84,20 +153,31 @@ public:
 
   void reset();
 
-  void attach_ram(RAM* ram);
+  void attach_ram(MemDevice* ram);
 
 #ifdef VM_ENABLE
   void set_satp(uint64_t satp) ;
 #endif
 
+  // save or restore the architectural state of a running kernel
+  void save(CheckpointWriter& ckpt) const;
+  void restore(CheckpointReader& ckpt);
+
   instr_trace_t* step();
 
   bool running() const;
 
+  // no warp can be scheduled
+  bool idle() const;
+
   void suspend(uint32_t wid);
 
   void resume(uint32_t wid);
 
+  bool suspended(uint32_t wid) const {
+    return stalled_warps_.test(wid);
+  }
+
   bool barrier(uint32_t bar_id, uint32_t count, uint32_t wid);
 
   bool wspawn(uint32_t num_warps, Word nextPC);
@@ -108,13 +188,25 @@ public:
 
   void dcache_write(const void* data, uint64_t addr, uint32_t size);
 
+  const DecodeCache::PerfStats& decode_perf_stats() const {
+    return decode_cache_.perf_stats();
+  }
+
+#ifdef VM_ENABLE
+  const MemoryUnit::PerfStats& tlb_perf_stats() const {
+    return mmu_.perf_stats();
+  }
+#endif
+
 private:
 
   uint32_t fetch(uint32_t wid, uint64_t uuid);
 
+  void fetch_decode(uint32_t wid, uint64_t uuid);
+
   void decode(uint32_t code, uint32_t wid, uint64_t uuid);
 
-  instr_trace_t* execute(const Instr &instr, uint32_t wid);
+  instr_trace_t* execute(const Instr &instr, uint32_t wid, uint64_t uuid);
 
   void fetch_registers(std::vector<reg_data_t>& out, uint32_t wid, uint32_t src_index, const RegOpd& reg);
 
@@ -124,6 +216,8 @@ private:
 
   bool dcache_amo_check(uint64_t addr);
 
+  void dcache_amo_sync();
+
   void writeToStdOut(const void* data, uint64_t addr, uint32_t size);
 
   void cout_flush();
@@ -163,7 +257,14 @@ private:
   VecUnit::Ptr vec_unit_;
 #endif
 
-  PoolAllocator<Instr, 64> instr_pool_;
+  PoolAllocator<Instr> instr_pool_;
+  DecodeCache decode_cache_;
+
+  std::vector<reg_data_t> rd_data_;
+  std::vector<reg_data_t> rs1_data_;
+  std::vector<reg_data_t> rs2_data_;
+  std::vector<reg_data_t> rs3_data_;
+  std::vector<Word> lane_mask_;
 };
 
 }
@@ -17,6 +17,7 @@
 #include <math.h>
 #include <bitset>
 #include <climits>
+#include <cstring>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <assert.h>
@@ -26,6 +27,7 @@
 #include "instr.h"
 #include "core.h"
 #include "types.h"
+#include "lane_kernels.h"
 #ifdef EXT_V_ENABLE
 #include "processor_impl.h"
 #endif
@@ -69,23 +71,35 @@ void Emulator::fetch_registers(std::vector<reg_data_t>& out, uint32_t wid, uint3
 #endif
     break;
   case RegType::Integer: {
+    // load all lanes, inactive ones are masked off on writeback
+    auto reg_data = warp.ireg_file[reg.idx];
+    auto values = out.data();
+    VX_LANE_LOOP
+    for (uint32_t t = 0; t < num_threads; ++t) {
+      values[t].u64 = reg_data[t];
+    }
+  #ifndef NDEBUG
     DPH(2, "Src" << src_index << " Reg: " << reg << "={");
-    auto& reg_data = warp.ireg_file.at(reg.idx);
     for (uint32_t t = 0; t < num_threads; ++t) {
       if (t) DPN(2, ", ");
       if (!warp.tmask.test(t)) {
         DPN(2, "-");
         continue;
       }
-      auto& value = out[t];
-      value.u = reg_data.at(t);
-      DPN(2, "0x" << std::hex << value.u << std::dec);
+      DPN(2, "0x" << std::hex << out[t].u << std::dec);
     }
     DPN(2, "}" << std::endl);
+  #endif
   } break;
   case RegType::Float: {
+    auto reg_data = warp.freg_file[reg.idx];
+    auto values = out.data();
+    VX_LANE_LOOP
+    for (uint32_t t = 0; t < num_threads; ++t) {
+      values[t].u64 = reg_data[t];
+    }
+  #ifndef NDEBUG
     DPH(2, "Src" << src_index << " Reg: " << reg << "={");
-    auto& reg_data = warp.freg_file.at(reg.idx);
     for (uint32_t t = 0; t < num_threads; ++t) {
       if (t) DPN(2, ", ");
       if (!warp.tmask.test(t)) {
@@ -93,7 +107,6 @@ void Emulator::fetch_registers(std::vector<reg_data_t>& out, uint32_t wid, uint3
         continue;
       }
       auto& value = out[t];
-      value.u64 = reg_data.at(t);
       if ((value.u64 >> 32) == 0xffffffff) {
         DPN(2, "0x" << std::hex << value.u32 << std::dec);
       } else {
@@ -101,6 +114,7 @@ void Emulator::fetch_registers(std::vector<reg_data_t>& out, uint32_t wid, uint3
       }
     }
     DPN(2, "}" << std::endl);
+  #endif
   } break;
   default:
     std::abort();
@@ -108,7 +122,7 @@ void Emulator::fetch_registers(std::vector<reg_data_t>& out, uint32_t wid, uint3
   }
 }
 
-instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
+instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid, uint64_t uuid) {
   auto& warp = warps_.at(wid);
   assert(warp.tmask.any());
 
@@ -127,7 +141,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
 
   // create instruction trace
   auto trace_alloc = core_->trace_pool().allocate(1);
-  auto trace = new (trace_alloc) instr_trace_t(instr.getUUID(), arch_);
+  auto trace = new (trace_alloc) instr_trace_t(uuid, arch_);
   trace->fu_type  = fu_type;
   trace->op_type  = op_type;
   trace->cid      = core_->id();
@@ -137,13 +151,16 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
   trace->dst_reg  = rdest;
   trace->src_regs = {rsrc0, rsrc1, rsrc2};
 
-  std::vector<reg_data_t> rd_data(num_threads);
-  std::vector<reg_data_t> rs1_data;
-  std::vector<reg_data_t> rs2_data;
-  std::vector<reg_data_t> rs3_data;
+  // operand buffers are preallocated and reused across instructions
+  auto& rd_data  = rd_data_;
+  auto& rs1_data = rs1_data_;
+  auto& rs2_data = rs2_data_;
+  auto& rs3_data = rs3_data_;
+  std::memset(rd_data.data(), 0, num_threads * sizeof(reg_data_t));
+  lane_mask_init(lane_mask_.data(), warp.tmask, num_threads);
 
   DP(1, "Instr: " << instr << ", cid=" << core_->id() << ", wid=" << wid << ", tmask=" << warp.tmask
-         << ", PC=0x" << std::hex << warp.PC << std::dec << "(#" << instr.getUUID() << ")");
+         << ", PC=0x" << std::hex << warp.PC << std::dec << "(#" << uuid << ")");
 
   // fetch register values
   if (rsrc0.type != RegType::None) fetch_registers(rs1_data, wid, 0, rsrc0);
@@ -173,132 +190,74 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
     [&](AluType alu_type) {
       auto aluArgs = std::get<IntrAluArgs>(instrArgs);
       Word imm = sext<Word>(aluArgs.imm, 32);
+      bool is_w = is_w_enabled && aluArgs.is_w;
+      auto rd = rd_data.data();
+      auto rs1 = rs1_data.data();
+      auto rs2 = rs2_data.data();
       switch (alu_type) {
       case AluType::LUI: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          rd_data[t].i = imm;
-        }
+        lane_fill(rd, imm, num_threads);
       } break;
       case AluType::AUIPC: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          rd_data[t].i = imm + warp.PC;
-        }
+        lane_fill(rd, imm + warp.PC, num_threads);
       } break;
       case AluType::ADD: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          if (is_w_enabled && aluArgs.is_w) {
-            auto result = rs1_data[t].i32 + (int32_t)(aluArgs.is_imm ? aluArgs.imm : rs2_data[t].i32);
-            rd_data[t].i = sext((uint64_t)result, 32);
-          } else {
-            rd_data[t].i = rs1_data[t].i + (aluArgs.is_imm ? imm : rs2_data[t].i);
-          }
+        if (is_w) {
+          lane_binop_w(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](uint32_t a, uint32_t b) { return a + b; });
+        } else {
+          lane_binop(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](Word a, Word b) { return a + b; });
         }
       } break;
       case AluType::SUB: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          if (is_w_enabled && aluArgs.is_w) {
-            auto result = rs1_data[t].i32 - (int32_t)(aluArgs.is_imm ? aluArgs.imm : rs2_data[t].i32);
-            rd_data[t].i = sext((uint64_t)result, 32);
-          } else {
-            rd_data[t].i = rs1_data[t].i - (aluArgs.is_imm ? imm : rs2_data[t].i);
-          }
+        if (is_w) {
+          lane_binop_w(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](uint32_t a, uint32_t b) { return a - b; });
+        } else {
+          lane_binop(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](Word a, Word b) { return a - b; });
         }
       } break;
       case AluType::SLT: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          rd_data[t].i = rs1_data[t].i < (aluArgs.is_imm ? WordI(imm) : rs2_data[t].i);
-        }
+        lane_binop(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](Word a, Word b) { return WordI(a) < WordI(b); });
       } break;
       case AluType::SLTU: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          rd_data[t].i = rs1_data[t].u < (aluArgs.is_imm ? imm : rs2_data[t].u);
-        }
+        lane_binop(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](Word a, Word b) { return a < b; });
       } break;
       case AluType::SLL: {
-        Word shamt_mask = (Word(1) << log2up(XLEN)) - 1;
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          if (is_w_enabled && aluArgs.is_w) {
-            uint32_t shamt = (aluArgs.is_imm ? aluArgs.imm : rs2_data[t].i32) & shamt_mask;
-            uint32_t result = (uint32_t)rs1_data[t].i << shamt;
-            rd_data[t].i = sext((uint64_t)result, 32);
-          } else {
-            Word shamt = (aluArgs.is_imm ? imm : rs2_data[t].i) & shamt_mask;
-            rd_data[t].i = rs1_data[t].i << shamt;
-          }
+        if (is_w) {
+          lane_binop_w(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](uint32_t a, uint32_t b) { return a << (b & 31); });
+        } else {
+          lane_binop(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](Word a, Word b) { return a << (b & (XLEN-1)); });
         }
       } break;
       case AluType::SRA: {
-        Word shamt_mask = (Word(1) << log2up(XLEN)) - 1;
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          if (is_w_enabled && aluArgs.is_w) {
-            uint32_t shamt = (aluArgs.is_imm ? aluArgs.imm : rs2_data[t].i32) & shamt_mask;
-            uint32_t result = (int32_t)rs1_data[t].i >> shamt;
-            rd_data[t].i = sext((uint64_t)result, 32);
-          } else {
-            Word shamt = (aluArgs.is_imm ? imm : rs2_data[t].i) & shamt_mask;
-            rd_data[t].i = rs1_data[t].i >> shamt;
-          }
+        if (is_w) {
+          lane_binop_w(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](uint32_t a, uint32_t b) { return uint32_t(int32_t(a) >> (b & 31)); });
+        } else {
+          lane_binop(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](Word a, Word b) { return Word(WordI(a) >> (b & (XLEN-1))); });
         }
       } break;
       case AluType::SRL: {
-        Word shamt_mask = (Word(1) << log2up(XLEN)) - 1;
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          if (is_w_enabled && aluArgs.is_w) {
-            uint32_t shamt = (aluArgs.is_imm ? aluArgs.imm : rs2_data[t].i32) & shamt_mask;
-            uint32_t result = (uint32_t)rs1_data[t].i >> shamt;
-            rd_data[t].i = sext((uint64_t)result, 32);
-          } else {
-            Word shamt = (aluArgs.is_imm ? imm : rs2_data[t].i) & shamt_mask;
-            rd_data[t].i = rs1_data[t].u >> shamt;
-          }
+        if (is_w) {
+          lane_binop_w(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](uint32_t a, uint32_t b) { return a >> (b & 31); });
+        } else {
+          lane_binop(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](Word a, Word b) { return a >> (b & (XLEN-1)); });
         }
       } break;
       case AluType::AND: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          rd_data[t].i = rs1_data[t].i & (aluArgs.is_imm ? imm : rs2_data[t].i);
-        }
+        lane_binop(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](Word a, Word b) { return a & b; });
       } break;
       case AluType::OR: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          rd_data[t].i = rs1_data[t].i | (aluArgs.is_imm ? imm : rs2_data[t].i);
-        }
+        lane_binop(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](Word a, Word b) { return a | b; });
       } break;
       case AluType::XOR: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          rd_data[t].i = rs1_data[t].i ^ (aluArgs.is_imm ? imm : rs2_data[t].i);
-        }
+        lane_binop(rd, rs1, rs2, aluArgs.is_imm, imm, num_threads, [](Word a, Word b) { return a ^ b; });
       } break;
       case AluType::CZERO: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          bool cond = (rs2_data[t].i == 0) ^ aluArgs.imm;
-          rd_data[t].i = cond ? 0 : rs1_data[t].i;
-        }
+        // czero.eqz (imm=0) / czero.nez (imm=1)
+        Word sel = Word(0) - Word(aluArgs.imm != 0);
+        lane_map(rd, num_threads, [&](uint32_t t) {
+          Word keep = (Word(0) - Word(rs2[t].u != 0)) ^ sel;
+          return rs1[t].u & keep;
+        });
       } break;
       default:
         std::abort();
@@ -388,84 +347,49 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
       Word offset = sext<Word>(brArgs.offset, 32);
       switch (br_type) {
       case BrType::BR: {
-        bool all_taken = false;
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          bool curr_taken = false;
-          switch (brArgs.cmp) {
-          case 0: { // RV32I: BEQ
-            if (rs1_data[t].i == rs2_data[t].i) {
-              next_pc = warp.PC + offset;
-              curr_taken = true;
-            }
-            break;
-          }
-          case 1: { // RV32I: BNE
-            if (rs1_data[t].i != rs2_data[t].i) {
-              next_pc = warp.PC + offset;
-              curr_taken = true;
-            }
-            break;
-          }
-          case 4: { // RV32I: BLT
-            if (rs1_data[t].i < rs2_data[t].i) {
-              next_pc = warp.PC + offset;
-              curr_taken = true;
-            }
-            break;
-          }
-          case 5: { // RV32I: BGE
-            if (rs1_data[t].i >= rs2_data[t].i) {
-              next_pc = warp.PC + offset;
-              curr_taken = true;
-            }
-            break;
-          }
-          case 6: { // RV32I: BLTU
-            if (rs1_data[t].u < rs2_data[t].u) {
-              next_pc = warp.PC + offset;
-              curr_taken = true;
-            }
-            break;
-          }
-          case 7: { // RV32I: BGEU
-            if (rs1_data[t].u >= rs2_data[t].u) {
-              next_pc = warp.PC + offset;
-              curr_taken = true;
-            }
-            break;
-          }
-          default:
+        auto rs1 = rs1_data.data();
+        auto rs2 = rs2_data.data();
+        auto mask = lane_mask_.data();
+        uint32_t taken;
+        switch (brArgs.cmp) {
+        case 0: // RV32I: BEQ
+          taken = lane_count(mask, num_threads, [&](uint32_t t) { return rs1[t].u == rs2[t].u; });
+          break;
+        case 1: // RV32I: BNE
+          taken = lane_count(mask, num_threads, [&](uint32_t t) { return rs1[t].u != rs2[t].u; });
+          break;
+        case 4: // RV32I: BLT
+          taken = lane_count(mask, num_threads, [&](uint32_t t) { return rs1[t].i < rs2[t].i; });
+          break;
+        case 5: // RV32I: BGE
+          taken = lane_count(mask, num_threads, [&](uint32_t t) { return rs1[t].i >= rs2[t].i; });
+          break;
+        case 6: // RV32I: BLTU
+          taken = lane_count(mask, num_threads, [&](uint32_t t) { return rs1[t].u < rs2[t].u; });
+          break;
+        case 7: // RV32I: BGEU
+          taken = lane_count(mask, num_threads, [&](uint32_t t) { return rs1[t].u >= rs2[t].u; });
+          break;
+        default:
+          std::abort();
+        }
+        if (taken != 0) {
+          if (taken != warp.tmask.count()) {
+            std::cout << "divergent branch! PC=0x" << std::hex << warp.PC << std::dec << " (#" << trace->uuid << ")\n" << std::flush;
             std::abort();
           }
-          if (t == thread_start) {
-            all_taken = curr_taken;
-          } else {
-            if (all_taken != curr_taken) {
-              std::cout << "divergent branch! PC=0x" << std::hex << warp.PC << std::dec << " (#" << trace->uuid << ")\n" << std::flush;
-              std::abort();
-            }
-          }
+          next_pc = warp.PC + offset;
         }
         trace->fetch_stall = true;
       } break;
       case BrType::JAL: { // RV32I: JAL
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          rd_data[t].i = next_pc;
-        }
+        lane_fill(rd_data.data(), next_pc, num_threads);
         next_pc = warp.PC + offset;
         trace->fetch_stall = true;
         rd_write = true;
       } break;
       case BrType::JALR: { // RV32I: JALR
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          rd_data[t].i = next_pc;
-        }
+        lane_fill(rd_data.data(), next_pc, num_threads);
         next_pc = rs1_data[thread_last].i + offset;
         trace->fetch_stall = true;
         rd_write = true;
@@ -492,164 +416,67 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
     },
     [&](MdvType mdv_type) {
       auto mdvArgs = std::get<IntrMdvArgs>(instrArgs);
+      bool is_w = is_w_enabled && mdvArgs.is_w;
+      auto rd = rd_data.data();
+      auto rs1 = rs1_data.data();
+      auto rs2 = rs2_data.data();
       switch (mdv_type) {
       case MdvType::MUL: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          if (is_w_enabled && mdvArgs.is_w) {
-            auto product = rs1_data[t].i32 * rs2_data[t].i32;
-            rd_data[t].i = sext((uint64_t)product, 32);
-          } else {
-            rd_data[t].i = rs1_data[t].i * rs2_data[t].i;
-          }
+        if (is_w) {
+          lane_binop_w(rd, rs1, rs2, false, 0, num_threads, [](uint32_t a, uint32_t b) { return a * b; });
+        } else {
+          lane_binop(rd, rs1, rs2, false, 0, num_threads, [](Word a, Word b) { return a * b; });
         }
       } break;
       case MdvType::MULH: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          auto first = static_cast<DWordI>(rs1_data[t].i);
-          auto second = static_cast<DWordI>(rs2_data[t].i);
-          rd_data[t].i = (first * second) >> XLEN;
-        }
+        lane_binop(rd, rs1, rs2, false, 0, num_threads, [](Word a, Word b) {
+          return Word((DWordI(WordI(a)) * DWordI(WordI(b))) >> XLEN);
+        });
       } break;
       case MdvType::MULHSU: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          auto first = static_cast<DWordI>(rs1_data[t].i);
-          auto second = static_cast<DWord>(rs2_data[t].u);
-          rd_data[t].i = (first * second) >> XLEN;
-        }
+        lane_binop(rd, rs1, rs2, false, 0, num_threads, [](Word a, Word b) {
+          return Word((DWordI(WordI(a)) * DWordI(DWord(b))) >> XLEN);
+        });
       } break;
       case MdvType::MULHU: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          auto first = static_cast<DWord>(rs1_data[t].u);
-          auto second = static_cast<DWord>(rs2_data[t].u);
-          rd_data[t].i = (first * second) >> XLEN;
-        }
+        lane_binop(rd, rs1, rs2, false, 0, num_threads, [](Word a, Word b) {
+          return Word((DWord(a) * DWord(b)) >> XLEN);
+        });
       } break;
       case MdvType::DIV: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          if (is_w_enabled && mdvArgs.is_w) {
-            auto dividen = rs1_data[t].i32;
-            auto divisor = rs2_data[t].i32;
-            int32_t largest_negative = 0x80000000;
-            int32_t quotient;
-            if (divisor == 0){
-              quotient = -1;
-            } else if (dividen == largest_negative && divisor == -1) {
-              quotient = dividen;
-            } else {
-              quotient = dividen / divisor;
-            }
-            rd_data[t].i = sext((uint64_t)quotient, 32);
-          } else {
-            auto dividen = rs1_data[t].i;
-            auto divisor = rs2_data[t].i;
-            auto largest_negative = WordI(1) << (XLEN-1);
-            WordI quotient;
-            if (divisor == 0) {
-              quotient = -1;
-            } else if (dividen == largest_negative && divisor == -1) {
-              quotient = dividen;
-            } else {
-              quotient = dividen / divisor;
-            }
-            rd_data[t].i = quotient;
-          }
+        if (is_w) {
+          lane_binop_w(rd, rs1, rs2, false, 0, num_threads, [](uint32_t a, uint32_t b) {
+            return uint32_t(lane_div(int32_t(a), int32_t(b)));
+          });
+        } else {
+          lane_binop(rd, rs1, rs2, false, 0, num_threads, [](Word a, Word b) {
+            return Word(lane_div(WordI(a), WordI(b)));
+          });
         }
       } break;
       case MdvType::DIVU: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          if (is_w_enabled && mdvArgs.is_w) {
-            auto dividen = rs1_data[t].u32;
-            auto divisor = rs2_data[t].u32;
-            uint32_t quotient;
-            if (divisor != 0){
-              quotient = dividen / divisor;
-            } else {
-              quotient = -1;
-            }
-            rd_data[t].i = sext((uint64_t)quotient, 32);
-          } else {
-            auto dividen = rs1_data[t].u;
-            auto divisor = rs2_data[t].u;
-            Word quotient;
-            if (divisor != 0) {
-              quotient = dividen / divisor;
-            } else {
-              quotient = -1;
-            }
-            rd_data[t].i = quotient;
-          }
+        if (is_w) {
+          lane_binop_w(rd, rs1, rs2, false, 0, num_threads, [](uint32_t a, uint32_t b) { return lane_divu(a, b); });
+        } else {
+          lane_binop(rd, rs1, rs2, false, 0, num_threads, [](Word a, Word b) { return lane_divu(a, b); });
         }
       } break;
       case MdvType::REM: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          if (is_w_enabled && mdvArgs.is_w) {
-            auto dividen = rs1_data[t].i32;
-            auto divisor = rs2_data[t].i32;
-            int32_t largest_negative = 0x80000000;
-            int32_t remainder;
-            if (divisor == 0){
-              remainder = dividen;
-            } else if (dividen == largest_negative && divisor == -1) {
-              remainder = 0;
-            } else {
-              remainder = dividen % divisor;
-            }
-            rd_data[t].i = sext((uint64_t)remainder, 32);
-          } else {
-            auto dividen = rs1_data[t].i;
-            auto divisor = rs2_data[t].i;
-            auto largest_negative = WordI(1) << (XLEN-1);
-            WordI remainder;
-            if (rs2_data[t].i == 0) {
-              remainder = dividen;
-            } else if (dividen == largest_negative && divisor == -1) {
-              remainder = 0;
-            } else {
-              remainder = dividen % divisor;
-            }
-            rd_data[t].i = remainder;
-          }
+        if (is_w) {
+          lane_binop_w(rd, rs1, rs2, false, 0, num_threads, [](uint32_t a, uint32_t b) {
+            return uint32_t(lane_rem(int32_t(a), int32_t(b)));
+          });
+        } else {
+          lane_binop(rd, rs1, rs2, false, 0, num_threads, [](Word a, Word b) {
+            return Word(lane_rem(WordI(a), WordI(b)));
+          });
         }
       } break;
       case MdvType::REMU: {
-        for (uint32_t t = thread_start; t < num_threads; ++t) {
-          if (!warp.tmask.test(t))
-            continue;
-          if (is_w_enabled && mdvArgs.is_w) {
-            auto dividen = (uint32_t)rs1_data[t].u32;
-            auto divisor = (uint32_t)rs2_data[t].u32;
-            uint32_t remainder;
-            if (divisor != 0){
-              remainder = dividen % divisor;
-            } else {
-              remainder = dividen;
-            }
-            rd_data[t].i = sext((uint64_t)remainder, 32);
-          } else {
-            auto dividen = rs1_data[t].u;
-            auto divisor = rs2_data[t].u;
-            Word remainder;
-            if (rs2_data[t].i != 0) {
-              remainder = dividen % divisor;
-            } else {
-              remainder = dividen;
-            }
-            rd_data[t].i = remainder;
-          }
+        if (is_w) {
+          lane_binop_w(rd, rs1, rs2, false, 0, num_threads, [](uint32_t a, uint32_t b) { return lane_remu(a, b); });
+        } else {
+          lane_binop(rd, rs1, rs2, false, 0, num_threads, [](Word a, Word b) { return lane_remu(a, b); });
         }
       } break;
       default:
@@ -731,6 +558,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
       }
     },
     [&](AmoType amo_type) {
+      this->dcache_amo_sync();
       auto amoArgs = std::get<IntrAmoArgs>(instrArgs);
       auto trace_data = std::make_shared<LsuTraceData>(num_threads);
       trace->data = trace_data;
@@ -1475,6 +1303,8 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
       break;
     case RegType::Integer:
       if (rdest.idx != 0) {
+        lane_blend(warp.ireg_file[rdest.idx], rd_data.data(), lane_mask_.data(), num_threads);
+      #ifndef NDEBUG
         DPH(2, "Dest Reg: " << rdest << "={");
         for (uint32_t t = 0; t < num_threads; ++t) {
           if (t) DPN(2, ", ");
@@ -1482,16 +1312,18 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
             DPN(2, "-");
             continue;
           }
-          warp.ireg_file.at(rdest.idx).at(t) = rd_data[t].i;
           DPN(2, "0x" << std::hex << rd_data[t].u << std::dec);
         }
         DPN(2, "}" << std::endl);
+      #endif
       } else {
         // disable writes to x0
         trace->wb = false;
       }
       break;
     case RegType::Float:
+      lane_blend(warp.freg_file[rdest.idx], rd_data.data(), lane_mask_.data(), num_threads);
+    #ifndef NDEBUG
       DPH(2, "Dest Reg: " << rdest << "={");
       for (uint32_t t = 0; t < num_threads; ++t) {
         if (t) DPN(2, ", ");
@@ -1499,7 +1331,6 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
           DPN(2, "-");
           continue;
         }
-        warp.freg_file.at(rdest.idx).at(t) = rd_data[t].u64;
         if ((rd_data[t].u64 >> 32) == 0xffffffff) {
           DPN(2, "0x" << std::hex << rd_data[t].u32 << std::dec);
         } else {
@@ -1507,6 +1338,7 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
         }
       }
       DPN(2, "}" << std::endl);
+    #endif
       break;
   #ifdef EXT_V_ENABLE
     case RegType::Vector:
@@ -1549,12 +1381,12 @@ instr_trace_t* Emulator::execute(const Instr &instr, uint32_t wid) {
     DPN(5, "  %r" << std::setfill('0') << std::setw(2) << i << ':' << std::hex);
     // Integer register file
     for (uint32_t j = 0; j < arch_.num_threads(); ++j) {
-      DPN(5, ' ' << std::setfill('0') << std::setw(XLEN/4) << warp.ireg_file.at(i).at(j) << std::setfill(' ') << ' ');
+      DPN(5, ' ' << std::setfill('0') << std::setw(XLEN/4) << warp.ireg_file[i][j] << std::setfill(' ') << ' ');
     }
     DPN(5, '|');
     // Floating point register file
     for (uint32_t j = 0; j < arch_.num_threads(); ++j) {
-      DPN(5, ' ' << std::setfill('0') << std::setw(16) << warp.freg_file.at(i).at(j) << std::setfill(' ') << ' ');
+      DPN(5, ' ' << std::setfill('0') << std::setw(16) << warp.freg_file[i][j] << std::setfill(' ') << ' ');
     }
     DPN(5, std::dec << std::endl);
   }
@@ -25,10 +25,20 @@
 
 using namespace vortex;
 
+FuncUnit::FuncUnit(const SimContext& ctx, Core* core, const char* name)
+	: SimObject<FuncUnit>(ctx, name)
+	, Inputs(core->arch().issue_width(), this)
+	, Outputs(core->arch().issue_width(), this)
+	, core_(core)
+	, issue_width_(core->arch().issue_width())
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+
 AluUnit::AluUnit(const SimContext& ctx, Core* core) : FuncUnit(ctx, core, "alu-unit") {}
 
 void AluUnit::tick() {
-  for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+  for (uint32_t iw = 0; iw < issue_width_; ++iw) {
 		auto& input = Inputs.at(iw);
 		if (input.empty())
 			continue;
@@ -109,7 +119,7 @@ void AluUnit::tick() {
 FpuUnit::FpuUnit(const SimContext& ctx, Core* core) : FuncUnit(ctx, core, "fpu-unit") {}
 
 void FpuUnit::tick() {
-	for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+	for (uint32_t iw = 0; iw < issue_width_; ++iw) {
 		auto& input = Inputs.at(iw);
 		if (input.empty())
 			continue;
@@ -158,8 +168,14 @@ void FpuUnit::tick() {
 
 LsuUnit::LsuUnit(const SimContext& ctx, Core* core)
 	: FuncUnit(ctx, core, "lsu-unit")
+	, states_(core->arch().num_lsu_blocks())
 	, pending_loads_(0)
-{}
+{
+	// memory responses are consumed from the lmem switch
+	for (uint32_t b = 0; b < states_.size(); ++b) {
+		core_->lmem_switch_.at(b)->RspIn.set_reader(this);
+	}
+}
 
 LsuUnit::~LsuUnit()
 {}
@@ -176,7 +192,7 @@ void LsuUnit::tick() {
 	core_->perf_stats_.load_latency += pending_loads_;
 
 	// handle memory responses
-	for (uint32_t b = 0; b < NUM_LSU_BLOCKS; ++b) {
+	for (uint32_t b = 0; b < states_.size(); ++b) {
 		auto& lsu_rsp_port = core_->lmem_switch_.at(b)->RspIn;
 		if (lsu_rsp_port.empty())
 			continue;
@@ -192,7 +208,7 @@ void LsuUnit::tick() {
 			state.pending_rd_reqs.release(lsu_rsp.tag);
 			// is last batch?
 			if (entry.eop) {
-				int iw = trace->wid % ISSUE_WIDTH;
+				int iw = trace->wid % issue_width_;
 				Outputs.at(iw).push(trace, 1);
 			}
 		}
@@ -201,8 +217,8 @@ void LsuUnit::tick() {
 	}
 
 	// handle LSU requests
-	for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
-		uint32_t block_idx = iw % NUM_LSU_BLOCKS;
+	for (uint32_t iw = 0; iw < issue_width_; ++iw) {
+		uint32_t block_idx = iw % states_.size();
 		auto& state = states_.at(block_idx);
 		if (state.fence_lock) {
 			// wait for all pending memory operations to complete
@@ -218,30 +234,16 @@ void LsuUnit::tick() {
 		if (input.empty())
 			continue;
 
-		bool is_fence = false;
-		bool is_write = false;
-
 		auto trace = input.front();
-		if (std::get_if<LsuType>(&trace->op_type)) {
-			auto lsu_type = std::get<LsuType>(trace->op_type);
-			is_fence = (lsu_type == LsuType::FENCE);
-			is_write = (lsu_type == LsuType::STORE);
-		} else if (std::get_if<AmoType>(&trace->op_type)) {
-			auto amp_type = std::get<AmoType>(trace->op_type);
-			is_write = (amp_type != AmoType::LR);
-		}
-	#ifdef EXT_V_ENABLE
-		else if (std::get_if<VlsType>(&trace->op_type)) {
-			auto vls_type = std::get<VlsType>(trace->op_type);
-			is_write = (vls_type == VlsType::VS
-			         || vls_type == VlsType::VSS
-							 || vls_type == VlsType::VSX);
-		}
-	#endif // EXT_V_ENABLE
-		else {
-			std::abort();
+		if (trace->tlb_latency != 0) {
+			// wait for the address translation
+			--trace->tlb_latency;
+			continue;
 		}
 
+		bool is_fence, is_write;
+		decode_op(trace, &is_fence, &is_write);
+
 		if (is_fence) {
 			// schedule fence lock
 			state.fence_trace = trace;
@@ -312,6 +314,7 @@ void LsuUnit::tick() {
 			lsu_req.tag  = tag;
 			lsu_req.cid  = trace->cid;
 			lsu_req.uuid = trace->uuid;
+			lsu_req.pc   = trace->PC;
 
 			// send memory request
 			core_->lmem_switch_.at(block_idx)->ReqIn.push(lsu_req);
@@ -337,6 +340,63 @@ void LsuUnit::tick() {
 	}
 }
 
+bool LsuUnit::idle() const {
+	for (uint32_t b = 0; b < states_.size(); ++b) {
+		if (!core_->lmem_switch_.at(b)->RspIn.empty())
+			return false;
+	}
+	for (uint32_t iw = 0; iw < issue_width_; ++iw) {
+		auto& state = states_.at(iw % states_.size());
+		if (state.fence_lock) {
+			// fences wait for the pending reads to complete
+			if (state.pending_rd_reqs.empty())
+				return false;
+			continue;
+		}
+		auto& input = Inputs.at(iw);
+		if (input.empty())
+			continue;
+		// reads wait for the pending queue to drain
+		auto trace = input.front();
+		bool is_fence, is_write;
+		decode_op(trace, &is_fence, &is_write);
+		if (trace->tlb_latency != 0
+		 || is_fence
+		 || is_write
+		 || !state.pending_rd_reqs.full())
+			return false;
+	}
+	return true;
+}
+
+void LsuUnit::skip(uint64_t cycles) {
+	core_->perf_stats_.load_latency += pending_loads_ * cycles;
+}
+
+void LsuUnit::decode_op(const instr_trace_t* trace, bool* is_fence, bool* is_write) {
+	*is_fence = false;
+	*is_write = false;
+	if (std::get_if<LsuType>(&trace->op_type)) {
+		auto lsu_type = std::get<LsuType>(trace->op_type);
+		*is_fence = (lsu_type == LsuType::FENCE);
+		*is_write = (lsu_type == LsuType::STORE);
+	} else if (std::get_if<AmoType>(&trace->op_type)) {
+		auto amp_type = std::get<AmoType>(trace->op_type);
+		*is_write = (amp_type != AmoType::LR);
+	}
+#ifdef EXT_V_ENABLE
+	else if (std::get_if<VlsType>(&trace->op_type)) {
+		auto vls_type = std::get<VlsType>(trace->op_type);
+		*is_write = (vls_type == VlsType::VS
+		          || vls_type == VlsType::VSS
+		          || vls_type == VlsType::VSX);
+	}
+#endif // EXT_V_ENABLE
+	else {
+		std::abort();
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 SfuUnit::SfuUnit(const SimContext& ctx, Core* core)
@@ -345,7 +405,7 @@ SfuUnit::SfuUnit(const SimContext& ctx, Core* core)
 
 void SfuUnit::tick() {
 	// check input queue
-	for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+	for (uint32_t iw = 0; iw < issue_width_; ++iw) {
 		auto& input = Inputs.at(iw);
 		if (input.empty())
 			continue;
@@ -413,7 +473,7 @@ VpuUnit::VpuUnit(const SimContext& ctx, Core* core)
 	: FuncUnit(ctx, core, "vpu-unit")
 {
 	// bind vector unit
-	for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+	for (uint32_t iw = 0; iw < issue_width_; ++iw) {
 		this->Inputs.at(iw).bind(&core_->vec_unit()->Inputs.at(iw));
 		core_->vec_unit()->Outputs.at(iw).bind(&this->Outputs.at(iw));
 	}
@@ -432,7 +492,7 @@ TcuUnit::TcuUnit(const SimContext& ctx, Core* core)
 	: FuncUnit(ctx, core, "tcu-unit")
 {
 	// bind tensor unit
-	for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+	for (uint32_t iw = 0; iw < issue_width_; ++iw) {
 		this->Inputs.at(iw).bind(&core_->tensor_unit()->Inputs.at(iw));
 		core_->tensor_unit()->Outputs.at(iw).bind(&this->Outputs.at(iw));
 	}
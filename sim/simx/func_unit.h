@@ -26,12 +26,7 @@ public:
 	std::vector<SimPort<instr_trace_t*>> Inputs;
 	std::vector<SimPort<instr_trace_t*>> Outputs;
 
-	FuncUnit(const SimContext& ctx, Core* core, const char* name)
-		: SimObject<FuncUnit>(ctx, name)
-		, Inputs(ISSUE_WIDTH, this)
-		, Outputs(ISSUE_WIDTH, this)
-		, core_(core)
-	{}
+	FuncUnit(const SimContext& ctx, Core* core, const char* name);
 
 	virtual ~FuncUnit() {}
 
@@ -39,8 +34,21 @@ public:
 
 	virtual void tick() = 0;
 
+	virtual bool idle() const {
+		for (auto& input : Inputs) {
+			if (!input.empty())
+				return false;
+		}
+		return true;
+	}
+
+	virtual void skip(uint64_t cycles) {
+		__unused (cycles);
+	}
+
 protected:
 	Core* core_;
+	uint32_t issue_width_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -71,6 +79,11 @@ public:
 	void reset() override;
 	void tick() override;
 
+	bool idle() const override;
+	void skip(uint64_t cycles) override;
+
+	static void decode_op(const instr_trace_t* trace, bool* is_fence, bool* is_write);
+
 private:
 
  	struct pending_req_t {
@@ -93,7 +106,7 @@ private:
 		}
 	};
 
-	std::array<lsu_state_t, NUM_LSU_BLOCKS> states_;
+	std::vector<lsu_state_t> states_;
 	uint64_t pending_loads_;
 	std::vector<mem_addr_size_t> pending_addrs_;
 	uint32_t remain_addrs_;
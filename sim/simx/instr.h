@@ -141,6 +141,10 @@ public:
     , fu_type_(fu_type)
   {}
 
+  void setUUID(uint64_t uuid) {
+    uuid_ = uuid;
+  }
+
   void setFUType(FUType fu_type) {
     fu_type_ = fu_type;
   }
@@ -60,7 +60,7 @@ public:
   RegOpd      dst_reg;
 
   //--
-  std::vector<RegOpd> src_regs;
+  std::array<RegOpd, NUM_SRC_REGS> src_regs;
 
   //-
   FUType     fu_type;
@@ -76,6 +76,10 @@ public:
 
   bool fetch_stall;
 
+  // address translation stall cycles
+  uint32_t fetch_tlb_latency;
+  uint32_t tlb_latency;
+
   uint64_t issue_time ;
 
   instr_trace_t(uint64_t uuid, const Arch& arch)
@@ -87,7 +91,7 @@ public:
     , PC(0)
     , wb(false)
     , dst_reg({RegType::None, 0})
-    , src_regs(NUM_SRC_REGS, {RegType::None, 0})
+    , src_regs()
     , fu_type(FUType::ALU)
     , op_type({})
     , data(nullptr)
@@ -95,6 +99,8 @@ public:
     , sop(true)
     , eop(true)
     , fetch_stall(false)
+    , fetch_tlb_latency(0)
+    , tlb_latency(0)
     , issue_time(SimPlatform::instance().cycles())
     , log_once_(false)
   {}
@@ -116,6 +122,8 @@ public:
     , sop(rhs.sop)
     , eop(rhs.eop)
     , fetch_stall(rhs.fetch_stall)
+    , fetch_tlb_latency(rhs.fetch_tlb_latency)
+    , tlb_latency(rhs.tlb_latency)
     , issue_time(rhs.issue_time)
     , log_once_(false)
   {}
@@ -0,0 +1,167 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include "types.h"
+
+// Per-lane kernels for the functional emulator.
+//
+// Kernels evaluate an operation on every thread of a warp without testing
+// the thread mask, so that the loop bodies are free of control flow and can
+// be auto-vectorized by the compiler. Inactive lanes produce don't-care
+// values which are discarded when the result is blended into the register
+// file using the warp's lane mask (all-ones for active threads, zero
+// otherwise).
+
+#if defined(__clang__)
+#define VX_LANE_LOOP _Pragma("clang loop vectorize(enable)")
+#elif defined(__GNUC__)
+#define VX_LANE_LOOP _Pragma("GCC ivdep")
+#else
+#define VX_LANE_LOOP
+#endif
+
+namespace vortex {
+
+// build the lane mask of a warp
+inline void lane_mask_init(Word* mask, const ThreadMask& tmask, uint32_t num_threads) {
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    mask[t] = Word(0) - Word(tmask.test(t));
+  }
+}
+
+// sign-extend a 32-bit result to the register width
+inline Word lane_sext32(uint32_t value) {
+  return Word(WordI(int32_t(value)));
+}
+
+// broadcast a value to all lanes
+inline void lane_fill(reg_data_t* rd, Word value, uint32_t num_threads) {
+  VX_LANE_LOOP
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    rd[t].u = value;
+  }
+}
+
+// rd[t] = f(t) for all lanes
+template <typename F>
+inline void lane_map(reg_data_t* rd, uint32_t num_threads, const F& f) {
+  VX_LANE_LOOP
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    rd[t].u = f(t);
+  }
+}
+
+// rd[t] = f(rs1[t], rs2[t] or imm) on XLEN-wide operands
+template <typename F>
+inline void lane_binop(reg_data_t* rd,
+                       const reg_data_t* rs1,
+                       const reg_data_t* rs2,
+                       bool is_imm,
+                       Word imm,
+                       uint32_t num_threads,
+                       const F& f) {
+  if (is_imm) {
+    lane_map(rd, num_threads, [&](uint32_t t) { return Word(f(rs1[t].u, imm)); });
+  } else {
+    lane_map(rd, num_threads, [&](uint32_t t) { return Word(f(rs1[t].u, rs2[t].u)); });
+  }
+}
+
+// rd[t] = sext(f(rs1[t], rs2[t] or imm)) on 32-bit operands (RV64 *W instructions)
+template <typename F>
+inline void lane_binop_w(reg_data_t* rd,
+                         const reg_data_t* rs1,
+                         const reg_data_t* rs2,
+                         bool is_imm,
+                         Word imm,
+                         uint32_t num_threads,
+                         const F& f) {
+  if (is_imm) {
+    auto imm32 = uint32_t(imm);
+    lane_map(rd, num_threads, [&](uint32_t t) { return lane_sext32(f(rs1[t].u32, imm32)); });
+  } else {
+    lane_map(rd, num_threads, [&](uint32_t t) { return lane_sext32(f(rs1[t].u32, rs2[t].u32)); });
+  }
+}
+
+// number of active lanes for which the predicate f(t) holds
+template <typename F>
+inline uint32_t lane_count(const Word* mask, uint32_t num_threads, const F& f) {
+  uint32_t count = 0;
+  VX_LANE_LOOP
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    count += uint32_t(f(t)) & uint32_t(mask[t]);
+  }
+  return count;
+}
+
+// write back active lanes: dst[t] = mask[t] ? src[t] : dst[t]
+template <typename T>
+inline void lane_blend(T* dst, const reg_data_t* src, const Word* mask, uint32_t num_threads) {
+  VX_LANE_LOOP
+  for (uint32_t t = 0; t < num_threads; ++t) {
+    T m = T(WordI(mask[t]));
+    T value;
+    if constexpr (sizeof(T) == sizeof(uint64_t)) {
+      value = T(src[t].u64);
+    } else {
+      value = T(src[t].u);
+    }
+    dst[t] = (value & m) | (dst[t] & ~m);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// RISC-V division semantics: x/0 = -1, INT_MIN/-1 = INT_MIN.
+// The divisor is substituted before dividing so that no lane can trap.
+
+template <typename S>
+inline S lane_div(S a, S b) {
+  using U = std::make_unsigned_t<S>;
+  bool zero = (b == 0);
+  bool ovf = (a == S(U(1) << (sizeof(S) * 8 - 1))) && (b == S(-1));
+  S d = (zero || ovf) ? S(1) : b;
+  S q = a / d;
+  return zero ? S(-1) : q;
+}
+
+template <typename U>
+inline U lane_divu(U a, U b) {
+  bool zero = (b == 0);
+  U q = a / (zero ? U(1) : b);
+  return zero ? U(-1) : q;
+}
+
+template <typename S>
+inline S lane_rem(S a, S b) {
+  using U = std::make_unsigned_t<S>;
+  bool zero = (b == 0);
+  bool ovf = (a == S(U(1) << (sizeof(S) * 8 - 1))) && (b == S(-1));
+  S d = (zero || ovf) ? S(1) : b;
+  S r = a % d;
+  return zero ? a : r;
+}
+
+template <typename U>
+inline U lane_remu(U a, U b) {
+  bool zero = (b == 0);
+  U r = a % (zero ? U(1) : b);
+  return zero ? a : r;
+}
+
+}
@@ -54,6 +54,9 @@ public:
 			simobject->Inputs.at(i).bind(&mem_xbar_->ReqIn.at(i));
 			mem_xbar_->RspIn.at(i).bind(&simobject->Outputs.at(i));
 		}
+		for (uint32_t i = 0; i < num_banks; ++i) {
+			mem_xbar_->ReqOut.at(i).set_reader(simobject);
+		}
 	}
 
 	virtual ~Impl() {}
@@ -74,6 +77,14 @@ public:
 		ram_.write(data, l_addr, size);
 	}
 
+	void save(CheckpointWriter& ckpt) const {
+		ram_.save(ckpt);
+	}
+
+	void restore(CheckpointReader& ckpt) {
+		ram_.restore(ckpt);
+	}
+
 	void tick() {
 		// process bank requets from xbar
 		uint32_t num_banks = (1 << config_.B);
@@ -100,6 +111,15 @@ public:
 		}
 	}
 
+	bool idle() const {
+		uint32_t num_banks = (1 << config_.B);
+		for (uint32_t i = 0; i < num_banks; ++i) {
+			if (!mem_xbar_->ReqOut.at(i).empty())
+				return false;
+		}
+		return true;
+	}
+
 	const PerfStats& perf_stats() const {
 		perf_stats_.bank_stalls = mem_xbar_->collisions();
 		return perf_stats_;
@@ -131,10 +151,22 @@ void LocalMem::write(const void* data, uint64_t addr, uint32_t size) {
   impl_->write(data, addr, size);
 }
 
+void LocalMem::save(CheckpointWriter& ckpt) const {
+  impl_->save(ckpt);
+}
+
+void LocalMem::restore(CheckpointReader& ckpt) {
+  impl_->restore(ckpt);
+}
+
 void LocalMem::tick() {
   impl_->tick();
 }
 
+bool LocalMem::idle() const {
+  return impl_->idle();
+}
+
 const LocalMem::PerfStats& LocalMem::perf_stats() const {
   return impl_->perf_stats();
 }
\ No newline at end of file
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <simobject.h>
+#include <checkpoint.h>
 #include "types.h"
 
 namespace vortex {
@@ -59,8 +60,13 @@ public:
 
   void write(const void* data, uint64_t addr, uint32_t size);
 
+  void save(CheckpointWriter& ckpt) const;
+  void restore(CheckpointReader& ckpt);
+
   void tick();
 
+  bool idle() const;
+
   const PerfStats& perf_stats() const;
 
 protected:
@@ -14,8 +14,10 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <vector>
 #include <sstream>
 #include <fstream>
+#include <chrono>
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/stat.h>
@@ -23,34 +25,68 @@
 #include "mem.h"
 #include "constants.h"
 #include <util.h>
+#include <mempool.h>
 #include "core.h"
 #include "VX_types.h"
 
 using namespace vortex;
 
 static void show_usage() {
-   std::cout << "Usage: [-c <cores>] [-w <warps>] [-t <threads>] [-v: vector-test] [-s: stats] [-h: help] <program>" << std::endl;
+   std::cout << "Usage: [-c <cores>] [-w <warps>] [-t <threads>] [-A <arch.json>] [-P <param>=<value>] [-j <sim-threads>] [-n: no idle fast-forward] [-a: tick all objects] [-S <sampling-spec>] [-C <checkpoint-out>] [-R <checkpoint-in>] [-T <pipe-trace>] [-v: vector-test] [-s: stats] [-h: help] <program>" << std::endl;
 }
 
-uint32_t num_threads = NUM_THREADS;
-uint32_t num_warps = NUM_WARPS;
-uint32_t num_cores = NUM_CORES;
+const char* arch_file = nullptr;
+std::vector<std::string> arch_params;
+uint32_t sim_threads = 0;
+bool fast_forward = true;
+bool activity_tracking = true;
+const char* sampling = nullptr;
+const char* checkpoint_out = nullptr;
+const char* checkpoint_in = nullptr;
+const char* pipe_trace = nullptr;
 bool showStats = false;
 bool vector_test = false;
 const char* program = nullptr;
 
 static void parse_args(int argc, char **argv) {
   	int c;
-  	while ((c = getopt(argc, argv, "t:w:c:vsh")) != -1) {
+  	while ((c = getopt(argc, argv, "t:w:c:A:P:j:naS:C:R:T:vsh")) != -1) {
     	switch (c) {
       case 't':
-        num_threads = atoi(optarg);
+        arch_params.push_back(std::string("num_threads=") + optarg);
         break;
       case 'w':
-        num_warps = atoi(optarg);
+        arch_params.push_back(std::string("num_warps=") + optarg);
         break;
 		  case 'c':
-        num_cores = atoi(optarg);
+        arch_params.push_back(std::string("num_cores=") + optarg);
+        break;
+      case 'A':
+        arch_file = optarg;
+        break;
+      case 'P':
+        arch_params.push_back(optarg);
+        break;
+      case 'j':
+        sim_threads = atoi(optarg);
+        break;
+      case 'n':
+        fast_forward = false;
+        break;
+      case 'a':
+        activity_tracking = false;
+        break;
+      case 'S':
+        sampling = optarg;
+        break;
+      case 'C':
+        checkpoint_out = optarg;
+        break;
+      case 'R':
+        checkpoint_in = optarg;
+        break;
+      case 'T':
+        pipe_trace = optarg;
         break;
       case 'v':
         vector_test = true;
@@ -84,7 +120,19 @@ int main(int argc, char **argv) {
 
   {
     // create processor configuation
-    Arch arch(num_threads, num_warps, num_cores);
+    Arch arch(NUM_THREADS, NUM_WARPS, NUM_CORES);
+    if (arch_file && arch.load(arch_file) != 0) {
+      return -1;
+    }
+    for (auto& param : arch_params) {
+      if (arch.set(param) != 0) {
+        std::cerr << "Error: invalid architecture parameter: " << param << std::endl;
+        return -1;
+      }
+    }
+    if (arch.validate() != 0) {
+      return -1;
+    }
 
     // create memory module
     RAM ram(0, MEM_PAGE_SIZE);
@@ -95,6 +143,36 @@ int main(int argc, char **argv) {
     // attach memory module
     processor.attach_ram(&ram);
 
+    // enable multi-threaded simulation
+    processor.set_sim_threads(sim_threads);
+
+    // skip idle cycles
+    processor.set_fast_forward(fast_forward);
+
+    // only tick active objects
+    processor.set_activity_tracking(activity_tracking);
+
+    // functional fast-forward and sampled detailed simulation
+    if (sampling && processor.set_sampling(sampling) != 0) {
+      std::cerr << "Error: invalid sampling spec '" << sampling << "'." << std::endl;
+      return -1;
+    }
+
+    // save a checkpoint when the sampling trigger fires
+    if (checkpoint_out) {
+      if (!sampling) {
+        std::cerr << "Error: checkpoints are taken at the sampling trigger (-S)." << std::endl;
+        return -1;
+      }
+      processor.set_trigger_checkpoint(checkpoint_out);
+    }
+
+    // binary pipeline trace
+    if (pipe_trace && processor.set_pipe_trace(pipe_trace) != 0) {
+      std::cerr << "Error: cannot create pipeline trace '" << pipe_trace << "'." << std::endl;
+      return -1;
+    }
+
 	  // setup base DCRs
     const uint64_t startup_addr(STARTUP_ADDR);
     processor.dcr_write(VX_DCR_BASE_STARTUP_ADDR0, startup_addr & 0xffffffff);
@@ -106,15 +184,20 @@ int main(int argc, char **argv) {
     // load program
     {
       std::string program_ext(fileExtension(program));
-      if (program_ext == "bin") {
+      if (program_ext == "bin" || program_ext == "zst") {
         ram.loadBinImage(program, startup_addr);
       } else if (program_ext == "hex") {
         ram.loadHexImage(program);
       } else {
-        std::cerr << "Error: only *.bin or *.hex images supported." << std::endl;
+        std::cerr << "Error: only *.bin, *.bin.zst or *.hex images supported." << std::endl;
         return -1;
       }
     }
+
+    // resume from a checkpoint of this program
+    if (checkpoint_in && processor.restore_checkpoint(checkpoint_in) != 0) {
+      return -1;
+    }
 #ifndef NDEBUG
     std::cout << "[VXDRV] START: program=" << program << std::endl;
 #endif
@@ -124,10 +207,70 @@ int main(int argc, char **argv) {
     if (vector_test) return (processor.run() != 1);
   #endif
     // else continue as normal
+    auto start_time = std::chrono::high_resolution_clock::now();
     processor.run();
+    auto end_time = std::chrono::high_resolution_clock::now();
 
     // read exitcode from @MPM.1
     ram.read(&exitcode, (IO_MPM_ADDR + 8), 4);
+
+    if (showStats) {
+      // read performance counters dumped by the kernel on exit
+      uint64_t instrs = 0;
+      uint64_t cycles = 0;
+      for (uint32_t core_id = 0, n = arch.num_cores() * arch.num_clusters(); core_id < n; ++core_id) {
+        uint64_t mpm_mem_addr = IO_MPM_ADDR + core_id * 32 * sizeof(uint64_t);
+        uint64_t core_instrs, core_cycles;
+        ram.read(&core_cycles, mpm_mem_addr + (VX_CSR_MCYCLE - VX_CSR_MPM_BASE) * sizeof(uint64_t), sizeof(uint64_t));
+        ram.read(&core_instrs, mpm_mem_addr + (VX_CSR_MINSTRET - VX_CSR_MPM_BASE) * sizeof(uint64_t), sizeof(uint64_t));
+        instrs += core_instrs;
+        cycles = std::max(cycles, core_cycles);
+      }
+      double elapsed = std::chrono::duration<double>(end_time - start_time).count();
+      std::cout << std::fixed << std::setprecision(3);
+      std::cout << "PERF: instrs=" << instrs << ", cycles=" << cycles << ", IPC=" << (cycles ? double(instrs) / cycles : 0) << std::endl;
+      std::cout << "PERF: simulation time=" << elapsed << " sec, rate=" << (instrs / elapsed) / 1e6 << " MIPS, "
+                << (cycles / elapsed) / 1e3 << " KHz" << std::endl;
+
+      // cache hit rates under the configured replacement policies
+      auto counters = processor.perf_counters();
+      auto counter = [&](const std::string& name) {
+        for (auto& c : counters) {
+          if (c.first == name)
+            return c.second;
+        }
+        return uint64_t(0);
+      };
+      std::pair<const char*, const CacheArch*> caches[] = {
+        {"icache", &arch.icache()}, {"dcache", &arch.dcache()},
+        {"l2cache", &arch.l2cache()}, {"l3cache", &arch.l3cache()}
+      };
+      for (auto& cache : caches) {
+        if (!cache.second->enabled)
+          continue;
+        std::string name(cache.first);
+        auto accesses = counter(name + ".reads") + counter(name + ".writes");
+        auto misses = counter(name + ".read_misses") + counter(name + ".write_misses");
+        if (accesses == 0)
+          continue;
+        std::cout << "PERF: " << name << " (" << cache.second->repl_policy << "): hit rate="
+                  << (100.0 * (accesses - misses) / accesses) << "%, accesses=" << accesses
+                  << ", misses=" << misses << std::endl;
+        auto pf_issued = counter(name + ".pf_issued");
+        if (pf_issued != 0) {
+          auto pf_useful = counter(name + ".pf_useful");
+          auto pf_late = counter(name + ".pf_late");
+          std::cout << "PERF: " << name << " prefetches: issued=" << pf_issued
+                    << ", useful=" << pf_useful
+                    << ", late=" << pf_late
+                    << ", polluting=" << counter(name + ".pf_polluting")
+                    << ", accuracy=" << (100.0 * (pf_useful + pf_late) / pf_issued) << "%" << std::endl;
+        }
+      }
+
+      // simulator object pools
+      mempool_dump_stats(std::cout);
+    }
   }
 
   return exitcode;
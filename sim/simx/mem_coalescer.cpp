@@ -142,6 +142,7 @@ void MemCoalescer::tick() {
   out_req.addrs = out_addrs;
   out_req.cid = in_req.cid;
   out_req.uuid = in_req.uuid;
+  out_req.pc = in_req.pc;
 
   // send memory request
   ReqOut.push(out_req, delay_);
@@ -158,6 +159,11 @@ void MemCoalescer::tick() {
   }
 }
 
+bool MemCoalescer::idle() const {
+  // requests wait for a response tag to be released
+  return RspOut.empty() && (ReqIn.empty() || pending_rd_reqs_.full());
+}
+
 const MemCoalescer::PerfStats& MemCoalescer::perf_stats() const {
   return perf_stats_;
 }
\ No newline at end of file
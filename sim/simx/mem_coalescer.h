@@ -50,6 +50,8 @@ public:
 
   void tick();
 
+  bool idle() const;
+
   const PerfStats& perf_stats() const;
 
 private:
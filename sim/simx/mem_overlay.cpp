@@ -0,0 +1,99 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mem_overlay.h"
+#include <simobject.h>
+
+using namespace vortex;
+
+MemOverlay::MemOverlay(RAM* ram, const std::vector<MemOverlay*>& lowers)
+  : ram_(ram)
+  , lowers_(lowers)
+  , enabled_(false)
+  , synced_(false)
+{}
+
+uint64_t MemOverlay::size() const {
+  return ram_->size();
+}
+
+void MemOverlay::read(void* data, uint64_t addr, uint64_t size) {
+  if (!enabled_) {
+    ram_->read(data, addr, size);
+    return;
+  }
+  ram_->peek(data, addr, size);
+  if (synced_) {
+    for (auto lower : lowers_) {
+      lower->apply(data, addr, size);
+    }
+  }
+  this->apply(data, addr, size);
+}
+
+void MemOverlay::write(const void* data, uint64_t addr, uint64_t size) {
+  if (!enabled_) {
+    ram_->write(data, addr, size);
+    return;
+  }
+  auto d = (const uint8_t*)data;
+  for (uint64_t i = 0; i < size; ++i) {
+    uint64_t a = addr + i;
+    uint32_t offset = a & 0x7;
+    auto& block = blocks_[a >> 3];
+    block.data = (block.data & ~(0xffull << (offset * 8))) | (uint64_t(d[i]) << (offset * 8));
+    block.mask |= (1 << offset);
+  }
+}
+
+void MemOverlay::enable(bool enable) {
+  this->commit();
+  enabled_ = enable;
+}
+
+void MemOverlay::sync() {
+  if (!enabled_ || synced_)
+    return;
+  SimPlatform::instance().sync();
+  synced_ = true;
+}
+
+void MemOverlay::commit() {
+  for (auto& it : blocks_) {
+    auto& block = it.second;
+    for (uint32_t offset = 0; offset < 8; ++offset) {
+      if (block.mask & (1 << offset)) {
+        uint8_t value = block.data >> (offset * 8);
+        ram_->write(&value, (it.first << 3) + offset, 1);
+      }
+    }
+  }
+  blocks_.clear();
+  synced_ = false;
+}
+
+void MemOverlay::apply(void* data, uint64_t addr, uint64_t size) const {
+  if (blocks_.empty())
+    return;
+  auto d = (uint8_t*)data;
+  for (uint64_t i = 0; i < size; ++i) {
+    uint64_t a = addr + i;
+    auto it = blocks_.find(a >> 3);
+    if (it == blocks_.end())
+      continue;
+    uint32_t offset = a & 0x7;
+    if (it->second.mask & (1 << offset)) {
+      d[i] = it->second.data >> (offset * 8);
+    }
+  }
+}
@@ -0,0 +1,64 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <mem.h>
+#include <unordered_map>
+#include <vector>
+
+namespace vortex {
+
+// Per-cluster view of the global memory for the multi-threaded simulation.
+// Stores issued during a cycle are buffered and committed to RAM at the end
+// of the cycle in cluster order, loads observe memory as of the last commit
+// plus the cluster's own stores. sync() extends the view with the stores of
+// all lower clusters for the current cycle, which linearizes atomics.
+class MemOverlay : public MemDevice {
+public:
+  MemOverlay(RAM* ram, const std::vector<MemOverlay*>& lowers);
+
+  uint64_t size() const override;
+
+  void read(void* data, uint64_t addr, uint64_t size) override;
+
+  void write(const void* data, uint64_t addr, uint64_t size) override;
+
+  // buffer stores instead of writing through to RAM
+  void enable(bool enable);
+
+  bool enabled() const {
+    return enabled_;
+  }
+
+  void sync();
+
+  void commit();
+
+private:
+
+  struct block_t {
+    uint64_t data;
+    uint8_t  mask;
+  };
+
+  void apply(void* data, uint64_t addr, uint64_t size) const;
+
+  RAM* ram_;
+  std::vector<MemOverlay*> lowers_;
+  std::unordered_map<uint64_t, block_t> blocks_;
+  bool enabled_;
+  bool synced_;
+};
+
+}
@@ -16,6 +16,7 @@
 #include <queue>
 #include <stdlib.h>
 #include <dram_sim.h>
+#include <mempool.h>
 
 #include "constants.h"
 #include "types.h"
@@ -35,12 +36,13 @@ private:
 		MemReq request;
 		uint32_t bank_id;
 	};
+	PoolAllocator<DramCallbackArgs> req_args_pool_;
 
 public:
 	Impl(MemSim* simobject, const Config& config)
 		: simobject_(simobject)
 		, config_(config)
-		, dram_sim_(config.num_banks, config.block_size, config.clock_ratio)
+		, dram_sim_(DramSim::Config{config.model, config.num_banks, config.block_size, config.clock_ratio, config.timing, config.ramulator})
 	{
 		char sname[100];
 		snprintf(sname, 100, "%s-xbar", simobject->name().c_str());
@@ -53,6 +55,9 @@ public:
 			simobject->MemReqPorts.at(i).bind(&mem_xbar_->ReqIn.at(i));
 			mem_xbar_->RspIn.at(i).bind(&simobject->MemRspPorts.at(i));
 		}
+		for (uint32_t i = 0; i < config.num_banks; ++i) {
+			mem_xbar_->ReqOut.at(i).set_reader(simobject);
+		}
 	}
 
 	~Impl() {
@@ -78,7 +83,7 @@ public:
 			auto& mem_req = mem_xbar_->ReqOut.at(i).front();
 
 			// enqueue the request to the memory system
-			auto req_args = new DramCallbackArgs{this, mem_req, i};
+			auto req_args = new (req_args_pool_.allocate(1)) DramCallbackArgs{this, mem_req, i};
 			dram_sim_.send_request(
 				mem_req.addr,
 				mem_req.write,
@@ -90,7 +95,9 @@ public:
 						rsp_args->memsim->mem_xbar_->RspOut.at(rsp_args->bank_id).push(mem_rsp, 1);
 						DT(3, rsp_args->memsim->simobject_->name() << "-mem-rsp" << rsp_args->bank_id << ": " << mem_rsp);
 					}
-					delete rsp_args;
+					auto memsim = rsp_args->memsim;
+					rsp_args->~DramCallbackArgs();
+					memsim->req_args_pool_.deallocate(const_cast<DramCallbackArgs*>(rsp_args), 1);
 				},
 				req_args
 			);
@@ -99,6 +106,22 @@ public:
 			mem_xbar_->ReqOut.at(i).pop();
 		}
 	}
+
+	bool idle() const {
+		for (uint32_t i = 0; i < config_.num_banks; ++i) {
+			if (!mem_xbar_->ReqOut.at(i).empty())
+				return false;
+		}
+		return true;
+	}
+
+	uint64_t run_ahead(uint64_t cycles) {
+		return dram_sim_.run_ahead(cycles);
+	}
+
+	void skip(uint64_t cycles) {
+		dram_sim_.skip(cycles);
+	}
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -122,6 +145,18 @@ void MemSim::tick() {
   impl_->tick();
 }
 
+bool MemSim::idle() const {
+  return impl_->idle();
+}
+
+uint64_t MemSim::run_ahead(uint64_t cycles) {
+  return impl_->run_ahead(cycles);
+}
+
+void MemSim::skip(uint64_t cycles) {
+  impl_->skip(cycles);
+}
+
 const MemSim::PerfStats &MemSim::perf_stats() const {
 	return impl_->perf_stats();
 }
\ No newline at end of file
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <simobject.h>
+#include <dram_sim.h>
 #include "types.h"
 
 namespace vortex {
@@ -25,6 +26,9 @@ public:
 		uint32_t num_ports;
 		uint32_t block_size;
 		float clock_ratio;
+		DramModel model;
+		DramTiming timing;
+		RamulatorConfig ramulator;
 	};
 
 	struct PerfStats {
@@ -50,6 +54,12 @@ public:
 
 	void tick();
 
+	bool idle() const;
+
+	uint64_t run_ahead(uint64_t cycles);
+
+	void skip(uint64_t cycles);
+
 	const PerfStats& perf_stats() const;
 
 private:
@@ -62,6 +62,10 @@ void OpcUnit::tick() {
   Input.pop();
 }
 
+bool OpcUnit::idle() const {
+  return Input.empty();
+}
+
 void OpcUnit::writeback(instr_trace_t* trace) {
   __unused(trace);
 }
\ No newline at end of file
@@ -16,22 +16,24 @@
 
 using namespace vortex;
 
-Operands::Operands(const SimContext &ctx, Core* /*core*/)
+Operands::Operands(const SimContext &ctx, Core* core)
     : SimObject<Operands>(ctx, "operands")
     , Input(this)
     , Output(this)
-    , opc_units_(NUM_OPCS) {
-  static_assert(NUM_OPCS <= PER_ISSUE_WARPS, "invalid NUM_OPCS value");
+    , opc_units_(core->arch().num_opcs())
+    , issue_width_(core->arch().issue_width())
+    , num_opcs_(core->arch().num_opcs()) {
+  assert(num_opcs_ <= core->arch().per_issue_warps());
   // create OPC units
-  for (uint32_t i = 0; i < NUM_OPCS; i++) {
+  for (uint32_t i = 0; i < num_opcs_; i++) {
     opc_units_.at(i) = OpcUnit::Create();
   }
 
-  if (NUM_OPCS >= 2) {
+  if (num_opcs_ >= 2) {
     char sname[100];
     snprintf(sname, 100, "%s-rsp_arb", this->name().c_str());
-    rsp_arb_ = TraceArbiter::Create(sname, ArbiterType::RoundRobin, NUM_OPCS, 1);
-    for (uint32_t i = 0; i < NUM_OPCS; ++i) {
+    rsp_arb_ = TraceArbiter::Create(sname, ArbiterType::RoundRobin, num_opcs_, 1);
+    for (uint32_t i = 0; i < num_opcs_; ++i) {
       opc_units_.at(i)->Output.bind(&rsp_arb_->Inputs.at(i));
     }
     rsp_arb_->Outputs.at(0).bind(&this->Output);
@@ -51,22 +53,26 @@ void Operands::reset() {
 }
 
 void Operands::tick() {
-  if (NUM_OPCS < 2)
+  if (num_opcs_ < 2)
     return; // pass-thru
 
   // process requests
   if (Input.empty())
     return;
   auto trace = this->Input.front();
-  for (uint32_t i = 0; i < NUM_OPCS; i++) {
-    uint32_t wis = trace->wid / ISSUE_WIDTH;
-    uint32_t index = wis % NUM_OPCS;
+  for (uint32_t i = 0; i < num_opcs_; i++) {
+    uint32_t wis = trace->wid / issue_width_;
+    uint32_t index = wis % num_opcs_;
     opc_units_.at(index)->Input.push(trace);
     Input.pop();
     break;
   }
 }
 
+bool Operands::idle() const {
+  return (num_opcs_ < 2) || Input.empty();
+}
+
 uint32_t Operands::total_stalls() const {
   uint32_t total = 0;
   for (const auto& opc_unit : opc_units_) {
@@ -76,7 +82,7 @@ uint32_t Operands::total_stalls() const {
 }
 
 void Operands::writeback(instr_trace_t* trace) {
-  uint32_t wis = trace->wid / ISSUE_WIDTH;
-  uint32_t index = wis % NUM_OPCS;
+  uint32_t wis = trace->wid / issue_width_;
+  uint32_t index = wis % num_opcs_;
   opc_units_.at(index)->writeback(trace);
 }
\ No newline at end of file
@@ -28,7 +28,7 @@ public:
     return queue_.empty();
   }
 
-  instr_trace_t* front() {
+  instr_trace_t* front() const {
     return queue_.front();
   }
 
@@ -13,12 +13,17 @@
 
 #include "processor.h"
 #include "processor_impl.h"
+#include <checkpoint.h>
+#include <fstream>
+#include <sstream>
 
 using namespace vortex;
 
 ProcessorImpl::ProcessorImpl(const Arch& arch)
   : arch_(arch)
   , clusters_(arch.num_clusters())
+  , ram_(nullptr)
+  , fast_forward_(true)
 {
   SimPlatform::instance().initialize();
 
@@ -26,51 +31,68 @@ ProcessorImpl::ProcessorImpl(const Arch& arch)
 
   // create memory simulator
   memsim_ = MemSim::Create("dram", MemSim::Config{
-    PLATFORM_MEMORY_NUM_BANKS,
-    L3_MEM_PORTS,
+    arch.dram().num_banks,
+    arch.l3cache().mem_ports,
     MEM_BLOCK_SIZE,
-    MEM_CLOCK_RATIO
+    arch.dram().clock_ratio,
+    arch.dram().model,
+    arch.dram().timing,
+    arch.dram().ramulator
   });
 
-  // create clusters
+  // create clusters, each cluster is a separate simulation partition
   for (uint32_t i = 0; i < arch.num_clusters(); ++i) {
+    SimPlatform::instance().set_partition(i + 1);
     clusters_.at(i) = Cluster::Create(i, this, arch, dcrs_);
   }
+  SimPlatform::instance().set_partition(0);
+
+  for (auto cluster : clusters_) {
+    for (auto& socket : cluster->sockets()) {
+      for (auto& core : socket->cores()) {
+        cores_.push_back(core.get());
+      }
+    }
+  }
 
   // create L3 cache
+  auto& l3 = arch.l3cache();
   l3cache_ = CacheSim::Create("l3cache", CacheSim::Config{
-    !L3_ENABLED,
-    log2ceil(L3_CACHE_SIZE),  // C
+    !l3.enabled,
+    log2ceil(l3.size),        // C
     log2ceil(MEM_BLOCK_SIZE), // L
     log2ceil(L2_LINE_SIZE),   // W
-    log2ceil(L3_NUM_WAYS),    // A
-    log2ceil(L3_NUM_BANKS),   // B
+    log2ceil(l3.num_ways),    // A
+    log2ceil(l3.num_banks),   // B
     XLEN,                     // address bits
-    L3_NUM_REQS,              // request size
-    L3_MEM_PORTS,             // memory ports
-    L3_WRITEBACK,             // write-back
+    arch.l3_num_reqs(),       // request size
+    l3.mem_ports,             // memory ports
+    l3.writeback,             // write-back
     false,                    // write response
-    L3_MSHR_SIZE,             // mshr size
+    l3.mshr_size,             // mshr size
     2,                        // pipeline latency
+    l3.repl_policy,           // replacement policy
+    l3.prefetch,              // prefetchers
     }
   );
 
   // connect L3 core interfaces
+  uint32_t l2_mem_ports = arch.l2cache().mem_ports;
   for (uint32_t i = 0; i < arch.num_clusters(); ++i) {
-    for (uint32_t j = 0; j < L2_MEM_PORTS; ++j) {
-      clusters_.at(i)->mem_req_ports.at(j).bind(&l3cache_->CoreReqPorts.at(i * L2_MEM_PORTS + j));
-      l3cache_->CoreRspPorts.at(i * L2_MEM_PORTS + j).bind(&clusters_.at(i)->mem_rsp_ports.at(j));
+    for (uint32_t j = 0; j < l2_mem_ports; ++j) {
+      clusters_.at(i)->mem_req_ports.at(j).bind(&l3cache_->CoreReqPorts.at(i * l2_mem_ports + j));
+      l3cache_->CoreRspPorts.at(i * l2_mem_ports + j).bind(&clusters_.at(i)->mem_rsp_ports.at(j));
     }
   }
 
   // connect L3 memory interfaces
-  for (uint32_t i = 0; i < L3_MEM_PORTS; ++i) {
+  for (uint32_t i = 0; i < l3.mem_ports; ++i) {
     l3cache_->MemReqPorts.at(i).bind(&memsim_->MemReqPorts.at(i));
     memsim_->MemRspPorts.at(i).bind(&l3cache_->MemRspPorts.at(i));
   }
 
   // set up memory profiling
-  for (uint32_t i = 0; i < L3_MEM_PORTS; ++i) {
+  for (uint32_t i = 0; i < l3.mem_ports; ++i) {
     memsim_->MemReqPorts.at(i).tx_callback([&](const MemReq& req, uint64_t cycle){
       __unused (cycle);
       perf_mem_reads_  += !req.write;
@@ -85,15 +107,7 @@ ProcessorImpl::ProcessorImpl(const Arch& arch)
 
 #ifndef NDEBUG
   // dump device configuration
-  std::cout << "CONFIGS:"
-            << " num_threads=" << arch.num_threads()
-            << ", num_warps=" << arch.num_warps()
-            << ", num_cores=" << arch.num_cores()
-            << ", num_clusters=" << arch.num_clusters()
-            << ", socket_size=" << arch.socket_size()
-            << ", local_mem_base=0x" << std::hex << arch.local_mem_base() << std::dec
-            << ", num_barriers=" << arch.num_barriers()
-            << std::endl;
+  arch.dump(std::cout);
 #endif
   // reset the device
   this->reset();
@@ -104,8 +118,14 @@ ProcessorImpl::~ProcessorImpl() {
 }
 
 void ProcessorImpl::attach_ram(RAM* ram) {
+  ram_ = ram;
+  mem_overlays_.clear();
+  std::vector<MemOverlay*> lowers;
   for (auto cluster : clusters_) {
-    cluster->attach_ram(ram);
+    auto overlay = new MemOverlay(ram, lowers);
+    mem_overlays_.emplace_back(overlay);
+    lowers.push_back(overlay);
+    cluster->attach_ram(overlay);
   }
 }
 #ifdef VM_ENABLE
@@ -120,10 +140,45 @@ int ProcessorImpl::run() {
   SimPlatform::instance().reset();
   this->reset();
 
+  // buffer memory stores while clusters are ticked concurrently
+  bool threaded = (SimPlatform::instance().num_threads() != 0);
+  for (auto& overlay : mem_overlays_) {
+    overlay->enable(threaded);
+  }
+
+  // continue a kernel restored from a checkpoint
+  bool resumed = !resume_state_.empty();
+  if (resumed) {
+    this->resume_state();
+  }
+
+  sampler_.reset(this->instrs(), SimPlatform::instance().cycles());
+  if (resumed) {
+    sampler_.resume(this->instrs(), SimPlatform::instance().cycles());
+  }
+
   bool done;
   int exitcode = 0;
   do {
-    SimPlatform::instance().tick();
+    if (sampler_.phase() == Sampler::Phase::Functional) {
+      // fast-forward up to the next detailed window
+      this->run_functional(threaded);
+    } else {
+      if (fast_forward_) {
+        auto skipped = SimPlatform::instance().fast_forward();
+        perf_mem_latency_ += perf_mem_pending_reads_ * skipped;
+      }
+      SimPlatform::instance().tick();
+      if (threaded) {
+        for (auto& overlay : mem_overlays_) {
+          overlay->commit();
+        }
+      }
+      perf_mem_latency_ += perf_mem_pending_reads_;
+      if (sampler_.enabled()) {
+        this->sample_step();
+      }
+    }
     done = true;
     for (auto cluster : clusters_) {
       if (cluster->running()) {
@@ -132,12 +187,194 @@ int ProcessorImpl::run() {
       }
       exitcode |= cluster->get_exitcode();
     }
-    perf_mem_latency_ += perf_mem_pending_reads_;
   } while (!done);
 
+  // update the counters of sleeping objects
+  SimPlatform::instance().catch_up();
+
+  if (sampler_.enabled()) {
+    sampler_.finish(this->instrs(), SimPlatform::instance().cycles());
+    sampler_.dump(std::cout);
+  }
+
+  for (auto& overlay : mem_overlays_) {
+    overlay->enable(false);
+  }
+
   return exitcode;
 }
 
+void ProcessorImpl::run_functional(bool threaded) {
+  // the emulator updates the memory directly
+  for (auto& overlay : mem_overlays_) {
+    overlay->enable(false);
+  }
+
+  bool triggered = sampler_.triggered();
+  auto cycles = SimPlatform::instance().cycles();
+  for (;;) {
+    // step one instruction per core
+    bool running = false;
+    bool stepped = false;
+    for (auto core : cores_) {
+      if (!core->running())
+        continue;
+      running = true;
+      uint64_t PC;
+      if (core->step_functional(&PC)) {
+        sampler_.pc_event(PC);
+        stepped = true;
+      }
+    }
+    if (!running)
+      break;
+    if (!stepped)
+      throw std::runtime_error("functional simulation deadlock");
+    if (sampler_.functional_step(this->instrs(), cycles))
+      break;
+  }
+
+  for (auto core : cores_) {
+    core->end_functional();
+  }
+
+  if (!triggered && sampler_.triggered() && !trigger_checkpoint_.empty()) {
+    this->save_checkpoint(trigger_checkpoint_.c_str(), true);
+    std::cout << "CHECKPOINT: saved " << trigger_checkpoint_ << " at "
+              << this->instrs() << " instructions" << std::endl;
+  }
+
+  for (auto& overlay : mem_overlays_) {
+    overlay->enable(threaded);
+  }
+}
+
+// checkpoint layout:
+//   configuration, DCRs, memory, cache tags and MSHRs,
+//   then the cluster and core state when taken within a kernel.
+// Checkpoints are only taken while the pipelines are empty, either between
+// kernels or at the end of a functional window, so no timing event is in
+// flight; TLBs and the decode cache are rebuilt on demand after a restore.
+// In-flight cache prefetches are dropped and the prefetcher tables retrained.
+static constexpr uint32_t CHECKPOINT_VERSION = 4;
+
+static void checkpoint_config(const Arch& arch, CheckpointWriter* writer, CheckpointReader* reader) {
+  uint32_t config[] = {
+    XLEN,
+    arch.num_threads(),
+    arch.num_warps(),
+    arch.num_cores(),
+    arch.num_clusters(),
+    arch.socket_size(),
+    arch.issue_width()
+  };
+  if (writer) {
+    writer->section("VXCK");
+    writer->write(CHECKPOINT_VERSION);
+    for (auto value : config) {
+      writer->write(value);
+    }
+  } else {
+    reader->section("VXCK");
+    reader->check(CHECKPOINT_VERSION, "version");
+    for (auto value : config) {
+      reader->check(value, "processor configuration");
+    }
+  }
+}
+
+void ProcessorImpl::save_checkpoint(const char* path, bool running) const {
+  if (ram_ == nullptr)
+    throw std::runtime_error("no memory attached");
+  std::ofstream ofs(path, std::ios::binary);
+  if (!ofs)
+    throw std::runtime_error(std::string("cannot create checkpoint file: ") + path);
+  CheckpointWriter ckpt(ofs);
+  checkpoint_config(arch_, &ckpt, nullptr);
+  ckpt.write(dcrs_);
+  ram_->save(ckpt);
+  l3cache_->save(ckpt);
+  for (auto cluster : clusters_) {
+    cluster->save(ckpt);
+  }
+  ckpt.write(running);
+  if (running) {
+    for (auto cluster : clusters_) {
+      cluster->save_state(ckpt);
+    }
+    for (auto core : cores_) {
+      core->save(ckpt);
+    }
+  }
+  ckpt.section("END");
+}
+
+void ProcessorImpl::restore_checkpoint(const char* path) {
+  if (ram_ == nullptr)
+    throw std::runtime_error("no memory attached");
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs)
+    throw std::runtime_error(std::string("cannot open checkpoint file: ") + path);
+  CheckpointReader ckpt(ifs);
+  checkpoint_config(arch_, nullptr, &ckpt);
+  dcrs_ = ckpt.read<DCRS>();
+  ram_->restore(ckpt);
+  l3cache_->restore(ckpt);
+  for (auto cluster : clusters_) {
+    cluster->restore(ckpt);
+  }
+  // the kernel state is applied once the next run has reset the device
+  resume_state_.clear();
+  if (ckpt.read<bool>()) {
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    resume_state_ = ss.str();
+  } else {
+    ckpt.section("END");
+  }
+}
+
+void ProcessorImpl::resume_state() {
+  std::istringstream is(resume_state_);
+  resume_state_.clear();
+  CheckpointReader ckpt(is);
+  for (auto cluster : clusters_) {
+    cluster->restore_state(ckpt);
+  }
+  for (auto core : cores_) {
+    core->restore(ckpt);
+  }
+  ckpt.section("END");
+}
+
+void ProcessorImpl::sample_step() {
+  auto instrs = this->instrs();
+  if (sampler_.detailed_step(instrs)) {
+    // let in-flight instructions complete before the functional window
+    for (auto core : cores_) {
+      core->set_draining(true);
+    }
+  }
+  if (sampler_.phase() != Sampler::Phase::Drain)
+    return;
+  for (auto core : cores_) {
+    if (!core->drained())
+      return;
+  }
+  for (auto core : cores_) {
+    core->set_draining(false);
+  }
+  sampler_.drained(instrs, SimPlatform::instance().cycles());
+}
+
+uint64_t ProcessorImpl::instrs() const {
+  uint64_t instrs = 0;
+  for (auto core : cores_) {
+    instrs += core->instrs();
+  }
+  return instrs;
+}
+
 void ProcessorImpl::reset() {
   perf_mem_reads_ = 0;
   perf_mem_writes_ = 0;
@@ -149,6 +386,43 @@ void ProcessorImpl::dcr_write(uint32_t addr, uint32_t value) {
   dcrs_.write(addr, value);
 }
 
+void ProcessorImpl::set_sim_threads(uint32_t num_threads) {
+  SimPlatform::instance().set_num_threads(num_threads);
+}
+
+void ProcessorImpl::set_fast_forward(bool enable) {
+  fast_forward_ = enable;
+}
+
+void ProcessorImpl::set_activity_tracking(bool enable) {
+  SimPlatform::instance().set_activity_tracking(enable);
+}
+
+int ProcessorImpl::set_sampling(const char* spec) {
+  Sampler::Config config;
+  if (Sampler::parse(spec, &config) != 0)
+    return -1;
+  sampler_.configure(config);
+  return 0;
+}
+
+int ProcessorImpl::set_pipe_trace(const char* path) {
+  uint32_t num_cores = 0;
+  for (auto core : cores_) {
+    num_cores = std::max(num_cores, core->id() + 1);
+  }
+  if (pipe_trace_.open(path, num_cores, 1) != 0)
+    return -1;
+  for (auto core : cores_) {
+    core->set_pipe_trace(&pipe_trace_);
+  }
+  return 0;
+}
+
+void ProcessorImpl::warm_l3cache(uint64_t addr, bool write) {
+  l3cache_->warm(addr, &write);
+}
+
 ProcessorImpl::PerfStats ProcessorImpl::perf_stats() const {
   ProcessorImpl::PerfStats perf;
   perf.mem_reads   = perf_mem_reads_;
@@ -159,6 +433,97 @@ ProcessorImpl::PerfStats ProcessorImpl::perf_stats() const {
   return perf;
 }
 
+PerfCounters ProcessorImpl::perf_counters() const {
+  PerfCounters counters;
+  auto add = [&](const std::string& name, uint64_t value) {
+    counters.emplace_back(name, value);
+  };
+  auto add_cache = [&](const std::string& name, const CacheSim::PerfStats& perf) {
+    add(name + ".reads", perf.reads);
+    add(name + ".writes", perf.writes);
+    add(name + ".read_misses", perf.read_misses);
+    add(name + ".write_misses", perf.write_misses);
+    add(name + ".evictions", perf.evictions);
+    add(name + ".bank_stalls", perf.bank_stalls);
+    add(name + ".mshr_stalls", perf.mshr_stalls);
+    add(name + ".mem_latency", perf.mem_latency);
+    add(name + ".pf_issued", perf.pf_issued);
+    add(name + ".pf_useful", perf.pf_useful);
+    add(name + ".pf_late", perf.pf_late);
+    add(name + ".pf_polluting", perf.pf_polluting);
+    add(name + ".mshr_merged", perf.mshr_merged);
+    add(name + ".mshr_full", perf.mshr_full);
+    for (uint32_t i = 0; i < CacheSim::PerfStats::MSHR_OCC_BINS; ++i) {
+      add(name + ".mshr_occ" + std::to_string(i), perf.mshr_occupancy[i]);
+    }
+  };
+
+  Core::PerfStats core;
+  LocalMem::PerfStats lmem;
+  MemCoalescer::PerfStats coalescer;
+  for (auto c : cores_) {
+    auto& perf = c->perf_stats();
+    core.cycles = std::max(core.cycles, perf.cycles);
+    core.instrs         += perf.instrs;
+    core.sched_idle     += perf.sched_idle;
+    core.sched_stalls   += perf.sched_stalls;
+    core.ibuf_stalls    += perf.ibuf_stalls;
+    core.scrb_stalls    += perf.scrb_stalls;
+    core.opds_stalls    += perf.opds_stalls;
+    core.ifetches       += perf.ifetches;
+    core.loads          += perf.loads;
+    core.stores         += perf.stores;
+    core.ifetch_latency += perf.ifetch_latency;
+    core.load_latency   += perf.load_latency;
+    core.decodes        += perf.decodes;
+    core.decode_hits    += perf.decode_hits;
+    lmem += c->local_mem()->perf_stats();
+    for (uint32_t i = 0; i < arch_.num_lsu_blocks(); ++i) {
+      coalescer += c->mem_coalescer(i)->perf_stats();
+    }
+  }
+  add("cycles", core.cycles);
+  add("instrs", core.instrs);
+  add("sched_idle", core.sched_idle);
+  add("sched_stalls", core.sched_stalls);
+  add("ibuf_stalls", core.ibuf_stalls);
+  add("scrb_stalls", core.scrb_stalls);
+  add("opds_stalls", core.opds_stalls);
+  add("ifetches", core.ifetches);
+  add("loads", core.loads);
+  add("stores", core.stores);
+  add("ifetch_latency", core.ifetch_latency);
+  add("load_latency", core.load_latency);
+  add("decodes", core.decodes);
+  add("decode_hits", core.decode_hits);
+  add("coalescer_misses", coalescer.misses);
+  add("lmem.reads", lmem.reads);
+  add("lmem.writes", lmem.writes);
+  add("lmem.bank_stalls", lmem.bank_stalls);
+
+  Socket::PerfStats socket;
+  Cluster::PerfStats cluster;
+  for (auto& c : clusters_) {
+    cluster.l2cache += c->perf_stats().l2cache;
+    for (auto& s : c->sockets()) {
+      auto perf = s->perf_stats();
+      socket.icache += perf.icache;
+      socket.dcache += perf.dcache;
+    }
+  }
+  add_cache("icache", socket.icache);
+  add_cache("dcache", socket.dcache);
+  add_cache("l2cache", cluster.l2cache);
+
+  auto perf = this->perf_stats();
+  add_cache("l3cache", perf.l3cache);
+  add("mem.reads", perf.mem_reads);
+  add("mem.writes", perf.mem_writes);
+  add("mem.latency", perf.mem_latency);
+  add("mem.bank_stalls", perf.memsim.bank_stalls);
+  return counters;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 Processor::Processor(const Arch& arch)
@@ -196,6 +561,54 @@ void Processor::dcr_write(uint32_t addr, uint32_t value) {
   return impl_->dcr_write(addr, value);
 }
 
+void Processor::set_sim_threads(uint32_t num_threads) {
+  impl_->set_sim_threads(num_threads);
+}
+
+void Processor::set_fast_forward(bool enable) {
+  impl_->set_fast_forward(enable);
+}
+
+void Processor::set_activity_tracking(bool enable) {
+  impl_->set_activity_tracking(enable);
+}
+
+int Processor::set_sampling(const char* spec) {
+  return impl_->set_sampling(spec);
+}
+
+PerfCounters Processor::perf_counters() const {
+  return impl_->perf_counters();
+}
+
+int Processor::save_checkpoint(const char* path) {
+  try {
+    impl_->save_checkpoint(path, false);
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: checkpoint: " << e.what() << std::endl;
+  }
+  return -1;
+}
+
+int Processor::restore_checkpoint(const char* path) {
+  try {
+    impl_->restore_checkpoint(path);
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: checkpoint: " << e.what() << std::endl;
+  }
+  return -1;
+}
+
+void Processor::set_trigger_checkpoint(const char* path) {
+  impl_->set_trigger_checkpoint(path);
+}
+
+int Processor::set_pipe_trace(const char* path) {
+  return impl_->set_pipe_trace(path);
+}
+
 #ifdef VM_ENABLE
 int16_t Processor::set_satp_by_addr(uint64_t base_addr) {
   uint16_t asid = 0;
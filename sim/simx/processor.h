@@ -14,6 +14,8 @@
 #pragma once
 
 #include <stdint.h>
+#include <string>
+#include <vector>
 #include <VX_config.h>
 #include <mem.h>
 
@@ -26,6 +28,9 @@ class ProcessorImpl;
 class SATP_t;
 #endif
 
+// named device-wide performance counters
+typedef std::vector<std::pair<std::string, uint64_t>> PerfCounters;
+
 class Processor {
 public:
   Processor(const Arch& arch);
@@ -36,6 +41,34 @@ public:
   int run();
 
   void dcr_write(uint32_t addr, uint32_t value);
+
+  // tick clusters on multiple host threads (0: single-threaded)
+  void set_sim_threads(uint32_t num_threads);
+
+  // skip the cycles during which the whole device is idle (default: on)
+  void set_fast_forward(bool enable);
+
+  void set_activity_tracking(bool enable);
+
+  // fast-forward functionally up to a trigger, then alternate with detailed
+  // windows, see Sampler::parse() for the spec format (returns 0 on success)
+  int set_sampling(const char* spec);
+
+  // save or restore the memory, cache and device configuration state;
+  // the device must be idle (returns 0 on success)
+  int save_checkpoint(const char* path);
+  int restore_checkpoint(const char* path);
+
+  // save a checkpoint of the running kernel when the sampling trigger fires,
+  // restoring it resumes the kernel in detailed mode from that point
+  void set_trigger_checkpoint(const char* path);
+
+  // record a binary pipeline trace, see pipe_trace.h (returns 0 on success)
+  int set_pipe_trace(const char* path);
+
+  // performance counters of the last run, summed over cores and caches
+  // (cycles is the maximum over cores)
+  PerfCounters perf_counters() const;
 #ifdef VM_ENABLE
   bool is_satp_unset();
   uint8_t get_satp_mode();
@@ -13,11 +13,15 @@
 
 #pragma once
 
+#include "processor.h"
 #include "mem_sim.h"
 #include "cache_sim.h"
 #include "constants.h"
 #include "dcrs.h"
 #include "cluster.h"
+#include "mem_overlay.h"
+#include "sampler.h"
+#include <string>
 
 namespace vortex {
 
@@ -40,18 +44,56 @@ public:
 
   void dcr_write(uint32_t addr, uint32_t value);
 
+  void set_sim_threads(uint32_t num_threads);
+
+  void set_fast_forward(bool enable);
+
+  void set_activity_tracking(bool enable);
+
+  int set_sampling(const char* spec);
+
+  void save_checkpoint(const char* path, bool running) const;
+
+  void restore_checkpoint(const char* path);
+
+  void set_trigger_checkpoint(const char* path) {
+    trigger_checkpoint_ = path;
+  }
+
+  int set_pipe_trace(const char* path);
+
+  // CSR write executed by the emulator
+  void csr_event(uint32_t addr, uint64_t value) {
+    sampler_.csr_event(addr, value);
+  }
+
+  void warm_l3cache(uint64_t addr, bool write);
+
 #ifdef VM_ENABLE
   void set_satp(uint64_t satp);
 #endif
 
   PerfStats perf_stats() const;
 
+  PerfCounters perf_counters() const;
+
 private:
 
   void reset();
 
+  void run_functional(bool threaded);
+
+  void resume_state();
+
+  void sample_step();
+
+  uint64_t instrs() const;
+
   const Arch& arch_;
   std::vector<std::shared_ptr<Cluster>> clusters_;
+  std::vector<Core*> cores_;
+  std::vector<std::unique_ptr<MemOverlay>> mem_overlays_;
+  RAM* ram_;
   DCRS dcrs_;
   MemSim::Ptr memsim_;
   CacheSim::Ptr l3cache_;
@@ -59,6 +101,11 @@ private:
   uint64_t perf_mem_writes_;
   uint64_t perf_mem_latency_;
   uint64_t perf_mem_pending_reads_;
+  bool fast_forward_;
+  Sampler sampler_;
+  std::string trigger_checkpoint_;
+  std::string resume_state_;
+  PipeTraceWriter pipe_trace_;
 };
 
 }
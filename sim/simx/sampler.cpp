@@ -0,0 +1,212 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "sampler.h"
+#include <VX_types.h>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+
+using namespace vortex;
+
+static constexpr uint64_t ANY_MARKER = std::numeric_limits<uint64_t>::max();
+
+static bool parse_number(const std::string& str, uint64_t* value) {
+  if (str.empty())
+    return false;
+  char* end;
+  *value = strtoull(str.c_str(), &end, 0);
+  return (*end == '\0');
+}
+
+Sampler::Sampler()
+  : enabled_(false)
+  , phase_(Phase::Detailed)
+  , triggered_(true)
+  , window_end_(0)
+  , window_instrs_(0)
+  , window_cycles_(0)
+  , functional_instrs_(0)
+{}
+
+int Sampler::parse(const char* spec, Config* config) {
+  Config cfg;
+  std::stringstream ss(spec);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    auto pos = item.find('=');
+    auto key = item.substr(0, pos);
+    auto value = (pos != std::string::npos) ? item.substr(pos + 1) : std::string();
+    if (key == "pc") {
+      cfg.trigger = Trigger::PC;
+      if (!parse_number(value, &cfg.trigger_value))
+        return -1;
+    } else if (key == "instrs") {
+      cfg.trigger = Trigger::Instrs;
+      if (!parse_number(value, &cfg.trigger_value))
+        return -1;
+    } else if (key == "csr") {
+      cfg.trigger = Trigger::CSR;
+      if (!parse_number(value, &cfg.trigger_value))
+        return -1;
+    } else if (key == "marker") {
+      cfg.trigger = Trigger::Marker;
+      cfg.trigger_value = ANY_MARKER;
+      if (pos != std::string::npos && !parse_number(value, &cfg.trigger_value))
+        return -1;
+    } else if (key == "window") {
+      auto sep = value.find(':');
+      if (sep == std::string::npos
+       || !parse_number(value.substr(0, sep), &cfg.functional_window)
+       || !parse_number(value.substr(sep + 1), &cfg.detailed_window)
+       || cfg.functional_window == 0
+       || cfg.detailed_window == 0)
+        return -1;
+    } else {
+      return -1;
+    }
+  }
+  if (cfg.trigger == Trigger::None && cfg.detailed_window == 0)
+    return -1;
+  *config = cfg;
+  return 0;
+}
+
+void Sampler::configure(const Config& config) {
+  config_ = config;
+  enabled_ = true;
+}
+
+void Sampler::reset(uint64_t instrs, uint64_t cycles) {
+  phase_ = enabled_ ? Phase::Functional : Phase::Detailed;
+  triggered_ = (config_.trigger == Trigger::None);
+  window_end_ = instrs + config_.functional_window;
+  window_instrs_ = instrs;
+  window_cycles_ = cycles;
+  functional_instrs_ = 0;
+  samples_.clear();
+}
+
+void Sampler::pc_event(uint64_t PC) {
+  if (!triggered_
+   && config_.trigger == Trigger::PC
+   && config_.trigger_value == PC) {
+    triggered_ = true;
+  }
+}
+
+void Sampler::csr_event(uint32_t addr, uint64_t value) {
+  if (triggered_)
+    return;
+  if (config_.trigger == Trigger::CSR) {
+    triggered_ = (config_.trigger_value == addr);
+  } else if (config_.trigger == Trigger::Marker) {
+    triggered_ = (addr == VX_CSR_SIM_MARKER)
+              && (config_.trigger_value == ANY_MARKER || config_.trigger_value == value);
+  }
+}
+
+void Sampler::resume(uint64_t instrs, uint64_t cycles) {
+  if (!enabled_)
+    return;
+  triggered_ = true;
+  this->start_detailed(instrs, cycles);
+}
+
+bool Sampler::functional_step(uint64_t instrs, uint64_t cycles) {
+  if (!triggered_) {
+    if (config_.trigger == Trigger::Instrs && instrs >= config_.trigger_value) {
+      triggered_ = true;
+    }
+    if (!triggered_)
+      return false;
+  } else if (instrs < window_end_) {
+    return false;
+  }
+  this->start_detailed(instrs, cycles);
+  return true;
+}
+
+bool Sampler::detailed_step(uint64_t instrs) {
+  if (phase_ != Phase::Detailed
+   || config_.detailed_window == 0
+   || instrs < window_end_)
+    return false;
+  phase_ = Phase::Drain;
+  return true;
+}
+
+void Sampler::drained(uint64_t instrs, uint64_t cycles) {
+  samples_.push_back({instrs - window_instrs_, cycles - window_cycles_});
+  phase_ = Phase::Functional;
+  window_end_ = instrs + config_.functional_window;
+  window_instrs_ = instrs;
+}
+
+void Sampler::finish(uint64_t instrs, uint64_t cycles) {
+  if (phase_ == Phase::Functional) {
+    functional_instrs_ += instrs - window_instrs_;
+  } else if (instrs != window_instrs_) {
+    samples_.push_back({instrs - window_instrs_, cycles - window_cycles_});
+  }
+  window_instrs_ = instrs;
+  window_cycles_ = cycles;
+}
+
+void Sampler::start_detailed(uint64_t instrs, uint64_t cycles) {
+  functional_instrs_ += instrs - window_instrs_;
+  phase_ = Phase::Detailed;
+  window_instrs_ = instrs;
+  window_cycles_ = cycles;
+  window_end_ = instrs + config_.detailed_window;
+}
+
+void Sampler::dump(std::ostream& os) const {
+  uint64_t instrs = 0;
+  uint64_t cycles = 0;
+  for (auto& sample : samples_) {
+    instrs += sample.instrs;
+    cycles += sample.cycles;
+  }
+  os << "SAMPLING: functional instrs=" << functional_instrs_
+     << ", detailed instrs=" << instrs
+     << ", detailed cycles=" << cycles
+     << ", windows=" << samples_.size() << std::endl;
+  if (instrs == 0)
+    return;
+
+  // ratio estimate of the CPI over the detailed windows
+  double cpi = double(cycles) / instrs;
+  double estimate = cycles + functional_instrs_ * cpi;
+  os << std::fixed << std::setprecision(3);
+  os << "SAMPLING: CPI=" << cpi << ", estimated cycles=" << uint64_t(estimate + 0.5);
+
+  // 95% confidence interval from the variance of the ratio estimator
+  uint32_t n = samples_.size();
+  if (n >= 2) {
+    double mean_instrs = double(instrs) / n;
+    double sum_sq = 0;
+    for (auto& sample : samples_) {
+      double residual = sample.cycles - cpi * sample.instrs;
+      sum_sq += residual * residual;
+    }
+    double std_err = std::sqrt(sum_sq / (n - 1) / n) / mean_instrs;
+    double half_width = 1.96 * std_err * functional_instrs_;
+    os << " (+/-" << uint64_t(half_width + 0.5)
+       << ", " << (100.0 * half_width / estimate) << "%)";
+  }
+  os << std::endl;
+}
@@ -0,0 +1,123 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <ostream>
+
+namespace vortex {
+
+// Sampled simulation controller.
+// The program is first executed functionally, with only the cache tags kept
+// warm, until the trigger fires; the processor then switches to the detailed
+// timing model. With periodic windows, execution keeps alternating between
+// functional and detailed windows (SMARTS-style) and the total cycle count is
+// extrapolated from the CPI measured over the detailed windows.
+// Instruction counts are committed thread instructions, as reported by MINSTRET.
+class Sampler {
+public:
+  enum class Trigger {
+    None,
+    PC,       // an instruction at the given PC executes
+    Instrs,   // the given instruction count is reached
+    CSR,      // the given CSR is written
+    Marker    // vx_sim_marker() is called with the given id (any if unset)
+  };
+
+  enum class Phase {
+    Functional,
+    Detailed,
+    Drain     // waiting for in-flight instructions before a functional window
+  };
+
+  struct Config {
+    Trigger  trigger;
+    uint64_t trigger_value;
+    uint64_t functional_window;
+    uint64_t detailed_window;
+
+    Config()
+      : trigger(Trigger::None)
+      , trigger_value(0)
+      , functional_window(0)
+      , detailed_window(0)
+    {}
+  };
+
+  Sampler();
+
+  // parse a comma-separated spec:
+  //   pc=<addr> | instrs=<count> | csr=<addr> | marker[=<id>], window=<functional>:<detailed>
+  // returns 0 on success
+  static int parse(const char* spec, Config* config);
+
+  void configure(const Config& config);
+
+  bool enabled() const {
+    return enabled_;
+  }
+
+  Phase phase() const {
+    return phase_;
+  }
+
+  bool triggered() const {
+    return triggered_;
+  }
+
+  void reset(uint64_t instrs, uint64_t cycles);
+
+  // functional execution events
+  void pc_event(uint64_t PC);
+  void csr_event(uint32_t addr, uint64_t value);
+
+  // resume from a checkpoint taken at the trigger, skipping the fast-forward
+  void resume(uint64_t instrs, uint64_t cycles);
+
+  // advance the functional phase, returns true when switching to detailed
+  bool functional_step(uint64_t instrs, uint64_t cycles);
+
+  // advance the detailed phase, returns true when the pipelines should drain
+  bool detailed_step(uint64_t instrs);
+
+  // the pipelines are drained, start the next functional window
+  void drained(uint64_t instrs, uint64_t cycles);
+
+  // close the current window at the end of the program
+  void finish(uint64_t instrs, uint64_t cycles);
+
+  void dump(std::ostream& os) const;
+
+private:
+
+  struct sample_t {
+    uint64_t instrs;
+    uint64_t cycles;
+  };
+
+  void start_detailed(uint64_t instrs, uint64_t cycles);
+
+  Config   config_;
+  bool     enabled_;
+  Phase    phase_;
+  bool     triggered_;
+  uint64_t window_end_;
+  uint64_t window_instrs_;
+  uint64_t window_cycles_;
+  uint64_t functional_instrs_;
+  std::vector<sample_t> samples_;
+};
+
+}
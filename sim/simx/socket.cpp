@@ -22,8 +22,8 @@ Socket::Socket(const SimContext& ctx,
                 const Arch &arch,
                 const DCRS &dcrs)
   : SimObject(ctx, StrFormat("socket%d", socket_id))
-  , mem_req_ports(L1_MEM_PORTS, this)
-  , mem_rsp_ports(L1_MEM_PORTS, this)
+  , mem_req_ports(arch.dcache().mem_ports, this)
+  , mem_rsp_ports(arch.dcache().mem_ports, this)
   , socket_id_(socket_id)
   , cluster_(cluster)
   , cores_(arch.socket_size())
@@ -32,44 +32,50 @@ Socket::Socket(const SimContext& ctx,
 
   char sname[100];
   snprintf(sname, 100, "%s-icaches", this->name().c_str());
-  icaches_ = CacheCluster::Create(sname, cores_per_socket, NUM_ICACHES, CacheSim::Config{
-    !ICACHE_ENABLED,
-    log2ceil(ICACHE_SIZE),  // C
+  auto& icache = arch.icache();
+  icaches_ = CacheCluster::Create(sname, cores_per_socket, icache.num_caches, CacheSim::Config{
+    !icache.enabled,
+    log2ceil(icache.size),  // C
     log2ceil(L1_LINE_SIZE), // L
     log2ceil(sizeof(uint32_t)), // W
-    log2ceil(ICACHE_NUM_WAYS),// A
+    log2ceil(icache.num_ways),// A
     log2ceil(1),            // B
     XLEN,                   // address bits
     1,                      // number of inputs
-    ICACHE_MEM_PORTS,       // memory ports
+    icache.mem_ports,       // memory ports
     false,                  // write-back
     false,                  // write response
-    ICACHE_MSHR_SIZE,       // mshr size
+    icache.mshr_size,       // mshr size
     2,                      // pipeline latency
+    icache.repl_policy,     // replacement policy
+    icache.prefetch,        // prefetchers
   });
 
   snprintf(sname, 100, "%s-dcaches", this->name().c_str());
-  dcaches_ = CacheCluster::Create(sname, cores_per_socket, NUM_DCACHES, CacheSim::Config{
-    !DCACHE_ENABLED,
-    log2ceil(DCACHE_SIZE),  // C
+  auto& dcache = arch.dcache();
+  dcaches_ = CacheCluster::Create(sname, cores_per_socket, dcache.num_caches, CacheSim::Config{
+    !dcache.enabled,
+    log2ceil(dcache.size),  // C
     log2ceil(L1_LINE_SIZE), // L
     log2ceil(DCACHE_WORD_SIZE), // W
-    log2ceil(DCACHE_NUM_WAYS),// A
-    log2ceil(DCACHE_NUM_BANKS), // B
+    log2ceil(dcache.num_ways),// A
+    log2ceil(dcache.num_banks), // B
     XLEN,                   // address bits
-    DCACHE_NUM_REQS,        // number of inputs
-    L1_MEM_PORTS,           // memory ports
-    DCACHE_WRITEBACK,       // write-back
+    arch.dcache_num_reqs(), // number of inputs
+    dcache.mem_ports,       // memory ports
+    dcache.writeback,       // write-back
     false,                  // write response
-    DCACHE_MSHR_SIZE,       // mshr size
+    dcache.mshr_size,       // mshr size
     2,                      // pipeline latency
+    dcache.repl_policy,     // replacement policy
+    dcache.prefetch,        // prefetchers
   });
 
   // find overlap
-  uint32_t overlap = MIN(ICACHE_MEM_PORTS, L1_MEM_PORTS);
+  uint32_t overlap = MIN(icache.mem_ports, dcache.mem_ports);
 
   // connect l1 caches to outgoing memory interfaces
-  for (uint32_t i = 0; i < L1_MEM_PORTS; ++i) {
+  for (uint32_t i = 0; i < dcache.mem_ports; ++i) {
     snprintf(sname, 100, "%s-l1_arb%d", this->name().c_str(), i);
     auto l1_arb = MemArbiter::Create(sname, ArbiterType::RoundRobin, 2 * overlap, overlap);
 
@@ -83,7 +89,7 @@ Socket::Socket(const SimContext& ctx,
       l1_arb->ReqOut.at(i).bind(&this->mem_req_ports.at(i));
       this->mem_rsp_ports.at(i).bind(&l1_arb->RspOut.at(i));
     } else {
-      if (L1_MEM_PORTS > ICACHE_MEM_PORTS) {
+      if (dcache.mem_ports > icache.mem_ports) {
         // if more dcache ports
         dcaches_->MemReqPorts.at(i).bind(&this->mem_req_ports.at(i));
         this->mem_rsp_ports.at(i).bind(&dcaches_->MemRspPorts.at(i));
@@ -106,7 +112,7 @@ Socket::Socket(const SimContext& ctx,
     cores_.at(i)->icache_req_ports.at(0).bind(&icaches_->CoreReqPorts.at(i).at(0));
     icaches_->CoreRspPorts.at(i).at(0).bind(&cores_.at(i)->icache_rsp_ports.at(0));
 
-    for (uint32_t j = 0; j < DCACHE_NUM_REQS; ++j) {
+    for (uint32_t j = 0, n = arch.dcache_num_reqs(); j < n; ++j) {
       cores_.at(i)->dcache_req_ports.at(j).bind(&dcaches_->CoreReqPorts.at(i).at(j));
       dcaches_->CoreRspPorts.at(i).at(j).bind(&cores_.at(i)->dcache_rsp_ports.at(j));
     }
@@ -125,7 +131,11 @@ void Socket::tick() {
   //--
 }
 
-void Socket::attach_ram(RAM* ram) {
+bool Socket::idle() const {
+  return true;
+}
+
+void Socket::attach_ram(MemDevice* ram) {
   for (auto core : cores_) {
     core->attach_ram(ram);
   }
@@ -163,6 +173,29 @@ void Socket::resume(uint32_t core_index) {
   cores_.at(core_index)->resume(-1);
 }
 
+void Socket::warm_icache(uint32_t core_index, uint64_t addr) {
+  bool write = false;
+  if (icaches_->warm(core_index, addr, &write)) {
+    cluster_->warm_l2cache(addr, write);
+  }
+}
+
+void Socket::warm_dcache(uint32_t core_index, uint64_t addr, bool write) {
+  if (dcaches_->warm(core_index, addr, &write)) {
+    cluster_->warm_l2cache(addr, write);
+  }
+}
+
+void Socket::save(CheckpointWriter& ckpt) const {
+  icaches_->save(ckpt);
+  dcaches_->save(ckpt);
+}
+
+void Socket::restore(CheckpointReader& ckpt) {
+  icaches_->restore(ckpt);
+  dcaches_->restore(ckpt);
+}
+
 Socket::PerfStats Socket::perf_stats() const {
   PerfStats perf_stats;
   perf_stats.icache = icaches_->perf_stats();
@@ -55,7 +55,9 @@ public:
 
   void tick();
 
-  void attach_ram(RAM* ram);
+  bool idle() const;
+
+  void attach_ram(MemDevice* ram);
 
 #ifdef VM_ENABLE
   void set_satp(uint64_t satp);
@@ -69,6 +71,18 @@ public:
 
   void resume(uint32_t core_id);
 
+  const std::vector<Core::Ptr>& cores() const {
+    return cores_;
+  }
+
+  // cache warm-up during functional simulation
+  void warm_icache(uint32_t core_index, uint64_t addr);
+  void warm_dcache(uint32_t core_index, uint64_t addr, bool write);
+
+  // save or restore the cache state
+  void save(CheckpointWriter& ckpt) const;
+  void restore(CheckpointReader& ckpt);
+
   PerfStats perf_stats() const;
 
 private:
@@ -216,7 +216,7 @@ public:
   }
 
   void tick() {
-    for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+    for (uint32_t iw = 0; iw < arch_.issue_width(); ++iw) {
       auto& input = simobject_->Inputs.at(iw);
       if (input.empty())
         continue;
@@ -305,8 +305,8 @@ op_string_t vortex::op_string(TcuType tcu_type, IntrTcuArgs args) {
 
 TensorUnit::TensorUnit(const SimContext &ctx, const char* name, const Arch& arch, Core* core)
 	: SimObject<TensorUnit>(ctx, name)
-	, Inputs(ISSUE_WIDTH, this)
-	, Outputs(ISSUE_WIDTH, this)
+	, Inputs(arch.issue_width(), this)
+	, Outputs(arch.issue_width(), this)
 	, impl_(new Impl(this, arch, core))
 {}
 
@@ -322,6 +322,14 @@ void TensorUnit::tick() {
   impl_->tick();
 }
 
+bool TensorUnit::idle() const {
+  for (auto& input : Inputs) {
+    if (!input.empty())
+      return false;
+  }
+  return true;
+}
+
 const TensorUnit::PerfStats &TensorUnit::perf_stats() const {
 	return impl_->perf_stats();
 }
@@ -52,6 +52,8 @@ public:
 
   virtual void tick();
 
+  bool idle() const;
+
 	void wmma(uint32_t wid,
 			 	    uint32_t fmt_s,
 						uint32_t fmt_d,
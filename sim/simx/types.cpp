@@ -55,6 +55,7 @@ void LocalMemSwitch::tick() {
     out_dc_req.tag   = in_req.tag;
     out_dc_req.cid   = in_req.cid;
     out_dc_req.uuid  = in_req.uuid;
+    out_dc_req.pc    = in_req.pc;
 
     LsuReq out_lmem_req(out_dc_req);
 
@@ -84,6 +85,10 @@ void LocalMemSwitch::tick() {
   }
 }
 
+bool LocalMemSwitch::idle() const {
+  return RspLmem.empty() && RspDC.empty() && ReqIn.empty();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 LsuMemAdapter::LsuMemAdapter(
@@ -151,6 +156,7 @@ void LsuMemAdapter::tick() {
         out_req.tag   = in_req.tag;
         out_req.cid   = in_req.cid;
         out_req.uuid  = in_req.uuid;
+        out_req.pc    = in_req.pc;
         // send memory request
         ReqOut.at(i).push(out_req, delay_);
         DT(4, this->name() << "-req" << i << ": " << out_req);
@@ -158,4 +164,12 @@ void LsuMemAdapter::tick() {
     }
     ReqIn.pop();
   }
+}
+
+bool LsuMemAdapter::idle() const {
+  for (auto& rsp_out : RspOut) {
+    if (!rsp_out.empty())
+      return false;
+  }
+  return ReqIn.empty();
 }
\ No newline at end of file
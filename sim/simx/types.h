@@ -740,6 +740,56 @@ struct mem_addr_size_t {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// cache replacement policies, the first three match the RTL encoding (CS_REPL_*)
+enum class ReplPolicy {
+  Random,
+  FIFO,
+  PLRU,
+  LRU,
+  SRRIP,
+  BRRIP
+};
+
+inline std::ostream &operator<<(std::ostream &os, const ReplPolicy& policy) {
+  switch (policy) {
+  case ReplPolicy::Random: os << "random"; break;
+  case ReplPolicy::FIFO:   os << "fifo"; break;
+  case ReplPolicy::PLRU:   os << "plru"; break;
+  case ReplPolicy::LRU:    os << "lru"; break;
+  case ReplPolicy::SRRIP:  os << "srrip"; break;
+  case ReplPolicy::BRRIP:  os << "brrip"; break;
+  default: assert(false);
+  }
+  return os;
+}
+
+// cache prefetchers, each engine has its own prefetch queue
+struct PrefetchConfig {
+  bool     next_line;      // next-line prefetcher
+  bool     stride;         // PC-indexed stride prefetcher
+  bool     stream;         // stream prefetcher
+  uint32_t degree;         // lines prefetched per trigger
+  uint32_t queue_size;     // prefetch queue size
+  uint32_t mshr_limit;     // MSHR occupancy (%) above which prefetches are held
+  bool     protect_demand; // prefetches may not evict demand-fetched lines
+
+  PrefetchConfig()
+    : next_line(false)
+    , stride(false)
+    , stream(false)
+    , degree(2)
+    , queue_size(8)
+    , mshr_limit(50)
+    , protect_demand(false)
+  {}
+
+  bool enabled() const {
+    return next_line || stride || stream;
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 enum class ArbiterType {
   Priority,
   RoundRobin,
@@ -909,6 +959,7 @@ struct LsuReq {
   uint32_t tag;
   uint32_t cid;
   uint64_t uuid;
+  uint64_t pc;
 
   LsuReq(uint32_t size)
     : mask(size)
@@ -917,6 +968,7 @@ struct LsuReq {
     , tag(0)
     , cid(0)
     , uuid(0)
+    , pc(0)
   {}
 
   friend std::ostream &operator<<(std::ostream &os, const LsuReq& req) {
@@ -968,19 +1020,22 @@ struct MemReq {
   uint32_t tag;
   uint32_t cid;
   uint64_t uuid;
+  uint64_t pc;  // issuing instruction, for the cache prefetchers
 
   MemReq(uint64_t _addr = 0,
           bool _write = false,
           AddrType _type = AddrType::Global,
           uint64_t _tag = 0,
           uint32_t _cid = 0,
-          uint64_t _uuid = 0
+          uint64_t _uuid = 0,
+          uint64_t _pc = 0
   ) : addr(_addr)
     , write(_write)
     , type(_type)
     , tag(_tag)
     , cid(_cid)
     , uuid(_uuid)
+    , pc(_pc)
   {}
 
   friend std::ostream &operator<<(std::ostream &os, const MemReq& req) {
@@ -1107,6 +1162,10 @@ public:
     //--
   }
 
+  bool idle() const {
+    return true;
+  }
+
   bool empty() const {
     return bus_.empty();
   }
@@ -1147,6 +1206,11 @@ public:
     bus_.pop();
   }
 
+  // object woken up when entries are delivered
+  void set_reader(SimObjectBase* reader) {
+    bus_.set_reader(reader);
+  }
+
 private:
   SimPort<Type> bus_;
   uint32_t delay_;
@@ -1238,6 +1302,16 @@ public:
     }
   }
 
+  bool idle() const {
+    if (Inputs.size() == Outputs.size())
+      return true;
+    for (auto& input : Inputs) {
+      if (!input.empty())
+        return false;
+    }
+    return true;
+  }
+
 protected:
 
   uint32_t delay_;
@@ -1341,6 +1415,16 @@ public:
     }
   }
 
+  bool idle() const {
+    if (Inputs.size() == 1 && Outputs.size() == 1)
+      return true;
+    for (auto& input : Inputs) {
+      if (!input.empty())
+        return false;
+    }
+    return true;
+  }
+
   uint64_t collisions() const {
     return collisions_;
   }
@@ -1443,6 +1527,16 @@ public:
     }
   }
 
+  bool idle() const {
+    if (!arbiter_)
+      return true;
+    for (auto& rsp_out : RspOut) {
+      if (!rsp_out.empty())
+        return false;
+    }
+    return true;
+  }
+
 protected:
   typedef TxArbiter<Req> ReqArb;
 
@@ -1552,6 +1646,16 @@ public:
     }
   }
 
+  bool idle() const {
+    if (!crossbar_)
+      return true;
+    for (auto& rsp_out : RspOut) {
+      if (!rsp_out.empty())
+        return false;
+    }
+    return true;
+  }
+
   uint64_t collisions() const {
     if (crossbar_) {
       return crossbar_->collisions();
@@ -1591,6 +1695,8 @@ public:
 
   void tick();
 
+  bool idle() const;
+
 private:
   uint32_t delay_;
 };
@@ -1616,6 +1722,8 @@ public:
 
   void tick();
 
+  bool idle() const;
+
 private:
   uint32_t delay_;
 };
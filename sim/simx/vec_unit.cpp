@@ -45,7 +45,7 @@ public:
   }
 
   void tick() {
-    for (uint32_t iw = 0; iw < ISSUE_WIDTH; ++iw) {
+    for (uint32_t iw = 0; iw < simobject_->Inputs.size(); ++iw) {
       auto &input = simobject_->Inputs.at(iw);
       if (input.empty())
         continue;
@@ -1799,7 +1799,7 @@ VecUnit::VecUnit(const SimContext &ctx,
                  const char *name,
                  const Arch &arch,
                  Core *core)
-    : SimObject<VecUnit>(ctx, name), Inputs(ISSUE_WIDTH, this), Outputs(ISSUE_WIDTH, this), impl_(new Impl(this, arch, core)) {}
+    : SimObject<VecUnit>(ctx, name), Inputs(arch.issue_width(), this), Outputs(arch.issue_width(), this), impl_(new Impl(this, arch, core)) {}
 
 VecUnit::~VecUnit() {
   delete impl_;
@@ -1813,6 +1813,14 @@ void VecUnit::tick() {
   impl_->tick();
 }
 
+bool VecUnit::idle() const {
+  for (auto& input : Inputs) {
+    if (!input.empty())
+      return false;
+  }
+  return true;
+}
+
 std::string VecUnit::dumpRegister(uint32_t wid, uint32_t tid, uint32_t reg_idx) const {
   return impl_->dumpRegister(wid, tid, reg_idx);
 }
@@ -80,6 +80,10 @@ void VOpcUnit::tick() {
   Input.pop();
 }
 
+bool VOpcUnit::idle() const {
+  return Input.empty();
+}
+
 void VOpcUnit::translate(instr_trace_t* trace) {
   auto trace_data = std::dynamic_pointer_cast<VecUnit::ExeTraceData>(trace->data);
   auto vpu_op = trace_data->vpu_op;
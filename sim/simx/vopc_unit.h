@@ -32,6 +32,8 @@ public:
 
   virtual void tick();
 
+  bool idle() const;
+
   void writeback(instr_trace_t* trace);
 
   uint32_t total_stalls() const {
@@ -33,6 +33,8 @@ public:
 
   virtual void tick();
 
+  bool idle() const;
+
   void writeback(instr_trace_t* trace);
 
   uint32_t total_stalls() const;
@@ -40,6 +42,8 @@ public:
 private:
   std::vector<VOpcUnit::Ptr> opc_units_;
   TraceArbiter::Ptr rsp_arb_;
+  uint32_t issue_width_;
+  uint32_t num_opcs_;
 };
 
 } // namespace vortex
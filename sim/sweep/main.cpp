@@ -0,0 +1,549 @@
+// Copyright © 2019-2023
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <nlohmann_json.hpp>
+#include <processor.h>
+#include <arch.h>
+#include <mem.h>
+#include <util.h>
+#include <VX_types.h>
+
+using namespace vortex;
+
+// Design-space sweep.
+// The program is loaded once into the parent's RAM; each point of the
+// parameter grid then runs in a forked worker, which shares the loaded
+// image copy-on-write and sends its performance counters back over a pipe.
+
+typedef std::vector<std::pair<std::string, std::string>> params_t;
+
+struct result_t {
+  enum Status { Pending, Ok, Invalid, Failed };
+  Status status;
+  int exitcode;
+  double sim_time;
+  PerfCounters counters;
+};
+
+static const char* arch_file = nullptr;
+static const char* grid_file = nullptr;
+static std::vector<std::string> grid_params;
+static uint32_t num_jobs = 0;
+static const char* output_file = nullptr;
+static bool verbose = false;
+static const char* program = nullptr;
+
+static void show_usage() {
+  std::cout << "Usage: [-G <grid.json>] [-P <param>=<value>[,<value>...]] [-A <base-arch.json>] [-j <jobs>] [-o <results.csv|results.json>] [-v: show simulator output] [-h: help] <program>" << std::endl;
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "G:P:A:j:o:vh")) != -1) {
+    switch (c) {
+    case 'G':
+      grid_file = optarg;
+      break;
+    case 'P':
+      grid_params.push_back(optarg);
+      break;
+    case 'A':
+      arch_file = optarg;
+      break;
+    case 'j':
+      num_jobs = atoi(optarg);
+      break;
+    case 'o':
+      output_file = optarg;
+      break;
+    case 'v':
+      verbose = true;
+      break;
+    case 'h':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+  if (optind < argc) {
+    program = argv[optind];
+  } else {
+    show_usage();
+    exit(-1);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+typedef std::vector<std::pair<std::string, std::vector<std::string>>> grid_t;
+
+static void add_axis(grid_t* grid, const std::string& key, const std::vector<std::string>& values) {
+  for (auto& axis : *grid) {
+    if (axis.first == key) {
+      axis.second = values;
+      return;
+    }
+  }
+  grid->emplace_back(key, values);
+}
+
+static bool json_value(const nlohmann::json& value, std::string* str) {
+  if (value.is_boolean()) {
+    *str = value.get<bool>() ? "true" : "false";
+  } else if (value.is_number_unsigned()) {
+    *str = std::to_string(value.get<uint64_t>());
+  } else if (value.is_number_float()) {
+    *str = std::to_string(value.get<double>());
+  } else if (value.is_string()) {
+    *str = value.get<std::string>();
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// nested objects map to dotted keys, arrays list the values of an axis
+static int load_grid(grid_t* grid, const std::string& prefix, const nlohmann::json& obj) {
+  for (auto& item : obj.items()) {
+    auto key = prefix + item.key();
+    auto& value = item.value();
+    if (value.is_object()) {
+      if (load_grid(grid, key + ".", value) != 0)
+        return -1;
+      continue;
+    }
+    std::vector<std::string> values;
+    std::string str;
+    if (value.is_array()) {
+      for (auto& elem : value) {
+        if (!json_value(elem, &str))
+          break;
+        values.push_back(str);
+      }
+      if (values.empty() || values.size() != value.size()) {
+        std::cerr << "Error: invalid sweep values: " << key << "=" << value << std::endl;
+        return -1;
+      }
+    } else {
+      if (!json_value(value, &str)) {
+        std::cerr << "Error: invalid sweep value: " << key << "=" << value << std::endl;
+        return -1;
+      }
+      values.push_back(str);
+    }
+    add_axis(grid, key, values);
+  }
+  return 0;
+}
+
+static int build_grid(grid_t* grid) {
+  if (grid_file) {
+    std::ifstream ifs(grid_file);
+    if (!ifs) {
+      std::cerr << "Error: failed to open " << grid_file << std::endl;
+      return -1;
+    }
+    auto json = nlohmann::json::parse(ifs, nullptr, false);
+    if (json.is_discarded() || !json.is_object()) {
+      std::cerr << "Error: invalid sweep grid " << grid_file << std::endl;
+      return -1;
+    }
+    if (load_grid(grid, "", json) != 0)
+      return -1;
+  }
+  for (auto& param : grid_params) {
+    auto pos = param.find('=');
+    if (pos == std::string::npos || pos == 0 || pos + 1 == param.size()) {
+      std::cerr << "Error: invalid sweep parameter: " << param << std::endl;
+      return -1;
+    }
+    std::vector<std::string> values;
+    std::stringstream ss(param.substr(pos + 1));
+    std::string value;
+    while (std::getline(ss, value, ',')) {
+      values.push_back(value);
+    }
+    add_axis(grid, param.substr(0, pos), values);
+  }
+  return 0;
+}
+
+// cartesian product of the grid axes, the last axis varies fastest
+static std::vector<params_t> expand_grid(const grid_t& grid) {
+  std::vector<params_t> points(1);
+  for (auto& axis : grid) {
+    std::vector<params_t> next;
+    for (auto& point : points) {
+      for (auto& value : axis.second) {
+        next.push_back(point);
+        next.back().emplace_back(axis.first, value);
+      }
+    }
+    points = std::move(next);
+  }
+  return points;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// worker exit codes
+static constexpr int WORKER_OK      = 0;
+static constexpr int WORKER_INVALID = 2;
+
+static int run_worker(RAM& ram, const params_t& params, int fd) {
+  Arch arch(NUM_THREADS, NUM_WARPS, NUM_CORES);
+  if (arch_file && arch.load(arch_file) != 0)
+    return WORKER_INVALID;
+  for (auto& param : params) {
+    if (arch.set(param.first, param.second) != 0) {
+      std::cerr << "Error: invalid architecture parameter: " << param.first << "=" << param.second << std::endl;
+      return WORKER_INVALID;
+    }
+  }
+  if (arch.validate() != 0)
+    return WORKER_INVALID;
+
+  Processor processor(arch);
+  processor.attach_ram(&ram);
+
+  const uint64_t startup_addr(STARTUP_ADDR);
+  processor.dcr_write(VX_DCR_BASE_STARTUP_ADDR0, startup_addr & 0xffffffff);
+#if (XLEN == 64)
+  processor.dcr_write(VX_DCR_BASE_STARTUP_ADDR1, startup_addr >> 32);
+#endif
+  processor.dcr_write(VX_DCR_BASE_MPM_CLASS, 0);
+
+  auto start_time = std::chrono::high_resolution_clock::now();
+  processor.run();
+  auto end_time = std::chrono::high_resolution_clock::now();
+
+  int exitcode = 0;
+  ram.read(&exitcode, (IO_MPM_ADDR + 8), 4);
+
+  // the whole report fits in the pipe buffer, so the worker can exit
+  // before the parent reads it
+  std::ostringstream os;
+  os << "exitcode " << exitcode << "\n";
+  os << "sim_time " << std::chrono::duration<double>(end_time - start_time).count() << "\n";
+  for (auto& counter : processor.perf_counters()) {
+    os << counter.first << " " << counter.second << "\n";
+  }
+  auto report = os.str();
+  if (write(fd, report.data(), report.size()) != (ssize_t)report.size())
+    return -1;
+  return WORKER_OK;
+}
+
+static void parse_report(int fd, result_t* result) {
+  std::string report;
+  char buf[4096];
+  ssize_t n;
+  while ((n = read(fd, buf, sizeof(buf))) > 0) {
+    report.append(buf, n);
+  }
+  std::istringstream is(report);
+  std::string name;
+  std::string value;
+  while (is >> name >> value) {
+    if (name == "exitcode") {
+      result->exitcode = std::stoi(value);
+    } else if (name == "sim_time") {
+      result->sim_time = std::stod(value);
+    } else {
+      result->counters.emplace_back(name, std::stoull(value));
+    }
+  }
+}
+
+static pid_t spawn_worker(RAM& ram, const params_t& params, int* fd) {
+  int fds[2];
+  if (pipe(fds) != 0)
+    return -1;
+  // do not duplicate pending output in the child
+  std::cout.flush();
+  std::cerr.flush();
+  auto pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    if (!verbose) {
+      int null_fd = open("/dev/null", O_WRONLY);
+      dup2(null_fd, STDOUT_FILENO);
+      close(null_fd);
+    }
+    int ret = run_worker(ram, params, fds[1]);
+    std::cout.flush();
+    std::cerr.flush();
+    _exit(ret);
+  }
+  close(fds[1]);
+  if (pid < 0) {
+    close(fds[0]);
+    return -1;
+  }
+  *fd = fds[0];
+  return pid;
+}
+
+static int run_sweep(RAM& ram, const std::vector<params_t>& points, std::vector<result_t>* results) {
+  struct job_t {
+    uint32_t point;
+    int fd;
+  };
+  std::unordered_map<pid_t, job_t> jobs;
+  results->assign(points.size(), result_t{result_t::Pending, 0, 0, {}});
+  uint32_t next = 0;
+  uint32_t done = 0;
+  while (next < points.size() || !jobs.empty()) {
+    while (next < points.size() && jobs.size() < num_jobs) {
+      int fd;
+      auto pid = spawn_worker(ram, points.at(next), &fd);
+      if (pid < 0) {
+        std::cerr << "Error: failed to start worker" << std::endl;
+        if (jobs.empty())
+          return -1;
+        break;
+      }
+      jobs[pid] = job_t{next++, fd};
+    }
+
+    int status;
+    auto pid = waitpid(-1, &status, 0);
+    if (pid < 0)
+      return -1;
+    auto it = jobs.find(pid);
+    if (it == jobs.end())
+      continue;
+    auto& job = it->second;
+    auto& result = results->at(job.point);
+    if (WIFEXITED(status) && WEXITSTATUS(status) == WORKER_OK) {
+      parse_report(job.fd, &result);
+      result.status = result.counters.empty() ? result_t::Failed : result_t::Ok;
+    } else if (WIFEXITED(status) && WEXITSTATUS(status) == WORKER_INVALID) {
+      result.status = result_t::Invalid;
+    } else {
+      result.status = result_t::Failed;
+    }
+    close(job.fd);
+
+    std::cout << "[" << ++done << "/" << points.size() << "] point" << job.point << ":";
+    for (auto& param : points.at(job.point)) {
+      std::cout << " " << param.first << "=" << param.second;
+    }
+    switch (result.status) {
+    case result_t::Ok:
+      std::cout << " -> exitcode=" << result.exitcode;
+      for (auto& counter : result.counters) {
+        if (counter.first == "cycles" || counter.first == "instrs")
+          std::cout << ", " << counter.first << "=" << counter.second;
+      }
+      break;
+    case result_t::Invalid:
+      std::cout << " -> invalid configuration";
+      break;
+    default:
+      std::cout << " -> failed";
+      break;
+    }
+    std::cout << std::endl;
+    jobs.erase(it);
+  }
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static const char* status_name(result_t::Status status) {
+  switch (status) {
+  case result_t::Ok:      return "ok";
+  case result_t::Invalid: return "invalid";
+  case result_t::Failed:  return "failed";
+  default:                return "pending";
+  }
+}
+
+static uint64_t counter_value(const result_t& result, const std::string& name) {
+  for (auto& counter : result.counters) {
+    if (counter.first == name)
+      return counter.second;
+  }
+  return 0;
+}
+
+static double result_ipc(const result_t& result) {
+  auto cycles = counter_value(result, "cycles");
+  return cycles ? (double(counter_value(result, "instrs")) / cycles) : 0;
+}
+
+static const char* cache_levels[] = {"icache", "dcache", "l2cache", "l3cache"};
+
+static double result_hit_rate(const result_t& result, const std::string& cache) {
+  auto accesses = counter_value(result, cache + ".reads") + counter_value(result, cache + ".writes");
+  auto misses = counter_value(result, cache + ".read_misses") + counter_value(result, cache + ".write_misses");
+  return accesses ? (1.0 - double(misses) / accesses) : 0;
+}
+
+// counter names of the first completed point, all points share them
+static std::vector<std::string> counter_names(const std::vector<result_t>& results) {
+  std::vector<std::string> names;
+  for (auto& result : results) {
+    if (result.status != result_t::Ok)
+      continue;
+    for (auto& counter : result.counters) {
+      names.push_back(counter.first);
+    }
+    break;
+  }
+  return names;
+}
+
+static int write_csv(const char* filename, const grid_t& grid, const std::vector<params_t>& points, const std::vector<result_t>& results) {
+  std::ofstream ofs(filename);
+  if (!ofs) {
+    std::cerr << "Error: failed to create " << filename << std::endl;
+    return -1;
+  }
+  auto names = counter_names(results);
+  ofs << "point";
+  for (auto& axis : grid) {
+    ofs << "," << axis.first;
+  }
+  ofs << ",status,exitcode,sim_time,ipc";
+  for (auto cache : cache_levels) {
+    ofs << "," << cache << ".hit_rate";
+  }
+  for (auto& name : names) {
+    ofs << "," << name;
+  }
+  ofs << std::endl;
+  for (uint32_t i = 0; i < points.size(); ++i) {
+    auto& result = results.at(i);
+    ofs << i;
+    for (auto& param : points.at(i)) {
+      ofs << "," << param.second;
+    }
+    ofs << "," << status_name(result.status);
+    if (result.status == result_t::Ok) {
+      ofs << "," << result.exitcode << "," << result.sim_time << "," << result_ipc(result);
+      for (auto cache : cache_levels) {
+        ofs << "," << result_hit_rate(result, cache);
+      }
+      for (auto& name : names) {
+        ofs << "," << counter_value(result, name);
+      }
+    }
+    ofs << std::endl;
+  }
+  return 0;
+}
+
+static int write_json(const char* filename, const std::vector<params_t>& points, const std::vector<result_t>& results) {
+  std::ofstream ofs(filename);
+  if (!ofs) {
+    std::cerr << "Error: failed to create " << filename << std::endl;
+    return -1;
+  }
+  auto table = nlohmann::ordered_json::array();
+  for (uint32_t i = 0; i < points.size(); ++i) {
+    auto& result = results.at(i);
+    nlohmann::ordered_json entry;
+    entry["point"] = i;
+    entry["params"] = nlohmann::ordered_json::object();
+    for (auto& param : points.at(i)) {
+      entry["params"][param.first] = param.second;
+    }
+    entry["status"] = status_name(result.status);
+    if (result.status == result_t::Ok) {
+      entry["exitcode"] = result.exitcode;
+      entry["sim_time"] = result.sim_time;
+      entry["ipc"] = result_ipc(result);
+      for (auto cache : cache_levels) {
+        entry[std::string(cache) + ".hit_rate"] = result_hit_rate(result, cache);
+      }
+      auto& perf = entry["perf"];
+      for (auto& counter : result.counters) {
+        perf[counter.first] = counter.second;
+      }
+    }
+    table.push_back(entry);
+  }
+  ofs << table.dump(2) << std::endl;
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  if (num_jobs == 0) {
+    num_jobs = std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+  }
+
+  grid_t grid;
+  if (build_grid(&grid) != 0)
+    return -1;
+  auto points = expand_grid(grid);
+  num_jobs = std::min<uint32_t>(num_jobs, points.size());
+
+  // load the program once, workers share it copy-on-write
+  RAM ram(0, MEM_PAGE_SIZE);
+  {
+    std::string program_ext(fileExtension(program));
+    if (program_ext == "bin" || program_ext == "zst") {
+      ram.loadBinImage(program, STARTUP_ADDR);
+    } else if (program_ext == "hex") {
+      ram.loadHexImage(program);
+    } else {
+      std::cerr << "Error: only *.bin, *.bin.zst or *.hex images supported." << std::endl;
+      return -1;
+    }
+  }
+
+  std::cout << "Sweeping " << program << ": " << points.size() << " points on " << num_jobs << " workers" << std::endl;
+
+  std::vector<result_t> results;
+  if (run_sweep(ram, points, &results) != 0)
+    return -1;
+
+  if (output_file) {
+    std::string output_ext(fileExtension(output_file));
+    int err = (output_ext == "json") ? write_json(output_file, points, results)
+                                     : write_csv(output_file, grid, points, results);
+    if (err != 0)
+      return -1;
+  }
+
+  int failures = 0;
+  for (auto& result : results) {
+    failures += (result.status != result_t::Ok || result.exitcode != 0);
+  }
+  if (failures != 0) {
+    std::cout << failures << " of " << points.size() << " points did not complete successfully" << std::endl;
+  }
+  return failures ? 1 : 0;
+}
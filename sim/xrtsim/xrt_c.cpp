@@ -127,6 +127,14 @@ extern int xrtKernelReadRegister(xrtKernelHandle kernelHandle, uint32_t offset,
   return sim->register_read(offset, data);
 }
 
+extern int xrtSimSetInterruptCallback(xrtDeviceHandle dhdl, void (*callback)(void* arg), void* arg) {
+  if (dhdl == nullptr)
+    return -1;
+  auto sim = reinterpret_cast<xrt_sim*>(dhdl);
+  sim->set_interrupt_callback(callback, arg);
+  return 0;
+}
+
 extern int xrtErrorGetString(xrtDeviceHandle, xrtErrorCode error, char* out, size_t len, size_t* out_len) {
   return 0;
 }
@@ -106,6 +106,10 @@ int xrtKernelReadRegister(xrtKernelHandle kernelHandle, uint32_t offset, uint32_
 
 int xrtErrorGetString(xrtDeviceHandle, xrtErrorCode error, char* out, size_t len, size_t* out_len);
 
+// Simulator extension: the callback is invoked from the simulation thread
+// on the rising edge of the kernel interrupt.
+int xrtSimSetInterruptCallback(xrtDeviceHandle dhdl, void (*callback)(void* arg), void* arg);
+
 #ifdef __cplusplus
 }
 #endif
@@ -130,6 +130,9 @@ public:
   , ram_(nullptr)
   , dram_sim_(PLATFORM_MEMORY_NUM_BANKS, PLATFORM_MEMORY_DATA_SIZE, MEM_CLOCK_RATIO)
   , stop_(false)
+  , interrupt_callback_(nullptr)
+  , interrupt_arg_(nullptr)
+  , interrupt_(false)
 #ifdef VCD_OUTPUT
   , tfp_(nullptr)
 #endif
@@ -309,6 +312,12 @@ public:
     return 0;
   }
 
+  void set_interrupt_callback(xrt_interrupt_callback_t callback, void* arg) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    interrupt_callback_ = callback;
+    interrupt_arg_ = arg;
+  }
+
 private:
 
   void reset() {
@@ -354,6 +363,13 @@ private:
 
     this->axi_mem_bus_eval(1);
 
+    // notify the host on the rising edge of the interrupt
+    bool interrupt = device_->interrupt;
+    if (interrupt && !interrupt_ && interrupt_callback_) {
+      interrupt_callback_(interrupt_arg_);
+    }
+    interrupt_ = interrupt;
+
     dram_sim_.tick();
 
     for (int b = 0; b < PLATFORM_MEMORY_NUM_BANKS; ++b) {
@@ -614,6 +630,10 @@ private:
 
   std::queue<mem_req_t*> dram_queues_[PLATFORM_MEMORY_NUM_BANKS];
 
+  xrt_interrupt_callback_t interrupt_callback_;
+  void* interrupt_arg_;
+  bool interrupt_;
+
 #ifdef VCD_OUTPUT
   VerilatedVcdC* tfp_;
 #endif
@@ -655,4 +675,8 @@ int xrt_sim::register_write(uint32_t offset, uint32_t value) {
 
 int xrt_sim::register_read(uint32_t offset, uint32_t* value) {
   return impl_->register_read(offset, value);
+}
+
+void xrt_sim::set_interrupt_callback(xrt_interrupt_callback_t callback, void* arg) {
+  impl_->set_interrupt_callback(callback, arg);
 }
\ No newline at end of file
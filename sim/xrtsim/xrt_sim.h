@@ -17,6 +17,8 @@
 
 namespace vortex {
 
+typedef void (*xrt_interrupt_callback_t)(void* arg);
+
 class xrt_sim {
 public:
 
@@ -37,6 +39,8 @@ public:
 
   int register_read(uint32_t offset, uint32_t* value);
 
+  void set_interrupt_callback(xrt_interrupt_callback_t callback, void* arg);
+
 private:
 
   class Impl;
@@ -0,0 +1,167 @@
+#include <mempool.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     int _ret = _expr;                                          \
+     if (0 == _ret)                                             \
+       break;                                                   \
+     printf("Error: '%s' returned %d!\n", #_expr, (int)_ret);   \
+     return -1;                                                 \
+   } while (false)
+
+using namespace vortex;
+
+static uint64_t num_ops = 10000000;
+static uint32_t pending = 4096;
+static uint32_t rounds  = 64;
+
+static void show_usage() {
+  printf("Usage: [-n operations] [-p pending] [-r rounds] [-h help]\n");
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "n:p:r:h")) != -1) {
+    switch (c) {
+    case 'n':
+      num_ops = atoll(optarg);
+      break;
+    case 'p':
+      pending = atoi(optarg);
+      break;
+    case 'r':
+      rounds = atoi(optarg);
+      break;
+    case 'h':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+// object sizes of a port event and of an instruction trace
+struct SmallObject {
+  uint64_t id;
+  uint64_t data[5];
+};
+
+struct LargeObject {
+  uint64_t id;
+  uint64_t data[31];
+};
+
+// Keeps a fixed number of live objects and replaces a random one on each
+// operation, as the simulator does with its pending events.
+// Returns the number of corrupted objects.
+template <typename T, typename Alloc>
+static uint64_t churn(Alloc& alloc, uint64_t ops, double* rate) {
+  std::mt19937_64 rng(0x5eed);
+  std::vector<T*> live(pending);
+  uint64_t errors = 0;
+  uint64_t id = 0;
+  for (auto& obj : live) {
+    obj = alloc.allocate(1);
+    obj->id = id++;
+  }
+  std::vector<uint64_t> ids(pending);
+  for (uint32_t i = 0; i < pending; ++i) {
+    ids[i] = i;
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  for (uint64_t i = 0; i < ops; ++i) {
+    uint32_t slot = rng() % pending;
+    if (live[slot]->id != ids[slot]) {
+      ++errors;
+    }
+    alloc.deallocate(live[slot], 1);
+    live[slot] = alloc.allocate(1);
+    live[slot]->id = id;
+    ids[slot] = id++;
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  for (auto obj : live) {
+    alloc.deallocate(obj, 1);
+  }
+  double elapsed = std::chrono::duration<double>(end - start).count();
+  *rate = (ops / elapsed) / 1e6;
+  return errors;
+}
+
+// One thread allocates the pending objects and another one frees them,
+// with a new thread each round like the simulation workers.
+// Returns the number of corrupted objects.
+template <typename T>
+static uint64_t cross_thread(PoolAllocator<T>& alloc, uint32_t num_rounds) {
+  std::vector<T*> live(pending);
+  uint64_t errors = 0;
+  for (uint32_t r = 0; r < num_rounds; ++r) {
+    for (uint32_t i = 0; i < pending; ++i) {
+      live[i] = alloc.allocate(1);
+      live[i]->id = i;
+    }
+    std::thread consumer([&]() {
+      for (uint32_t i = 0; i < pending; ++i) {
+        if (live[i]->id != i) {
+          ++errors;
+        }
+        alloc.deallocate(live[i], 1);
+      }
+    });
+    consumer.join();
+  }
+  return errors;
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  std::allocator<SmallObject> heap_small;
+  std::allocator<LargeObject> heap_large;
+  PoolAllocator<SmallObject> pool_small;
+  PoolAllocator<LargeObject> pool_large;
+  auto& small_pool = MemoryPool<SmallObject>::instance();
+  auto& large_pool = MemoryPool<LargeObject>::instance();
+
+  double heap_rate, pool_rate;
+  printf("operations=%lu, pending=%u\n", num_ops, pending);
+
+  RT_CHECK(churn<SmallObject>(heap_small, num_ops, &heap_rate) != 0);
+  RT_CHECK(churn<SmallObject>(pool_small, num_ops, &pool_rate) != 0);
+  printf("small objects: heap=%.2f Mops/sec, pool=%.2f Mops/sec\n", heap_rate, pool_rate);
+
+  RT_CHECK(churn<LargeObject>(heap_large, num_ops, &heap_rate) != 0);
+  RT_CHECK(churn<LargeObject>(pool_large, num_ops, &pool_rate) != 0);
+  printf("large objects: heap=%.2f Mops/sec, pool=%.2f Mops/sec\n", heap_rate, pool_rate);
+
+  // the steady state must not grow the pools
+  auto small_capacity = small_pool.capacity();
+  auto large_capacity = large_pool.capacity();
+  RT_CHECK(churn<SmallObject>(pool_small, num_ops / 10, &pool_rate) != 0);
+  RT_CHECK(churn<LargeObject>(pool_large, num_ops / 10, &pool_rate) != 0);
+  RT_CHECK(small_pool.capacity() != small_capacity);
+  RT_CHECK(large_pool.capacity() != large_capacity);
+
+  // objects freed by other threads must be reused
+  RT_CHECK(cross_thread(pool_small, 2) != 0);
+  small_capacity = small_pool.capacity();
+  RT_CHECK(cross_thread(pool_small, rounds) != 0);
+  printf("cross-thread: rounds=%u, capacity=%lu\n", rounds, small_pool.capacity());
+  RT_CHECK(small_pool.capacity() != small_capacity);
+
+  mempool_dump_stats(std::cout);
+
+  printf("PASSED!\n");
+
+  return 0;
+}
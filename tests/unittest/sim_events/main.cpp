@@ -0,0 +1,244 @@
+#include <simobject.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#define RT_CHECK(_expr)                                         \
+   do {                                                         \
+     int _ret = _expr;                                          \
+     if (0 == _ret)                                             \
+       break;                                                   \
+     printf("Error: '%s' returned %d!\n", #_expr, (int)_ret);   \
+     return -1;                                                 \
+   } while (false)
+
+using namespace vortex;
+
+static uint64_t num_events = 1000000;
+static uint32_t max_delay  = 2048;
+static uint32_t pending    = 4096;
+
+static void show_usage() {
+  printf("Usage: [-n events] [-d max_delay] [-p pending] [-h help]\n");
+}
+
+static void parse_args(int argc, char **argv) {
+  int c;
+  while ((c = getopt(argc, argv, "n:d:p:h")) != -1) {
+    switch (c) {
+    case 'n':
+      num_events = atoll(optarg);
+      break;
+    case 'd':
+      max_delay = atoi(optarg);
+      break;
+    case 'p':
+      pending = atoi(optarg);
+      break;
+    case 'h':
+      show_usage();
+      exit(0);
+      break;
+    default:
+      show_usage();
+      exit(-1);
+    }
+  }
+}
+
+// Each fired event re-schedules a new one with a random delay until
+// num_events have been issued, keeping the pending queue at a steady size.
+class EventBench {
+public:
+  EventBench()
+    : rng_(0x5eed)
+    , dist_(1, max_delay)
+    , issued_(0)
+    , fired_(0)
+    , last_cycle_(0)
+    , last_seq_(0)
+    , errors_(0) {
+    targets_.reserve(num_events);
+  }
+
+  void issue() {
+    if (issued_ == num_events)
+      return;
+    auto& platform = SimPlatform::instance();
+    uint64_t delay = dist_(rng_);
+    uint64_t seq = issued_++;
+    targets_.push_back(platform.cycles() + delay);
+    platform.schedule<uint64_t>([this](const uint64_t& seq) {
+      this->fire(seq);
+    }, seq, delay);
+  }
+
+  void fire(uint64_t seq) {
+    auto cycle = SimPlatform::instance().cycles();
+    // events must fire on their target cycle in issue order
+    if (targets_.at(seq) != cycle
+     || (fired_ != 0 && cycle == last_cycle_ && seq < last_seq_)) {
+      ++errors_;
+    }
+    last_cycle_ = cycle;
+    last_seq_ = seq;
+    ++fired_;
+    this->issue();
+  }
+
+  bool done() const {
+    return fired_ == num_events;
+  }
+
+  uint64_t errors() const {
+    return errors_;
+  }
+
+private:
+  std::mt19937_64 rng_;
+  std::uniform_int_distribution<uint32_t> dist_;
+  std::vector<uint64_t> targets_;
+  uint64_t issued_;
+  uint64_t fired_;
+  uint64_t last_cycle_;
+  uint64_t last_seq_;
+  uint64_t errors_;
+};
+
+// Two objects bouncing a token with short and long port delays, the token
+// must arrive on the same cycles whether or not idle cycles are skipped
+// or idle objects are put to sleep.
+class PingPong : public SimObject<PingPong> {
+public:
+  SimPort<uint32_t> Input;
+  SimPort<uint32_t> Output;
+
+  PingPong(const SimContext& ctx, uint32_t delay)
+    : SimObject<PingPong>(ctx, "ping-pong")
+    , Input(this)
+    , Output(this)
+    , delay_(delay)
+  {}
+
+  void reset() {
+    cycles_ = 0;
+    ticks_ = 0;
+    signature_ = 0;
+    done_ = false;
+  }
+
+  void tick() {
+    ++cycles_;
+    ++ticks_;
+    if (Input.empty())
+      return;
+    auto hops = Input.front();
+    signature_ = signature_ * 31 + SimPlatform::instance().cycles() * 7 + cycles_;
+    if (hops != 0) {
+      Output.push(hops - 1, delay_);
+    } else {
+      done_ = true;
+    }
+    Input.pop();
+  }
+
+  bool idle() const {
+    return Input.empty();
+  }
+
+  void skip(uint64_t cycles) {
+    cycles_ += cycles;
+  }
+
+  uint64_t signature() const {
+    return signature_;
+  }
+
+  bool done() const {
+    return done_;
+  }
+
+  uint64_t ticks() const {
+    return ticks_;
+  }
+
+private:
+  uint32_t delay_;
+  uint64_t cycles_;
+  uint64_t ticks_;
+  uint64_t signature_;
+  bool done_;
+};
+
+static uint64_t run_ping_pong(PingPong* ping, PingPong* pong, bool fast_forward, bool tracking, uint64_t* skipped) {
+  auto& platform = SimPlatform::instance();
+  platform.set_activity_tracking(tracking);
+  platform.reset();
+  ping->Output.push(64, 1);
+  *skipped = 0;
+  while (!ping->done() && !pong->done()) {
+    if (fast_forward) {
+      *skipped += platform.fast_forward();
+    }
+    platform.tick();
+  }
+  return ping->signature() ^ (pong->signature() << 1);
+}
+
+int main(int argc, char **argv) {
+  parse_args(argc, argv);
+
+  auto& platform = SimPlatform::instance();
+  platform.reset();
+
+  EventBench bench;
+  for (uint32_t i = 0; i < pending; ++i) {
+    bench.issue();
+  }
+
+  auto start = std::chrono::high_resolution_clock::now();
+  while (!bench.done()) {
+    platform.tick();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+
+  double elapsed = std::chrono::duration<double>(end - start).count();
+  printf("events=%lu, max_delay=%u, pending=%u, cycles=%lu\n",
+         num_events, max_delay, pending, platform.cycles());
+  printf("elapsed=%.3f sec, rate=%.2f Mevents/sec\n",
+         elapsed, (num_events / elapsed) / 1e6);
+
+  RT_CHECK(bench.errors() != 0);
+
+  // idle fast-forwarding
+  {
+    auto ping = PingPong::Create(37);
+    auto pong = PingPong::Create(3 * max_delay);
+    ping->Output.bind(&pong->Input);
+    pong->Output.bind(&ping->Input);
+    uint64_t skipped;
+    auto ref_signature = run_ping_pong(ping.get(), pong.get(), false, false, &skipped);
+    auto ref_cycles = platform.cycles();
+    auto ref_ticks = ping->ticks() + pong->ticks();
+    auto signature = run_ping_pong(ping.get(), pong.get(), true, false, &skipped);
+    printf("fast-forward: cycles=%lu, skipped=%lu\n", platform.cycles(), skipped);
+    RT_CHECK(signature != ref_signature || platform.cycles() != ref_cycles || skipped == 0);
+
+    // activity tracking, with and without fast-forwarding
+    signature = run_ping_pong(ping.get(), pong.get(), false, true, &skipped);
+    platform.catch_up();
+    auto ticks = ping->ticks() + pong->ticks();
+    printf("activity: cycles=%lu, ticks=%lu/%lu\n", platform.cycles(), ticks, ref_ticks);
+    RT_CHECK(signature != ref_signature || platform.cycles() != ref_cycles || ticks >= ref_ticks);
+    signature = run_ping_pong(ping.get(), pong.get(), true, true, &skipped);
+    RT_CHECK(signature != ref_signature || platform.cycles() != ref_cycles || skipped == 0);
+  }
+
+  platform.finalize();
+
+  printf("PASSED!\n");
+
+  return 0;
+}
@@ -44,6 +44,19 @@ int main() {
     RT_CHECK(allocator->release(a2));
     RT_CHECK(allocator->release(a3));
 
+    // aligned allocations split off the unaligned head of their block
+    RT_CHECK(allocator->allocate(1, &a0));
+    RT_CHECK(allocator->allocate(0x100, 0x400, &a1));
+    RT_CHECK((a1 & 0x3ff) != 0);
+    RT_CHECK(allocator->allocate(1, &a2));
+    RT_CHECK(a2 >= a1);
+    RT_CHECK(allocator->allocate(0x200000, 0x200000, &a3));
+    RT_CHECK((a3 & 0x1fffff) != 0);
+    RT_CHECK(allocator->release(a1));
+    RT_CHECK(allocator->release(a0));
+    RT_CHECK(allocator->release(a3));
+    RT_CHECK(allocator->release(a2));
+
     delete allocator;
 
     printf("PASSED!\n");